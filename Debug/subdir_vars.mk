@@ -18,6 +18,7 @@ C_SRCS += \
 ../images.c \
 ../tm4c123gh6pm_startup_ccs.c \
 ../touch.c \
+../touchcal.c \
 C:/ti/TivaWare_C_Series-2.1.3.156/utils/ustdlib.c 
 
 C_DEPS += \
@@ -26,6 +27,7 @@ C_DEPS += \
 ./images.d \
 ./tm4c123gh6pm_startup_ccs.d \
 ./touch.d \
+./touchcal.d \
 ./ustdlib.d 
 
 OBJS += \
@@ -34,6 +36,7 @@ OBJS += \
 ./images.obj \
 ./tm4c123gh6pm_startup_ccs.obj \
 ./touch.obj \
+./touchcal.obj \
 ./ustdlib.obj 
 
 OBJS__QUOTED += \
@@ -42,6 +45,7 @@ OBJS__QUOTED += \
 "images.obj" \
 "tm4c123gh6pm_startup_ccs.obj" \
 "touch.obj" \
+"touchcal.obj" \
 "ustdlib.obj" 
 
 C_DEPS__QUOTED += \
@@ -50,6 +54,7 @@ C_DEPS__QUOTED += \
 "images.d" \
 "tm4c123gh6pm_startup_ccs.d" \
 "touch.d" \
+"touchcal.d" \
 "ustdlib.d" 
 
 C_SRCS__QUOTED += \
@@ -58,6 +63,7 @@ C_SRCS__QUOTED += \
 "../images.c" \
 "../tm4c123gh6pm_startup_ccs.c" \
 "../touch.c" \
+"../touchcal.c" \
 "C:/ti/TivaWare_C_Series-2.1.3.156/utils/ustdlib.c" 
 
 
@@ -37,6 +37,28 @@
 //
 #define LCD_READ_START      0x00000004
 
+//*****************************************************************************
+//
+// The size in bytes of the shadow frame buffer that must be supplied to
+// Kentec320x240x16_SSD2119MonoInit().
+//
+//*****************************************************************************
+#define KENTEC_MONO_BUFFER_SIZE (320 * 240 / 8)
+
+//*****************************************************************************
+//
+// A horizontal run of pixels for Kentec320x240x16_SSD2119SpansFill(), from
+// i16X1 to i16X2 inclusive on row i16Y.
+//
+//*****************************************************************************
+typedef struct
+{
+    int16_t i16Y;
+    int16_t i16X1;
+    int16_t i16X2;
+}
+tSSD2119Span;
+
 //*****************************************************************************
 //
 // Prototypes for the globals exported by this driver.
@@ -46,6 +68,38 @@ extern void Kentec320x240x16_SSD2119Init(void);
 extern const tDisplay g_sKentec320x240x16_SSD2119;
 extern void Kentec320x240x16_SSD2119SetLCDControl(unsigned char ucMask,
                                                     unsigned char ucVal);
+extern const tDisplay g_sKentec320x240x16_SSD2119Capture;
+extern void Kentec320x240x16_SSD2119CaptureSet(unsigned short *pusBuffer,
+                                               const tRectangle *pRect);
+extern void Kentec320x240x16_SSD2119Blit(const tRectangle *pRect,
+                                         const unsigned short *pusData);
+extern void Kentec320x240x16_SSD2119FramesEncode(const unsigned short *pusPixels,
+                                                 unsigned short *pusFrames,
+                                                 unsigned int ulCount);
+extern void Kentec320x240x16_SSD2119FramesBlit(const tRectangle *pRect,
+                                               const unsigned short *pusFrames);
+extern void Kentec320x240x16_SSD2119SpansFill(const tSSD2119Span *psSpans,
+                                              unsigned int ulCount,
+                                              unsigned int ulValue);
+extern void Kentec320x240x16_SSD2119IntHandler(void);
+#ifdef TILE_RENDER
+extern void Kentec320x240x16_SSD2119TilePaint(const tRectangle *pRegion,
+                                              unsigned int ulBackground,
+                                              void (*pfnPaint)(void *pvData),
+                                              void *pvData);
+extern void Kentec320x240x16_SSD2119TileStats(unsigned int *pulSent,
+                                              unsigned int *pulSkipped,
+                                              bool bReset);
+#endif
+extern const tDisplay g_sKentec320x240x16_SSD2119Mono;
+extern void Kentec320x240x16_SSD2119MonoInit(unsigned char *pucBuffer,
+                                             unsigned int ulForeground,
+                                             unsigned int ulBackground);
+extern void Kentec320x240x16_SSD2119MonoInvert(const tRectangle *pRect);
+extern void Kentec320x240x16_SSD2119TxRingStats(unsigned int *pulHighWater,
+                                                unsigned int *pulStalls,
+                                                bool bReset);
+extern unsigned int Kentec320x240x16_SSD2119DrawCount(void);
 extern void LED_ON(void);
 extern void LED_OFF(void);
 #endif // __KENTEC320X240X16_SSD2119_H__
@@ -21,6 +21,7 @@
 #include "inc/hw_memmap.h"
 #include "inc/hw_ssi.h"
 #include "inc/hw_types.h"
+#include "inc/hw_udma.h"
 #include "driverlib/gpio.h"
 #include "driverlib/interrupt.h"
 #include "driverlib/sysctl.h"
@@ -28,6 +29,7 @@
 #include "driverlib/rom.h"
 #include "driverlib/pin_map.h"
 #include "driverlib/ssi.h"
+#include "driverlib/udma.h"
 #include "grlib/grlib.h"
 #include "Kentec320x240x16_ssd2119_8bit.h"
 //#include "drivers/set_pinout.h"
@@ -66,9 +68,59 @@
 //#define PORTRAIT
 #endif
 
+//*****************************************************************************
+//
+// This driver can talk to the SSD2119 over one of three interfaces:
+//
+// * SPI_3 - 3-wire SPI on SSI2 with 9-bit frames, the D/C bit being carried
+//           in the first bit of every frame.
+//
+// * SPI_4 - 4-wire SPI on SSI2 with 8-bit frames and a separate D/C GPIO.
+//
+// * Parallel_8 - 8080-style 8-bit parallel bus driven from GPIO (PS3-0 =
+//                0011b on the panel).
+//
+// If no interface is selected, SPI_3 is used.
+//
+//*****************************************************************************
+#if ! defined(SPI_4) && ! defined(SPI_3) && ! defined(Parallel_8)
 //#define SPI_4
 #define SPI_3
-//#define Parallel_8 
+//#define Parallel_8
+#endif
+
+#if (defined(SPI_3) + defined(SPI_4) + defined(Parallel_8)) != 1
+#error "Select exactly one of SPI_3, SPI_4 or Parallel_8"
+#endif
+
+//*****************************************************************************
+//
+// In SPI_3 mode every byte on the wire is a self-contained 9-bit frame, so a
+// complete drawing primitive (window setup, RAM write command and pixels) can
+// be streamed into SSI2 by the uDMA controller with no CPU involvement.  This
+// is used automatically once the application has enabled the uDMA controller
+// and set its control table; until then, and when LCD_NO_DMA is defined, all
+// drawing goes through the CPU.
+//
+//*****************************************************************************
+//
+// Where no uDMA channel can be given to SSI2, defining LCD_TX_RING instead
+// queues the frames in a RAM ring that the SSI2 transmit interrupt drains,
+// so that drawing calls return as soon as their frames are queued.
+//
+#if defined(LCD_TX_RING) && ! defined(SPI_3)
+#error "LCD_TX_RING is only supported with SPI_3"
+#endif
+
+#if defined(SPI_3) && ! defined(LCD_NO_DMA) && ! defined(LCD_TX_RING)
+#define LCD_DMA
+#endif
+
+//
+// The tile renderer, Kentec320x240x16_SSD2119TilePaint(), keeps a hash of
+// every tile of the screen and a scratch tile in RAM, so it is only included
+// when TILE_RENDER is defined for the project.
+//
 
 //*****************************************************************************
 //
@@ -129,12 +181,19 @@
 #define LCD_RD_PERIPH           SYSCTL_PERIPH_GPIOA
 #define LCD_RD_BASE             GPIO_PORTA_BASE
 #define LCD_RD_PIN              GPIO_PIN_4
+#define LCD_DC_PERIPH           SYSCTL_PERIPH_GPIOA
+#define LCD_DC_BASE             GPIO_PORTA_BASE
+#define LCD_DC_PIN              GPIO_PIN_6
+#define LCD_CS_PERIPH           SYSCTL_PERIPH_GPIOA
+#define LCD_CS_BASE             GPIO_PORTA_BASE
+#define LCD_CS_PIN              GPIO_PIN_7
 #endif
 
 #define LCD_RST_PERIPH          SYSCTL_PERIPH_GPIOD
 #define LCD_RST_BASE            GPIO_PORTD_BASE
 #define LCD_RST_PIN             GPIO_PIN_7
 
+#if defined(SPI_3) || defined(SPI_4)
 #define LCD_SSI_BASE SSI2_BASE
 
 #define LCD_SSI_GPIOPERIPH        SYSCTL_PERIPH_GPIOB
@@ -143,6 +202,7 @@
 #define LCD_SCLK_PIN          GPIO_PIN_4
 #define LCD_CS_PIN              GPIO_PIN_5
 #define LCD_SDA_PIN          GPIO_PIN_7
+#endif
 
 //*****************************************************************************
 //
@@ -171,6 +231,107 @@
     HWREG(LCD_DATAH_BASE + GPIO_O_DATA + (LCD_DATAH_PINS << 2)) = (ucByte);   \
 }
 
+#if defined(SPI_3) || defined(SPI_4)
+//*****************************************************************************
+//
+// Macro used to place a frame into the SSI transmit FIFO, waiting for room.
+// This is SSIDataPut() without the call overhead, for use in burst loops.
+//
+//*****************************************************************************
+#define SSI_FIFO_PUT(ulFrame)                                                 \
+{                                                                             \
+    while(!(HWREG(LCD_SSI_BASE + SSI_O_SR) & SSI_SR_TNF))                     \
+    {                                                                         \
+    }                                                                         \
+    HWREG(LCD_SSI_BASE + SSI_O_DR) = (ulFrame);                               \
+}
+#endif
+
+#ifdef Parallel_8
+//*****************************************************************************
+//
+// Timing of the 8080 bus WR strobe.  The SSD2119 needs WR held low for at
+// least LCD_WR_LOW_NS and high for at least LCD_WR_HIGH_NS.  Each edge is
+// padded by repeating the same GPIO write, assuming one write per system
+// clock, so the number of writes is derived from LCD_SYSCLK_HZ at compile
+// time.  LCD_SYSCLK_HZ must be at least the clock passed to SysCtlClockSet();
+// the default is the TM4C123 maximum so that any application is in spec.
+//
+// With the defaults (80 MHz: 5 writes low, 4 high) a pixel costs two strobes
+// of ten writes each, about 250 ns, or up to 4 Mpixel/s on the bus.  The same
+// pixel takes 18 SSI clocks in SPI_3 mode, 900 ns with the SSI at 20 MHz, so
+// the parallel bus moves roughly three to four times as many pixels.  These
+// are bus-time estimates from the write counts, not measurements.
+//
+//*****************************************************************************
+#ifndef LCD_SYSCLK_HZ
+#define LCD_SYSCLK_HZ           80000000
+#endif
+#define LCD_WR_LOW_NS           60
+#define LCD_WR_HIGH_NS          50
+#define LCD_NS_TO_WRITES(ns)    ((((ns) * (LCD_SYSCLK_HZ / 1000000)) + 999) / \
+                                 1000)
+#define LCD_WR_LOW_WRITES       LCD_NS_TO_WRITES(LCD_WR_LOW_NS)
+#define LCD_WR_HIGH_WRITES      LCD_NS_TO_WRITES(LCD_WR_HIGH_NS)
+
+#if (LCD_WR_LOW_WRITES > 8) || (LCD_WR_HIGH_WRITES > 8)
+#error "LCD_SYSCLK_HZ is too high for the WR padding macros"
+#endif
+
+//*****************************************************************************
+//
+// Repeats a register write a compile-time constant number of times (at least
+// once and at most eight).  The conditions are constant, so only the writes
+// remain in the generated code.
+//
+//*****************************************************************************
+#define LCD_PAD(ulCount, sWrite)                                              \
+{                                                                             \
+    sWrite;                                                                   \
+    if((ulCount) > 1) { sWrite; }                                             \
+    if((ulCount) > 2) { sWrite; }                                             \
+    if((ulCount) > 3) { sWrite; }                                             \
+    if((ulCount) > 4) { sWrite; }                                             \
+    if((ulCount) > 5) { sWrite; }                                             \
+    if((ulCount) > 6) { sWrite; }                                             \
+    if((ulCount) > 7) { sWrite; }                                             \
+}
+
+//*****************************************************************************
+//
+// Macros used to strobe WR, to drive D/C and to select and deselect the
+// panel.  D/C must be stable around both edges of WR, so it is changed
+// outside a strobe: lowered before the bus is set for the first byte of a
+// command, which gives at least one write of setup before WR falls, and
+// raised only after the WR high padding of the last byte, which gives the
+// hold time.
+//
+//*****************************************************************************
+#define LCD_STROBE(ucPins)                                                    \
+{                                                                             \
+    LCD_PAD(LCD_WR_LOW_WRITES,                                                \
+            HWREG(LCD_WR_BASE + GPIO_O_DATA + ((ucPins) << 2)) = 0);          \
+    LCD_PAD(LCD_WR_HIGH_WRITES,                                               \
+            HWREG(LCD_WR_BASE + GPIO_O_DATA + ((ucPins) << 2)) = (ucPins));   \
+}
+#define LCD_DC_COMMAND()                                                      \
+{                                                                             \
+    HWREG(LCD_DC_BASE + GPIO_O_DATA + (LCD_DC_PIN << 2)) = 0;                 \
+}
+#define LCD_DC_DATA()                                                         \
+{                                                                             \
+    HWREG(LCD_DC_BASE + GPIO_O_DATA + (LCD_DC_PIN << 2)) = LCD_DC_PIN;        \
+}
+#define LCD_CS_ASSERT()                                                       \
+{                                                                             \
+    HWREG(LCD_CS_BASE + GPIO_O_DATA + (LCD_CS_PIN << 2)) = 0;                 \
+}
+#define LCD_CS_DEASSERT()                                                     \
+{                                                                             \
+    HWREG(LCD_CS_BASE + GPIO_O_DATA + (LCD_CS_PIN << 2)) = LCD_CS_PIN;        \
+}
+#endif
+
 //*****************************************************************************
 //
 // Various internal SD2119 registers name labels
@@ -259,6 +420,9 @@ typedef void (*pfnWriteCommand)(unsigned char ucData);
 
 static void WriteDataGPIO(unsigned short usData);
 static void WriteCommandGPIO(unsigned char ucData);
+#ifdef LCD_DMA
+static void DMAWait(void);
+#endif
 
 pfnWriteData WriteData = WriteDataGPIO;
 pfnWriteCommand WriteCommand = WriteCommandGPIO;
@@ -315,7 +479,195 @@ WriteCommandGPIO(unsigned char out) {
 	}
 	DC_mode = 0;
 }
+
+//*****************************************************************************
+//
+// Writes the same data word to the SSD2119 a number of times.  D/C is set
+// once for the whole burst and the bytes go straight into the SSI FIFO.
+//
+//*****************************************************************************
+static void
+WriteDataRepeat(unsigned short usData, unsigned int ulCount)
+{
+    unsigned int ulHigh, ulLow;
+
+    ulHigh = usData >> 8;
+    ulLow = usData & 0xff;
+    if(DC_mode != 1)
+    {
+        while(SSIBusy(LCD_SSI_BASE))
+            ;
+        GPIOPinWrite(LCD_DC_BASE, LCD_DC_PIN, LCD_DC_PIN); // DC=1
+        DC_mode = 1;
+    }
+    while(ulCount--)
+    {
+        SSI_FIFO_PUT(ulHigh);
+        SSI_FIFO_PUT(ulLow);
+    }
+
+    //
+    // Let the burst drain so that a following command can safely drop D/C.
+    //
+    while(SSIBusy(LCD_SSI_BASE))
+        ;
+}
+
+//*****************************************************************************
+//
+// Writes an array of data words to the SSD2119 in a single burst.
+//
+//*****************************************************************************
+static void
+WriteDataArray(const unsigned short *pusData, unsigned int ulCount)
+{
+    if(DC_mode != 1)
+    {
+        while(SSIBusy(LCD_SSI_BASE))
+            ;
+        GPIOPinWrite(LCD_DC_BASE, LCD_DC_PIN, LCD_DC_PIN); // DC=1
+        DC_mode = 1;
+    }
+    while(ulCount--)
+    {
+        SSI_FIFO_PUT(*pusData >> 8);
+        SSI_FIFO_PUT(*pusData++ & 0xff);
+    }
+
+    //
+    // Let the burst drain so that a following command can safely drop D/C.
+    //
+    while(SSIBusy(LCD_SSI_BASE))
+        ;
+}
+#endif
+#ifdef LCD_TX_RING
+//*****************************************************************************
+//
+// The ring of frames waiting for the SSI.  The drawing code adds frames at
+// the head and the SSI2 transmit interrupt, raised while the transmit FIFO is
+// half empty or less, moves them from the tail into the FIFO.  The interrupt
+// is only enabled while the ring holds frames.  The size is in frames and
+// must be a power of two.
+//
+//*****************************************************************************
+#ifndef LCD_TX_RING_SIZE
+#define LCD_TX_RING_SIZE        512
+#endif
+
+#if (LCD_TX_RING_SIZE & (LCD_TX_RING_SIZE - 1)) != 0
+#error "LCD_TX_RING_SIZE must be a power of two"
+#endif
+
+static unsigned short g_pusTxRing[LCD_TX_RING_SIZE];
+static volatile unsigned int g_ulTxRingHead;
+static volatile unsigned int g_ulTxRingTail;
+static volatile bool g_bTxRingActive;
+
+//
+// The most frames ever waiting in the ring, and the number of times the
+// drawing code found it full and had to feed the FIFO itself.
+//
+static unsigned int g_ulTxRingHighWater;
+static unsigned int g_ulTxRingStalls;
+
+//*****************************************************************************
+//
+// Moves frames from the ring into the transmit FIFO until one of them is
+// empty or full, and turns the interrupt off once the ring is empty.  The
+// ring is checked again after the interrupt is turned off, in case a frame
+// was added in between.
+//
+//*****************************************************************************
+static void
+TxRingService(void)
+{
+    unsigned int ulTail;
+
+    ulTail = g_ulTxRingTail;
+    while((ulTail != g_ulTxRingHead) &&
+          (HWREG(LCD_SSI_BASE + SSI_O_SR) & SSI_SR_TNF))
+    {
+        HWREG(LCD_SSI_BASE + SSI_O_DR) = g_pusTxRing[ulTail];
+        ulTail = (ulTail + 1) & (LCD_TX_RING_SIZE - 1);
+    }
+    g_ulTxRingTail = ulTail;
+
+    if(ulTail == g_ulTxRingHead)
+    {
+        SSIIntDisable(LCD_SSI_BASE, SSI_TXFF);
+        g_bTxRingActive = false;
+        if(ulTail != g_ulTxRingHead)
+        {
+            g_bTxRingActive = true;
+            SSIIntEnable(LCD_SSI_BASE, SSI_TXFF);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Adds a frame to the ring.  If the ring is full the caller blocks, feeding
+// the FIFO itself with the interrupt masked so that this also works from a
+// handler that the SSI2 interrupt cannot preempt.
+//
+//*****************************************************************************
+static void
+TxRingPut(unsigned int ulFrame)
+{
+    unsigned int ulHead, ulNext, ulUsed;
+
+    ulHead = g_ulTxRingHead;
+    ulNext = (ulHead + 1) & (LCD_TX_RING_SIZE - 1);
+    if(ulNext == g_ulTxRingTail)
+    {
+        g_ulTxRingStalls++;
+        do
+        {
+            IntDisable(INT_SSI2);
+            TxRingService();
+            IntEnable(INT_SSI2);
+        }
+        while(ulNext == g_ulTxRingTail);
+    }
+
+    g_pusTxRing[ulHead] = ulFrame;
+    g_ulTxRingHead = ulNext;
+
+    ulUsed = (ulNext - g_ulTxRingTail) & (LCD_TX_RING_SIZE - 1);
+    if(ulUsed > g_ulTxRingHighWater)
+    {
+        g_ulTxRingHighWater = ulUsed;
+    }
+
+    if(!g_bTxRingActive)
+    {
+        g_bTxRingActive = true;
+        SSIIntEnable(LCD_SSI_BASE, SSI_TXFF);
+    }
+}
+
+//*****************************************************************************
+//
+// Waits until every queued frame has been handed to the SSI.
+//
+//*****************************************************************************
+static void
+TxRingWait(void)
+{
+    while(g_ulTxRingTail != g_ulTxRingHead)
+    {
+        IntDisable(INT_SSI2);
+        TxRingService();
+        IntEnable(INT_SSI2);
+    }
+}
+
+#define LCD_FRAME_PUT(ulFrame)  TxRingPut(ulFrame)
+#elif defined(SPI_3)
+#define LCD_FRAME_PUT(ulFrame)  SSI_FIFO_PUT(ulFrame)
 #endif
+
 #ifdef SPI_3
 
 // Data: DC bit is 1.
@@ -324,13 +676,55 @@ WriteDataGPIO(unsigned short out)
 {
 	unsigned char datH, datL;
 	datH = out>>8;	datL = out;
-	SSIDataPut(LCD_SSI_BASE,  0x100 | datH);
-	SSIDataPut(LCD_SSI_BASE, 0x100 | datL);
+	LCD_FRAME_PUT(0x100 | datH);
+	LCD_FRAME_PUT(0x100 | datL);
 }
 // Command: DC bit is 0.
 static void
 WriteCommandGPIO(unsigned char out) {
-	SSIDataPut(LCD_SSI_BASE, out);
+#ifdef LCD_DMA
+	//
+	// Every CPU transaction starts with a command, so this is where the CPU
+	// waits for a uDMA sequence still feeding the SSI to finish.
+	//
+	DMAWait();
+#endif
+	LCD_FRAME_PUT(out);
+}
+
+//*****************************************************************************
+//
+// Writes the same data word to the SSD2119 a number of times.  Both 9-bit
+// frames are computed once and fed straight into the SSI FIFO.
+//
+//*****************************************************************************
+static void
+WriteDataRepeat(unsigned short usData, unsigned int ulCount)
+{
+    unsigned int ulHigh, ulLow;
+
+    ulHigh = 0x100 | (usData >> 8);
+    ulLow = 0x100 | (usData & 0xff);
+    while(ulCount--)
+    {
+        LCD_FRAME_PUT(ulHigh);
+        LCD_FRAME_PUT(ulLow);
+    }
+}
+
+//*****************************************************************************
+//
+// Writes an array of data words to the SSD2119 in a single burst.
+//
+//*****************************************************************************
+static void
+WriteDataArray(const unsigned short *pusData, unsigned int ulCount)
+{
+    while(ulCount--)
+    {
+        LCD_FRAME_PUT(0x100 | (*pusData >> 8));
+        LCD_FRAME_PUT(0x100 | (*pusData++ & 0xff));
+    }
 }
 #endif
 
@@ -338,48 +732,22 @@ WriteCommandGPIO(unsigned char out) {
 static void
 WriteDataGPIO(unsigned short usData)
 {
-	//
-    // Write the most significant byte of the data to the bus.
-    //
-    SET_LCD_DATA(usData >> 8);
-
-	HWREG(LCD_CS_BASE + GPIO_O_DATA + (LCD_CS_PIN << 2)) = 0;
-    
-    //
-    // Assert the write enable signal.  Do this three times to ensure that we
-    // meet the display timing requirements (20nS per instruction at 50MHz
-    // means we need to ensure at least 3 instructions between edges on WR)
-    //
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + (LCD_WR_PIN << 2)) = 0;
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + (LCD_WR_PIN << 2)) = 0;
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + (LCD_WR_PIN << 2)) = 0;
+    LCD_CS_ASSERT();
 
     //
-    // Deassert the write enable signal.
+    // Write the most significant byte of the data to the bus and strobe WR.
+    // D/C is left high (data) by the previous command write.
     //
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + (LCD_WR_PIN << 2)) = LCD_WR_PIN;
+    SET_LCD_DATA(usData >> 8);
+    LCD_STROBE(LCD_WR_PIN);
 
     //
-    // Write the least significant byte of the data to the bus.
+    // Write the least significant byte of the data to the bus and strobe WR.
     //
     SET_LCD_DATA(usData);
+    LCD_STROBE(LCD_WR_PIN);
 
-    //
-    // Assert the write enable signal.
-    //
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + (LCD_WR_PIN << 2)) = 0;
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + (LCD_WR_PIN << 2)) = 0;
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + (LCD_WR_PIN << 2)) = 0;
-
-    //
-    // Deassert the write enable signal.
-    //
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + (LCD_WR_PIN << 2)) = LCD_WR_PIN;
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + (LCD_WR_PIN << 2)) = LCD_WR_PIN;
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + (LCD_WR_PIN << 2)) = LCD_WR_PIN;
-
-	HWREG(LCD_CS_BASE + GPIO_O_DATA + (LCD_CS_PIN << 2)) = LCD_CS_PIN;
-    
+    LCD_CS_DEASSERT();
 }
 //*****************************************************************************
 //
@@ -389,60 +757,91 @@ WriteDataGPIO(unsigned short usData)
 //*****************************************************************************
 static void
 WriteCommandGPIO(unsigned char ucData)
-
 {
-    //
-    // Write the most significant byte of the data to the bus. This is always
-    // 0 since commands are no more than 8 bits currently.
-    //
-    SET_LCD_DATA(0);
-
-	HWREG(LCD_CS_BASE + GPIO_O_DATA + (LCD_CS_PIN << 2)) = 0;
-    
-    //
-    // Assert the write enable and DC signals.  Do this 3 times to slow things
-    // down a bit.
-    //
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + ((LCD_WR_PIN | LCD_DC_PIN) << 2)) = 0;
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + ((LCD_WR_PIN | LCD_DC_PIN) << 2)) = 0;
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + ((LCD_WR_PIN | LCD_DC_PIN) << 2)) = 0;
+    LCD_CS_ASSERT();
 
     //
-    // Deassert the write enable and DC signals. We need to leave WR high for
-    // at least 50nS so, again, stick in dummy writes to pad the timing.
+    // Select the command register, then write the most significant byte of
+    // the data to the bus. This is always 0 since commands are no more than 8
+    // bits currently.
     //
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + ((LCD_WR_PIN | LCD_DC_PIN) << 2)) =
-        (LCD_WR_PIN | LCD_DC_PIN);
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + ((LCD_WR_PIN | LCD_DC_PIN) << 2)) =
-        (LCD_WR_PIN | LCD_DC_PIN);
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + ((LCD_WR_PIN | LCD_DC_PIN) << 2)) =
-        (LCD_WR_PIN | LCD_DC_PIN);
+    LCD_DC_COMMAND();
+    SET_LCD_DATA(0);
+    LCD_STROBE(LCD_WR_PIN);
 
     //
     // Write the least significant byte of the data to the bus.
     //
     SET_LCD_DATA(ucData);
+    LCD_STROBE(LCD_WR_PIN);
 
     //
-    // Assert the write enable signal.  Again, do this three times to ensure
-    // we meet the timing spec.
+    // Return D/C high once WR has been high for its padding, leaving the bus
+    // in data mode.
     //
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + ((LCD_WR_PIN | LCD_DC_PIN) << 2)) = 0;
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + ((LCD_WR_PIN | LCD_DC_PIN) << 2)) = 0;
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + ((LCD_WR_PIN | LCD_DC_PIN) << 2)) = 0;
+    LCD_DC_DATA();
 
-    //
-    // Deassert the write enable and DC signals.  Make sure we add padding here
-    // too since some compilers inline this function.
-    //
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + ((LCD_WR_PIN | LCD_DC_PIN) << 2)) =
-        (LCD_WR_PIN | LCD_DC_PIN);
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + ((LCD_WR_PIN | LCD_DC_PIN) << 2)) =
-        (LCD_WR_PIN | LCD_DC_PIN);
-    HWREG(LCD_WR_BASE + GPIO_O_DATA + ((LCD_WR_PIN | LCD_DC_PIN) << 2)) =
-            (LCD_WR_PIN | LCD_DC_PIN);
+    LCD_CS_DEASSERT();
+}
+
+//*****************************************************************************
+//
+// Writes the same data word to the SSD2119 a number of times.  The panel stays
+// selected for the whole burst, and when both bytes of the word are equal (for
+// example black or white) the data bus is set only once.
+//
+//*****************************************************************************
+static void
+WriteDataRepeat(unsigned short usData, unsigned int ulCount)
+{
+    unsigned char ucHigh, ucLow;
+
+    ucHigh = usData >> 8;
+    ucLow = usData;
+
+    LCD_CS_ASSERT();
+    if(ucHigh == ucLow)
+    {
+        SET_LCD_DATA(ucHigh);
+        while(ulCount--)
+        {
+            LCD_STROBE(LCD_WR_PIN);
+            LCD_STROBE(LCD_WR_PIN);
+        }
+    }
+    else
+    {
+        while(ulCount--)
+        {
+            SET_LCD_DATA(ucHigh);
+            LCD_STROBE(LCD_WR_PIN);
+            SET_LCD_DATA(ucLow);
+            LCD_STROBE(LCD_WR_PIN);
+        }
+    }
+    LCD_CS_DEASSERT();
+}
+
+//*****************************************************************************
+//
+// Writes an array of data words to the SSD2119 in a single burst.
+//
+//*****************************************************************************
+static void
+WriteDataArray(const unsigned short *pusData, unsigned int ulCount)
+{
+    unsigned short usData;
 
-	HWREG(LCD_CS_BASE + GPIO_O_DATA + (LCD_CS_PIN << 2)) = LCD_CS_PIN;
+    LCD_CS_ASSERT();
+    while(ulCount--)
+    {
+        usData = *pusData++;
+        SET_LCD_DATA(usData >> 8);
+        LCD_STROBE(LCD_WR_PIN);
+        SET_LCD_DATA(usData);
+        LCD_STROBE(LCD_WR_PIN);
+    }
+    LCD_CS_DEASSERT();
 }
 #endif
 
@@ -473,7 +872,9 @@ InitSPILCDInterface(unsigned int ulClockMS)
 	GPIOPinTypeGPIOOutput(LCD_DATAH_BASE, LCD_DATAH_PINS);
     GPIOPinTypeGPIOOutput(LCD_RD_BASE, LCD_RD_PIN);
     GPIOPinTypeGPIOOutput(LCD_WR_BASE, LCD_WR_PIN);
-#endif
+    GPIOPinTypeGPIOOutput(LCD_DC_BASE, LCD_DC_PIN);
+    GPIOPinTypeGPIOOutput(LCD_CS_BASE, LCD_CS_PIN);
+#else
     SysCtlPeripheralEnable(SYSCTL_PERIPH_SSI2);
 
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_SSI2))
@@ -485,6 +886,7 @@ InitSPILCDInterface(unsigned int ulClockMS)
     GPIOPinConfigure(GPIO_PB5_SSI2FSS);
 
     GPIOPinTypeSSI(LCD_SSI_GPIOBASE,LCD_CS_PIN | LCD_SCLK_PIN | LCD_SDA_PIN);
+#endif
 
     GPIOPinTypeGPIOOutput(LCD_BACKLIGHT_BASE, LCD_BACKLIGHT_PIN);
 	
@@ -496,6 +898,7 @@ InitSPILCDInterface(unsigned int ulClockMS)
 	}
     GPIOPinTypeGPIOOutput(LCD_RST_BASE, LCD_RST_PIN);
 
+#ifndef Parallel_8
     SSIClockSourceSet(LCD_SSI_BASE, SSI_CLOCK_SYSTEM);
     // Max clock of SD2119 is 15 MHz
 #ifdef SPI_4
@@ -508,6 +911,10 @@ InitSPILCDInterface(unsigned int ulClockMS)
     		SSI_MODE_MASTER, 14000000, 9);
 #endif
     SSIEnable(LCD_SSI_BASE);
+#ifdef LCD_TX_RING
+    IntEnable(INT_SSI2);
+#endif
+#endif
     //
     // Set the LCD control pins to their default values.  This also asserts the
     // LCD reset signal.
@@ -516,6 +923,8 @@ InitSPILCDInterface(unsigned int ulClockMS)
     GPIOPinWrite(LCD_DATAH_BASE, LCD_DATAH_PINS, 0x00);
     GPIOPinWrite(LCD_RD_BASE, LCD_RD_PIN, LCD_RD_PIN);
     GPIOPinWrite(LCD_WR_BASE, LCD_WR_PIN, LCD_WR_PIN);
+    GPIOPinWrite(LCD_DC_BASE, LCD_DC_PIN, LCD_DC_PIN);
+    GPIOPinWrite(LCD_CS_BASE, LCD_CS_PIN, LCD_CS_PIN);
 #endif
 
 
@@ -551,7 +960,7 @@ InitSPILCDInterface(unsigned int ulClockMS)
 void
 Kentec320x240x16_SSD2119Init(void)
 {
-    unsigned int ulClockMS, ulCount;
+    unsigned int ulClockMS;
 
     //
     // Get the current processor clock frequency.
@@ -568,11 +977,13 @@ Kentec320x240x16_SSD2119Init(void)
     SysCtlPeripheralEnable(LCD_DATAH_PERIPH);
     SysCtlPeripheralEnable(LCD_RD_PERIPH);
     SysCtlPeripheralEnable(LCD_WR_PERIPH);
+    SysCtlPeripheralEnable(LCD_DC_PERIPH);
+    SysCtlPeripheralEnable(LCD_CS_PERIPH);
+#else
+    SysCtlPeripheralEnable(LCD_SSI_GPIOPERIPH);
 #endif
     SysCtlPeripheralEnable(LCD_RST_PERIPH);
 
-    SysCtlPeripheralEnable(LCD_SSI_GPIOPERIPH);
-
     SysCtlPeripheralEnable(LCD_BACKLIGHT_PERIPH);
 
     //
@@ -696,573 +1107,2279 @@ Kentec320x240x16_SSD2119Init(void)
     // Clear the contents of the display buffer.
     //
     WriteCommand(SSD2119_RAM_DATA_REG);
-    for(ulCount = 0; ulCount < (320 * 240); ulCount++)
-    {
-        WriteData(0x0000);
-    }
+    WriteDataRepeat(0x0000, 320 * 240);
 }
 
 //*****************************************************************************
 //
-//! Draws a pixel on the screen.
-//!
-//! \param pvDisplayData is a pointer to the driver-specific data for this
-//! display driver.
-//! \param lX is the X coordinate of the pixel.
-//! \param lY is the Y coordinate of the pixel.
-//! \param ulValue is the color of the pixel.
+// The registers that restrict the SSD2119 GRAM window to a rectangle, in the
+// order in which WindowValuesGet() returns their values.
+//
+//*****************************************************************************
+#define WINDOW_REGS             6
+
+static const unsigned char g_pucWindowRegs[WINDOW_REGS] =
+{
+    SSD2119_ENTRY_MODE_REG,
+    SSD2119_H_RAM_START_REG,
+    SSD2119_H_RAM_END_REG,
+    SSD2119_V_RAM_POS_REG,
+    SSD2119_X_RAM_ADDR_REG,
+    SSD2119_Y_RAM_ADDR_REG
+};
+
+//*****************************************************************************
+//
+// Computes the register values that restrict the GRAM window to a rectangle
+// (in application coordinates) and place the cursor at its upper left corner,
+// with the cursor incrementing left to right, then top to bottom.
+//
+//*****************************************************************************
+static void
+WindowValuesGet(const tRectangle *pRect, unsigned short *pusValues)
+{
+    //
+    // Set the cursor increment to left to right, followed by top to bottom.
+    //
+    pusValues[0] = MAKE_ENTRY_MODE(HORIZ_DIRECTION);
+
+    //
+    // The X extents of the rectangle.
+    //
+#if (defined PORTRAIT) || (defined LANDSCAPE)
+    pusValues[1] = MAPPED_X(pRect->i16XMax, pRect->i16YMax);
+    pusValues[2] = MAPPED_X(pRect->i16XMin, pRect->i16YMin);
+#else
+    pusValues[1] = MAPPED_X(pRect->i16XMin, pRect->i16YMin);
+    pusValues[2] = MAPPED_X(pRect->i16XMax, pRect->i16YMax);
+#endif
+
+    //
+    // The Y extents of the rectangle.
+    //
+#if (defined LANDSCAPE_FLIP) || (defined PORTRAIT)
+    pusValues[3] = (MAPPED_Y(pRect->i16XMin, pRect->i16YMin) |
+                    (MAPPED_Y(pRect->i16XMax, pRect->i16YMax) << 8));
+#else
+    pusValues[3] = (MAPPED_Y(pRect->i16XMax, pRect->i16YMax) |
+                    (MAPPED_Y(pRect->i16XMin, pRect->i16YMin) << 8));
+#endif
+
+    //
+    // The display cursor at the upper left of the rectangle (in application
+    // coordinate space).
+    //
+    pusValues[4] = MAPPED_X(pRect->i16XMin, pRect->i16YMin);
+    pusValues[5] = MAPPED_Y(pRect->i16XMin, pRect->i16YMin);
+}
+
+//*****************************************************************************
+//
+// Restricts the SSD2119 GRAM window to a rectangle (in application
+// coordinates), sets the cursor to its upper left corner and issues the RAM
+// write command.  Pixels written afterwards fill the rectangle left to right,
+// top to bottom in application coordinate space.
+//
+//*****************************************************************************
+static void
+SetWindow(const tRectangle *pRect)
+{
+    unsigned short pusValues[WINDOW_REGS];
+    unsigned int ulIdx;
+
+    WindowValuesGet(pRect, pusValues);
+    for(ulIdx = 0; ulIdx < WINDOW_REGS; ulIdx++)
+    {
+        WriteCommand(g_pucWindowRegs[ulIdx]);
+        WriteData(pusValues[ulIdx]);
+    }
+
+    //
+    // Tell the controller we are about to write data into its RAM.
+    //
+    WriteCommand(SSD2119_RAM_DATA_REG);
+}
+
+//*****************************************************************************
+//
+// Restores the SSD2119 GRAM window to the entire screen.
+//
+//*****************************************************************************
+static void
+ResetWindow(void)
+{
+    //
+    // Reset the X extents to the entire screen.
+    //
+    WriteCommand(SSD2119_H_RAM_START_REG);
+    WriteData(0x0000);
+    WriteCommand(SSD2119_H_RAM_END_REG);
+    WriteData(0x013F);
+
+    //
+    // Reset the Y extent to the full screen
+    //
+    WriteCommand(SSD2119_V_RAM_POS_REG);
+    WriteData(0xEF00);
+}
+
+#ifdef LCD_DMA
+//*****************************************************************************
+//
+// The uDMA channel carrying SSI2 transmit requests, and the limits of the
+// sequences built for it.
+//
+// A sequence is a peripheral scatter-gather task list: each task moves a run
+// of 9-bit frames into the SSI data register, either from the setup buffer
+// (commands and register values), from the fill pattern (a solid color) or
+// from a caller's pre-encoded image.  A single task moves at most 1024
+// frames, so a fill of LCD_DMA_PATTERN_PIXELS pixels or an image run of 512
+// pixels per task.  Larger primitives are split into bands of rows, each band
+// being one sequence; the completion interrupt of one band starts the next.
+// Primitives smaller than LCD_DMA_MIN_PIXELS are cheaper to send from the CPU.
+//
+//*****************************************************************************
+#define LCD_DMA_CHANNEL         13
+#define LCD_DMA_MAX_ITEMS       1024
+#ifndef LCD_DMA_MAX_TASKS
+#define LCD_DMA_MAX_TASKS       32
+#endif
+#ifndef LCD_DMA_PATTERN_PIXELS
+#define LCD_DMA_PATTERN_PIXELS  256
+#endif
+#ifndef LCD_DMA_MIN_PIXELS
+#define LCD_DMA_MIN_PIXELS      32
+#endif
+#define LCD_DMA_SETUP_FRAMES    (4 * LCD_DMA_MAX_TASKS)
+
+#if LCD_DMA_MAX_TASKS < 8
+#error "LCD_DMA_MAX_TASKS is too small to hold a drawing sequence"
+#endif
+#if (LCD_DMA_PATTERN_PIXELS * 2) > LCD_DMA_MAX_ITEMS
+#error "LCD_DMA_PATTERN_PIXELS is larger than a single uDMA transfer"
+#endif
+
+//
+// The frames that carry a command and a data byte in SPI_3 mode.
+//
+#define FRAME_HIGH(usData)      (0x100 | ((usData) >> 8))
+#define FRAME_LOW(usData)       (0x100 | ((usData) & 0xff))
+
+//
+// The kinds of primitive a sequence can be carrying.
+//
+#define DMA_JOB_FILL            0
+#define DMA_JOB_FRAMES          1
+#define DMA_JOB_PIXELS          2
+
+//*****************************************************************************
+//
+// The state of the uDMA sequence engine.  g_bDMABusy is set while a primitive
+// is being transferred, from the first band until the last band completes;
+// g_sDMABand holds the rows of the primitive that are still to be sent, and
+// g_pusDMAData the frames or pixels that carry them.
+//
+//*****************************************************************************
+static bool g_bDMAConfigured;
+static volatile bool g_bDMABusy;
+static tDMAControlTable g_psDMATasks[LCD_DMA_MAX_TASKS];
+static unsigned int g_ulDMATasks;
+static unsigned short g_pusDMASetup[LCD_DMA_SETUP_FRAMES];
+static unsigned int g_ulDMASetupUsed;
+static unsigned int g_ulDMASetupRun;
+static unsigned short g_pusDMAPattern[LCD_DMA_PATTERN_PIXELS * 2];
+static unsigned int g_ulDMAPatternColor = 0xffffffff;
+static unsigned int g_ulDMAJob;
+static tRectangle g_sDMABand;
+static const unsigned short *g_pusDMAData;
+
+//*****************************************************************************
+//
+// Checks whether the application has brought up the uDMA controller and, the
+// first time it has, routes SSI2 transmit requests and the completion
+// interrupt to this driver.  The uDMA registers are only touched once its
+// clock is known to be running.
+//
+//*****************************************************************************
+static bool
+DMAAvailable(void)
+{
+    if(!g_bDMAConfigured)
+    {
+        if(!SysCtlPeripheralReady(SYSCTL_PERIPH_UDMA) ||
+           !(HWREG(UDMA_STAT) & UDMA_STAT_MASTEN) ||
+           (HWREG(UDMA_CTLBASE) == 0))
+        {
+            return(false);
+        }
+
+        uDMAChannelAssign(UDMA_CH13_SSI2TX);
+        uDMAChannelAttributeDisable(LCD_DMA_CHANNEL, UDMA_ATTR_ALL);
+        SSIDMAEnable(LCD_SSI_BASE, SSI_DMA_TX);
+        IntEnable(INT_SSI2);
+        g_bDMAConfigured = true;
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Appends a task that moves ulFrames frames into the SSI, either walking
+// through pusSrc or repeating the frame it points at.
+//
+//*****************************************************************************
+static void
+DMATaskAdd(const unsigned short *pusSrc, unsigned int ulFrames,
+           bool bIncrement)
+{
+    tDMAControlTable *psTask;
+
+    psTask = &g_psDMATasks[g_ulDMATasks++];
+    psTask->pvSrcEndAddr = (void *)(bIncrement ? (pusSrc + ulFrames - 1) :
+                                                 pusSrc);
+    psTask->pvDstEndAddr = (void *)(LCD_SSI_BASE + SSI_O_DR);
+    psTask->ui32Control = (UDMA_SIZE_16 | UDMA_DST_INC_NONE | UDMA_ARB_4 |
+                           (bIncrement ? UDMA_SRC_INC_16 : UDMA_SRC_INC_NONE) |
+                           ((ulFrames - 1) << 4) |
+                           UDMA_MODE_PER_SCATTER_GATHER |
+                           UDMA_MODE_ALT_SELECT);
+    psTask->ui32Spare = 0;
+}
+
+//*****************************************************************************
+//
+// Appends a register write to the setup buffer.  Consecutive setup frames
+// are sent by a single task, added by DMASetupEnd().
+//
+//*****************************************************************************
+static void
+DMASetupReg(unsigned char ucReg, unsigned short usValue)
+{
+    g_pusDMASetup[g_ulDMASetupUsed++] = ucReg;
+    g_pusDMASetup[g_ulDMASetupUsed++] = FRAME_HIGH(usValue);
+    g_pusDMASetup[g_ulDMASetupUsed++] = FRAME_LOW(usValue);
+}
+
+static void
+DMASetupEnd(void)
+{
+    if(g_ulDMASetupUsed != g_ulDMASetupRun)
+    {
+        DMATaskAdd(g_pusDMASetup + g_ulDMASetupRun,
+                   g_ulDMASetupUsed - g_ulDMASetupRun, true);
+        g_ulDMASetupRun = g_ulDMASetupUsed;
+    }
+}
+
+//*****************************************************************************
+//
+// Builds the task list for the next band of the current primitive: the
+// window and RAM write command, the pixels, and for the last band the
+// restoration of the full-screen window.  Returns false if there is nothing
+// left to send.  Pixels in 5-6-5 form cannot be sent as they are, so a band
+// of them is limited to the size of the fill pattern and encoded into it
+// here, while the SSI is idle between bands.
+//
+//*****************************************************************************
+static bool
+DMABandBuild(void)
+{
+    unsigned short pusValues[WINDOW_REGS];
+    unsigned int ulIdx, ulWidth, ulRows, ulPixels, ulPerTask, ulCount;
+    tRectangle sRect;
+
+    if(g_sDMABand.i16YMin > g_sDMABand.i16YMax)
+    {
+        return(false);
+    }
+
+    g_ulDMATasks = 0;
+    g_ulDMASetupUsed = 0;
+    g_ulDMASetupRun = 0;
+
+    //
+    // Take as many rows as the payload tasks (all but the setup and reset
+    // tasks) can carry.
+    //
+    ulPerTask = ((g_ulDMAJob == DMA_JOB_FILL) ? LCD_DMA_PATTERN_PIXELS :
+                 (LCD_DMA_MAX_ITEMS / 2));
+    ulWidth = g_sDMABand.i16XMax - g_sDMABand.i16XMin + 1;
+    ulRows = ((LCD_DMA_MAX_TASKS - 2) * ulPerTask) / ulWidth;
+    if(g_ulDMAJob == DMA_JOB_PIXELS)
+    {
+        ulRows = LCD_DMA_PATTERN_PIXELS / ulWidth;
+    }
+    if(ulRows > (unsigned int)(g_sDMABand.i16YMax - g_sDMABand.i16YMin + 1))
+    {
+        ulRows = g_sDMABand.i16YMax - g_sDMABand.i16YMin + 1;
+    }
+    sRect = g_sDMABand;
+    sRect.i16YMax = sRect.i16YMin + ulRows - 1;
+    g_sDMABand.i16YMin += ulRows;
+
+    //
+    // Window, cursor and RAM write command.
+    //
+    WindowValuesGet(&sRect, pusValues);
+    for(ulIdx = 0; ulIdx < WINDOW_REGS; ulIdx++)
+    {
+        DMASetupReg(g_pucWindowRegs[ulIdx], pusValues[ulIdx]);
+    }
+    g_pusDMASetup[g_ulDMASetupUsed++] = SSD2119_RAM_DATA_REG;
+    DMASetupEnd();
+
+    //
+    // The pixels, from the fill pattern or the image.
+    //
+    ulPixels = ulWidth * ulRows;
+    if(g_ulDMAJob == DMA_JOB_PIXELS)
+    {
+        for(ulIdx = 0; ulIdx < ulPixels; ulIdx++, g_pusDMAData++)
+        {
+            g_pusDMAPattern[ulIdx * 2] = FRAME_HIGH(*g_pusDMAData);
+            g_pusDMAPattern[(ulIdx * 2) + 1] = FRAME_LOW(*g_pusDMAData);
+        }
+        DMATaskAdd(g_pusDMAPattern, ulPixels * 2, true);
+        ulPixels = 0;
+    }
+    for(; ulPixels; ulPixels -= ulCount)
+    {
+        ulCount = (ulPixels < ulPerTask) ? ulPixels : ulPerTask;
+        if(g_ulDMAJob == DMA_JOB_FILL)
+        {
+            DMATaskAdd(g_pusDMAPattern, ulCount * 2, true);
+        }
+        else
+        {
+            DMATaskAdd(g_pusDMAData, ulCount * 2, true);
+            g_pusDMAData += ulCount * 2;
+        }
+    }
+
+    //
+    // After the last band, restore the GRAM window to the full screen.
+    //
+    if(g_sDMABand.i16YMin > g_sDMABand.i16YMax)
+    {
+        DMASetupReg(SSD2119_H_RAM_START_REG, 0x0000);
+        DMASetupReg(SSD2119_H_RAM_END_REG, 0x013F);
+        DMASetupReg(SSD2119_V_RAM_POS_REG, 0xEF00);
+        DMASetupEnd();
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Starts the task list that has been built.  The last task runs in basic
+// mode, which ends the sequence and raises the completion interrupt.
+//
+//*****************************************************************************
+static void
+DMAStart(void)
+{
+    tDMAControlTable *psLast;
+
+    psLast = &g_psDMATasks[g_ulDMATasks - 1];
+    psLast->ui32Control = ((psLast->ui32Control & ~0x7) | UDMA_MODE_BASIC);
+
+    uDMAChannelScatterGatherSet(LCD_DMA_CHANNEL, g_ulDMATasks, g_psDMATasks,
+                                1);
+    uDMAChannelEnable(LCD_DMA_CHANNEL);
+}
+
+//*****************************************************************************
+//
+// Moves the engine on once the channel has stopped: starts the next band or
+// marks the primitive as complete.  This is safe to call at any time; it
+// does nothing while a sequence is still running.
+//
+//*****************************************************************************
+static void
+DMAService(void)
+{
+    if(g_bDMABusy && !uDMAChannelIsEnabled(LCD_DMA_CHANNEL))
+    {
+        if(DMABandBuild())
+        {
+            DMAStart();
+        }
+        else
+        {
+            g_bDMABusy = false;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Waits for the current primitive to leave the uDMA controller.  The engine
+// is serviced here as well as from the interrupt, with the interrupt masked,
+// so that drawing from a handler of equal or higher priority cannot
+// deadlock.
+//
+//*****************************************************************************
+static void
+DMAWait(void)
+{
+    while(g_bDMABusy)
+    {
+        IntDisable(INT_SSI2);
+        DMAService();
+        IntEnable(INT_SSI2);
+    }
+}
+
+//*****************************************************************************
+//
+// Loads the fill pattern with a color, unless it already holds it.  The
+// pattern must not be in use by a running sequence.
+//
+//*****************************************************************************
+static void
+DMAPatternSet(unsigned int ulValue)
+{
+    unsigned int ulIdx;
+
+    if(ulValue != g_ulDMAPatternColor)
+    {
+        for(ulIdx = 0; ulIdx < (LCD_DMA_PATTERN_PIXELS * 2); ulIdx += 2)
+        {
+            g_pusDMAPattern[ulIdx] = FRAME_HIGH(ulValue);
+            g_pusDMAPattern[ulIdx + 1] = FRAME_LOW(ulValue);
+        }
+        g_ulDMAPatternColor = ulValue;
+    }
+}
+
+//*****************************************************************************
+//
+// Hands a primitive to the uDMA controller.  pusData points at the frames
+// or pixels of an image, and ulValue is the color of a fill.  Returns false,
+// leaving the work to the CPU, if it is too small, if it is an image of 5-6-5
+// pixels wider than the fill pattern, or if the uDMA controller is not
+// available.
+//
+//*****************************************************************************
+static bool
+DMAPrimitiveStart(const tRectangle *pRect, unsigned int ulJob,
+                  unsigned int ulValue, const unsigned short *pusData)
+{
+    if((((pRect->i16XMax - pRect->i16XMin + 1) *
+         (pRect->i16YMax - pRect->i16YMin + 1)) < LCD_DMA_MIN_PIXELS) ||
+       (pRect->i16XMax < pRect->i16XMin) ||
+       ((ulJob == DMA_JOB_PIXELS) &&
+        ((pRect->i16XMax - pRect->i16XMin + 1) > LCD_DMA_PATTERN_PIXELS)) ||
+       !DMAAvailable())
+    {
+        return(false);
+    }
+
+    //
+    // The previous primitive may still be using the pattern and task list.
+    //
+    DMAWait();
+
+    if(ulJob == DMA_JOB_FILL)
+    {
+        DMAPatternSet(ulValue);
+    }
+    else if(ulJob == DMA_JOB_PIXELS)
+    {
+        //
+        // The pattern is about to hold the encoded pixels, so the next fill
+        // must load it again.
+        //
+        g_ulDMAPatternColor = 0xffffffff;
+    }
+
+    g_ulDMAJob = ulJob;
+    g_sDMABand = *pRect;
+    g_pusDMAData = pusData;
+
+    DMABandBuild();
+    g_bDMABusy = true;
+    DMAStart();
+
+    return(true);
+}
+#endif
+
+//*****************************************************************************
+//
+//! Handles the SSI2 interrupt.
+//!
+//! In SPI_3 mode this interrupt signals the end of a uDMA drawing sequence;
+//! it starts the next band of a large primitive, or marks the driver idle.
+//! With LCD_TX_RING it refills the transmit FIFO from the ring instead.  It
+//! must be installed in the vector table for SSI2.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+Kentec320x240x16_SSD2119IntHandler(void)
+{
+#ifdef LCD_DMA
+    SSIIntClear(LCD_SSI_BASE, SSIIntStatus(LCD_SSI_BASE, true));
+    DMAService();
+#endif
+#ifdef LCD_TX_RING
+    TxRingService();
+#endif
+}
+
+//*****************************************************************************
+//
+//! Returns the transmit ring statistics.
+//!
+//! \param pulHighWater is a pointer to the value that receives the largest
+//! number of frames that have been waiting in the ring at once.
+//! \param pulStalls is a pointer to the value that receives the number of
+//! times a drawing call found the ring full and had to wait for it.
+//! \param bReset is \b true to clear both counters after reading them.
+//!
+//! The counters are only kept when the driver is built with LCD_TX_RING, and
+//! are reported as zero otherwise.  A high water mark that reaches
+//! LCD_TX_RING_SIZE - 1 together with a rising stall count suggests that the
+//! ring is too small for the drawing being done.  Either pointer may be NULL.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+Kentec320x240x16_SSD2119TxRingStats(unsigned int *pulHighWater,
+                                    unsigned int *pulStalls, bool bReset)
+{
+#ifdef LCD_TX_RING
+    if(pulHighWater)
+    {
+        *pulHighWater = g_ulTxRingHighWater;
+    }
+    if(pulStalls)
+    {
+        *pulStalls = g_ulTxRingStalls;
+    }
+    if(bReset)
+    {
+        g_ulTxRingHighWater = 0;
+        g_ulTxRingStalls = 0;
+    }
+#else
+    if(pulHighWater)
+    {
+        *pulHighWater = 0;
+    }
+    if(pulStalls)
+    {
+        *pulStalls = 0;
+    }
+#endif
+}
+
+//*****************************************************************************
+//
+// The screen is divided into tiles of TILE_WIDTH by TILE_HEIGHT pixels (in
+// application coordinates) for Kentec320x240x16_SSD2119TilePaint().  For each
+// tile it keeps a hash of the pixels it last sent, or zero if the contents of
+// the tile are unknown.  Every drawing operation on the panel clears the hash
+// of the tiles it touches, so a tile is only ever skipped when the panel is
+// known to hold exactly the pixels that would be sent.
+//
+//*****************************************************************************
+#define TILE_WIDTH              32
+#define TILE_HEIGHT             16
+#if defined(PORTRAIT) || defined(PORTRAIT_FLIP)
+#define TILE_SCREEN_WIDTH       240
+#define TILE_SCREEN_HEIGHT      320
+#else
+#define TILE_SCREEN_WIDTH       320
+#define TILE_SCREEN_HEIGHT      240
+#endif
+#define TILE_COLS               ((TILE_SCREEN_WIDTH + TILE_WIDTH - 1) /       \
+                                 TILE_WIDTH)
+#define TILE_ROWS               ((TILE_SCREEN_HEIGHT + TILE_HEIGHT - 1) /     \
+                                 TILE_HEIGHT)
+
+#ifdef TILE_RENDER
+static unsigned int g_pulTileHash[TILE_ROWS * TILE_COLS];
+#endif
+
+//*****************************************************************************
+//
+// The number of drawing operations that have reached the panel, for
+// Kentec320x240x16_SSD2119DrawCount().
+//
+//*****************************************************************************
+static volatile unsigned int g_ulDrawCount;
+
+//*****************************************************************************
+//
+// Forgets the contents of the tiles covering a rectangle of the screen.
+// Every drawing operation on the panel passes through here, so it is also
+// counted here.
+//
+//*****************************************************************************
+static void
+TileInvalidate(int lX1, int lY1, int lX2, int lY2)
+{
+#ifdef TILE_RENDER
+    int lCol, lRow;
+#endif
+
+    if((lX2 < lX1) || (lY2 < lY1))
+    {
+        return;
+    }
+    g_ulDrawCount++;
+#ifdef TILE_RENDER
+    for(lRow = lY1 / TILE_HEIGHT; lRow <= (lY2 / TILE_HEIGHT); lRow++)
+    {
+        for(lCol = lX1 / TILE_WIDTH; lCol <= (lX2 / TILE_WIDTH); lCol++)
+        {
+            g_pulTileHash[(lRow * TILE_COLS) + lCol] = 0;
+        }
+    }
+#endif
+}
+
+//*****************************************************************************
+//
+//! Draws a pixel on the screen.
+//!
+//! \param pvDisplayData is a pointer to the driver-specific data for this
+//! display driver.
+//! \param lX is the X coordinate of the pixel.
+//! \param lY is the Y coordinate of the pixel.
+//! \param ulValue is the color of the pixel.
+//!
+//! This function sets the given pixel to a particular color.  The coordinates
+//! of the pixel are assumed to be within the extents of the display.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+Kentec320x240x16_SSD2119PixelDraw(void *pvDisplayData, int lX, int lY,
+                                   unsigned int ulValue)
+{
+    TileInvalidate(lX, lY, lX, lY);
+
+    //
+    // Set the X address of the display cursor.
+    //
+    WriteCommand(SSD2119_X_RAM_ADDR_REG);
+    WriteData(MAPPED_X(lX, lY));
+
+    //
+    // Set the Y address of the display cursor.
+    //
+    WriteCommand(SSD2119_Y_RAM_ADDR_REG);
+    WriteData(MAPPED_Y(lX, lY));
+
+    //
+    // Write the pixel value.
+    //
+    WriteCommand(SSD2119_RAM_DATA_REG);
+    WriteData(ulValue);
+}
+
+//*****************************************************************************
+//
+//! Draws a horizontal sequence of pixels on the screen.
+//!
+//! \param pvDisplayData is a pointer to the driver-specific data for this
+//! display driver.
+//! \param lX is the X coordinate of the first pixel.
+//! \param lY is the Y coordinate of the first pixel.
+//! \param lX0 is sub-pixel offset within the pixel data, which is valid for 1
+//! or 4 bit per pixel formats.
+//! \param lCount is the number of pixels to draw.
+//! \param lBPP is the number of bits per pixel; must be 1, 4, or 8.
+//! \param pucData is a pointer to the pixel data.  For 1 and 4 bit per pixel
+//! formats, the most significant bit(s) represent the left-most pixel.
+//! \param pucPalette is a pointer to the palette used to draw the pixels.
+//!
+//! This function draws a horizontal sequence of pixels on the screen, using
+//! the supplied palette.  For 1 bit per pixel format, the palette contains
+//! pre-translated colors; for 4 and 8 bit per pixel formats, the palette
+//! contains 24-bit RGB values that must be translated before being written to
+//! the display.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+Kentec320x240x16_SSD2119PixelDrawMultiple(void *pvDisplayData, int lX,
+                                           int lY, int lX0, int lCount,
+                                           int lBPP,
+                                           const unsigned char *pucData,
+                                           const unsigned char *pucPalette)
+{
+    unsigned int ulByte;
+
+    TileInvalidate(lX, lY, lX + lCount - 1, lY);
+
+    //
+    // Set the cursor increment to left to right, followed by top to bottom.
+    //
+    WriteCommand(SSD2119_ENTRY_MODE_REG);
+    WriteData(MAKE_ENTRY_MODE(HORIZ_DIRECTION));
+
+    //
+    // Set the starting X address of the display cursor.
+    //
+    WriteCommand(SSD2119_X_RAM_ADDR_REG);
+    WriteData(MAPPED_X(lX, lY));
+
+    //
+    // Set the Y address of the display cursor.
+    //
+    WriteCommand(SSD2119_Y_RAM_ADDR_REG);
+    WriteData(MAPPED_Y(lX, lY));
+
+    //
+    // Write the data RAM write command.
+    //
+    WriteCommand(SSD2119_RAM_DATA_REG);
+
+    //
+    // Determine how to interpret the pixel data based on the number of bits
+    // per pixel.
+    //
+    switch(lBPP)
+    {
+        //
+        // The pixel data is in 1 bit per pixel format.
+        //
+        case 1:
+        {
+            //
+            // Loop while there are more pixels to draw.
+            //
+            while(lCount)
+            {
+                //
+                // Get the next byte of image data.
+                //
+                ulByte = *pucData++;
+
+                //
+                // Loop through the pixels in this byte of image data.
+                //
+                for(; (lX0 < 8) && lCount; lX0++, lCount--)
+                {
+                    //
+                    // Draw this pixel in the appropriate color.
+                    //
+                    WriteData(((unsigned int *)pucPalette)[(ulByte >>
+                                                             (7 - lX0)) & 1]);
+                }
+
+                //
+                // Start at the beginning of the next byte of image data.
+                //
+                lX0 = 0;
+            }
+
+            //
+            // The image data has been drawn.
+            //
+            break;
+        }
+
+        //
+        // The pixel data is in 4 bit per pixel format.
+        //
+        case 4:
+        {
+            //
+            // Loop while there are more pixels to draw.  "Duff's device" is
+            // used to jump into the middle of the loop if the first nibble of
+            // the pixel data should not be used.  Duff's device makes use of
+            // the fact that a case statement is legal anywhere within a
+            // sub-block of a switch statement.  See
+            // http://en.wikipedia.org/wiki/Duff's_device for detailed
+            // information about Duff's device.
+            //
+            switch(lX0 & 1)
+            {
+                case 0:
+                    while(lCount)
+                    {
+                        //
+                        // Get the upper nibble of the next byte of pixel data
+                        // and extract the corresponding entry from the
+                        // palette.
+                        //
+                        ulByte = (*pucData >> 4) * 3;
+                        ulByte = (*(unsigned int *)(pucPalette + ulByte) &
+                                  0x00ffffff);
+
+                        //
+                        // Translate this palette entry and write it to the
+                        // screen.
+                        //
+                        WriteData(DPYCOLORTRANSLATE(ulByte));
+
+                        //
+                        // Decrement the count of pixels to draw.
+                        //
+                        lCount--;
+
+                        //
+                        // See if there is another pixel to draw.
+                        //
+                        if(lCount)
+                        {
+                case 1:
+                            //
+                            // Get the lower nibble of the next byte of pixel
+                            // data and extract the corresponding entry from
+                            // the palette.
+                            //
+                            ulByte = (*pucData++ & 15) * 3;
+                            ulByte = (*(unsigned int *)(pucPalette + ulByte) &
+                                      0x00ffffff);
+
+                            //
+                            // Translate this palette entry and write it to the
+                            // screen.
+                            //
+                            WriteData(DPYCOLORTRANSLATE(ulByte));
+
+                            //
+                            // Decrement the count of pixels to draw.
+                            //
+                            lCount--;
+                        }
+                    }
+            }
+
+            //
+            // The image data has been drawn.
+            //
+            break;
+        }
+
+        //
+        // The pixel data is in 8 bit per pixel format.
+        //
+        case 8:
+        {
+            //
+            // Loop while there are more pixels to draw.
+            //
+            while(lCount--)
+            {
+                //
+                // Get the next byte of pixel data and extract the
+                // corresponding entry from the palette.
+                //
+                ulByte = *pucData++ * 3;
+                ulByte = *(unsigned int *)(pucPalette + ulByte) & 0x00ffffff;
+
+                //
+                // Translate this palette entry and write it to the screen.
+                //
+                WriteData(DPYCOLORTRANSLATE(ulByte));
+            }
+
+            //
+            // The image data has been drawn.
+            //
+            break;
+        }
+
+        //
+        // We are being passed data in the display's native format.  Merely
+        // write it directly to the display.  This is a special case which is
+        // not used by the graphics library but which is helpful to
+        // applications which may want to handle, for example, JPEG images.
+        //
+        case 16:
+        {
+            //
+            // Send the pixels to the display in a single burst.
+            //
+            WriteDataArray((const unsigned short *)pucData, lCount);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Draws a horizontal line.
+//!
+//! \param pvDisplayData is a pointer to the driver-specific data for this
+//! display driver.
+//! \param lX1 is the X coordinate of the start of the line.
+//! \param lX2 is the X coordinate of the end of the line.
+//! \param lY is the Y coordinate of the line.
+//! \param ulValue is the color of the line.
+//!
+//! This function draws a horizontal line on the display.  The coordinates of
+//! the line are assumed to be within the extents of the display.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+Kentec320x240x16_SSD2119LineDrawH(void *pvDisplayData, int lX1, int lX2,
+                                   int lY, unsigned int ulValue)
+{
+#ifdef LCD_DMA
+    tRectangle sRect;
+#endif
+
+    TileInvalidate(lX1, lY, lX2, lY);
+
+#ifdef LCD_DMA
+    //
+    // A long line is a one pixel high rectangle for the uDMA controller.
+    //
+    sRect.i16XMin = lX1;
+    sRect.i16YMin = lY;
+    sRect.i16XMax = lX2;
+    sRect.i16YMax = lY;
+    if(DMAPrimitiveStart(&sRect, DMA_JOB_FILL, ulValue, 0))
+    {
+        return;
+    }
+#endif
+
+    //
+    // Set the cursor increment to left to right, followed by top to bottom.
+    //
+    WriteCommand(SSD2119_ENTRY_MODE_REG);
+    WriteData(MAKE_ENTRY_MODE(HORIZ_DIRECTION));
+
+    //
+    // Set the starting X address of the display cursor.
+    //
+    WriteCommand(SSD2119_X_RAM_ADDR_REG);
+    WriteData(MAPPED_X(lX1, lY));
+
+    //
+    // Set the Y address of the display cursor.
+    //
+    WriteCommand(SSD2119_Y_RAM_ADDR_REG);
+    WriteData(MAPPED_Y(lX1, lY));
+
+    //
+    // Write the data RAM write command.
+    //
+    WriteCommand(SSD2119_RAM_DATA_REG);
+
+    //
+    // Write the pixels of this horizontal line.
+    //
+    if(lX2 >= lX1)
+    {
+        WriteDataRepeat(ulValue, lX2 - lX1 + 1);
+    }
+}
+
+//*****************************************************************************
+//
+//! Draws a vertical line.
+//!
+//! \param pvDisplayData is a pointer to the driver-specific data for this
+//! display driver.
+//! \param lX is the X coordinate of the line.
+//! \param lY1 is the Y coordinate of the start of the line.
+//! \param lY2 is the Y coordinate of the end of the line.
+//! \param ulValue is the color of the line.
+//!
+//! This function draws a vertical line on the display.  The coordinates of the
+//! line are assumed to be within the extents of the display.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+Kentec320x240x16_SSD2119LineDrawV(void *pvDisplayData, int lX, int lY1,
+                                   int lY2, unsigned int ulValue)
+{
+#ifdef LCD_DMA
+    tRectangle sRect;
+#endif
+
+    TileInvalidate(lX, lY1, lX, lY2);
+
+#ifdef LCD_DMA
+    //
+    // A long line is a one pixel wide rectangle for the uDMA controller.
+    //
+    sRect.i16XMin = lX;
+    sRect.i16YMin = lY1;
+    sRect.i16XMax = lX;
+    sRect.i16YMax = lY2;
+    if(DMAPrimitiveStart(&sRect, DMA_JOB_FILL, ulValue, 0))
+    {
+        return;
+    }
+#endif
+
+    //
+    // Set the cursor increment to top to bottom, followed by left to right.
+    //
+    WriteCommand(SSD2119_ENTRY_MODE_REG);
+    WriteData(MAKE_ENTRY_MODE(VERT_DIRECTION));
+
+    //
+    // Set the X address of the display cursor.
+    //
+    WriteCommand(SSD2119_X_RAM_ADDR_REG);
+    WriteData(MAPPED_X(lX, lY1));
+
+    //
+    // Set the starting Y address of the display cursor.
+    //
+    WriteCommand(SSD2119_Y_RAM_ADDR_REG);
+    WriteData(MAPPED_Y(lX, lY1));
+
+    //
+    // Write the data RAM write command.
+    //
+    WriteCommand(SSD2119_RAM_DATA_REG);
+
+    //
+    // Write the pixels of this vertical line.
+    //
+    if(lY2 >= lY1)
+    {
+        WriteDataRepeat(ulValue, lY2 - lY1 + 1);
+    }
+}
+
+//*****************************************************************************
+//
+//! Fills a rectangle.
+//!
+//! \param pvDisplayData is a pointer to the driver-specific data for this
+//! display driver.
+//! \param pRect is a pointer to the structure describing the rectangle.
+//! \param ulValue is the color of the rectangle.
+//!
+//! This function fills a rectangle on the display.  The coordinates of the
+//! rectangle are assumed to be within the extents of the display, and the
+//! rectangle specification is fully inclusive (in other words, both sXMin and
+//! sXMax are drawn, along with sYMin and sYMax).
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+Kentec320x240x16_SSD2119RectFill(void *pvDisplayData, const tRectangle *pRect,
+                                  unsigned int ulValue)
+{
+    TileInvalidate(pRect->i16XMin, pRect->i16YMin, pRect->i16XMax,
+                   pRect->i16YMax);
+
+#ifdef LCD_DMA
+    //
+    // Let the uDMA controller send the whole rectangle if it can.
+    //
+    if(DMAPrimitiveStart(pRect, DMA_JOB_FILL, ulValue, 0))
+    {
+        return;
+    }
+#endif
+
+    //
+    // Restrict the GRAM window to the rectangle and place the cursor at its
+    // upper left corner.
+    //
+    SetWindow(pRect);
+
+    //
+    // Write the pixels of this filled rectangle.
+    //
+    WriteDataRepeat(ulValue, ((pRect->i16XMax - pRect->i16XMin + 1) *
+                              (pRect->i16YMax - pRect->i16YMin + 1)));
+
+    //
+    // Restore the GRAM window to the full screen.
+    //
+    ResetWindow();
+}
+
+//*****************************************************************************
+//
+//! Translates a 24-bit RGB color to a display driver-specific color.
+//!
+//! \param pvDisplayData is a pointer to the driver-specific data for this
+//! display driver.
+//! \param ulValue is the 24-bit RGB color.  The least-significant byte is the
+//! blue channel, the next byte is the green channel, and the third byte is the
+//! red channel.
+//!
+//! This function translates a 24-bit RGB color into a value that can be
+//! written into the display's frame buffer in order to reproduce that color,
+//! or the closest possible approximation of that color.
+//!
+//! \return Returns the display-driver specific color.
+//
+//*****************************************************************************
+static unsigned int
+Kentec320x240x16_SSD2119ColorTranslate(void *pvDisplayData,
+                                        unsigned int ulValue)
+{
+    //
+    // Translate from a 24-bit RGB color to a 5-6-5 RGB color.
+    //
+    return(DPYCOLORTRANSLATE(ulValue));
+}
+
+//*****************************************************************************
+//
+//! Flushes any cached drawing operations.
+//!
+//! \param pvDisplayData is a pointer to the driver-specific data for this
+//! display driver.
+//!
+//! This functions flushes any cached drawing operations to the display.  This
+//! is useful when a local frame buffer is used for drawing operations, and the
+//! flush would copy the local frame buffer to the display.  For the SSD2119
+//! driver, the flush waits for any drawing still being sent by the uDMA
+//! controller or queued in the transmit ring to reach the SSI, and then for
+//! the SSI to shift out the last frame, so that on return every pixel drawn
+//! is in the SSD2119's GRAM.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+Kentec320x240x16_SSD2119Flush(void *pvDisplayData)
+{
+#ifdef LCD_DMA
+    DMAWait();
+#endif
+#ifdef LCD_TX_RING
+    TxRingWait();
+#endif
+#if defined(SPI_3) || defined(SPI_4)
+    while(SSIBusy(LCD_SSI_BASE))
+    {
+    }
+#endif
+}
+
+//*****************************************************************************
+//
+//! Returns the number of drawing operations sent to the panel.
+//!
+//! The count covers every operation that changes pixels on the panel,
+//! whether through the graphics library or the driver's own blit, span and
+//! tile functions.  Comparing it before and after some work shows whether
+//! that work drew anything; a flush then waits for the drawing to reach the
+//! panel.
+//!
+//! \return The number of drawing operations since the driver was
+//! initialized.
+//
+//*****************************************************************************
+unsigned int
+Kentec320x240x16_SSD2119DrawCount(void)
+{
+    return(g_ulDrawCount);
+}
+
+//*****************************************************************************
+//
+//! The display structure that describes the driver for the Kentec
+//! K350QVG-V2-F TFT panel with an SSD2119 controller.
+//
+//*****************************************************************************
+const tDisplay g_sKentec320x240x16_SSD2119 =
+{
+    sizeof(tDisplay),
+    0,
+#if defined(PORTRAIT) || defined(PORTRAIT_FLIP)
+    240,
+    320,
+#else
+    320,
+    240,
+#endif
+    Kentec320x240x16_SSD2119PixelDraw,
+    Kentec320x240x16_SSD2119PixelDrawMultiple,
+    Kentec320x240x16_SSD2119LineDrawH,
+    Kentec320x240x16_SSD2119LineDrawV,
+    Kentec320x240x16_SSD2119RectFill,
+    Kentec320x240x16_SSD2119ColorTranslate,
+    Kentec320x240x16_SSD2119Flush
+};
+
+//*****************************************************************************
+//
+//! Copies a block of pixels in the display's native format to the screen.
+//!
+//! \param pRect is a pointer to the structure describing the destination
+//! rectangle, which is fully inclusive.
+//! \param pusData is a pointer to the pixel data, stored as 5-6-5 RGB values
+//! in rows from top to bottom, each row from left to right.
+//!
+//! This function writes a pre-rendered block of pixels, such as one captured
+//! with g_sKentec320x240x16_SSD2119Capture, with no per-pixel decoding.  In
+//! SPI_3 mode with the uDMA controller enabled, the pixels are sent by the
+//! uDMA controller a band at a time, each band being encoded into bus frames
+//! by the completion interrupt of the one before, and this function returns
+//! before the transfer completes; the pixels must remain unchanged until the
+//! next drawing call or GrFlush() returns.  Otherwise they are written by the
+//! CPU with a single GRAM window setup.  The rectangle is assumed to be within
+//! the extents of the display.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+Kentec320x240x16_SSD2119Blit(const tRectangle *pRect,
+                             const unsigned short *pusData)
+{
+    TileInvalidate(pRect->i16XMin, pRect->i16YMin, pRect->i16XMax,
+                   pRect->i16YMax);
+
+#ifdef LCD_DMA
+    if(DMAPrimitiveStart(pRect, DMA_JOB_PIXELS, 0, pusData))
+    {
+        return;
+    }
+#endif
+
+    //
+    // Restrict the GRAM window to the destination rectangle.
+    //
+    SetWindow(pRect);
+
+    //
+    // Stream the pixels into the window.
+    //
+    WriteDataArray(pusData, ((pRect->i16XMax - pRect->i16XMin + 1) *
+                             (pRect->i16YMax - pRect->i16YMin + 1)));
+
+    //
+    // Restore the GRAM window to the full screen.
+    //
+    ResetWindow();
+}
+
+//*****************************************************************************
+//
+//! Encodes pixels into the frame format sent on the SPI_3 bus.
 //!
-//! This function sets the given pixel to a particular color.  The coordinates
-//! of the pixel are assumed to be within the extents of the display.
+//! \param pusPixels is a pointer to the 5-6-5 RGB pixels to encode.
+//! \param pusFrames is a pointer to the buffer that receives the frames; it
+//! must hold two entries per pixel.
+//! \param ulCount is the number of pixels to encode.
+//!
+//! Each pixel becomes the two 9-bit data frames that carry it to the SSD2119,
+//! so that an image encoded once can be sent by
+//! Kentec320x240x16_SSD2119FramesBlit() without any further processing.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+Kentec320x240x16_SSD2119FramesEncode(const unsigned short *pusPixels,
+                                     unsigned short *pusFrames,
+                                     unsigned int ulCount)
+{
+    while(ulCount--)
+    {
+        *pusFrames++ = 0x100 | (*pusPixels >> 8);
+        *pusFrames++ = 0x100 | (*pusPixels++ & 0xff);
+    }
+}
+
+//*****************************************************************************
+//
+//! Copies a block of pixels encoded as bus frames to the screen.
+//!
+//! \param pRect is a pointer to the structure describing the destination
+//! rectangle, which is fully inclusive.
+//! \param pusFrames is a pointer to the pixels, as produced by
+//! Kentec320x240x16_SSD2119FramesEncode(), in rows from top to bottom, each
+//! row from left to right.
+//!
+//! In SPI_3 mode with the uDMA controller enabled, the window setup and the
+//! frames are sent by the uDMA controller and this function returns before
+//! the transfer completes; the frames must remain unchanged until the next
+//! drawing call or GrFlush() returns.  Otherwise the pixels are decoded and
+//! written by the CPU.  The rectangle is assumed to be within the extents of
+//! the display.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+Kentec320x240x16_SSD2119FramesBlit(const tRectangle *pRect,
+                                   const unsigned short *pusFrames)
+{
+    unsigned int ulCount;
+
+    TileInvalidate(pRect->i16XMin, pRect->i16YMin, pRect->i16XMax,
+                   pRect->i16YMax);
+
+#ifdef LCD_DMA
+    if(DMAPrimitiveStart(pRect, DMA_JOB_FRAMES, 0, pusFrames))
+    {
+        return;
+    }
+#endif
+
+    SetWindow(pRect);
+    for(ulCount = ((pRect->i16XMax - pRect->i16XMin + 1) *
+                   (pRect->i16YMax - pRect->i16YMin + 1)); ulCount;
+        ulCount--, pusFrames += 2)
+    {
+        WriteData(((pusFrames[0] & 0xff) << 8) | (pusFrames[1] & 0xff));
+    }
+    ResetWindow();
+}
+
+//*****************************************************************************
+//
+//! Fills a list of horizontal spans with a color.
+//!
+//! \param psSpans is a pointer to the spans to fill.
+//! \param ulCount is the number of spans.
+//! \param ulValue is the display-driver specific color of the spans.
+//!
+//! Each span is drawn from i16X1 to i16X2 inclusive on row i16Y; spans with
+//! i16X2 less than i16X1 are skipped.  In SPI_3 mode with the uDMA controller
+//! enabled, the cursor moves and pixels of as many spans as fit in one uDMA
+//! task list are sent as a single sequence.  The span list is no longer
+//! needed once this function returns.  The spans are assumed to be within
+//! the extents of the display.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+Kentec320x240x16_SSD2119SpansFill(const tSSD2119Span *psSpans,
+                                  unsigned int ulCount, unsigned int ulValue)
+{
+#ifdef LCD_DMA
+    unsigned int ulPixels, ulTask;
+
+    if(DMAAvailable())
+    {
+        while(ulCount)
+        {
+            DMAWait();
+            DMAPatternSet(ulValue);
+            g_ulDMATasks = 0;
+            g_ulDMASetupUsed = 0;
+            g_ulDMASetupRun = 0;
+
+            //
+            // Each span needs a cursor setup task and up to two pixel tasks,
+            // since a span can be wider than the fill pattern.
+            //
+            DMASetupReg(SSD2119_ENTRY_MODE_REG,
+                        MAKE_ENTRY_MODE(HORIZ_DIRECTION));
+            for(; ulCount && ((g_ulDMATasks + 3) <= LCD_DMA_MAX_TASKS);
+                ulCount--, psSpans++)
+            {
+                if(psSpans->i16X2 < psSpans->i16X1)
+                {
+                    continue;
+                }
+                TileInvalidate(psSpans->i16X1, psSpans->i16Y, psSpans->i16X2,
+                               psSpans->i16Y);
+                DMASetupReg(SSD2119_X_RAM_ADDR_REG,
+                            MAPPED_X(psSpans->i16X1, psSpans->i16Y));
+                DMASetupReg(SSD2119_Y_RAM_ADDR_REG,
+                            MAPPED_Y(psSpans->i16X1, psSpans->i16Y));
+                g_pusDMASetup[g_ulDMASetupUsed++] = SSD2119_RAM_DATA_REG;
+                DMASetupEnd();
+                for(ulPixels = psSpans->i16X2 - psSpans->i16X1 + 1; ulPixels;
+                    ulPixels -= ulTask)
+                {
+                    ulTask = ((ulPixels < LCD_DMA_PATTERN_PIXELS) ? ulPixels :
+                              LCD_DMA_PATTERN_PIXELS);
+                    DMATaskAdd(g_pusDMAPattern, ulTask * 2, true);
+                }
+            }
+            DMASetupEnd();
+
+            //
+            // The band is left empty, so the completion interrupt of this
+            // sequence marks the driver idle.
+            //
+            g_ulDMAJob = DMA_JOB_FILL;
+            g_sDMABand.i16YMin = 1;
+            g_sDMABand.i16YMax = 0;
+            g_bDMABusy = true;
+            DMAStart();
+        }
+        return;
+    }
+#endif
+
+    for(; ulCount; ulCount--, psSpans++)
+    {
+        Kentec320x240x16_SSD2119LineDrawH(0, psSpans->i16X1, psSpans->i16X2,
+                                          psSpans->i16Y, ulValue);
+    }
+}
+
+//*****************************************************************************
+//
+// The RAM buffer and area that the capture display currently renders into.
+// When the buffer pointer is zero, everything drawn to the capture display is
+// discarded.
+//
+//*****************************************************************************
+static unsigned short *g_pusCaptureBuffer;
+static tRectangle g_sCaptureArea;
+
+//*****************************************************************************
+//
+// Stores a pixel into the capture buffer if it lies within the capture area.
+//
+//*****************************************************************************
+#define CAPTURE_PUT(lX, lY, ulValue)                                          \
+{                                                                             \
+    if(g_pusCaptureBuffer &&                                                  \
+       ((lX) >= g_sCaptureArea.i16XMin) && ((lX) <= g_sCaptureArea.i16XMax) && \
+       ((lY) >= g_sCaptureArea.i16YMin) && ((lY) <= g_sCaptureArea.i16YMax))   \
+    {                                                                         \
+        g_pusCaptureBuffer[(((lY) - g_sCaptureArea.i16YMin) *                \
+                            (g_sCaptureArea.i16XMax -                         \
+                             g_sCaptureArea.i16XMin + 1)) +                   \
+                           ((lX) - g_sCaptureArea.i16XMin)] = (ulValue);      \
+    }                                                                         \
+}
+
+//*****************************************************************************
+//
+//! Selects the RAM buffer that the capture display renders into.
+//!
+//! \param pusBuffer is a pointer to the buffer, which must hold one 5-6-5 RGB
+//! value for each pixel of the capture area.  If zero, drawing operations
+//! performed on the capture display are discarded.
+//! \param pRect is a pointer to the capture area, in screen coordinates.
+//!
+//! The capture display, g_sKentec320x240x16_SSD2119Capture, has the same
+//! dimensions and color format as the SSD2119 panel but draws into RAM.
+//! Graphics library and widget drawing aimed at it can later be sent to the
+//! panel with Kentec320x240x16_SSD2119Blit().
 //!
 //! \return None.
 //
 //*****************************************************************************
+void
+Kentec320x240x16_SSD2119CaptureSet(unsigned short *pusBuffer,
+                                   const tRectangle *pRect)
+{
+    g_pusCaptureBuffer = pusBuffer;
+    if(pRect)
+    {
+        g_sCaptureArea = *pRect;
+    }
+}
+
+//*****************************************************************************
+//
+// Draws a pixel into the capture buffer.
+//
+//*****************************************************************************
 static void
-Kentec320x240x16_SSD2119PixelDraw(void *pvDisplayData, int lX, int lY,
-                                   unsigned int ulValue)
+CapturePixelDraw(void *pvDisplayData, int lX, int lY, unsigned int ulValue)
+{
+    CAPTURE_PUT(lX, lY, ulValue);
+}
+
+//*****************************************************************************
+//
+// Draws a horizontal sequence of pixels into the capture buffer, using the
+// same pixel formats as Kentec320x240x16_SSD2119PixelDrawMultiple().
+//
+//*****************************************************************************
+static void
+CapturePixelDrawMultiple(void *pvDisplayData, int lX, int lY, int lX0,
+                         int lCount, int lBPP, const unsigned char *pucData,
+                         const unsigned char *pucPalette)
 {
+    unsigned int ulByte;
+
     //
-    // Set the X address of the display cursor.
+    // Rows outside the capture area are skipped without decoding them.
     //
-    WriteCommand(SSD2119_X_RAM_ADDR_REG);
-    WriteData(MAPPED_X(lX, lY));
+    if((lY < g_sCaptureArea.i16YMin) || (lY > g_sCaptureArea.i16YMax))
+    {
+        return;
+    }
 
     //
-    // Set the Y address of the display cursor.
+    // Loop while there are more pixels to draw.
     //
-    WriteCommand(SSD2119_Y_RAM_ADDR_REG);
-    WriteData(MAPPED_Y(lX, lY));
+    while(lCount--)
+    {
+        switch(lBPP)
+        {
+            case 1:
+            {
+                ulByte = ((unsigned int *)pucPalette)[(*pucData >>
+                                                       (7 - lX0)) & 1];
+                if(++lX0 == 8)
+                {
+                    lX0 = 0;
+                    pucData++;
+                }
+                break;
+            }
+
+            case 4:
+            {
+                ulByte = (lX0 & 1) ? (*pucData++ & 15) : (*pucData >> 4);
+                ulByte = *(unsigned int *)(pucPalette + (ulByte * 3)) &
+                         0x00ffffff;
+                ulByte = DPYCOLORTRANSLATE(ulByte);
+                lX0++;
+                break;
+            }
+
+            case 8:
+            {
+                ulByte = *(unsigned int *)(pucPalette + (*pucData++ * 3)) &
+                         0x00ffffff;
+                ulByte = DPYCOLORTRANSLATE(ulByte);
+                break;
+            }
+
+            case 16:
+            {
+                ulByte = *((unsigned short *)pucData);
+                pucData += 2;
+                break;
+            }
 
+            default:
+            {
+                return;
+            }
+        }
+
+        //
+        // Store this pixel and move to the next one.
+        //
+        CAPTURE_PUT(lX, lY, ulByte);
+        lX++;
+    }
+}
+
+//*****************************************************************************
+//
+// Draws a horizontal line into the capture buffer.
+//
+//*****************************************************************************
+static void
+CaptureLineDrawH(void *pvDisplayData, int lX1, int lX2, int lY,
+                 unsigned int ulValue)
+{
     //
-    // Write the pixel value.
+    // Clip the line to the capture area, so that drawing a large scene into
+    // a small area costs little more than the pixels that are kept.
     //
-    WriteCommand(SSD2119_RAM_DATA_REG);
-    WriteData(ulValue);
+    if((lY < g_sCaptureArea.i16YMin) || (lY > g_sCaptureArea.i16YMax))
+    {
+        return;
+    }
+    if(lX1 < g_sCaptureArea.i16XMin)
+    {
+        lX1 = g_sCaptureArea.i16XMin;
+    }
+    if(lX2 > g_sCaptureArea.i16XMax)
+    {
+        lX2 = g_sCaptureArea.i16XMax;
+    }
+
+    for(; lX1 <= lX2; lX1++)
+    {
+        CAPTURE_PUT(lX1, lY, ulValue);
+    }
 }
 
 //*****************************************************************************
 //
-//! Draws a horizontal sequence of pixels on the screen.
-//!
-//! \param pvDisplayData is a pointer to the driver-specific data for this
-//! display driver.
-//! \param lX is the X coordinate of the first pixel.
-//! \param lY is the Y coordinate of the first pixel.
-//! \param lX0 is sub-pixel offset within the pixel data, which is valid for 1
-//! or 4 bit per pixel formats.
-//! \param lCount is the number of pixels to draw.
-//! \param lBPP is the number of bits per pixel; must be 1, 4, or 8.
-//! \param pucData is a pointer to the pixel data.  For 1 and 4 bit per pixel
-//! formats, the most significant bit(s) represent the left-most pixel.
-//! \param pucPalette is a pointer to the palette used to draw the pixels.
+// Draws a vertical line into the capture buffer.
+//
+//*****************************************************************************
+static void
+CaptureLineDrawV(void *pvDisplayData, int lX, int lY1, int lY2,
+                 unsigned int ulValue)
+{
+    //
+    // Clip the line to the capture area.
+    //
+    if((lX < g_sCaptureArea.i16XMin) || (lX > g_sCaptureArea.i16XMax))
+    {
+        return;
+    }
+    if(lY1 < g_sCaptureArea.i16YMin)
+    {
+        lY1 = g_sCaptureArea.i16YMin;
+    }
+    if(lY2 > g_sCaptureArea.i16YMax)
+    {
+        lY2 = g_sCaptureArea.i16YMax;
+    }
+
+    for(; lY1 <= lY2; lY1++)
+    {
+        CAPTURE_PUT(lX, lY1, ulValue);
+    }
+}
+
+//*****************************************************************************
+//
+// Fills a rectangle in the capture buffer.
+//
+//*****************************************************************************
+static void
+CaptureRectFill(void *pvDisplayData, const tRectangle *pRect,
+                unsigned int ulValue)
+{
+    int lY, lY2;
+
+    //
+    // Only the rows within the capture area need to be visited.
+    //
+    lY = ((pRect->i16YMin < g_sCaptureArea.i16YMin) ? g_sCaptureArea.i16YMin :
+          pRect->i16YMin);
+    lY2 = ((pRect->i16YMax > g_sCaptureArea.i16YMax) ? g_sCaptureArea.i16YMax :
+           pRect->i16YMax);
+    for(; lY <= lY2; lY++)
+    {
+        CaptureLineDrawH(pvDisplayData, pRect->i16XMin, pRect->i16XMax, lY,
+                         ulValue);
+    }
+}
+
+//*****************************************************************************
+//
+//! The display structure that renders into the RAM buffer selected with
+//! Kentec320x240x16_SSD2119CaptureSet() instead of the panel.
+//
+//*****************************************************************************
+const tDisplay g_sKentec320x240x16_SSD2119Capture =
+{
+    sizeof(tDisplay),
+    0,
+#if defined(PORTRAIT) || defined(PORTRAIT_FLIP)
+    240,
+    320,
+#else
+    320,
+    240,
+#endif
+    CapturePixelDraw,
+    CapturePixelDrawMultiple,
+    CaptureLineDrawH,
+    CaptureLineDrawV,
+    CaptureRectFill,
+    Kentec320x240x16_SSD2119ColorTranslate,
+    Kentec320x240x16_SSD2119Flush
+};
+
+#ifdef TILE_RENDER
+//*****************************************************************************
+//
+// The scratch buffer each tile is rendered into, and the number of pixels
+// that Kentec320x240x16_SSD2119TilePaint() has sent to and skipped sending
+// to the panel.  The buffer is declared as words so that it can be hashed a
+// word at a time.
+//
+//*****************************************************************************
+static unsigned int g_pulTileScratch[(TILE_WIDTH * TILE_HEIGHT) / 2];
+static unsigned int g_ulTilePixelsSent;
+static unsigned int g_ulTilePixelsSkipped;
+
+//*****************************************************************************
+//
+// Computes a 32-bit FNV-1a hash of a tile, a word (two pixels) at a time.
+// Zero is reserved to mark a tile whose contents are unknown.
+//
+//*****************************************************************************
+static unsigned int
+TileHash(const unsigned int *pulData, unsigned int ulWords)
+{
+    unsigned int ulHash;
+
+    ulHash = 2166136261;
+    while(ulWords--)
+    {
+        ulHash = (ulHash ^ *pulData++) * 16777619;
+    }
+
+    return(ulHash ? ulHash : 1);
+}
+
+//*****************************************************************************
+//
+//! Paints a region of the screen, sending only the tiles that have changed.
 //!
-//! This function draws a horizontal sequence of pixels on the screen, using
-//! the supplied palette.  For 1 bit per pixel format, the palette contains
-//! pre-translated colors; for 4 and 8 bit per pixel formats, the palette
-//! contains 24-bit RGB values that must be translated before being written to
-//! the display.
+//! \param pRegion is a pointer to the region to paint, which is fully
+//! inclusive and assumed to be within the extents of the display.
+//! \param ulBackground is the display-driver specific color that the region
+//! is cleared to before it is painted.
+//! \param pfnPaint is a pointer to the function that paints the region.
+//! \param pvData is passed to the paint function.
+//!
+//! The region is processed as a grid of 32x16 pixel tiles.  For each tile
+//! that it overlaps, the paint function is called with
+//! g_sKentec320x240x16_SSD2119Capture set to render only that tile into a
+//! scratch buffer, so it must draw to the capture display and must paint the
+//! whole region each time it is called.  A tile lying entirely within the
+//! region is hashed, and only sent to the panel if the hash differs from
+//! that of the pixels last sent for it; tiles on the edge of the region are
+//! always sent.  Any other drawing on the panel makes the tiles it touches be
+//! sent again.
+//!
+//! Since the paint function is called once per tile, this trades processor
+//! time for bus time.  It pays off for repaints that mostly redraw the same
+//! pixels over a slow bus.
+//!
+//! This function is only available when TILE_RENDER is defined.
 //!
 //! \return None.
 //
 //*****************************************************************************
-static void
-Kentec320x240x16_SSD2119PixelDrawMultiple(void *pvDisplayData, int lX,
-                                           int lY, int lX0, int lCount,
-                                           int lBPP,
-                                           const unsigned char *pucData,
-                                           const unsigned char *pucPalette)
+void
+Kentec320x240x16_SSD2119TilePaint(const tRectangle *pRegion,
+                                  unsigned int ulBackground,
+                                  void (*pfnPaint)(void *pvData),
+                                  void *pvData)
 {
-    unsigned int ulByte;
-
-    //
-    // Set the cursor increment to left to right, followed by top to bottom.
-    //
-    WriteCommand(SSD2119_ENTRY_MODE_REG);
-    WriteData(MAKE_ENTRY_MODE(HORIZ_DIRECTION));
-
-    //
-    // Set the starting X address of the display cursor.
-    //
-    WriteCommand(SSD2119_X_RAM_ADDR_REG);
-    WriteData(MAPPED_X(lX, lY));
-
-    //
-    // Set the Y address of the display cursor.
-    //
-    WriteCommand(SSD2119_Y_RAM_ADDR_REG);
-    WriteData(MAPPED_Y(lX, lY));
+    unsigned short *pusScratch;
+    unsigned int ulPixels, ulIdx, ulHash;
+    tRectangle sTile;
+    int lCol, lRow;
+    bool bWhole;
 
-    //
-    // Write the data RAM write command.
-    //
-    WriteCommand(SSD2119_RAM_DATA_REG);
+    pusScratch = (unsigned short *)g_pulTileScratch;
 
-    //
-    // Determine how to interpret the pixel data based on the number of bits
-    // per pixel.
-    //
-    switch(lBPP)
+    for(lRow = pRegion->i16YMin / TILE_HEIGHT;
+        lRow <= (pRegion->i16YMax / TILE_HEIGHT); lRow++)
     {
-        //
-        // The pixel data is in 1 bit per pixel format.
-        //
-        case 1:
+        for(lCol = pRegion->i16XMin / TILE_WIDTH;
+            lCol <= (pRegion->i16XMax / TILE_WIDTH); lCol++)
         {
             //
-            // Loop while there are more pixels to draw.
+            // Find the part of this tile that lies within the region, and
+            // whether that is the whole tile.
             //
-            while(lCount)
+            sTile.i16XMin = lCol * TILE_WIDTH;
+            sTile.i16YMin = lRow * TILE_HEIGHT;
+            sTile.i16XMax = sTile.i16XMin + TILE_WIDTH - 1;
+            sTile.i16YMax = sTile.i16YMin + TILE_HEIGHT - 1;
+            if(sTile.i16XMax >= TILE_SCREEN_WIDTH)
             {
-                //
-                // Get the next byte of image data.
-                //
-                ulByte = *pucData++;
-
-                //
-                // Loop through the pixels in this byte of image data.
-                //
-                for(; (lX0 < 8) && lCount; lX0++, lCount--)
+                sTile.i16XMax = TILE_SCREEN_WIDTH - 1;
+            }
+            if(sTile.i16YMax >= TILE_SCREEN_HEIGHT)
+            {
+                sTile.i16YMax = TILE_SCREEN_HEIGHT - 1;
+            }
+            bWhole = ((sTile.i16XMin >= pRegion->i16XMin) &&
+                      (sTile.i16YMin >= pRegion->i16YMin) &&
+                      (sTile.i16XMax <= pRegion->i16XMax) &&
+                      (sTile.i16YMax <= pRegion->i16YMax));
+            if(!bWhole)
+            {
+                if(sTile.i16XMin < pRegion->i16XMin)
                 {
-                    //
-                    // Draw this pixel in the appropriate color.
-                    //
-                    WriteData(((unsigned int *)pucPalette)[(ulByte >>
-                                                             (7 - lX0)) & 1]);
+                    sTile.i16XMin = pRegion->i16XMin;
+                }
+                if(sTile.i16YMin < pRegion->i16YMin)
+                {
+                    sTile.i16YMin = pRegion->i16YMin;
+                }
+                if(sTile.i16XMax > pRegion->i16XMax)
+                {
+                    sTile.i16XMax = pRegion->i16XMax;
+                }
+                if(sTile.i16YMax > pRegion->i16YMax)
+                {
+                    sTile.i16YMax = pRegion->i16YMax;
                 }
-
-                //
-                // Start at the beginning of the next byte of image data.
-                //
-                lX0 = 0;
             }
+            ulPixels = ((sTile.i16XMax - sTile.i16XMin + 1) *
+                        (sTile.i16YMax - sTile.i16YMin + 1));
 
             //
-            // The image data has been drawn.
-            //
-            break;
-        }
-
-        //
-        // The pixel data is in 4 bit per pixel format.
-        //
-        case 4:
-        {
-            //
-            // Loop while there are more pixels to draw.  "Duff's device" is
-            // used to jump into the middle of the loop if the first nibble of
-            // the pixel data should not be used.  Duff's device makes use of
-            // the fact that a case statement is legal anywhere within a
-            // sub-block of a switch statement.  See
-            // http://en.wikipedia.org/wiki/Duff's_device for detailed
-            // information about Duff's device.
+            // Render the tile into the scratch buffer, once the previous tile
+            // has been taken out of it.
             //
-            switch(lX0 & 1)
+#ifdef LCD_DMA
+            DMAWait();
+#endif
+            for(ulIdx = 0; ulIdx < ulPixels; ulIdx++)
             {
-                case 0:
-                    while(lCount)
-                    {
-                        //
-                        // Get the upper nibble of the next byte of pixel data
-                        // and extract the corresponding entry from the
-                        // palette.
-                        //
-                        ulByte = (*pucData >> 4) * 3;
-                        ulByte = (*(unsigned int *)(pucPalette + ulByte) &
-                                  0x00ffffff);
-
-                        //
-                        // Translate this palette entry and write it to the
-                        // screen.
-                        //
-                        WriteData(DPYCOLORTRANSLATE(ulByte));
-
-                        //
-                        // Decrement the count of pixels to draw.
-                        //
-                        lCount--;
-
-                        //
-                        // See if there is another pixel to draw.
-                        //
-                        if(lCount)
-                        {
-                case 1:
-                            //
-                            // Get the lower nibble of the next byte of pixel
-                            // data and extract the corresponding entry from
-                            // the palette.
-                            //
-                            ulByte = (*pucData++ & 15) * 3;
-                            ulByte = (*(unsigned int *)(pucPalette + ulByte) &
-                                      0x00ffffff);
-
-                            //
-                            // Translate this palette entry and write it to the
-                            // screen.
-                            //
-                            WriteData(DPYCOLORTRANSLATE(ulByte));
-
-                            //
-                            // Decrement the count of pixels to draw.
-                            //
-                            lCount--;
-                        }
-                    }
+                pusScratch[ulIdx] = ulBackground;
             }
+            Kentec320x240x16_SSD2119CaptureSet(pusScratch, &sTile);
+            pfnPaint(pvData);
 
             //
-            // The image data has been drawn.
-            //
-            break;
-        }
-
-        //
-        // The pixel data is in 8 bit per pixel format.
-        //
-        case 8:
-        {
-            //
-            // Loop while there are more pixels to draw.
+            // Skip the tile if the panel already shows these pixels.
             //
-            while(lCount--)
+            ulIdx = (lRow * TILE_COLS) + lCol;
+            ulHash = 0;
+            if(bWhole)
             {
-                //
-                // Get the next byte of pixel data and extract the
-                // corresponding entry from the palette.
-                //
-                ulByte = *pucData++ * 3;
-                ulByte = *(unsigned int *)(pucPalette + ulByte) & 0x00ffffff;
-
-                //
-                // Translate this palette entry and write it to the screen.
-                //
-                WriteData(DPYCOLORTRANSLATE(ulByte));
+                ulHash = TileHash(g_pulTileScratch, (ulPixels + 1) / 2);
+                if(ulHash == g_pulTileHash[ulIdx])
+                {
+                    g_ulTilePixelsSkipped += ulPixels;
+                    continue;
+                }
             }
 
             //
-            // The image data has been drawn.
-            //
-            break;
-        }
-
-        //
-        // We are being passed data in the display's native format.  Merely
-        // write it directly to the display.  This is a special case which is
-        // not used by the graphics library but which is helpful to
-        // applications which may want to handle, for example, JPEG images.
-        //
-        case 16:
-        {
-            unsigned short usByte;
-
-            //
-            // Loop while there are more pixels to draw.
+            // Send the tile, then record what the panel now holds.
             //
-            while(lCount--)
-            {
-                //
-                // Get the next byte of pixel data and extract the
-                // corresponding entry from the palette.
-                //
-                usByte = *((unsigned short *)pucData);
-                pucData += 2;
-
-                //
-                // Translate this palette entry and write it to the screen.
-                //
-                WriteData(usByte);
-            }
+            Kentec320x240x16_SSD2119Blit(&sTile, pusScratch);
+            g_pulTileHash[ulIdx] = ulHash;
+            g_ulTilePixelsSent += ulPixels;
         }
     }
+
+    Kentec320x240x16_SSD2119CaptureSet(0, 0);
 }
 
 //*****************************************************************************
 //
-//! Draws a horizontal line.
+//! Returns the pixel counts of Kentec320x240x16_SSD2119TilePaint().
 //!
-//! \param pvDisplayData is a pointer to the driver-specific data for this
-//! display driver.
-//! \param lX1 is the X coordinate of the start of the line.
-//! \param lX2 is the X coordinate of the end of the line.
-//! \param lY is the Y coordinate of the line.
-//! \param ulValue is the color of the line.
+//! \param pulSent is a pointer to the value that receives the number of
+//! pixels sent to the panel.
+//! \param pulSkipped is a pointer to the value that receives the number of
+//! pixels not sent because the panel already showed them.
+//! \param bReset is \b true to clear both counters after reading them.
 //!
-//! This function draws a horizontal line on the display.  The coordinates of
-//! the line are assumed to be within the extents of the display.
+//! Either pointer may be NULL.
 //!
 //! \return None.
 //
 //*****************************************************************************
-static void
-Kentec320x240x16_SSD2119LineDrawH(void *pvDisplayData, int lX1, int lX2,
-                                   int lY, unsigned int ulValue)
+void
+Kentec320x240x16_SSD2119TileStats(unsigned int *pulSent,
+                                  unsigned int *pulSkipped, bool bReset)
 {
-    //
-    // Set the cursor increment to left to right, followed by top to bottom.
-    //
-    WriteCommand(SSD2119_ENTRY_MODE_REG);
-    WriteData(MAKE_ENTRY_MODE(HORIZ_DIRECTION));
-
-    //
-    // Set the starting X address of the display cursor.
-    //
-    WriteCommand(SSD2119_X_RAM_ADDR_REG);
-    WriteData(MAPPED_X(lX1, lY));
-
-    //
-    // Set the Y address of the display cursor.
-    //
-    WriteCommand(SSD2119_Y_RAM_ADDR_REG);
-    WriteData(MAPPED_Y(lX1, lY));
-
-    //
-    // Write the data RAM write command.
-    //
-    WriteCommand(SSD2119_RAM_DATA_REG);
-
-    //
-    // Loop through the pixels of this horizontal line.
-    //
-    while(lX1++ <= lX2)
+    if(pulSent)
     {
-        //
-        // Write the pixel value.
-        //
-        WriteData(ulValue);
+        *pulSent = g_ulTilePixelsSent;
+    }
+    if(pulSkipped)
+    {
+        *pulSkipped = g_ulTilePixelsSkipped;
     }
+    if(bReset)
+    {
+        g_ulTilePixelsSent = 0;
+        g_ulTilePixelsSkipped = 0;
+    }
+}
+#endif
+
+//*****************************************************************************
+//
+// The dimensions of the monochrome shadow frame buffer, which is kept in
+// application coordinates with eight pixels per byte, most significant bit
+// leftmost.  A set bit is a foreground pixel.
+//
+//*****************************************************************************
+#if defined(PORTRAIT) || defined(PORTRAIT_FLIP)
+#define MONO_WIDTH              240
+#define MONO_HEIGHT             320
+#else
+#define MONO_WIDTH              320
+#define MONO_HEIGHT             240
+#endif
+#define MONO_STRIDE             (MONO_WIDTH / 8)
+
+//*****************************************************************************
+//
+// The state of the monochrome display: the frame buffer supplied by the
+// application, the two colors its bits expand to, one dirty bit per scan line
+// and the line buffer used to expand a scan line on its way to the panel.
+//
+//*****************************************************************************
+static unsigned char *g_pucMonoBuffer;
+static unsigned short g_usMonoForeground;
+static unsigned short g_usMonoBackground;
+static unsigned int g_pulMonoDirty[(MONO_HEIGHT + 31) / 32];
+static unsigned short g_pusMonoLine[MONO_WIDTH];
+
+#define MONO_DIRTY(lY)                                                        \
+{                                                                             \
+    g_pulMonoDirty[(lY) >> 5] |= 1U << ((lY) & 31);                           \
 }
 
 //*****************************************************************************
 //
-//! Draws a vertical line.
+//! Selects the frame buffer and colors of the monochrome display.
 //!
-//! \param pvDisplayData is a pointer to the driver-specific data for this
-//! display driver.
-//! \param lX is the X coordinate of the line.
-//! \param lY1 is the Y coordinate of the start of the line.
-//! \param lY2 is the Y coordinate of the end of the line.
-//! \param ulValue is the color of the line.
+//! \param pucBuffer is a pointer to the shadow frame buffer, which must be
+//! KENTEC_MONO_BUFFER_SIZE bytes long.
+//! \param ulForeground is the 24-bit RGB color of set pixels.
+//! \param ulBackground is the 24-bit RGB color of clear pixels.
 //!
-//! This function draws a vertical line on the display.  The coordinates of the
-//! line are assumed to be within the extents of the display.
+//! The monochrome display, g_sKentec320x240x16_SSD2119Mono, draws into a one
+//! bit per pixel copy of the screen and sends only the scan lines that have
+//! changed when it is flushed.  Any color other than the background draws
+//! foreground pixels.  Because the screen is held in RAM it can also be
+//! modified in place, see Kentec320x240x16_SSD2119MonoInvert().
+//!
+//! The frame buffer is cleared to the background color, but only the scan
+//! lines that are drawn on are sent, so an application can use the
+//! monochrome display for part of the screen by first filling that part.
 //!
 //! \return None.
 //
 //*****************************************************************************
-static void
-Kentec320x240x16_SSD2119LineDrawV(void *pvDisplayData, int lX, int lY1,
-                                   int lY2, unsigned int ulValue)
+void
+Kentec320x240x16_SSD2119MonoInit(unsigned char *pucBuffer,
+                                 unsigned int ulForeground,
+                                 unsigned int ulBackground)
 {
-    //
-    // Set the cursor increment to top to bottom, followed by left to right.
-    //
-    WriteCommand(SSD2119_ENTRY_MODE_REG);
-    WriteData(MAKE_ENTRY_MODE(VERT_DIRECTION));
+    unsigned int ulIdx;
 
-    //
-    // Set the X address of the display cursor.
-    //
-    WriteCommand(SSD2119_X_RAM_ADDR_REG);
-    WriteData(MAPPED_X(lX, lY1));
+    g_pucMonoBuffer = pucBuffer;
+    g_usMonoForeground = DPYCOLORTRANSLATE(ulForeground);
+    g_usMonoBackground = DPYCOLORTRANSLATE(ulBackground);
 
-    //
-    // Set the starting Y address of the display cursor.
-    //
-    WriteCommand(SSD2119_Y_RAM_ADDR_REG);
-    WriteData(MAPPED_Y(lX, lY1));
+    for(ulIdx = 0; ulIdx < (MONO_STRIDE * MONO_HEIGHT); ulIdx++)
+    {
+        pucBuffer[ulIdx] = 0;
+    }
+    for(ulIdx = 0; ulIdx < ((MONO_HEIGHT + 31) / 32); ulIdx++)
+    {
+        g_pulMonoDirty[ulIdx] = 0;
+    }
+}
 
-    //
-    // Write the data RAM write command.
-    //
-    WriteCommand(SSD2119_RAM_DATA_REG);
+//*****************************************************************************
+//
+// Sets (ulValue non-zero), clears or, with ulValue of 2, inverts the pixels
+// from lX1 to lX2 inclusive on a scan line of the shadow frame buffer.
+//
+//*****************************************************************************
+#define MONO_INVERT             2
 
-    //
-    // Loop through the pixels of this vertical line.
-    //
-    while(lY1++ <= lY2)
+static void
+MonoSpan(int lX1, int lX2, int lY, unsigned int ulValue)
+{
+    unsigned char *pucByte, ucMask;
+    int lX;
+
+    if(lX2 < lX1)
+    {
+        return;
+    }
+    MONO_DIRTY(lY);
+
+    pucByte = g_pucMonoBuffer + (lY * MONO_STRIDE) + (lX1 >> 3);
+    for(lX = lX1; lX <= lX2; )
     {
         //
-        // Write the pixel value.
+        // Whole bytes in the middle of the span, then the partial bytes at
+        // either end.
         //
-        WriteData(ulValue);
+        if(((lX & 7) == 0) && ((lX + 7) <= lX2))
+        {
+            ucMask = 0xff;
+            lX += 8;
+        }
+        else
+        {
+            ucMask = 0x80 >> (lX & 7);
+            lX++;
+            while((lX & 7) && (lX <= lX2))
+            {
+                ucMask |= 0x80 >> (lX & 7);
+                lX++;
+            }
+        }
+
+        if(ulValue == MONO_INVERT)
+        {
+            *pucByte ^= ucMask;
+        }
+        else if(ulValue)
+        {
+            *pucByte |= ucMask;
+        }
+        else
+        {
+            *pucByte &= ~ucMask;
+        }
+        pucByte++;
     }
 }
 
 //*****************************************************************************
 //
-//! Fills a rectangle.
-//!
-//! \param pvDisplayData is a pointer to the driver-specific data for this
-//! display driver.
-//! \param pRect is a pointer to the structure describing the rectangle.
-//! \param ulValue is the color of the rectangle.
-//!
-//! This function fills a rectangle on the display.  The coordinates of the
-//! rectangle are assumed to be within the extents of the display, and the
-//! rectangle specification is fully inclusive (in other words, both sXMin and
-//! sXMax are drawn, along with sYMin and sYMax).
-//!
-//! \return None.
+// Draws a pixel into the shadow frame buffer.
 //
 //*****************************************************************************
 static void
-Kentec320x240x16_SSD2119RectFill(void *pvDisplayData, const tRectangle *pRect,
-                                  unsigned int ulValue)
+MonoPixelDraw(void *pvDisplayData, int lX, int lY, unsigned int ulValue)
 {
-    int lCount;
+    MonoSpan(lX, lX, lY, ulValue);
+}
 
-    //
-    // Write the Y extents of the rectangle.
-    //
-    WriteCommand(SSD2119_ENTRY_MODE_REG);
-    WriteData(MAKE_ENTRY_MODE(HORIZ_DIRECTION));
+//*****************************************************************************
+//
+// Draws a horizontal sequence of pixels into the shadow frame buffer, using
+// the same pixel formats as Kentec320x240x16_SSD2119PixelDrawMultiple().
+// Pixels other than the background color are drawn as foreground pixels.
+//
+//*****************************************************************************
+static void
+MonoPixelDrawMultiple(void *pvDisplayData, int lX, int lY, int lX0,
+                      int lCount, int lBPP, const unsigned char *pucData,
+                      const unsigned char *pucPalette)
+{
+    unsigned int ulByte;
 
     //
-    // Write the X extents of the rectangle.
+    // Loop while there are more pixels to draw.
     //
-    WriteCommand(SSD2119_H_RAM_START_REG);
-#if (defined PORTRAIT) || (defined LANDSCAPE)
-    WriteData(MAPPED_X(pRect->i16XMax, pRect->i16YMax));
-#else
-    WriteData(MAPPED_X(pRect->i16XMin, pRect->i16YMin));
-#endif
-
-    WriteCommand(SSD2119_H_RAM_END_REG);
-#if (defined PORTRAIT) || (defined LANDSCAPE)
-    WriteData(MAPPED_X(pRect->i16XMin, pRect->i16YMin));
-#else
-    WriteData(MAPPED_X(pRect->i16XMax, pRect->i16YMax));
-#endif
+    while(lCount--)
+    {
+        switch(lBPP)
+        {
+            case 1:
+            {
+                ulByte = ((unsigned int *)pucPalette)[(*pucData >>
+                                                       (7 - lX0)) & 1];
+                if(++lX0 == 8)
+                {
+                    lX0 = 0;
+                    pucData++;
+                }
+                break;
+            }
 
-    //
-    // Write the Y extents of the rectangle
-    //
-    WriteCommand(SSD2119_V_RAM_POS_REG);
-#if (defined LANDSCAPE_FLIP) || (defined PORTRAIT)
-    WriteData(MAPPED_Y(pRect->i16XMin, pRect->i16YMin) |
-             (MAPPED_Y(pRect->i16XMax, pRect->i16YMax) << 8));
-#else
-    WriteData(MAPPED_Y(pRect->i16XMax, pRect->i16YMax) |
-             (MAPPED_Y(pRect->i16XMin, pRect->i16YMin) << 8));
-#endif
+            case 4:
+            {
+                ulByte = (lX0 & 1) ? (*pucData++ & 15) : (*pucData >> 4);
+                ulByte = *(unsigned int *)(pucPalette + (ulByte * 3)) &
+                         0x00ffffff;
+                ulByte = (DPYCOLORTRANSLATE(ulByte) != g_usMonoBackground);
+                lX0++;
+                break;
+            }
 
-    //
-    // Set the display cursor to the upper left of the rectangle (in application
-    // coordinate space).
-    //
-    WriteCommand(SSD2119_X_RAM_ADDR_REG);
-    WriteData(MAPPED_X(pRect->i16XMin, pRect->i16YMin));
+            case 8:
+            {
+                ulByte = *(unsigned int *)(pucPalette + (*pucData++ * 3)) &
+                         0x00ffffff;
+                ulByte = (DPYCOLORTRANSLATE(ulByte) != g_usMonoBackground);
+                break;
+            }
 
-    WriteCommand(SSD2119_Y_RAM_ADDR_REG);
-    WriteData(MAPPED_Y(pRect->i16XMin, pRect->i16YMin));
+            case 16:
+            {
+                ulByte = (*((unsigned short *)pucData) != g_usMonoBackground);
+                pucData += 2;
+                break;
+            }
 
-    //
-    // Tell the controller we are about to write data into its RAM.
-    //
-    WriteCommand(SSD2119_RAM_DATA_REG);
+            default:
+            {
+                return;
+            }
+        }
 
-    //
-    // Loop through the pixels of this filled rectangle.
-    //
-    for(lCount = ((pRect->i16XMax - pRect->i16XMin + 1) *
-                  (pRect->i16YMax - pRect->i16YMin + 1)); lCount >= 0; lCount--)
-    {
         //
-        // Write the pixel value.
+        // Store this pixel and move to the next one.
         //
-        WriteData(ulValue);
+        MonoSpan(lX, lX, lY, ulByte);
+        lX++;
     }
+}
 
-    //
-    // Reset the X extents to the entire screen.
-    //
-    WriteCommand(SSD2119_H_RAM_START_REG);
-    WriteData(0x0000);
-    WriteCommand(SSD2119_H_RAM_END_REG);
-    WriteData(0x013F);
+//*****************************************************************************
+//
+// Draws a horizontal line into the shadow frame buffer.
+//
+//*****************************************************************************
+static void
+MonoLineDrawH(void *pvDisplayData, int lX1, int lX2, int lY,
+              unsigned int ulValue)
+{
+    MonoSpan(lX1, lX2, lY, ulValue);
+}
 
-    //
-    // Reset the Y extent to the full screen
-    //
-    WriteCommand(SSD2119_V_RAM_POS_REG);
-    WriteData(0xEF00);
+//*****************************************************************************
+//
+// Draws a vertical line into the shadow frame buffer.
+//
+//*****************************************************************************
+static void
+MonoLineDrawV(void *pvDisplayData, int lX, int lY1, int lY2,
+              unsigned int ulValue)
+{
+    for(; lY1 <= lY2; lY1++)
+    {
+        MonoSpan(lX, lX, lY1, ulValue);
+    }
 }
 
 //*****************************************************************************
 //
-//! Translates a 24-bit RGB color to a display driver-specific color.
-//!
-//! \param pvDisplayData is a pointer to the driver-specific data for this
-//! display driver.
-//! \param ulValue is the 24-bit RGB color.  The least-significant byte is the
-//! blue channel, the next byte is the green channel, and the third byte is the
-//! red channel.
-//!
-//! This function translates a 24-bit RGB color into a value that can be
-//! written into the display's frame buffer in order to reproduce that color,
-//! or the closest possible approximation of that color.
-//!
-//! \return Returns the display-driver specific color.
+// Fills a rectangle in the shadow frame buffer.
+//
+//*****************************************************************************
+static void
+MonoRectFill(void *pvDisplayData, const tRectangle *pRect,
+             unsigned int ulValue)
+{
+    int lY;
+
+    for(lY = pRect->i16YMin; lY <= pRect->i16YMax; lY++)
+    {
+        MonoSpan(pRect->i16XMin, pRect->i16XMax, lY, ulValue);
+    }
+}
+
+//*****************************************************************************
+//
+// Translates a 24-bit RGB color to a pixel of the shadow frame buffer: 0 for
+// the background color, 1 for anything else.
 //
 //*****************************************************************************
 static unsigned int
-Kentec320x240x16_SSD2119ColorTranslate(void *pvDisplayData,
-                                        unsigned int ulValue)
+MonoColorTranslate(void *pvDisplayData, unsigned int ulValue)
 {
-    //
-    // Translate from a 24-bit RGB color to a 5-6-5 RGB color.
-    //
-    return(DPYCOLORTRANSLATE(ulValue));
+    return(DPYCOLORTRANSLATE(ulValue) != g_usMonoBackground);
 }
 
 //*****************************************************************************
 //
-//! Flushes any cached drawing operations.
+// Sends the dirty scan lines of the shadow frame buffer to the panel.  Each
+// run of consecutive dirty lines is sent through a single GRAM window, one
+// expanded scan line at a time.
+//
+//*****************************************************************************
+static void
+MonoFlush(void *pvDisplayData)
+{
+    const unsigned char *pucLine;
+    tRectangle sRect;
+    int lY, lX;
+
+    sRect.i16XMin = 0;
+    sRect.i16XMax = MONO_WIDTH - 1;
+
+    for(lY = 0; lY < MONO_HEIGHT; )
+    {
+        //
+        // Skip clean lines, a word at a time where possible.
+        //
+        if(!g_pulMonoDirty[lY >> 5] && !(lY & 31))
+        {
+            lY += 32;
+            continue;
+        }
+        if(!(g_pulMonoDirty[lY >> 5] & (1U << (lY & 31))))
+        {
+            lY++;
+            continue;
+        }
+
+        //
+        // Find the end of this run of dirty lines.
+        //
+        sRect.i16YMin = lY;
+        while((lY < MONO_HEIGHT) &&
+              (g_pulMonoDirty[lY >> 5] & (1U << (lY & 31))))
+        {
+            g_pulMonoDirty[lY >> 5] &= ~(1U << (lY & 31));
+            lY++;
+        }
+        sRect.i16YMax = lY - 1;
+
+        //
+        // Expand and send each line of the run.
+        //
+        TileInvalidate(sRect.i16XMin, sRect.i16YMin, sRect.i16XMax,
+                       sRect.i16YMax);
+        SetWindow(&sRect);
+        pucLine = g_pucMonoBuffer + (sRect.i16YMin * MONO_STRIDE);
+        for(; sRect.i16YMin <= sRect.i16YMax; sRect.i16YMin++)
+        {
+            for(lX = 0; lX < MONO_WIDTH; lX++)
+            {
+                g_pusMonoLine[lX] = ((pucLine[lX >> 3] & (0x80 >> (lX & 7))) ?
+                                     g_usMonoForeground : g_usMonoBackground);
+            }
+            WriteDataArray(g_pusMonoLine, MONO_WIDTH);
+            pucLine += MONO_STRIDE;
+        }
+        ResetWindow();
+    }
+
+    Kentec320x240x16_SSD2119Flush(pvDisplayData);
+}
+
+//*****************************************************************************
+//
+//! Inverts a rectangle of the monochrome display.
 //!
-//! \param pvDisplayData is a pointer to the driver-specific data for this
-//! display driver.
+//! \param pRect is a pointer to the rectangle to invert, which is fully
+//! inclusive and assumed to be within the extents of the display.
 //!
-//! This functions flushes any cached drawing operations to the display.  This
-//! is useful when a local frame buffer is used for drawing operations, and the
-//! flush would copy the local frame buffer to the display.  For the SSD2119
-//! driver, the flush is a no operation.
+//! This function exclusive-ORs the pixels of the rectangle in the shadow frame
+//! buffer, which is not possible on the write-only panel.  Inverting the same
+//! rectangle twice restores it, so a cursor or a rubber band selection can be
+//! drawn by inverting a rectangle (or its four one pixel wide edges) and later
+//! removed by inverting it again.  The change reaches the panel on the next
+//! flush.
 //!
 //! \return None.
 //
 //*****************************************************************************
-static void
-Kentec320x240x16_SSD2119Flush(void *pvDisplayData)
+void
+Kentec320x240x16_SSD2119MonoInvert(const tRectangle *pRect)
 {
-    //
-    // There is nothing to be done.
-    //
+    int lY;
+
+    for(lY = pRect->i16YMin; lY <= pRect->i16YMax; lY++)
+    {
+        MonoSpan(pRect->i16XMin, pRect->i16XMax, lY, MONO_INVERT);
+    }
 }
 
 //*****************************************************************************
 //
-//! The display structure that describes the driver for the Kentec
-//! K350QVG-V2-F TFT panel with an SSD2119 controller.
+//! The display structure that renders into the monochrome shadow frame buffer
+//! selected with Kentec320x240x16_SSD2119MonoInit().  Drawing reaches the
+//! panel when the display is flushed with GrFlush().
 //
 //*****************************************************************************
-const tDisplay g_sKentec320x240x16_SSD2119 =
+const tDisplay g_sKentec320x240x16_SSD2119Mono =
 {
     sizeof(tDisplay),
     0,
-#if defined(PORTRAIT) || defined(PORTRAIT_FLIP)
-    240,
-    320,
-#else
-    320,
-    240,
-#endif
-    Kentec320x240x16_SSD2119PixelDraw,
-    Kentec320x240x16_SSD2119PixelDrawMultiple,
-    Kentec320x240x16_SSD2119LineDrawH,
-    Kentec320x240x16_SSD2119LineDrawV,
-    Kentec320x240x16_SSD2119RectFill,
-    Kentec320x240x16_SSD2119ColorTranslate,
-    Kentec320x240x16_SSD2119Flush
+    MONO_WIDTH,
+    MONO_HEIGHT,
+    MonoPixelDraw,
+    MonoPixelDrawMultiple,
+    MonoLineDrawH,
+    MonoLineDrawV,
+    MonoRectFill,
+    MonoColorTranslate,
+    MonoFlush
 };
 
 //*****************************************************************************
@@ -7,27 +7,25 @@
 #include "utils/ustdlib.h"
 #include <stdint.h>
 #include <stdbool.h>
-#include <string.h>
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "driverlib/debug.h"
 #include "driverlib/fpu.h"
 #include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/pin_map.h"
 #include "driverlib/rom.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/systick.h"
 #include "driverlib/uart.h"
-#include "utils/softssi.h"
-#include "utils/uartstdio.h"
 
 #include "inc/hw_nvic.h"
 #include "inc/hw_sysctl.h"
 #include "driverlib/flash.h"
-#include "driverlib/rom.h"
 #include "grlib/grlib.h"
 #include "Kentec320x240x16_ssd2119_8bit.h"
 #include "touch.h"
+#include "touchcal.h"
 
 //*****************************************************************************
 //
@@ -50,13 +48,86 @@ __error__(char *pcFilename, unsigned long ulLine)
 //*****************************************************************************
 //
 // This is the handler for this SysTick interrupt.  We use this to provide the
-// required timer call to the lwIP stack.
+// timer for the calibration.
 //
 //*****************************************************************************
 void
 SysTickIntHandler(void)
 {
+    TouchCalTick();
+}
+//*****************************************************************************
+//
+// This is the handler for the UART0 interrupt.  The UART is not used by this
+// application, so there is nothing to do but clear the interrupt.
+//
+//*****************************************************************************
+void
+UARTIntHandler(void)
+{
+    UARTIntClear(UART0_BASE, UARTIntStatus(UART0_BASE, true));
+}
+//*****************************************************************************
+//
+// Displays the result of the calibration once it has finished.
+//
+//*****************************************************************************
+static void
+CalibrateDone(const tTouchCalResult *psResult)
+{
+    uint32_t ulIdx;
+    char pcBuffer[32];
+
+    //
+    // Indicate that the calibration data is being displayed.
+    //
+    GrContextForegroundSet(&g_sContext, ClrWhite);
+    GrContextFontSet(&g_sContext, &g_sFontCmsc20);
+    GrStringDraw(&g_sContext, "Calibration data:", -1, 0, 40, 0);
+
+    //
+    // Stop if the points could not be fitted at all.
+    //
+    if(!psResult->bFitted)
+    {
+        GrStringDraw(&g_sContext, "Points do not fit", -1, 0, 80, 0);
+        GrFlush(&g_sContext);
+        return;
+    }
+
+    //
+    // Display the calibration values.
+    //
+    for(ulIdx = 0; ulIdx < 7; ulIdx++)
+    {
+        usprintf(pcBuffer, "M%d = %d", ulIdx, psResult->plParms[ulIdx]);
+        GrStringDraw(&g_sContext, pcBuffer, -1, 0, 80 + (ulIdx * 20), 0);
+    }
+
+    //
+    // Display the residual error of each point, in pixels.
+    //
+    for(ulIdx = 0; ulIdx < psResult->ulPoints; ulIdx++)
+    {
+        usprintf(pcBuffer, "P%d: %d.%d px", ulIdx + 1,
+                 psResult->plResiduals[ulIdx] / 10,
+                 psResult->plResiduals[ulIdx] % 10);
+        GrStringDraw(&g_sContext, pcBuffer, -1, 200, 40 + (ulIdx * 20), 0);
+    }
+
+    //
+    // The calibration values were saved in flash, where the touch screen
+    // driver will find them at the next reset.
+    //
+    GrStringDraw(&g_sContext, (psResult->bSaved ? "Saved to flash" :
+                               "Not saved"), -1, 0, 220, 0);
+
+    //
+    // Flush any cached drawing operations.
+    //
+    GrFlush(&g_sContext);
 }
+
 //*****************************************************************************
 //
 // Performs calibration of the touch screen.
@@ -65,9 +136,6 @@ SysTickIntHandler(void)
 int
 main(void)
 {
-    long lIdx, lX1, lY1, lX2, lY2, lCount;
-    long pplPoints[3][4];
-    char pcBuffer[32];
     tRectangle sRect;
 
     //
@@ -128,230 +196,41 @@ main(void)
                          GrContextDpyWidthGet(&g_sContext) / 2, 11, 0);
 
     //
-    // Print the instructions across the middle of the screen in white with a
-    // 20 point small-caps font.
+    // Initialize the touch screen driver.  Its messages are queued and
+    // passed to the calibration from the main loop.
     //
-    GrContextForegroundSet(&g_sContext, ClrWhite);
-    GrContextFontSet(&g_sContext, &g_sFontCmsc20);
-    GrStringDraw(&g_sContext, "Touch the box", -1, 0,
-                 (GrContextDpyHeightGet(&g_sContext) / 2) - 10, 0);
+    TouchScreenInit();
+    TouchScreenEventQueueEnable(true);
+    TouchScreenCallbackSet(TouchCalPointerMessage);
 
     //
-    // Set the points used for calibration based on the size of the screen.
+    // Start the SysTick timer that paces the calibration.
     //
-    pplPoints[0][0] = GrContextDpyWidthGet(&g_sContext) / 10;
-    pplPoints[0][1] = (GrContextDpyHeightGet(&g_sContext) * 2)/ 10;
-    pplPoints[1][0] = GrContextDpyWidthGet(&g_sContext) / 2;
-    pplPoints[1][1] = (GrContextDpyHeightGet(&g_sContext) * 9) / 10;
-    pplPoints[2][0] = (GrContextDpyWidthGet(&g_sContext) * 9) / 10;
-    pplPoints[2][1] = GrContextDpyHeightGet(&g_sContext) / 2;
+    SysTickPeriodSet(SysCtlClockGet() / TOUCHCAL_TICKS_PER_SECOND);
+    SysTickIntEnable();
+    SysTickEnable();
 
     //
-    // Initialize the touch screen driver.
+    // Start the calibration.
     //
-    TouchScreenInit();
+    TouchCalStart(&g_sKentec320x240x16_SSD2119, CalibrateDone);
 
     //
-    // Loop through the calibration points.
+    // Run the calibration, sleeping whenever there is nothing to do.  The
+    // check is made with interrupts disabled so that nothing can become
+    // pending between it and the sleep; a pending interrupt still wakes the
+    // processor, and is taken once interrupts are enabled again.
     //
-    for(lIdx = 0; lIdx < 3; lIdx++)
+    while(1)
     {
-        //
-        // Fill a white box around the calibration point.
-        //
-        GrContextForegroundSet(&g_sContext, ClrWhite);
-        GrFlush(&g_sContext);
-    	SysCtlDelay(10000000);
-
-
+        TouchScreenEventsProcess();
+        TouchCalProcess();
 
-        sRect.i16XMin = pplPoints[lIdx][0] - 5;
-        sRect.i16YMin = pplPoints[lIdx][1] - 5;
-        sRect.i16XMax = pplPoints[lIdx][0] + 5;
-        sRect.i16YMax = pplPoints[lIdx][1] + 5;
-        GrRectFill(&g_sContext, &sRect);
-
-        //
-        // Flush any cached drawing operations.
-        //
-        GrFlush(&g_sContext);
-
-        //
-        // Initialize the raw sample accumulators and the sample count.
-        //
-        lX1 = 0;
-        lY1 = 0;
-        lCount = -5;
-
-        //
-        // Loop forever.  This loop is explicitly broken out of when the pen is
-        // lifted.
-        //
-        while(1)
+        IntMasterDisable();
+        if(!TouchScreenEventsPending() && !TouchCalPending())
         {
-            //
-            // Grab the current raw touch screen position.
-            //
-            lX2 = g_sTouchX;
-            lY2 = g_sTouchY;
-
-            //
-            // See if the pen is up or down.
-            //
-            if((lX2 < g_sTouchMin) || (lY2 < g_sTouchMin))
-            {
-                //
-                // The pen is up, so see if any samples have been accumulated.
-                //
-                if(lCount > 0)
-                {
-                    //
-                    // The pen has just been lifted from the screen, so break
-                    // out of the controlling while loop.
-                    //
-                    break;
-                }
-
-                //
-                // Reset the accumulators and sample count.
-                //
-                lX1 = 0;
-                lY1 = 0;
-                lCount = -5;
-
-                //
-                // Grab the next sample.
-                //
-                continue;
-            }
-
-            //
-            // Increment the count of samples.
-            //
-            lCount++;
-
-            //
-            // If the sample count is greater than zero, add this sample to the
-            // accumulators.
-            //
-            if(lCount > 0)
-            {
-                lX1 += lX2;
-                lY1 += lY2;
-            }
+            SysCtlSleep();
         }
-
-        //
-        // Save the averaged raw ADC reading for this calibration point.
-        //
-        pplPoints[lIdx][2] = lX1 / lCount;
-        pplPoints[lIdx][3] = lY1 / lCount;
-
-        //
-        // Erase the box around this calibration point.
-        //
-        GrContextForegroundSet(&g_sContext, ClrBlack);
-        GrRectFill(&g_sContext, &sRect);
-    }
-
-    //
-    // Clear the screen.
-    //
-    sRect.i16XMin = 0;
-    sRect.i16YMin = 24;
-    sRect.i16XMax = GrContextDpyWidthGet(&g_sContext) - 1;
-    sRect.i16YMax = GrContextDpyHeightGet(&g_sContext) - 1;
-    GrRectFill(&g_sContext, &sRect);
-
-    //
-    // Indicate that the calibration data is being displayed.
-    //
-    GrContextForegroundSet(&g_sContext, ClrWhite);
-    GrStringDraw(&g_sContext, "Calibration data:", -1, 0, 40, 0);
-
-    //
-    // Compute and display the M0 calibration value.
-    //
-    usprintf(pcBuffer, "M0 = %d",
-             (((pplPoints[0][0] - pplPoints[2][0]) *
-               (pplPoints[1][3] - pplPoints[2][3])) -
-              ((pplPoints[1][0] - pplPoints[2][0]) *
-               (pplPoints[0][3] - pplPoints[2][3]))));
-    GrStringDraw(&g_sContext, pcBuffer, -1, 0, 80, 0);
-
-    //
-    // Compute and display the M1 calibration value.
-    //
-    usprintf(pcBuffer, "M1 = %d",
-             (((pplPoints[0][2] - pplPoints[2][2]) *
-               (pplPoints[1][0] - pplPoints[2][0])) -
-              ((pplPoints[0][0] - pplPoints[2][0]) *
-               (pplPoints[1][2] - pplPoints[2][2]))));
-    GrStringDraw(&g_sContext, pcBuffer, -1, 0, 100, 0);
-
-    //
-    // Compute and display the M2 calibration value.
-    //
-    usprintf(pcBuffer, "M2 = %d",
-             ((((pplPoints[2][2] * pplPoints[1][0]) -
-                (pplPoints[1][2] * pplPoints[2][0])) * pplPoints[0][3]) +
-              (((pplPoints[0][2] * pplPoints[2][0]) -
-                (pplPoints[2][2] * pplPoints[0][0])) * pplPoints[1][3]) +
-              (((pplPoints[1][2] * pplPoints[0][0]) -
-                (pplPoints[0][2] * pplPoints[1][0])) * pplPoints[2][3])));
-    GrStringDraw(&g_sContext, pcBuffer, -1, 0, 120, 0);
-
-    //
-    // Compute and display the M3 calibration value.
-    //
-    usprintf(pcBuffer, "M3 = %d",
-             (((pplPoints[0][1] - pplPoints[2][1]) *
-               (pplPoints[1][3] - pplPoints[2][3])) -
-              ((pplPoints[1][1] - pplPoints[2][1]) *
-               (pplPoints[0][3] - pplPoints[2][3]))));
-    GrStringDraw(&g_sContext, pcBuffer, -1, 0, 140, 0);
-
-    //
-    // Compute and display the M4 calibration value.
-    //
-    usprintf(pcBuffer, "M4 = %d",
-             (((pplPoints[0][2] - pplPoints[2][2]) *
-               (pplPoints[1][1] - pplPoints[2][1])) -
-              ((pplPoints[0][1] - pplPoints[2][1]) *
-               (pplPoints[1][2] - pplPoints[2][2]))));
-    GrStringDraw(&g_sContext, pcBuffer, -1, 0, 160, 0);
-
-    //
-    // Compute and display the M5 calibration value.
-    //
-    usprintf(pcBuffer, "M5 = %d",
-             ((((pplPoints[2][2] * pplPoints[1][1]) -
-                (pplPoints[1][2] * pplPoints[2][1])) * pplPoints[0][3]) +
-              (((pplPoints[0][2] * pplPoints[2][1]) -
-                (pplPoints[2][2] * pplPoints[0][1])) * pplPoints[1][3]) +
-              (((pplPoints[1][2] * pplPoints[0][1]) -
-                (pplPoints[0][2] * pplPoints[1][1])) * pplPoints[2][3])));
-    GrStringDraw(&g_sContext, pcBuffer, -1, 0, 180, 0);
-
-    //
-    // Compute and display the M6 calibration value.
-    //
-    usprintf(pcBuffer, "M6 = %d",
-             (((pplPoints[0][2] - pplPoints[2][2]) *
-               (pplPoints[1][3] - pplPoints[2][3])) -
-              ((pplPoints[1][2] - pplPoints[2][2]) *
-               (pplPoints[0][3] - pplPoints[2][3]))));
-    GrStringDraw(&g_sContext, pcBuffer, -1, 0, 200, 0);
-
-    //
-    // Flush any cached drawing operations.
-    //
-    GrFlush(&g_sContext);
-
-    //
-    // The calibration is complete.  Sit around and wait for a reset.
-    //
-    while(1)
-    {
+        IntMasterEnable();
     }
 }
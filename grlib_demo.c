@@ -25,6 +25,7 @@
 #include "stdint.h"
 #include "stdbool.h"
 #include "time.h"
+#include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
 #include "inc/hw_nvic.h"
 #include "inc/hw_sysctl.h"
@@ -32,6 +33,8 @@
 #include "driverlib/fpu.h"
 #include "driverlib/gpio.h"
 #include "driverlib/flash.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/systick.h"
 #include "driverlib/uart.h"
@@ -48,6 +51,7 @@
 #include "utils/ustdlib.h"
 #include "Kentec320x240x16_ssd2119_8bit.h"
 #include "touch.h"
+#include "touchcal.h"
 #include "images.h"
 
 //*****************************************************************************
@@ -62,7 +66,8 @@
 //! panel.
 //!
 //! The first panel provides some introductory text and basic instructions for
-//! operation of the application.
+//! operation of the application, and a button that calibrates the touch
+//! screen without leaving the application.
 //!
 //! The second panel shows the available drawing primitives: lines, circles,
 //! rectangles, strings, and images.
@@ -104,6 +109,18 @@
 //
 //*****************************************************************************
 
+//*****************************************************************************
+//
+// Define TILE_RENDER to have panel switches and slider changes repainted
+// through the display driver's tile renderer.  Each 32x16 tile of the area is
+// rasterized into RAM and only sent to the display if it differs from what
+// was last sent there.  This costs extra processor time to save bus time; the
+// share of pixels skipped is reported with the latency figures.  The driver
+// only includes the tile renderer when TILE_RENDER is defined, so it must be
+// added to the project's predefined symbols rather than defined here.
+//
+//*****************************************************************************
+
 //*****************************************************************************
 //
 // The DMA control structure table.
@@ -119,6 +136,176 @@ tDMAControlTable sDMAControlTable[64];
 tDMAControlTable sDMAControlTable[64] __attribute__ ((aligned(1024)));
 #endif
 
+//*****************************************************************************
+//
+// The touch-to-photon latency of the demo: the time from the touch screen
+// sampling the position that a message carries to the last pixel of the
+// repaint it causes reaching the display.  It is kept for three kinds of
+// feedback: any repaint following a press, a slider being dragged, and a
+// switch to another panel.  Each has a histogram of LATENCY_BUCKETS buckets
+// of LATENCY_BUCKET_MS milliseconds, the last of which also counts anything
+// longer, along with the count, total and worst case in microseconds.  The
+// figures are sent out of UART0 when any character is received there;
+// g_bLatencyDump is set by the UART0 interrupt to ask the main loop for them.
+//
+//*****************************************************************************
+#define LATENCY_NONE            0
+#define LATENCY_PRESS           1
+#define LATENCY_SLIDER          2
+#define LATENCY_PANEL           3
+#define NUM_LATENCY_TYPES       3
+#define LATENCY_BUCKETS         32
+#define LATENCY_BUCKET_MS       4
+static uint32_t g_ulLatencyType;
+static volatile bool g_bLatencyDump;
+static uint32_t g_pulLatencyHist[NUM_LATENCY_TYPES][LATENCY_BUCKETS];
+static uint32_t g_pulLatencyCount[NUM_LATENCY_TYPES];
+static uint32_t g_pulLatencyTotal[NUM_LATENCY_TYPES];
+static uint32_t g_pulLatencyMax[NUM_LATENCY_TYPES];
+static const char * const g_ppcLatencyNames[NUM_LATENCY_TYPES] =
+{
+    "press", "slider drag", "panel switch"
+};
+
+//*****************************************************************************
+//
+// The processor cycle counter, which the touch screen driver uses to time
+// its samples.
+//
+//*****************************************************************************
+#define DWT_CYCCNT              0xE0001004
+
+//*****************************************************************************
+//
+// Notes the kind of feedback the touch screen message being handled has
+// caused.  A panel switch outranks a slider change, which outranks a press.
+//
+//*****************************************************************************
+static void
+LatencyTypeSet(uint32_t ulType)
+{
+    if(ulType > g_ulLatencyType)
+    {
+        g_ulLatencyType = ulType;
+    }
+}
+
+//*****************************************************************************
+//
+// Adds a latency, in microseconds, to the figures for a kind of feedback.
+//
+//*****************************************************************************
+static void
+LatencyRecord(uint32_t ulType, uint32_t ulLatency)
+{
+    uint32_t ulBucket;
+
+    ulType--;
+    ulBucket = ulLatency / (LATENCY_BUCKET_MS * 1000);
+    if(ulBucket >= LATENCY_BUCKETS)
+    {
+        ulBucket = LATENCY_BUCKETS - 1;
+    }
+    g_pulLatencyHist[ulType][ulBucket]++;
+    g_pulLatencyCount[ulType]++;
+    g_pulLatencyTotal[ulType] += ulLatency;
+    if(ulLatency > g_pulLatencyMax[ulType])
+    {
+        g_pulLatencyMax[ulType] = ulLatency;
+    }
+}
+
+#ifdef TILE_RENDER
+//*****************************************************************************
+//
+// The share of pixels, in percent, that the tile renderer did not need to send
+// for the last panel switch and for the current (or last) slider drag.
+//
+//*****************************************************************************
+static uint32_t g_ulTileSkipPanel;
+static uint32_t g_ulTileSkipSlider;
+
+//*****************************************************************************
+//
+// Reports the share of pixels, in percent, that the tile renderer did not
+// need to send for the last panel switch and for the current (or last)
+// slider drag.  Either pointer may be NULL.
+//
+//*****************************************************************************
+static void
+TileSkipStats(uint32_t *pulPanel, uint32_t *pulSlider)
+{
+    if(pulPanel)
+    {
+        *pulPanel = g_ulTileSkipPanel;
+    }
+    if(pulSlider)
+    {
+        *pulSlider = g_ulTileSkipSlider;
+    }
+}
+#endif
+
+//*****************************************************************************
+//
+// Sends a string out of UART0.
+//
+//*****************************************************************************
+static void
+UARTStringPut(const char *pcString)
+{
+    while(*pcString)
+    {
+        UARTCharPut(UART0_BASE, *pcString++);
+    }
+}
+
+//*****************************************************************************
+//
+// Sends the latency figures out of UART0: a summary line for each kind of
+// feedback followed by its non-empty histogram buckets, and then the share
+// of pixels skipped by the tile renderer.
+//
+//*****************************************************************************
+static void
+LatencyDump(void)
+{
+    char pcLine[64];
+    uint32_t ulType, ulBucket;
+#ifdef TILE_RENDER
+    uint32_t ulPanel, ulSlider;
+#endif
+
+    for(ulType = 0; ulType < NUM_LATENCY_TYPES; ulType++)
+    {
+        usprintf(pcLine, "%s: %u, mean %u us, max %u us\r\n",
+                 g_ppcLatencyNames[ulType], g_pulLatencyCount[ulType],
+                 (g_pulLatencyCount[ulType] ?
+                  (g_pulLatencyTotal[ulType] / g_pulLatencyCount[ulType]) : 0),
+                 g_pulLatencyMax[ulType]);
+        UARTStringPut(pcLine);
+
+        for(ulBucket = 0; ulBucket < LATENCY_BUCKETS; ulBucket++)
+        {
+            if(g_pulLatencyHist[ulType][ulBucket])
+            {
+                usprintf(pcLine, "  %3u ms%s: %u\r\n",
+                         ulBucket * LATENCY_BUCKET_MS,
+                         ((ulBucket == (LATENCY_BUCKETS - 1)) ? "+" : ""),
+                         g_pulLatencyHist[ulType][ulBucket]);
+                UARTStringPut(pcLine);
+            }
+        }
+    }
+
+#ifdef TILE_RENDER
+    TileSkipStats(&ulPanel, &ulSlider);
+    usprintf(pcLine, "Tiles skipped: panel %u%%, slider %u%%\r\n", ulPanel,
+             ulSlider);
+    UARTStringPut(pcLine);
+#endif
+}
+
 //*****************************************************************************
 //
 // Forward declarations for the globals required to define the widgets at
@@ -128,22 +315,33 @@ tDMAControlTable sDMAControlTable[64] __attribute__ ((aligned(1024)));
 void OnPrevious(tWidget *pWidget);
 void OnNext(tWidget *pWidget);
 void OnIntroPaint(tWidget *pWidget, tContext *pContext);
+void OnCalibrate(tWidget *pWidget);
 void OnPrimitivePaint(tWidget *pWidget, tContext *pContext);
 void OnCanvasPaint(tWidget *pWidget, tContext *pContext);
 void OnCheckChange(tWidget *pWidget, uint32_t bSelected);
 void OnButtonPress(tWidget *pWidget);
 void OnRadioChange(tWidget *pWidget, uint32_t bSelected);
 void OnSliderChange(tWidget *pWidget, int32_t lValue);
+void OnMonoPaint(tWidget *pWidget, tContext *pContext);
 extern tCanvasWidget g_psPanels[];
+extern tCanvasWidget g_sIntroduction;
 
 //*****************************************************************************
 //
 // The first panel, which contains introductory text explaining the
-// application.
+// application and a button that starts a calibration of the touch screen.
 //
 //*****************************************************************************
-Canvas(g_sIntroduction, g_psPanels, 0, 0, &g_sKentec320x240x16_SSD2119, 0, 24,
-       320, 166, CANVAS_STYLE_APP_DRAWN, 0, 0, 0, 0, 0, 0, OnIntroPaint);
+RectangularButton(g_sCalibrate, &g_sIntroduction, 0, 0,
+                  &g_sKentec320x240x16_SSD2119, 100, 60, 120, 40,
+                  (PB_STYLE_FILL | PB_STYLE_OUTLINE | PB_STYLE_TEXT |
+                   PB_STYLE_RELEASE_NOTIFY), ClrMidnightBlue, ClrBlack,
+                  ClrGray, ClrSilver, &g_sFontCm20, "Calibrate", 0, 0, 0, 0,
+                  OnCalibrate);
+
+Canvas(g_sIntroduction, g_psPanels, 0, &g_sCalibrate,
+       &g_sKentec320x240x16_SSD2119, 0, 24, 320, 166, CANVAS_STYLE_APP_DRAWN,
+       0, 0, 0, 0, 0, 0, OnIntroPaint);
 
 //*****************************************************************************
 //
@@ -462,6 +660,9 @@ tCanvasWidget g_psPanels[] =
                  24, 320, 166, CANVAS_STYLE_FILL, ClrBlack, 0, 0, 0, 0, 0, 0),
     CanvasStruct(0, 0, g_psSliders, &g_sKentec320x240x16_SSD2119, 0,
                  24, 320, 166, CANVAS_STYLE_FILL, ClrBlack, 0, 0, 0, 0, 0, 0),
+    CanvasStruct(0, 0, 0, &g_sKentec320x240x16_SSD2119Mono, 0, 24, 320, 166,
+                 CANVAS_STYLE_FILL | CANVAS_STYLE_APP_DRAWN, ClrBlack, 0, 0, 0,
+                 0, 0, OnMonoPaint),
 };
 
 //*****************************************************************************
@@ -487,6 +688,7 @@ char *g_pcPanelNames[] =
     "     Push Buttons     ",
     "     Radio Buttons     ",
     "     Sliders     ",
+    "     Monochrome     ",
     "     S/W Update    "
 };
 
@@ -516,6 +718,669 @@ RectangularButton(g_sNext, 0, 0, 0, &g_sKentec320x240x16_SSD2119, 270, 190,
 //*****************************************************************************
 uint32_t g_ulPanel;
 
+//*****************************************************************************
+//
+// The index of the push button panel, whose rectangular buttons are drawn from
+// pre-rendered copies of their pressed and released appearances.
+//
+//*****************************************************************************
+#define PANEL_PUSH_BUTTONS      5
+
+//*****************************************************************************
+//
+// The number of pixels available for pre-rendered push button images.  Each
+// cached button takes two pixels (one per state) for each pixel of its area,
+// so the default holds both states of the two 50x50 image buttons.  The trace
+// recorder and the tile renderer need RAM of their own, so when either is
+// built in only one image button is cached.  Buttons that do not fit are
+// painted by the widget as usual.  The pixels share their memory with the
+// frame buffer of the monochrome panel, as the two panels are never shown at
+// once.
+//
+//*****************************************************************************
+#ifndef BUTTON_CACHE_PIXELS
+#if defined(TOUCH_TRACE) || defined(TILE_RENDER)
+#define BUTTON_CACHE_PIXELS     (2 * 50 * 50)
+#else
+#define BUTTON_CACHE_PIXELS     (2 * 2 * 50 * 50)
+#endif
+#endif
+
+//*****************************************************************************
+//
+// A push button whose appearance has been pre-rendered into the cache.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The push button, and the message procedure it had before it was
+    // cached.
+    //
+    tPushButtonWidget *psButton;
+    int32_t (*pfnMsgProc)(tWidget *pWidget, uint32_t ulMsg, uint32_t ulParam1,
+                          uint32_t ulParam2);
+
+    //
+    // The pre-rendered released and pressed appearances of the push button.
+    //
+    unsigned short *pusReleased;
+    unsigned short *pusPressed;
+}
+tButtonCacheEntry;
+
+//*****************************************************************************
+//
+// The push button cache.  Buffers are carved sequentially from the pixel pool
+// when the push button panel is shown and all released together when it is
+// removed.
+//
+//*****************************************************************************
+static unsigned short g_pusButtonCachePool[(BUTTON_CACHE_PIXELS >
+                                            (KENTEC_MONO_BUFFER_SIZE / 2)) ?
+                                           BUTTON_CACHE_PIXELS :
+                                           (KENTEC_MONO_BUFFER_SIZE / 2)];
+static uint32_t g_ulButtonCachePoolUsed;
+static tButtonCacheEntry g_psButtonCache[NUM_PUSH_BUTTONS];
+static uint32_t g_ulButtonCacheCount;
+
+//*****************************************************************************
+//
+// Handles messages for a push button whose appearance is held in the cache.
+// The original message procedure still implements the button's behavior, but
+// it draws into the discarding capture display, and each change of state is
+// shown by copying the matching pre-rendered image to the screen.  The copy
+// is sent by the uDMA controller, so it returns straight away.
+//
+//*****************************************************************************
+static int32_t
+CachedButtonMsgProc(tWidget *pWidget, uint32_t ulMsg, uint32_t ulParam1,
+                    uint32_t ulParam2)
+{
+    tButtonCacheEntry *psEntry;
+    tPushButtonWidget *psButton;
+    uint32_t ulPressed, ulIdx;
+    int32_t lRet;
+
+    //
+    // Find the cache entry for this push button.
+    //
+    for(ulIdx = 0; ulIdx < g_ulButtonCacheCount; ulIdx++)
+    {
+        if(pWidget == (tWidget *)g_psButtonCache[ulIdx].psButton)
+        {
+            break;
+        }
+    }
+    if(ulIdx == g_ulButtonCacheCount)
+    {
+        return(WidgetDefaultMsgProc(pWidget, ulMsg, ulParam1, ulParam2));
+    }
+    psEntry = &g_psButtonCache[ulIdx];
+    psButton = psEntry->psButton;
+
+    //
+    // A paint request is satisfied entirely from the cache, unless the button
+    // is being drawn somewhere other than the panel.
+    //
+    if((ulMsg == WIDGET_MSG_PAINT) &&
+       (pWidget->psDisplay != &g_sKentec320x240x16_SSD2119))
+    {
+        return(psEntry->pfnMsgProc(pWidget, ulMsg, ulParam1, ulParam2));
+    }
+    if(ulMsg == WIDGET_MSG_PAINT)
+    {
+        Kentec320x240x16_SSD2119Blit(&pWidget->sPosition,
+                                     ((psButton->ui32Style & PB_STYLE_PRESSED) ?
+                                      psEntry->pusPressed :
+                                      psEntry->pusReleased));
+        return(1);
+    }
+
+    //
+    // Let the push button handle everything else with its drawing discarded.
+    //
+    ulPressed = psButton->ui32Style & PB_STYLE_PRESSED;
+    Kentec320x240x16_SSD2119CaptureSet(0, 0);
+    pWidget->psDisplay = &g_sKentec320x240x16_SSD2119Capture;
+    lRet = psEntry->pfnMsgProc(pWidget, ulMsg, ulParam1, ulParam2);
+    pWidget->psDisplay = &g_sKentec320x240x16_SSD2119;
+
+    //
+    // If the press state changed, show the appearance for the new state.
+    //
+    if((psButton->ui32Style & PB_STYLE_PRESSED) != ulPressed)
+    {
+        Kentec320x240x16_SSD2119Blit(&pWidget->sPosition,
+                                     (ulPressed ? psEntry->pusReleased :
+                                      psEntry->pusPressed));
+    }
+
+    return(lRet);
+}
+
+//*****************************************************************************
+//
+// Renders the pressed and released appearances of a push button into the
+// cache.  Returns false if the cache does not have room for the button.
+//
+//*****************************************************************************
+static bool
+ButtonCacheAdd(tPushButtonWidget *psButton)
+{
+    tButtonCacheEntry *psEntry;
+    tWidget *pWidget;
+    uint32_t ulPixels, ulStyle;
+
+    //
+    // Only rectangular buttons are cached, since they cover their whole area.
+    //
+    pWidget = (tWidget *)psButton;
+    if(pWidget->pfnMsgProc != RectangularButtonMsgProc)
+    {
+        return(false);
+    }
+
+    //
+    // See if there is room in the pool for both states of this button.
+    //
+    ulPixels = ((pWidget->sPosition.i16XMax - pWidget->sPosition.i16XMin + 1) *
+                (pWidget->sPosition.i16YMax - pWidget->sPosition.i16YMin + 1));
+    if((g_ulButtonCachePoolUsed + (2 * ulPixels)) > BUTTON_CACHE_PIXELS)
+    {
+        return(false);
+    }
+
+    //
+    // Allocate the buffers for this button.
+    //
+    psEntry = &g_psButtonCache[g_ulButtonCacheCount++];
+    psEntry->psButton = psButton;
+    psEntry->pfnMsgProc = pWidget->pfnMsgProc;
+    psEntry->pusReleased = g_pusButtonCachePool + g_ulButtonCachePoolUsed;
+    psEntry->pusPressed = psEntry->pusReleased + ulPixels;
+    g_ulButtonCachePoolUsed += 2 * ulPixels;
+
+    //
+    // Have the push button paint itself in each state into the capture
+    // display.  The area is cleared first so that anything the button does
+    // not draw matches the black panel background.
+    //
+    ulStyle = psButton->ui32Style;
+    pWidget->psDisplay = &g_sKentec320x240x16_SSD2119Capture;
+
+    Kentec320x240x16_SSD2119CaptureSet(psEntry->pusReleased,
+                                       &pWidget->sPosition);
+    DpyRectFill(&g_sKentec320x240x16_SSD2119Capture, &pWidget->sPosition,
+                DpyColorTranslate(&g_sKentec320x240x16_SSD2119Capture,
+                                  ClrBlack));
+    psButton->ui32Style = ulStyle & ~PB_STYLE_PRESSED;
+    psEntry->pfnMsgProc(pWidget, WIDGET_MSG_PAINT, 0, 0);
+
+    Kentec320x240x16_SSD2119CaptureSet(psEntry->pusPressed,
+                                       &pWidget->sPosition);
+    DpyRectFill(&g_sKentec320x240x16_SSD2119Capture, &pWidget->sPosition,
+                DpyColorTranslate(&g_sKentec320x240x16_SSD2119Capture,
+                                  ClrBlack));
+    psButton->ui32Style = ulStyle | PB_STYLE_PRESSED;
+    psEntry->pfnMsgProc(pWidget, WIDGET_MSG_PAINT, 0, 0);
+
+    psButton->ui32Style = ulStyle;
+    pWidget->psDisplay = &g_sKentec320x240x16_SSD2119;
+    Kentec320x240x16_SSD2119CaptureSet(0, 0);
+
+    //
+    // Route this button's messages through the cache from now on.
+    //
+    pWidget->pfnMsgProc = CachedButtonMsgProc;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Pre-renders the push buttons on the push button panel.  The image buttons
+// are the most expensive to draw, so they are given the cache first.
+//
+//*****************************************************************************
+static void
+ButtonCacheLoad(void)
+{
+    uint32_t ulIdx;
+
+    for(ulIdx = 0; ulIdx < NUM_PUSH_BUTTONS; ulIdx++)
+    {
+        if(g_psPushButtons[ulIdx].ui32Style & PB_STYLE_IMG)
+        {
+            ButtonCacheAdd(g_psPushButtons + ulIdx);
+        }
+    }
+    for(ulIdx = 0; ulIdx < NUM_PUSH_BUTTONS; ulIdx++)
+    {
+        if(!(g_psPushButtons[ulIdx].ui32Style & PB_STYLE_IMG))
+        {
+            ButtonCacheAdd(g_psPushButtons + ulIdx);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the push buttons to their own message procedures and releases the
+// cache.  A copy from the cache may still be on its way to the display, so
+// it is waited for before the pool can be reused.
+//
+//*****************************************************************************
+static void
+ButtonCacheFree(void)
+{
+    uint32_t ulIdx;
+
+    DpyFlush(&g_sKentec320x240x16_SSD2119);
+    for(ulIdx = 0; ulIdx < g_ulButtonCacheCount; ulIdx++)
+    {
+        g_psButtonCache[ulIdx].psButton->sBase.pfnMsgProc =
+            g_psButtonCache[ulIdx].pfnMsgProc;
+    }
+    g_ulButtonCacheCount = 0;
+    g_ulButtonCachePoolUsed = 0;
+}
+
+//*****************************************************************************
+//
+// The index of the monochrome panel, which is drawn into a one bit per pixel
+// copy of the screen.  A drag across it draws a rubber band by inverting its
+// edges, and the area within is inverted once the pen is lifted; each is
+// undone by inverting it again, which needs the pixels to be read back.
+//
+//*****************************************************************************
+#define PANEL_MONO              8
+
+//*****************************************************************************
+//
+// The rubber band being dragged, and the point it was started from, and the
+// selected area, if any.
+//
+//*****************************************************************************
+static bool g_bMonoBand;
+static tRectangle g_sMonoBand;
+static int32_t g_lMonoX, g_lMonoY;
+static bool g_bMonoSelected;
+static tRectangle g_sMonoSelection;
+
+//*****************************************************************************
+//
+// Inverts the one pixel wide edges of a rectangle on the monochrome display,
+// taking care not to invert any pixel twice.
+//
+//*****************************************************************************
+static void
+MonoBandInvert(const tRectangle *psRect)
+{
+    tRectangle sEdge;
+
+    sEdge = *psRect;
+    sEdge.i16YMax = sEdge.i16YMin;
+    Kentec320x240x16_SSD2119MonoInvert(&sEdge);
+    if(psRect->i16YMax == psRect->i16YMin)
+    {
+        return;
+    }
+
+    sEdge.i16YMin = sEdge.i16YMax = psRect->i16YMax;
+    Kentec320x240x16_SSD2119MonoInvert(&sEdge);
+    if(psRect->i16YMax == (psRect->i16YMin + 1))
+    {
+        return;
+    }
+
+    sEdge.i16YMin = psRect->i16YMin + 1;
+    sEdge.i16YMax = psRect->i16YMax - 1;
+    sEdge.i16XMax = sEdge.i16XMin;
+    Kentec320x240x16_SSD2119MonoInvert(&sEdge);
+    if(psRect->i16XMax != psRect->i16XMin)
+    {
+        sEdge.i16XMin = sEdge.i16XMax = psRect->i16XMax;
+        Kentec320x240x16_SSD2119MonoInvert(&sEdge);
+    }
+}
+
+//*****************************************************************************
+//
+// Sets a rectangle to span from the start of the rubber band to a point,
+// which is held within the monochrome panel.
+//
+//*****************************************************************************
+static void
+MonoBandSet(tRectangle *psRect, const tRectangle *psPanel, int32_t lX,
+            int32_t lY)
+{
+    lX = (lX < psPanel->i16XMin) ? psPanel->i16XMin :
+         ((lX > psPanel->i16XMax) ? psPanel->i16XMax : lX);
+    lY = (lY < psPanel->i16YMin) ? psPanel->i16YMin :
+         ((lY > psPanel->i16YMax) ? psPanel->i16YMax : lY);
+
+    psRect->i16XMin = (lX < g_lMonoX) ? lX : g_lMonoX;
+    psRect->i16XMax = (lX < g_lMonoX) ? g_lMonoX : lX;
+    psRect->i16YMin = (lY < g_lMonoY) ? lY : g_lMonoY;
+    psRect->i16YMax = (lY < g_lMonoY) ? g_lMonoY : lY;
+}
+
+//*****************************************************************************
+//
+// Handles messages for the monochrome panel.  The canvas paints the panel,
+// and the pointer messages drag out a selection.
+//
+//*****************************************************************************
+static int32_t
+MonoPanelMsgProc(tWidget *pWidget, uint32_t ulMsg, uint32_t ulParam1,
+                 uint32_t ulParam2)
+{
+    switch(ulMsg)
+    {
+        case WIDGET_MSG_PTR_DOWN:
+        {
+            if(!GrRectContainsPoint(&pWidget->sPosition, (int32_t)ulParam1,
+                                    (int32_t)ulParam2))
+            {
+                return(0);
+            }
+
+            //
+            // Remove the previous selection and start a rubber band at the
+            // pen.
+            //
+            if(g_bMonoSelected)
+            {
+                Kentec320x240x16_SSD2119MonoInvert(&g_sMonoSelection);
+                g_bMonoSelected = false;
+            }
+            g_lMonoX = ulParam1;
+            g_lMonoY = ulParam2;
+            MonoBandSet(&g_sMonoBand, &pWidget->sPosition, ulParam1,
+                        ulParam2);
+            MonoBandInvert(&g_sMonoBand);
+            g_bMonoBand = true;
+            DpyFlush(&g_sKentec320x240x16_SSD2119Mono);
+            return(1);
+        }
+
+        case WIDGET_MSG_PTR_MOVE:
+        {
+            if(!g_bMonoBand)
+            {
+                return(0);
+            }
+
+            //
+            // Move the rubber band to the pen.
+            //
+            MonoBandInvert(&g_sMonoBand);
+            MonoBandSet(&g_sMonoBand, &pWidget->sPosition, ulParam1,
+                        ulParam2);
+            MonoBandInvert(&g_sMonoBand);
+            DpyFlush(&g_sKentec320x240x16_SSD2119Mono);
+            return(1);
+        }
+
+        case WIDGET_MSG_PTR_UP:
+        {
+            if(!g_bMonoBand)
+            {
+                return(0);
+            }
+
+            //
+            // Replace the rubber band with the inverted selection.
+            //
+            MonoBandInvert(&g_sMonoBand);
+            MonoBandSet(&g_sMonoSelection, &pWidget->sPosition, ulParam1,
+                        ulParam2);
+            Kentec320x240x16_SSD2119MonoInvert(&g_sMonoSelection);
+            g_bMonoBand = false;
+            g_bMonoSelected = true;
+            DpyFlush(&g_sKentec320x240x16_SSD2119Mono);
+            return(1);
+        }
+
+        default:
+        {
+            return(CanvasMsgProc(pWidget, ulMsg, ulParam1, ulParam2));
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Prepares the monochrome panel to be shown, giving it the memory of the
+// push button cache for its frame buffer.
+//
+//*****************************************************************************
+static void
+MonoPanelShow(void)
+{
+    Kentec320x240x16_SSD2119MonoInit((unsigned char *)g_pusButtonCachePool,
+                                     ClrWhite, ClrBlack);
+    g_psPanels[PANEL_MONO].sBase.pfnMsgProc = MonoPanelMsgProc;
+    g_bMonoBand = false;
+    g_bMonoSelected = false;
+}
+
+//*****************************************************************************
+//
+// Handles paint requests for the monochrome panel, drawing a few shapes and
+// some text to be selected, and sends the drawing to the screen.
+//
+//*****************************************************************************
+void
+OnMonoPaint(tWidget *pWidget, tContext *pContext)
+{
+    tRectangle sRect;
+    uint32_t ulIdx;
+
+    g_bMonoBand = false;
+    g_bMonoSelected = false;
+
+    GrContextForegroundSet(pContext, ClrWhite);
+    GrContextFontSet(pContext, &g_sFontCm18);
+    GrStringDrawCentered(pContext, "Drag across the panel to select", -1,
+                         160, 36, 0);
+
+    for(ulIdx = 0; ulIdx < 5; ulIdx++)
+    {
+        GrCircleDraw(pContext, 40 + (ulIdx * 60), 90, 10 + (ulIdx * 3));
+        GrCircleFill(pContext, 40 + (ulIdx * 60), 90, 6);
+    }
+
+    sRect.i16XMin = 20;
+    sRect.i16YMin = 125;
+    sRect.i16XMax = 299;
+    sRect.i16YMax = 175;
+    GrRectDraw(pContext, &sRect);
+    for(ulIdx = 0; ulIdx < 14; ulIdx++)
+    {
+        GrLineDraw(pContext, 20 + (ulIdx * 20), 175, 40 + (ulIdx * 20), 125);
+    }
+
+    GrFlush(pContext);
+}
+
+#ifdef TILE_RENDER
+//*****************************************************************************
+//
+// The index of the slider panel, whose sliders are repainted through the tile
+// renderer while it is shown.
+//
+//*****************************************************************************
+#define PANEL_SLIDERS           7
+
+//*****************************************************************************
+//
+// The pixel counts of the current (or last) slider drag so far.
+//
+//*****************************************************************************
+static uint32_t g_ulSliderDragSent;
+static uint32_t g_ulSliderDragSkipped;
+
+//*****************************************************************************
+//
+// The message procedure of the sliders, replaced while the slider panel is
+// shown.
+//
+//*****************************************************************************
+static int32_t (*g_pfnSliderMsgProc)(tWidget *pWidget, uint32_t ulMsg,
+                                     uint32_t ulParam1, uint32_t ulParam2);
+
+//*****************************************************************************
+//
+// Points a widget and all of its descendants at a display.
+//
+//*****************************************************************************
+static void
+WidgetTreeDisplaySet(tWidget *pWidget, const tDisplay *psDisplay)
+{
+    pWidget->psDisplay = psDisplay;
+    for(pWidget = pWidget->psChild; pWidget; pWidget = pWidget->psNext)
+    {
+        WidgetTreeDisplaySet(pWidget, psDisplay);
+    }
+}
+
+//*****************************************************************************
+//
+// Paints a widget and its descendants into the tile being rendered.
+//
+//*****************************************************************************
+static void
+TilePaintProc(void *pvData)
+{
+    tWidget *pWidget;
+
+    pWidget = (tWidget *)pvData;
+    WidgetTreeDisplaySet(pWidget, &g_sKentec320x240x16_SSD2119Capture);
+    WidgetMessageSendPreOrder(pWidget, WIDGET_MSG_PAINT, 0, 0, false);
+    WidgetTreeDisplaySet(pWidget, &g_sKentec320x240x16_SSD2119);
+}
+
+//*****************************************************************************
+//
+// Repaints a widget and its descendants immediately, sending only the tiles
+// that have changed.  Returns the percentage of pixels that were skipped, and
+// adds the pixel counts to the values pointed to.
+//
+//*****************************************************************************
+static uint32_t
+TilePaintWidget(tWidget *pWidget, uint32_t *pulSent, uint32_t *pulSkipped)
+{
+    unsigned int ulSent, ulSkipped;
+
+    Kentec320x240x16_SSD2119TileStats(0, 0, true);
+    Kentec320x240x16_SSD2119TilePaint(&pWidget->sPosition,
+                                      DpyColorTranslate(
+                                          &g_sKentec320x240x16_SSD2119,
+                                          ClrBlack),
+                                      TilePaintProc, pWidget);
+    Kentec320x240x16_SSD2119TileStats(&ulSent, &ulSkipped, true);
+
+    *pulSent += ulSent;
+    *pulSkipped += ulSkipped;
+
+    return((ulSent + ulSkipped) ? ((ulSkipped * 100) / (ulSent + ulSkipped)) :
+           0);
+}
+
+//*****************************************************************************
+//
+// Handles messages for the sliders while the slider panel is shown.  The
+// slider still implements its own behavior, but anything it draws outside of
+// a paint request is discarded; OnSliderChange() repaints it through the tile
+// renderer instead.  A pointer press starts a new drag for the statistics.
+//
+//*****************************************************************************
+static int32_t
+TiledSliderMsgProc(tWidget *pWidget, uint32_t ulMsg, uint32_t ulParam1,
+                   uint32_t ulParam2)
+{
+    const tDisplay *psDisplay;
+    int32_t lRet;
+
+    if(ulMsg == WIDGET_MSG_PAINT)
+    {
+        return(g_pfnSliderMsgProc(pWidget, ulMsg, ulParam1, ulParam2));
+    }
+
+    if(ulMsg == WIDGET_MSG_PTR_DOWN)
+    {
+        g_ulSliderDragSent = 0;
+        g_ulSliderDragSkipped = 0;
+    }
+
+    psDisplay = pWidget->psDisplay;
+    Kentec320x240x16_SSD2119CaptureSet(0, 0);
+    pWidget->psDisplay = &g_sKentec320x240x16_SSD2119Capture;
+    lRet = g_pfnSliderMsgProc(pWidget, ulMsg, ulParam1, ulParam2);
+    pWidget->psDisplay = psDisplay;
+
+    return(lRet);
+}
+
+//*****************************************************************************
+//
+// Routes the slider messages through TiledSliderMsgProc(), or returns them
+// to the slider message procedure.
+//
+//*****************************************************************************
+static void
+TiledSlidersSet(bool bTiled)
+{
+    uint32_t ulIdx;
+
+    if(!g_pfnSliderMsgProc)
+    {
+        g_pfnSliderMsgProc = g_psSliders[0].sBase.pfnMsgProc;
+    }
+    for(ulIdx = 0; ulIdx < NUM_SLIDERS; ulIdx++)
+    {
+        g_psSliders[ulIdx].sBase.pfnMsgProc = (bTiled ? TiledSliderMsgProc :
+                                               g_pfnSliderMsgProc);
+    }
+}
+#endif
+
+//*****************************************************************************
+//
+// Draws the panel that has just been added to the widget tree.  With
+// TILE_RENDER defined this is done immediately through the tile renderer,
+// which only sends the tiles that differ from the previous panel.
+//
+//*****************************************************************************
+static void
+PanelPaint(void)
+{
+#ifdef TILE_RENDER
+    uint32_t ulSent, ulSkipped;
+
+    //
+    // The monochrome panel keeps its own copy of the screen, so it is drawn
+    // directly.
+    //
+    if(g_ulPanel == PANEL_MONO)
+    {
+        TiledSlidersSet(false);
+        WidgetPaint((tWidget *)(g_psPanels + g_ulPanel));
+        return;
+    }
+
+    ulSent = 0;
+    ulSkipped = 0;
+    g_ulTileSkipPanel = TilePaintWidget((tWidget *)(g_psPanels + g_ulPanel),
+                                        &ulSent, &ulSkipped);
+    TiledSlidersSet(g_ulPanel == PANEL_SLIDERS);
+#else
+    WidgetPaint((tWidget *)(g_psPanels + g_ulPanel));
+#endif
+}
+
 //*****************************************************************************
 //
 // Handles presses of the previous panel button.
@@ -532,11 +1397,16 @@ OnPrevious(tWidget *pWidget)
     {
         return;
     }
+    LatencyTypeSet(LATENCY_PANEL);
 
     //
-    // Remove the current panel.
+    // Remove the current panel, releasing its cached push buttons.
     //
     WidgetRemove((tWidget *)(g_psPanels + g_ulPanel));
+    if(g_ulPanel == PANEL_PUSH_BUTTONS)
+    {
+        ButtonCacheFree();
+    }
 
     //
     // Decrement the panel index.
@@ -544,10 +1414,20 @@ OnPrevious(tWidget *pWidget)
     g_ulPanel--;
 
     //
-    // Add and draw the new panel.
+    // Add and draw the new panel, pre-rendering its push buttons if it is the
+    // push button panel, or setting up its frame buffer if it is the
+    // monochrome panel.
     //
     WidgetAdd(WIDGET_ROOT, (tWidget *)(g_psPanels + g_ulPanel));
-    WidgetPaint((tWidget *)(g_psPanels + g_ulPanel));
+    if(g_ulPanel == PANEL_PUSH_BUTTONS)
+    {
+        ButtonCacheLoad();
+    }
+    else if(g_ulPanel == PANEL_MONO)
+    {
+        MonoPanelShow();
+    }
+    PanelPaint();
 
     //
     // Set the title of this panel.
@@ -602,11 +1482,16 @@ OnNext(tWidget *pWidget)
     {
         return;
     }
+    LatencyTypeSet(LATENCY_PANEL);
 
     //
-    // Remove the current panel.
+    // Remove the current panel, releasing its cached push buttons.
     //
     WidgetRemove((tWidget *)(g_psPanels + g_ulPanel));
+    if(g_ulPanel == PANEL_PUSH_BUTTONS)
+    {
+        ButtonCacheFree();
+    }
 
     //
     // Increment the panel index.
@@ -614,10 +1499,20 @@ OnNext(tWidget *pWidget)
     g_ulPanel++;
 
     //
-    // Add and draw the new panel.
+    // Add and draw the new panel, pre-rendering its push buttons if it is the
+    // push button panel, or setting up its frame buffer if it is the
+    // monochrome panel.
     //
     WidgetAdd(WIDGET_ROOT, (tWidget *)(g_psPanels + g_ulPanel));
-    WidgetPaint((tWidget *)(g_psPanels + g_ulPanel));
+    if(g_ulPanel == PANEL_PUSH_BUTTONS)
+    {
+        ButtonCacheLoad();
+    }
+    else if(g_ulPanel == PANEL_MONO)
+    {
+        MonoPanelShow();
+    }
+    PanelPaint();
 
     //
     // Set the title of this panel.
@@ -656,6 +1551,61 @@ OnNext(tWidget *pWidget)
 
 }
 
+//*****************************************************************************
+//
+// This is the handler for the SysTick interrupt, which paces the touch screen
+// calibration.
+//
+//*****************************************************************************
+void
+SysTickIntHandler(void)
+{
+    TouchCalTick();
+}
+
+//*****************************************************************************
+//
+// This is the handler for the UART0 interrupt.  Any character received asks
+// for the latency figures, which are sent from the main loop.
+//
+//*****************************************************************************
+void
+UARTIntHandler(void)
+{
+    UARTIntClear(UART0_BASE, UARTIntStatus(UART0_BASE, true));
+
+    while(UARTCharsAvail(UART0_BASE))
+    {
+        UARTCharGetNonBlocking(UART0_BASE);
+        g_bLatencyDump = true;
+    }
+}
+
+//*****************************************************************************
+//
+// Called once the touch screen calibration has finished, to repaint the
+// application over the area it used.
+//
+//*****************************************************************************
+static void
+OnCalibrateDone(const tTouchCalResult *psResult)
+{
+    WidgetPaint(WIDGET_ROOT);
+}
+
+//*****************************************************************************
+//
+// Handles presses of the calibrate button.  The calibration takes over the
+// screen and the touch screen messages until it is done, while the main loop
+// carries on running.
+//
+//*****************************************************************************
+void
+OnCalibrate(tWidget *pWidget)
+{
+    TouchCalStart(&g_sKentec320x240x16_SSD2119, OnCalibrateDone);
+}
+
 //*****************************************************************************
 //
 // Handles paint requests for the introduction canvas widget.
@@ -871,6 +1821,21 @@ OnButtonPress(tWidget *pWidget)
 
 }
 
+//*****************************************************************************
+//
+// Repaints a widget on the slider panel in response to a slider change.
+//
+//*****************************************************************************
+static void
+SliderWidgetPaint(tWidget *pWidget)
+{
+#ifdef TILE_RENDER
+    TilePaintWidget(pWidget, &g_ulSliderDragSent, &g_ulSliderDragSkipped);
+#else
+    WidgetPaint(pWidget);
+#endif
+}
+
 //*****************************************************************************
 //
 // Handles notifications from the slider controls.
@@ -882,6 +1847,8 @@ OnSliderChange(tWidget *pWidget, int32_t lValue)
     static char pcCanvasText[5];
     static char pcSliderText[5];
 
+    LatencyTypeSet(LATENCY_SLIDER);
+
     //
     // Is this the widget whose value we mirror in the canvas widget and the
     // locked slider?
@@ -893,13 +1860,13 @@ OnSliderChange(tWidget *pWidget, int32_t lValue)
         //
         usprintf(pcCanvasText, "%3d%%", lValue);
         CanvasTextSet(&g_sSliderValueCanvas, pcCanvasText);
-        WidgetPaint((tWidget *)&g_sSliderValueCanvas);
+        SliderWidgetPaint((tWidget *)&g_sSliderValueCanvas);
 
         //
         // Also update the value of the locked slider to reflect this one.
         //
         SliderValueSet(&g_psSliders[SLIDER_LOCKED_INDEX], lValue);
-        WidgetPaint((tWidget *)&g_psSliders[SLIDER_LOCKED_INDEX]);
+        SliderWidgetPaint((tWidget *)&g_psSliders[SLIDER_LOCKED_INDEX]);
     }
 
     if(pWidget == (tWidget *)&g_psSliders[SLIDER_TEXT_VAL_INDEX])
@@ -909,8 +1876,21 @@ OnSliderChange(tWidget *pWidget, int32_t lValue)
         //
         usprintf(pcSliderText, "%3d%%", lValue);
         SliderTextSet(&g_psSliders[SLIDER_TEXT_VAL_INDEX], pcSliderText);
-        WidgetPaint((tWidget *)&g_psSliders[SLIDER_TEXT_VAL_INDEX]);
+        SliderWidgetPaint((tWidget *)&g_psSliders[SLIDER_TEXT_VAL_INDEX]);
     }
+#ifdef TILE_RENDER
+    else
+    {
+        //
+        // The slider's own drawing was discarded, so repaint it here.
+        //
+        SliderWidgetPaint(pWidget);
+    }
+
+    g_ulTileSkipSlider = ((g_ulSliderDragSent + g_ulSliderDragSkipped) ?
+                          ((g_ulSliderDragSkipped * 100) /
+                           (g_ulSliderDragSent + g_ulSliderDragSkipped)) : 0);
+#endif
 }
 
 //*****************************************************************************
@@ -985,6 +1965,8 @@ main(void)
 {
     tContext sContext;
     tRectangle sRect;
+    tTouchEvent sEvent;
+    uint32_t ulDrawn, ulCyclesPerUs;
 
     //
     // The FPU should be enabled because some compilers will use floating-
@@ -1047,11 +2029,30 @@ main(void)
     uDMAEnable();
 
     //
-    // Initialize the touch screen driver and have it route its messages to the
-    // widget tree.
+    // Initialize the touch screen driver.  The raw readings are median
+    // filtered so that a still finger does not produce a stream of move
+    // messages, and the messages are queued by the driver and passed on to
+    // the widget tree from the main loop.
     //
     TouchScreenInit();
-    TouchScreenCallbackSet(WidgetPointerMessage);
+    TouchScreenFilterSet(TOUCH_FILTER_MEDIAN, 5);
+    TouchScreenEventQueueEnable(true);
+    ulCyclesPerUs = SysCtlClockGet() / 1000000;
+
+    //
+    // Configure UART0 at 115,200 baud for the latency figures, with an
+    // interrupt on any character received.
+    //
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+    GPIOPinConfigure(GPIO_PA0_U0RX);
+    GPIOPinConfigure(GPIO_PA1_U0TX);
+    GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    UARTConfigSetExpClk(UART0_BASE, SysCtlClockGet(), 115200,
+                        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                         UART_CONFIG_PAR_NONE));
+    UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+    IntEnable(INT_UART0);
 
     //
     // Add the title block and the previous and next buttons to the widget
@@ -1074,13 +2075,77 @@ main(void)
     WidgetPaint(WIDGET_ROOT);
 
     //
-    // Loop forever handling widget messages.
+    // Start the SysTick timer that paces the touch screen calibration.
+    //
+    SysTickPeriodSet(SysCtlClockGet() / TOUCHCAL_TICKS_PER_SECOND);
+    SysTickIntEnable();
+    SysTickEnable();
+
+    //
+    // Loop forever handling widget messages, sleeping whenever there is
+    // nothing to do.  The check is made with interrupts disabled so that
+    // nothing can become pending between it and the sleep; a pending
+    // interrupt still wakes the processor, and is taken once interrupts are
+    // enabled again.
     //
     while(1)
     {
         //
-        // Process any messages in the widget message queue.
+        // Pass the touch screen messages on to the widget tree one at a time,
+        // so that the repaint each one causes can be timed.  The flush
+        // returns once the last pixel has reached the display.
         //
+        while(TouchScreenEventsRead(&sEvent, 1))
+        {
+            //
+            // While the touch screen is being calibrated, its messages carry
+            // raw readings and belong to the calibration.
+            //
+            if(TouchCalActive())
+            {
+                TouchCalPointerMessage(sEvent.ulMsg, sEvent.sX, sEvent.sY);
+                continue;
+            }
+
+            ulDrawn = Kentec320x240x16_SSD2119DrawCount();
+            g_ulLatencyType = ((sEvent.ulMsg == WIDGET_MSG_PTR_DOWN) ?
+                               LATENCY_PRESS : LATENCY_NONE);
+
+            WidgetPointerMessage(sEvent.ulMsg, sEvent.sX, sEvent.sY);
+            WidgetMessageQueueProcess();
+            GrFlush(&sContext);
+
+            if((g_ulLatencyType != LATENCY_NONE) &&
+               (Kentec320x240x16_SSD2119DrawCount() != ulDrawn))
+            {
+                LatencyRecord(g_ulLatencyType,
+                              ((HWREG(DWT_CYCCNT) - sEvent.ulTime) /
+                               ulCyclesPerUs));
+            }
+        }
+
+        //
+        // Let any calibration in progress move on, then process any messages
+        // in the widget message queue.
+        //
+        TouchCalProcess();
         WidgetMessageQueueProcess();
+
+        //
+        // Send the latency figures if they have been asked for.
+        //
+        if(g_bLatencyDump)
+        {
+            g_bLatencyDump = false;
+            LatencyDump();
+        }
+
+        IntMasterDisable();
+        if(!TouchScreenEventsPending() && !TouchCalPending() &&
+           !g_bLatencyDump)
+        {
+            SysCtlSleep();
+        }
+        IntMasterEnable();
     }
 }
@@ -29,7 +29,11 @@
 MEMORY
 {
     /* Application stored in and executes from internal flash */
-    FLASH (RX) : origin = APP_BASE, length = 0x00040000
+    FLASH (RX) : origin = APP_BASE, length = 0x0003FC00
+    /* Last 1 KB page holds the touch screen calibration saved by          */
+    /* TouchScreenCalibrationSave(); it must match TS_CAL_FLASH_ADDR in     */
+    /* touch.c.                                                             */
+    TOUCHCAL (R) : origin = 0x0003FC00, length = 0x00000400
     /* Application uses internal RAM for data */
     SRAM (RWX) : origin = 0x20000000, length = 0x00008000
 }
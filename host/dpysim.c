@@ -0,0 +1,268 @@
+//*****************************************************************************
+//
+// dpysim.c - A simulated Kentec K350QVG-V2-F display for the host build.
+//
+// This stands in for the SSD2119 driver.  The pixels are kept in a frame
+// buffer, which can be written out as a PPM image, and each drawing call
+// lets the time pass that the driver takes to send it in SPI_3 mode without
+// the uDMA controller: nine bit frames at 14 MHz, two for each pixel and
+// three for each register written, with the processor waiting on the SSI.
+// The work the processor does between the frames is not charged.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "grlib/grlib.h"
+#include "Kentec320x240x16_ssd2119_8bit.h"
+#include "hwsim.h"
+
+//*****************************************************************************
+//
+// The size of the display, and the rate and size of the SSI frames.
+//
+//*****************************************************************************
+#define DPYSIM_WIDTH            320
+#define DPYSIM_HEIGHT           240
+#define DPYSIM_SSI_RATE         14000000
+#define DPYSIM_FRAME_BITS       9
+
+//*****************************************************************************
+//
+// The frames sent to set up each kind of drawing, before its pixels: the
+// cursor and the RAM data command for a pixel, plus the entry mode for a
+// line, and the window, cursor and command for a rectangle and the window
+// reset after it.
+//
+//*****************************************************************************
+#define DPYSIM_PIXEL_SETUP      7
+#define DPYSIM_LINE_SETUP       10
+#define DPYSIM_RECT_SETUP       25
+
+//*****************************************************************************
+//
+// The frame buffer, in the display's 5-6-5 format, and the cycles spent
+// sending to the display.
+//
+//*****************************************************************************
+static uint16_t g_pusDpySimFrame[DPYSIM_HEIGHT][DPYSIM_WIDTH];
+static uint32_t g_ulDpySimCycles;
+
+//*****************************************************************************
+//
+// Translates a 24-bit RGB color to the display's 5-6-5 format.
+//
+//*****************************************************************************
+#define DPYCOLORTRANSLATE(c)    ((((c) & 0x00f80000) >> 8) |               \
+                                 (((c) & 0x0000fc00) >> 5) |               \
+                                 (((c) & 0x000000f8) >> 3))
+
+//*****************************************************************************
+//
+// Lets the time pass that sending a number of frames takes.
+//
+//*****************************************************************************
+static void
+DpySimSend(uint32_t ulFrames)
+{
+    uint32_t ulCycles;
+
+    ulCycles = (((uint64_t)ulFrames * DPYSIM_FRAME_BITS * SysCtlClockGet()) /
+                DPYSIM_SSI_RATE);
+    g_ulDpySimCycles += ulCycles;
+    HWSimCyclesAdd(ulCycles);
+}
+
+//*****************************************************************************
+//
+// Stores a pixel, if it is on the display.
+//
+//*****************************************************************************
+static void
+DpySimPut(int32_t i32X, int32_t i32Y, uint32_t ui32Value)
+{
+    if((i32X >= 0) && (i32X < DPYSIM_WIDTH) && (i32Y >= 0) &&
+       (i32Y < DPYSIM_HEIGHT))
+    {
+        g_pusDpySimFrame[i32Y][i32X] = ui32Value;
+    }
+}
+
+//*****************************************************************************
+//
+// The display driver functions.
+//
+//*****************************************************************************
+static void
+DpySimPixelDraw(void *pvDisplayData, int32_t i32X, int32_t i32Y,
+                uint32_t ui32Value)
+{
+    DpySimPut(i32X, i32Y, ui32Value);
+    DpySimSend(DPYSIM_PIXEL_SETUP + 2);
+}
+
+static void
+DpySimPixelDrawMultiple(void *pvDisplayData, int32_t i32X, int32_t i32Y,
+                        int32_t i32X0, int32_t i32Count, int32_t i32BPP,
+                        const uint8_t *pui8Data, const uint8_t *pui8Palette)
+{
+    //
+    // Images are not drawn by the target sources built here, so only the
+    // time is simulated.
+    //
+    DpySimSend(DPYSIM_LINE_SETUP + (i32Count * 2));
+}
+
+static void
+DpySimLineDrawH(void *pvDisplayData, int32_t i32X1, int32_t i32X2,
+                int32_t i32Y, uint32_t ui32Value)
+{
+    int32_t i32X;
+
+    for(i32X = i32X1; i32X <= i32X2; i32X++)
+    {
+        DpySimPut(i32X, i32Y, ui32Value);
+    }
+    DpySimSend(DPYSIM_LINE_SETUP + ((i32X2 - i32X1 + 1) * 2));
+}
+
+static void
+DpySimLineDrawV(void *pvDisplayData, int32_t i32X, int32_t i32Y1,
+                int32_t i32Y2, uint32_t ui32Value)
+{
+    int32_t i32Y;
+
+    for(i32Y = i32Y1; i32Y <= i32Y2; i32Y++)
+    {
+        DpySimPut(i32X, i32Y, ui32Value);
+    }
+    DpySimSend(DPYSIM_LINE_SETUP + ((i32Y2 - i32Y1 + 1) * 2));
+}
+
+static void
+DpySimRectFill(void *pvDisplayData, const tRectangle *psRect,
+               uint32_t ui32Value)
+{
+    int32_t i32X, i32Y;
+
+    for(i32Y = psRect->i16YMin; i32Y <= psRect->i16YMax; i32Y++)
+    {
+        for(i32X = psRect->i16XMin; i32X <= psRect->i16XMax; i32X++)
+        {
+            DpySimPut(i32X, i32Y, ui32Value);
+        }
+    }
+    DpySimSend(DPYSIM_RECT_SETUP +
+               ((psRect->i16XMax - psRect->i16XMin + 1) *
+                (psRect->i16YMax - psRect->i16YMin + 1) * 2));
+}
+
+static uint32_t
+DpySimColorTranslate(void *pvDisplayData, uint32_t ui32Value)
+{
+    return(DPYCOLORTRANSLATE(ui32Value));
+}
+
+static void
+DpySimFlush(void *pvDisplayData)
+{
+}
+
+//*****************************************************************************
+//
+// The display structure that describes the simulated display.
+//
+//*****************************************************************************
+const tDisplay g_sKentec320x240x16_SSD2119 =
+{
+    sizeof(tDisplay),
+    0,
+    DPYSIM_WIDTH,
+    DPYSIM_HEIGHT,
+    DpySimPixelDraw,
+    DpySimPixelDrawMultiple,
+    DpySimLineDrawH,
+    DpySimLineDrawV,
+    DpySimRectFill,
+    DpySimColorTranslate,
+    DpySimFlush
+};
+
+//*****************************************************************************
+//
+// Clears the frame buffer.
+//
+//*****************************************************************************
+void
+Kentec320x240x16_SSD2119Init(void)
+{
+    memset(g_pusDpySimFrame, 0, sizeof(g_pusDpySimFrame));
+    g_ulDpySimCycles = 0;
+}
+
+//*****************************************************************************
+//
+// Fills a list of horizontal spans, each sent as a line as the driver does
+// without the uDMA controller.
+//
+//*****************************************************************************
+void
+Kentec320x240x16_SSD2119SpansFill(const tSSD2119Span *psSpans,
+                                  unsigned int ulCount, unsigned int ulValue)
+{
+    for(; ulCount; ulCount--, psSpans++)
+    {
+        if(psSpans->i16X2 >= psSpans->i16X1)
+        {
+            DpySimLineDrawH(0, psSpans->i16X1, psSpans->i16X2, psSpans->i16Y,
+                            ulValue);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the processor cycles spent sending to the display so far.
+//
+//*****************************************************************************
+uint32_t
+DpySimCycles(void)
+{
+    return(g_ulDpySimCycles);
+}
+
+//*****************************************************************************
+//
+// Writes the frame buffer out as a binary PPM image.
+//
+//*****************************************************************************
+bool
+DpySimWrite(const char *pcFile)
+{
+    FILE *pFile;
+    uint32_t ulX, ulY, ulPixel;
+
+    pFile = fopen(pcFile, "wb");
+    if(!pFile)
+    {
+        return(false);
+    }
+
+    fprintf(pFile, "P6\n%d %d\n255\n", DPYSIM_WIDTH, DPYSIM_HEIGHT);
+    for(ulY = 0; ulY < DPYSIM_HEIGHT; ulY++)
+    {
+        for(ulX = 0; ulX < DPYSIM_WIDTH; ulX++)
+        {
+            ulPixel = g_pusDpySimFrame[ulY][ulX];
+            fputc(((ulPixel >> 11) & 0x1f) << 3, pFile);
+            fputc(((ulPixel >> 5) & 0x3f) << 2, pFile);
+            fputc((ulPixel & 0x1f) << 3, pFile);
+        }
+    }
+
+    return(fclose(pFile) == 0);
+}
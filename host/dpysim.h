@@ -0,0 +1,13 @@
+//*****************************************************************************
+//
+// dpysim.h - Prototypes for the simulated display of the host build.
+//
+//*****************************************************************************
+
+#ifndef __DPYSIM_H__
+#define __DPYSIM_H__
+
+extern uint32_t DpySimCycles(void);
+extern bool DpySimWrite(const char *pcFile);
+
+#endif // __DPYSIM_H__
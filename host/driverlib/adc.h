@@ -0,0 +1,29 @@
+//*****************************************************************************
+//
+// adc.h - Prototypes for the ADC functions simulated by the host build.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_ADC_H__
+#define __DRIVERLIB_ADC_H__
+
+#define ADC_TRIGGER_PROCESSOR   0x00000000
+#define ADC_TRIGGER_TIMER       0x00000005
+
+#define ADC_CTL_IE              0x00000040
+#define ADC_CTL_END             0x00000020
+#define ADC_CTL_CH0             0x00000000
+#define ADC_CTL_CH6             0x00000006
+#define ADC_CTL_CH7             0x00000007
+
+extern void ADCIntEnable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+extern void ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum);
+extern void ADCSequenceConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                                 uint32_t ui32Trigger, uint32_t ui32Priority);
+extern void ADCSequenceStepConfigure(uint32_t ui32Base,
+                                     uint32_t ui32SequenceNum,
+                                     uint32_t ui32Step, uint32_t ui32Config);
+extern void ADCHardwareOversampleConfigure(uint32_t ui32Base,
+                                           uint32_t ui32Factor);
+
+#endif // __DRIVERLIB_ADC_H__
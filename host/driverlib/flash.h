@@ -0,0 +1,14 @@
+//*****************************************************************************
+//
+// flash.h - Prototypes for the flash functions simulated by the host build.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_FLASH_H__
+#define __DRIVERLIB_FLASH_H__
+
+extern int32_t FlashErase(uint32_t ui32Address);
+extern int32_t FlashProgram(uint32_t *pui32Data, uint32_t ui32Address,
+                            uint32_t ui32Count);
+
+#endif // __DRIVERLIB_FLASH_H__
@@ -0,0 +1,16 @@
+//*****************************************************************************
+//
+// interrupt.h - Prototypes for the interrupt controller functions simulated
+//               by the host build.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_INTERRUPT_H__
+#define __DRIVERLIB_INTERRUPT_H__
+
+extern bool IntMasterEnable(void);
+extern bool IntMasterDisable(void);
+extern void IntEnable(uint32_t ui32Interrupt);
+extern void IntDisable(uint32_t ui32Interrupt);
+
+#endif // __DRIVERLIB_INTERRUPT_H__
@@ -0,0 +1,10 @@
+//*****************************************************************************
+//
+// rom.h - The host build has no ROM, so there are no ROM_ functions.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_ROM_H__
+#define __DRIVERLIB_ROM_H__
+
+#endif // __DRIVERLIB_ROM_H__
@@ -0,0 +1,16 @@
+//*****************************************************************************
+//
+// sw_crc.h - Prototypes for the software CRC functions, built from the same
+//            polynomials as TivaWare for the host.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_SW_CRC_H__
+#define __DRIVERLIB_SW_CRC_H__
+
+extern uint16_t Crc16(uint16_t ui16Crc, const uint8_t *pui8Data,
+                      uint32_t ui32Count);
+extern uint32_t Crc32(uint32_t ui32Crc, const uint8_t *pui8Data,
+                      uint32_t ui32Count);
+
+#endif // __DRIVERLIB_SW_CRC_H__
@@ -0,0 +1,30 @@
+//*****************************************************************************
+//
+// sysctl.h - Prototypes for the system control functions simulated by the
+//            host build.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_SYSCTL_H__
+#define __DRIVERLIB_SYSCTL_H__
+
+#define SYSCTL_SYSDIV_2_5       0xC1000000
+#define SYSCTL_USE_PLL          0x00000000
+#define SYSCTL_OSC_MAIN         0x00000000
+#define SYSCTL_XTAL_16MHZ       0x00000540
+
+#define SYSCTL_PERIPH_ADC0      0xf0003800
+#define SYSCTL_PERIPH_GPIOA     0xf0000800
+#define SYSCTL_PERIPH_GPIOD     0xf0000803
+#define SYSCTL_PERIPH_GPIOE     0xf0000804
+#define SYSCTL_PERIPH_TIMER1    0xf0000401
+#define SYSCTL_PERIPH_UART0     0xf0001800
+#define SYSCTL_PERIPH_UDMA      0xf0000c00
+
+extern uint32_t SysCtlClockGet(void);
+extern void SysCtlClockSet(uint32_t ui32Config);
+extern void SysCtlDelay(uint32_t ui32Count);
+extern void SysCtlPeripheralEnable(uint32_t ui32Peripheral);
+extern bool SysCtlPeripheralReady(uint32_t ui32Peripheral);
+
+#endif // __DRIVERLIB_SYSCTL_H__
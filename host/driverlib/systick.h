@@ -0,0 +1,19 @@
+//*****************************************************************************
+//
+// systick.h - Prototypes for the SysTick functions simulated by the host
+//             build.  The host program sets the handler with
+//             HWSimHandlerSet(), and it is called as the simulated time
+//             passes each period.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_SYSTICK_H__
+#define __DRIVERLIB_SYSTICK_H__
+
+extern void SysTickEnable(void);
+extern void SysTickDisable(void);
+extern void SysTickIntEnable(void);
+extern void SysTickIntDisable(void);
+extern void SysTickPeriodSet(uint32_t ui32Period);
+
+#endif // __DRIVERLIB_SYSTICK_H__
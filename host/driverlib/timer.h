@@ -0,0 +1,25 @@
+//*****************************************************************************
+//
+// timer.h - Prototypes for the timer functions simulated by the host build.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_TIMER_H__
+#define __DRIVERLIB_TIMER_H__
+
+#define TIMER_CFG_SPLIT_PAIR    0x04000000
+#define TIMER_CFG_A_PERIODIC    0x00000022
+#define TIMER_CFG_B_PERIODIC    0x00002200
+
+#define TIMER_A                 0x000000ff
+#define TIMER_B                 0x0000ff00
+
+extern void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config);
+extern void TimerControlTrigger(uint32_t ui32Base, uint32_t ui32Timer,
+                                bool bEnable);
+extern void TimerDisable(uint32_t ui32Base, uint32_t ui32Timer);
+extern void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer);
+extern void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer,
+                         uint32_t ui32Value);
+
+#endif // __DRIVERLIB_TIMER_H__
@@ -0,0 +1,34 @@
+//*****************************************************************************
+//
+// uart.h - Prototypes for the UART functions simulated by the host build.
+//          Characters sent are written to the standard output.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_UART_H__
+#define __DRIVERLIB_UART_H__
+
+#define UART_INT_TX             0x020
+#define UART_CONFIG_WLEN_8      0x00000060
+#define UART_CONFIG_STOP_ONE    0x00000000
+#define UART_CONFIG_PAR_NONE    0x00000000
+#define UART_FIFO_TX1_8         0x00000000
+#define UART_FIFO_TX2_8         0x00000001
+#define UART_FIFO_TX4_8         0x00000002
+#define UART_FIFO_TX6_8         0x00000003
+#define UART_FIFO_TX7_8         0x00000004
+#define UART_FIFO_RX4_8         0x00000010
+
+extern void UARTCharPut(uint32_t ui32Base, unsigned char ucData);
+extern bool UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData);
+extern bool UARTSpaceAvail(uint32_t ui32Base);
+extern void UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk,
+                                uint32_t ui32Baud, uint32_t ui32Config);
+extern void UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel,
+                             uint32_t ui32RxLevel);
+extern void UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags);
+extern void UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags);
+extern uint32_t UARTIntStatus(uint32_t ui32Base, bool bMasked);
+extern void UARTIntClear(uint32_t ui32Base, uint32_t ui32IntFlags);
+
+#endif // __DRIVERLIB_UART_H__
@@ -0,0 +1,24 @@
+//*****************************************************************************
+//
+// udma.h - The uDMA control structure.  The host build has no uDMA
+//          controller, so the drivers are built without their uDMA paths
+//          and enabling it has no effect.
+//
+//*****************************************************************************
+
+#ifndef __DRIVERLIB_UDMA_H__
+#define __DRIVERLIB_UDMA_H__
+
+typedef struct
+{
+    volatile void *pvSrcEndAddr;
+    volatile void *pvDstEndAddr;
+    volatile uint32_t ui32Control;
+    volatile uint32_t ui32Spare;
+}
+tDMAControlTable;
+
+extern void uDMAEnable(void);
+extern void uDMAControlBaseSet(void *pControlTable);
+
+#endif // __DRIVERLIB_UDMA_H__
@@ -0,0 +1,162 @@
+//*****************************************************************************
+//
+// grlib.h - The graphics library subset used by the host build, implemented
+//           in grsim.c.  Text is not rendered.
+//
+//*****************************************************************************
+
+#ifndef __GRLIB_H__
+#define __GRLIB_H__
+
+//*****************************************************************************
+//
+// A rectangle, inclusive of both corners.
+//
+//*****************************************************************************
+typedef struct
+{
+    int16_t i16XMin;
+    int16_t i16YMin;
+    int16_t i16XMax;
+    int16_t i16YMax;
+}
+tRectangle;
+
+//*****************************************************************************
+//
+// A display driver.
+//
+//*****************************************************************************
+typedef struct
+{
+    int32_t i32Size;
+    void *pvDisplayData;
+    uint16_t ui16Width;
+    uint16_t ui16Height;
+    void (*pfnPixelDraw)(void *pvDisplayData, int32_t i32X, int32_t i32Y,
+                         uint32_t ui32Value);
+    void (*pfnPixelDrawMultiple)(void *pvDisplayData, int32_t i32X,
+                                 int32_t i32Y, int32_t i32X0,
+                                 int32_t i32Count, int32_t i32BPP,
+                                 const uint8_t *pui8Data,
+                                 const uint8_t *pui8Palette);
+    void (*pfnLineDrawH)(void *pvDisplayData, int32_t i32X1, int32_t i32X2,
+                         int32_t i32Y, uint32_t ui32Value);
+    void (*pfnLineDrawV)(void *pvDisplayData, int32_t i32X, int32_t i32Y1,
+                         int32_t i32Y2, uint32_t ui32Value);
+    void (*pfnRectFill)(void *pvDisplayData, const tRectangle *psRect,
+                        uint32_t ui32Value);
+    uint32_t (*pfnColorTranslate)(void *pvDisplayData, uint32_t ui32Value);
+    void (*pfnFlush)(void *pvDisplayData);
+}
+tDisplay;
+
+//*****************************************************************************
+//
+// A font.  The host build has no glyphs, so only the height is kept.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t ui8Format;
+    uint8_t ui8MaxWidth;
+    uint8_t ui8Height;
+    uint8_t ui8Baseline;
+}
+tFont;
+
+//*****************************************************************************
+//
+// A drawing context.
+//
+//*****************************************************************************
+typedef struct
+{
+    int32_t i32Size;
+    const tDisplay *psDisplay;
+    tRectangle sClipRegion;
+    uint32_t ui32Foreground;
+    uint32_t ui32Background;
+    const tFont *psFont;
+}
+tContext;
+
+//*****************************************************************************
+//
+// The colors used by the target sources, as 24-bit RGB.
+//
+//*****************************************************************************
+#define ClrBlack                0x00000000
+#define ClrBlue                 0x000000FF
+#define ClrCyan                 0x0000FFFF
+#define ClrDarkBlue             0x0000008B
+#define ClrGreen                0x00008000
+#define ClrLime                 0x0000FF00
+#define ClrMagenta              0x00FF00FF
+#define ClrRed                  0x00FF0000
+#define ClrWhite                0x00FFFFFF
+#define ClrYellow               0x00FFFF00
+
+//*****************************************************************************
+//
+// The display and context accessors, which are macros in the graphics
+// library too.
+//
+//*****************************************************************************
+#define DpyColorTranslate(psDisplay, ui32Value)                               \
+        ((psDisplay)->pfnColorTranslate((psDisplay)->pvDisplayData,           \
+                                        ui32Value))
+#define DpyFlush(psDisplay)                                                   \
+        ((psDisplay)->pfnFlush((psDisplay)->pvDisplayData))
+#define DpyHeightGet(psDisplay) ((psDisplay)->ui16Height)
+#define DpyWidthGet(psDisplay)  ((psDisplay)->ui16Width)
+
+#define GrContextDpyHeightGet(psContext)                                      \
+        (DpyHeightGet((psContext)->psDisplay))
+#define GrContextDpyWidthGet(psContext)                                       \
+        (DpyWidthGet((psContext)->psDisplay))
+#define GrContextFontSet(psContext, pFnt)                                     \
+        do { (psContext)->psFont = (pFnt); } while(0)
+#define GrContextForegroundSet(psContext, ui32Value)                          \
+        do                                                                    \
+        {                                                                     \
+            (psContext)->ui32Foreground =                                     \
+                DpyColorTranslate((psContext)->psDisplay, ui32Value);         \
+        }                                                                     \
+        while(0)
+#define GrFlush(psContext)      DpyFlush((psContext)->psDisplay)
+
+//*****************************************************************************
+//
+// The fonts used by the target sources.
+//
+//*****************************************************************************
+extern const tFont g_sFontCm20;
+extern const tFont g_sFontCmss14;
+extern const tFont g_sFontCmss20;
+
+//*****************************************************************************
+//
+// Prototypes for the graphics functions simulated by the host build.
+// GrStringDrawCentered() writes the string to the standard error.
+//
+//*****************************************************************************
+extern void GrContextInit(tContext *psContext, const tDisplay *psDisplay);
+extern void GrContextClipRegionSet(tContext *psContext, tRectangle *psRect);
+extern void GrLineDraw(const tContext *psContext, int32_t i32X1,
+                       int32_t i32Y1, int32_t i32X2, int32_t i32Y2);
+extern void GrLineDrawH(const tContext *psContext, int32_t i32X1,
+                        int32_t i32X2, int32_t i32Y);
+extern void GrLineDrawV(const tContext *psContext, int32_t i32X,
+                        int32_t i32Y1, int32_t i32Y2);
+extern void GrRectDraw(const tContext *psContext, const tRectangle *psRect);
+extern void GrRectFill(const tContext *psContext, const tRectangle *psRect);
+extern int32_t GrRectIntersectGet(tRectangle *psRect1, tRectangle *psRect2,
+                                  tRectangle *psIntersect);
+extern int32_t GrRectOverlapCheck(tRectangle *psRect1, tRectangle *psRect2);
+extern void GrStringDrawCentered(const tContext *psContext,
+                                 const char *pcString, int32_t i32Length,
+                                 int32_t i32X, int32_t i32Y,
+                                 uint32_t bOpaque);
+
+#endif // __GRLIB_H__
@@ -0,0 +1,15 @@
+//*****************************************************************************
+//
+// widget.h - The widget messages used by the host build.
+//
+//*****************************************************************************
+
+#ifndef __WIDGET_H__
+#define __WIDGET_H__
+
+#define WIDGET_MSG_PAINT        0x00000001
+#define WIDGET_MSG_PTR_DOWN     0x00000002
+#define WIDGET_MSG_PTR_MOVE     0x00000003
+#define WIDGET_MSG_PTR_UP       0x00000004
+
+#endif // __WIDGET_H__
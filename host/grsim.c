@@ -0,0 +1,303 @@
+//*****************************************************************************
+//
+// grsim.c - The graphics library subset used by the host build.
+//
+// These draw through the display driver's functions as the graphics library
+// does, clipped to the context's clipping region.  There are no glyphs, so
+// a string is written to the standard error instead of being drawn, which
+// lets a host program follow the status lines that a target source shows.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "grlib/grlib.h"
+
+//*****************************************************************************
+//
+// The fonts used by the target sources.
+//
+//*****************************************************************************
+const tFont g_sFontCm20 = { 0, 20, 20, 15 };
+const tFont g_sFontCmss14 = { 0, 14, 14, 11 };
+const tFont g_sFontCmss20 = { 0, 20, 20, 15 };
+
+//*****************************************************************************
+//
+// Initializes a drawing context, with the whole display as the clipping
+// region.
+//
+//*****************************************************************************
+void
+GrContextInit(tContext *psContext, const tDisplay *psDisplay)
+{
+    psContext->i32Size = sizeof(tContext);
+    psContext->psDisplay = psDisplay;
+    psContext->sClipRegion.i16XMin = 0;
+    psContext->sClipRegion.i16YMin = 0;
+    psContext->sClipRegion.i16XMax = DpyWidthGet(psDisplay) - 1;
+    psContext->sClipRegion.i16YMax = DpyHeightGet(psDisplay) - 1;
+    psContext->ui32Foreground = 0;
+    psContext->ui32Background = 0;
+    psContext->psFont = 0;
+}
+
+//*****************************************************************************
+//
+// Sets the clipping region, limited to the display.
+//
+//*****************************************************************************
+void
+GrContextClipRegionSet(tContext *psContext, tRectangle *psRect)
+{
+    int32_t i32W, i32H;
+
+    i32W = DpyWidthGet(psContext->psDisplay);
+    i32H = DpyHeightGet(psContext->psDisplay);
+
+    psContext->sClipRegion.i16XMin = (psRect->i16XMin < 0) ? 0 :
+                                     psRect->i16XMin;
+    psContext->sClipRegion.i16YMin = (psRect->i16YMin < 0) ? 0 :
+                                     psRect->i16YMin;
+    psContext->sClipRegion.i16XMax = ((psRect->i16XMax >= i32W) ?
+                                      (i32W - 1) : psRect->i16XMax);
+    psContext->sClipRegion.i16YMax = ((psRect->i16YMax >= i32H) ?
+                                      (i32H - 1) : psRect->i16YMax);
+}
+
+//*****************************************************************************
+//
+// Draws a horizontal line.
+//
+//*****************************************************************************
+void
+GrLineDrawH(const tContext *psContext, int32_t i32X1, int32_t i32X2,
+            int32_t i32Y)
+{
+    const tRectangle *psClip;
+    int32_t i32Swap;
+
+    psClip = &psContext->sClipRegion;
+    if(i32X1 > i32X2)
+    {
+        i32Swap = i32X1;
+        i32X1 = i32X2;
+        i32X2 = i32Swap;
+    }
+    if((i32Y < psClip->i16YMin) || (i32Y > psClip->i16YMax) ||
+       (i32X2 < psClip->i16XMin) || (i32X1 > psClip->i16XMax))
+    {
+        return;
+    }
+    i32X1 = (i32X1 < psClip->i16XMin) ? psClip->i16XMin : i32X1;
+    i32X2 = (i32X2 > psClip->i16XMax) ? psClip->i16XMax : i32X2;
+
+    psContext->psDisplay->pfnLineDrawH(psContext->psDisplay->pvDisplayData,
+                                       i32X1, i32X2, i32Y,
+                                       psContext->ui32Foreground);
+}
+
+//*****************************************************************************
+//
+// Draws a vertical line.
+//
+//*****************************************************************************
+void
+GrLineDrawV(const tContext *psContext, int32_t i32X, int32_t i32Y1,
+            int32_t i32Y2)
+{
+    const tRectangle *psClip;
+    int32_t i32Swap;
+
+    psClip = &psContext->sClipRegion;
+    if(i32Y1 > i32Y2)
+    {
+        i32Swap = i32Y1;
+        i32Y1 = i32Y2;
+        i32Y2 = i32Swap;
+    }
+    if((i32X < psClip->i16XMin) || (i32X > psClip->i16XMax) ||
+       (i32Y2 < psClip->i16YMin) || (i32Y1 > psClip->i16YMax))
+    {
+        return;
+    }
+    i32Y1 = (i32Y1 < psClip->i16YMin) ? psClip->i16YMin : i32Y1;
+    i32Y2 = (i32Y2 > psClip->i16YMax) ? psClip->i16YMax : i32Y2;
+
+    psContext->psDisplay->pfnLineDrawV(psContext->psDisplay->pvDisplayData,
+                                       i32X, i32Y1, i32Y2,
+                                       psContext->ui32Foreground);
+}
+
+//*****************************************************************************
+//
+// Draws a line, stepping along the longer axis and drawing each pixel that
+// is within the clipping region.
+//
+//*****************************************************************************
+void
+GrLineDraw(const tContext *psContext, int32_t i32X1, int32_t i32Y1,
+           int32_t i32X2, int32_t i32Y2)
+{
+    const tRectangle *psClip;
+    int32_t i32DX, i32DY, i32SX, i32SY, i32Err, i32E2;
+
+    if(i32Y1 == i32Y2)
+    {
+        GrLineDrawH(psContext, i32X1, i32X2, i32Y1);
+        return;
+    }
+    if(i32X1 == i32X2)
+    {
+        GrLineDrawV(psContext, i32X1, i32Y1, i32Y2);
+        return;
+    }
+
+    psClip = &psContext->sClipRegion;
+    i32DX = abs(i32X2 - i32X1);
+    i32DY = -abs(i32Y2 - i32Y1);
+    i32SX = (i32X1 < i32X2) ? 1 : -1;
+    i32SY = (i32Y1 < i32Y2) ? 1 : -1;
+    i32Err = i32DX + i32DY;
+    while(1)
+    {
+        if((i32X1 >= psClip->i16XMin) && (i32X1 <= psClip->i16XMax) &&
+           (i32Y1 >= psClip->i16YMin) && (i32Y1 <= psClip->i16YMax))
+        {
+            psContext->psDisplay->pfnPixelDraw(
+                psContext->psDisplay->pvDisplayData, i32X1, i32Y1,
+                psContext->ui32Foreground);
+        }
+        if((i32X1 == i32X2) && (i32Y1 == i32Y2))
+        {
+            break;
+        }
+        i32E2 = i32Err * 2;
+        if(i32E2 >= i32DY)
+        {
+            i32Err += i32DY;
+            i32X1 += i32SX;
+        }
+        if(i32E2 <= i32DX)
+        {
+            i32Err += i32DX;
+            i32Y1 += i32SY;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Draws the outline of a rectangle.
+//
+//*****************************************************************************
+void
+GrRectDraw(const tContext *psContext, const tRectangle *psRect)
+{
+    GrLineDrawH(psContext, psRect->i16XMin, psRect->i16XMax, psRect->i16YMin);
+    if(psRect->i16YMin == psRect->i16YMax)
+    {
+        return;
+    }
+    GrLineDrawV(psContext, psRect->i16XMax, psRect->i16YMin + 1,
+                psRect->i16YMax);
+    if(psRect->i16XMin == psRect->i16XMax)
+    {
+        return;
+    }
+    GrLineDrawH(psContext, psRect->i16XMax - 1, psRect->i16XMin,
+                psRect->i16YMax);
+    if((psRect->i16YMin + 1) == psRect->i16YMax)
+    {
+        return;
+    }
+    GrLineDrawV(psContext, psRect->i16XMin, psRect->i16YMax - 1,
+                psRect->i16YMin + 1);
+}
+
+//*****************************************************************************
+//
+// Fills a rectangle.
+//
+//*****************************************************************************
+void
+GrRectFill(const tContext *psContext, const tRectangle *psRect)
+{
+    tRectangle sRect, sClip;
+
+    sRect = *psRect;
+    sClip = psContext->sClipRegion;
+    if(GrRectIntersectGet(&sRect, &sClip, &sRect))
+    {
+        psContext->psDisplay->pfnRectFill(psContext->psDisplay->pvDisplayData,
+                                          &sRect, psContext->ui32Foreground);
+    }
+}
+
+//*****************************************************************************
+//
+// Finds the intersection of two rectangles, and returns 1 if they overlap
+// or 0 if they do not.
+//
+//*****************************************************************************
+int32_t
+GrRectIntersectGet(tRectangle *psRect1, tRectangle *psRect2,
+                   tRectangle *psIntersect)
+{
+    if(!GrRectOverlapCheck(psRect1, psRect2))
+    {
+        return(0);
+    }
+
+    psIntersect->i16XMin = ((psRect1->i16XMin > psRect2->i16XMin) ?
+                            psRect1->i16XMin : psRect2->i16XMin);
+    psIntersect->i16YMin = ((psRect1->i16YMin > psRect2->i16YMin) ?
+                            psRect1->i16YMin : psRect2->i16YMin);
+    psIntersect->i16XMax = ((psRect1->i16XMax < psRect2->i16XMax) ?
+                            psRect1->i16XMax : psRect2->i16XMax);
+    psIntersect->i16YMax = ((psRect1->i16YMax < psRect2->i16YMax) ?
+                            psRect1->i16YMax : psRect2->i16YMax);
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Returns 1 if two rectangles overlap, or 0 if they do not.
+//
+//*****************************************************************************
+int32_t
+GrRectOverlapCheck(tRectangle *psRect1, tRectangle *psRect2)
+{
+    if((psRect1->i16XMax < psRect2->i16XMin) ||
+       (psRect2->i16XMax < psRect1->i16XMin) ||
+       (psRect1->i16YMax < psRect2->i16YMin) ||
+       (psRect2->i16YMax < psRect1->i16YMin))
+    {
+        return(0);
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Writes a string to the standard error in place of drawing it.
+//
+//*****************************************************************************
+void
+GrStringDrawCentered(const tContext *psContext, const char *pcString,
+                     int32_t i32Length, int32_t i32X, int32_t i32Y,
+                     uint32_t bOpaque)
+{
+    if(i32Length < 0)
+    {
+        fprintf(stderr, "%s\n", pcString);
+    }
+    else
+    {
+        fprintf(stderr, "%.*s\n", (int)i32Length, pcString);
+    }
+}
@@ -0,0 +1,829 @@
+//*****************************************************************************
+//
+// hwsim.c - Simulated registers and driverlib functions for the host build.
+//
+// The target sources reach the hardware through HWREG() and the driverlib
+// functions.  Here HWREG() resolves to a word in a sparse register file, and
+// the driverlib functions update that file as the real ones update the
+// registers, so a host program can drive a driver by writing the registers
+// it reads (an ADC FIFO, a GPIO interrupt status, the cycle counter) and
+// calling its interrupt handler.  Time only passes when HWSimCyclesAdd() is
+// called, by the host program or by a simulated function that would take
+// that long; as it passes, the SysTick timer and the UART transmitter run
+// and call the handlers set with HWSimHandlerSet() for their interrupts.
+// Otherwise registers only change when the driver or the host program
+// writes them.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "inc/hw_gpio.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_timer.h"
+#include "inc/hw_types.h"
+#include "inc/hw_uart.h"
+#include "driverlib/adc.h"
+#include "driverlib/flash.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sw_crc.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/systick.h"
+#include "driverlib/timer.h"
+#include "driverlib/uart.h"
+#include "driverlib/udma.h"
+#include "hwsim.h"
+
+//*****************************************************************************
+//
+// The register file, an open addressed hash of register addresses to their
+// values.  Registers read as zero until they are written.
+//
+//*****************************************************************************
+#define HWSIM_REGS              4096
+
+typedef struct
+{
+    uint32_t ulAddr;
+    bool bUsed;
+    volatile uint32_t ulValue;
+}
+tHWSimReg;
+
+static tHWSimReg g_psHWSimRegs[HWSIM_REGS];
+
+//*****************************************************************************
+//
+// The processor clock reported by SysCtlClockGet(), the state of the
+// processor interrupt, and the peripherals that have been enabled.
+//
+//*****************************************************************************
+static uint32_t g_ulHWSimClock = 50000000;
+static bool g_bHWSimIntsOff;
+#define HWSIM_PERIPHS           32
+static uint32_t g_pulHWSimPeriph[HWSIM_PERIPHS];
+static uint32_t g_ulHWSimPeriphCount;
+
+//*****************************************************************************
+//
+// The interrupt handlers set by the host program, the interrupts that are
+// enabled and those waiting to be taken, and whether a handler is running.
+// All the interrupts have the same priority, so a handler is never
+// interrupted and the lowest numbered one waiting is taken next.
+//
+//*****************************************************************************
+static void (*g_ppfnHWSimHandlers[NUM_INTERRUPTS])(void);
+static bool g_pbHWSimEnabled[NUM_INTERRUPTS];
+static bool g_pbHWSimPending[NUM_INTERRUPTS];
+static bool g_bHWSimInHandler;
+
+//*****************************************************************************
+//
+// The SysTick timer: its period, whether it and its interrupt are enabled,
+// and the cycle count at which it next reaches zero.
+//
+//*****************************************************************************
+static uint32_t g_ulHWSimTickPeriod = 0x01000000;
+static bool g_bHWSimTickOn;
+static bool g_bHWSimTickInt;
+static uint32_t g_ulHWSimTickNext;
+
+//*****************************************************************************
+//
+// The UART0 transmitter: the characters in its FIFO, the cycles each takes
+// to send, the cycle count at which the first finishes, and the FIFO level
+// at or below which the transmit interrupt is raised.  Characters are
+// written to the standard output as they finish.
+//
+//*****************************************************************************
+#define HWSIM_UART_FIFO         16
+static unsigned char g_pucHWSimUARTFIFO[HWSIM_UART_FIFO];
+static uint32_t g_ulHWSimUARTRead;
+static uint32_t g_ulHWSimUARTCount;
+static uint32_t g_ulHWSimUARTCharCycles = 50000000 / 11520;
+static uint32_t g_ulHWSimUARTNext;
+static uint32_t g_ulHWSimUARTLevel = 2;
+
+//*****************************************************************************
+//
+// The simulated flash.  Only the last 4 KB of the 256 KB part is mapped, at
+// its real address, which holds the touch screen calibration page; erased
+// flash reads as all ones.
+//
+//*****************************************************************************
+#define HWSIM_FLASH_BASE        0x0003F000
+#define HWSIM_FLASH_SIZE        0x00001000
+#define HWSIM_FLASH_PAGE        0x00000400
+static bool g_bHWSimFlash;
+
+//*****************************************************************************
+//
+// Returns the storage that simulates the register at ulAddr.
+//
+//*****************************************************************************
+volatile uint32_t *
+HWSimRegister(uint32_t ulAddr)
+{
+    uint32_t ulIdx, ulProbe;
+
+    ulIdx = ((ulAddr >> 2) * 2654435761u) % HWSIM_REGS;
+    for(ulProbe = 0; ulProbe < HWSIM_REGS; ulProbe++)
+    {
+        if(!g_psHWSimRegs[ulIdx].bUsed)
+        {
+            g_psHWSimRegs[ulIdx].bUsed = true;
+            g_psHWSimRegs[ulIdx].ulAddr = ulAddr;
+            g_psHWSimRegs[ulIdx].ulValue = 0;
+            return(&g_psHWSimRegs[ulIdx].ulValue);
+        }
+        if(g_psHWSimRegs[ulIdx].ulAddr == ulAddr)
+        {
+            return(&g_psHWSimRegs[ulIdx].ulValue);
+        }
+        ulIdx = (ulIdx + 1) % HWSIM_REGS;
+    }
+
+    fprintf(stderr, "hwsim: register file full at 0x%08x\n", ulAddr);
+    exit(1);
+}
+
+//*****************************************************************************
+//
+// Sets the processor clock reported by SysCtlClockGet().
+//
+//*****************************************************************************
+void
+HWSimClockSet(uint32_t ulClock)
+{
+    g_ulHWSimClock = ulClock;
+}
+
+//*****************************************************************************
+//
+// Sets the handler called for an interrupt, by its vector number.
+//
+//*****************************************************************************
+void
+HWSimHandlerSet(uint32_t ulInterrupt, void (*pfnHandler)(void))
+{
+    if(ulInterrupt < NUM_INTERRUPTS)
+    {
+        g_ppfnHWSimHandlers[ulInterrupt] = pfnHandler;
+    }
+}
+
+//*****************************************************************************
+//
+// Takes the interrupts that are waiting, unless the processor interrupt is
+// disabled or a handler is already running.  An interrupt with no handler
+// is dropped.
+//
+//*****************************************************************************
+static void
+HWSimIntsTake(void)
+{
+    uint32_t ulInt;
+
+    if(g_bHWSimIntsOff || g_bHWSimInHandler)
+    {
+        return;
+    }
+
+    for(ulInt = 0; ulInt < NUM_INTERRUPTS; ulInt++)
+    {
+        if(!g_pbHWSimPending[ulInt])
+        {
+            continue;
+        }
+        g_pbHWSimPending[ulInt] = false;
+        if(!g_ppfnHWSimHandlers[ulInt])
+        {
+            continue;
+        }
+
+        g_bHWSimInHandler = true;
+        HWSimCyclesAdd(HWSIM_INT_CYCLES);
+        g_ppfnHWSimHandlers[ulInt]();
+        g_bHWSimInHandler = false;
+
+        //
+        // Start again from the lowest numbered, as the handler may have
+        // raised others.
+        //
+        ulInt = (uint32_t)-1;
+    }
+}
+
+//*****************************************************************************
+//
+// Raises an interrupt.  SysTick is not gated by the interrupt controller.
+//
+//*****************************************************************************
+static void
+HWSimIntRaise(uint32_t ulInterrupt)
+{
+    if((ulInterrupt == FAULT_SYSTICK) || g_pbHWSimEnabled[ulInterrupt])
+    {
+        g_pbHWSimPending[ulInterrupt] = true;
+    }
+}
+
+//*****************************************************************************
+//
+// Sends the character at the head of the UART FIFO, raising the transmit
+// interrupt if that takes the FIFO down to its trigger level.
+//
+//*****************************************************************************
+static void
+HWSimUARTShift(void)
+{
+    putchar(g_pucHWSimUARTFIFO[g_ulHWSimUARTRead]);
+    g_ulHWSimUARTRead = (g_ulHWSimUARTRead + 1) % HWSIM_UART_FIFO;
+    g_ulHWSimUARTCount--;
+    g_ulHWSimUARTNext += g_ulHWSimUARTCharCycles;
+
+    if(g_ulHWSimUARTCount == g_ulHWSimUARTLevel)
+    {
+        HWREG(UART0_BASE + UART_O_RIS) |= UART_INT_TX;
+        if(HWREG(UART0_BASE + UART_O_IM) & UART_INT_TX)
+        {
+            HWSimIntRaise(INT_UART0);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Lets a number of processor cycles pass.  The SysTick timer and the UART
+// run meanwhile, and any interrupts they raise are taken when they are
+// raised, which holds up the code that called this by the time their
+// handlers take.
+//
+//*****************************************************************************
+void
+HWSimCyclesAdd(uint32_t ulCycles)
+{
+    uint32_t ulEnd, ulNext, ulStart;
+    bool bTick;
+
+    ulEnd = HWREG(HWSIM_DWT_CYCCNT) + ulCycles;
+
+    while(1)
+    {
+        //
+        // Find the next thing to happen before the end of the time given.
+        //
+        bTick = false;
+        ulNext = ulEnd;
+        if(g_ulHWSimUARTCount &&
+           ((int32_t)(g_ulHWSimUARTNext - ulNext) <= 0))
+        {
+            ulNext = g_ulHWSimUARTNext;
+        }
+        if(g_bHWSimTickOn && ((int32_t)(g_ulHWSimTickNext - ulNext) <= 0))
+        {
+            ulNext = g_ulHWSimTickNext;
+            bTick = true;
+        }
+        HWREG(HWSIM_DWT_CYCCNT) = ulNext;
+
+        if(bTick)
+        {
+            g_ulHWSimTickNext += g_ulHWSimTickPeriod;
+            if(g_bHWSimTickInt)
+            {
+                HWSimIntRaise(FAULT_SYSTICK);
+            }
+        }
+        else if(g_ulHWSimUARTCount && (g_ulHWSimUARTNext == ulNext))
+        {
+            HWSimUARTShift();
+        }
+        else
+        {
+            break;
+        }
+
+        //
+        // The handlers run before the rest of the time given.
+        //
+        ulStart = HWREG(HWSIM_DWT_CYCCNT);
+        HWSimIntsTake();
+        ulEnd += HWREG(HWSIM_DWT_CYCCNT) - ulStart;
+    }
+}
+
+//*****************************************************************************
+//
+// Maps the simulated flash at its target address, erased.  This must be done
+// before any driver that reads flash directly is initialized.
+//
+//*****************************************************************************
+bool
+HWSimFlashMap(void)
+{
+    void *pvFlash;
+
+    if(g_bHWSimFlash)
+    {
+        return(true);
+    }
+
+    pvFlash = mmap((void *)HWSIM_FLASH_BASE, HWSIM_FLASH_SIZE,
+                   PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if((pvFlash == MAP_FAILED) || (pvFlash != (void *)HWSIM_FLASH_BASE))
+    {
+        return(false);
+    }
+
+    memset(pvFlash, 0xff, HWSIM_FLASH_SIZE);
+    g_bHWSimFlash = true;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Returns true if the processor interrupt is disabled.  A driver that
+// leaves it disabled on return has lost track of its masking.
+//
+//*****************************************************************************
+bool
+HWSimIntsOff(void)
+{
+    return(g_bHWSimIntsOff);
+}
+
+//*****************************************************************************
+//
+// The system control functions.
+//
+//*****************************************************************************
+uint32_t
+SysCtlClockGet(void)
+{
+    return(g_ulHWSimClock);
+}
+
+void
+SysCtlClockSet(uint32_t ui32Config)
+{
+}
+
+void
+SysCtlDelay(uint32_t ui32Count)
+{
+    HWSimCyclesAdd(ui32Count * 3);
+}
+
+void
+SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+    if(!SysCtlPeripheralReady(ui32Peripheral) &&
+       (g_ulHWSimPeriphCount < HWSIM_PERIPHS))
+    {
+        g_pulHWSimPeriph[g_ulHWSimPeriphCount++] = ui32Peripheral;
+    }
+}
+
+bool
+SysCtlPeripheralReady(uint32_t ui32Peripheral)
+{
+    uint32_t ulIdx;
+
+    for(ulIdx = 0; ulIdx < g_ulHWSimPeriphCount; ulIdx++)
+    {
+        if(g_pulHWSimPeriph[ulIdx] == ui32Peripheral)
+        {
+            return(true);
+        }
+    }
+
+    return(false);
+}
+
+//*****************************************************************************
+//
+// The interrupt controller functions.  Only the interrupts raised by the
+// simulated SysTick timer and UART are taken here; the host program calls
+// the other handlers itself.
+//
+//*****************************************************************************
+bool
+IntMasterEnable(void)
+{
+    bool bWasOff;
+
+    bWasOff = g_bHWSimIntsOff;
+    g_bHWSimIntsOff = false;
+    HWSimIntsTake();
+
+    return(bWasOff);
+}
+
+bool
+IntMasterDisable(void)
+{
+    bool bWasOff;
+
+    bWasOff = g_bHWSimIntsOff;
+    g_bHWSimIntsOff = true;
+
+    return(bWasOff);
+}
+
+void
+IntEnable(uint32_t ui32Interrupt)
+{
+    if(ui32Interrupt < NUM_INTERRUPTS)
+    {
+        g_pbHWSimEnabled[ui32Interrupt] = true;
+    }
+}
+
+void
+IntDisable(uint32_t ui32Interrupt)
+{
+    if(ui32Interrupt < NUM_INTERRUPTS)
+    {
+        g_pbHWSimEnabled[ui32Interrupt] = false;
+    }
+}
+
+//*****************************************************************************
+//
+// The SysTick functions.  The count restarts from the period when the timer
+// is enabled.
+//
+//*****************************************************************************
+void
+SysTickEnable(void)
+{
+    if(!g_bHWSimTickOn)
+    {
+        g_bHWSimTickOn = true;
+        g_ulHWSimTickNext = HWREG(HWSIM_DWT_CYCCNT) + g_ulHWSimTickPeriod;
+    }
+}
+
+void
+SysTickDisable(void)
+{
+    g_bHWSimTickOn = false;
+}
+
+void
+SysTickIntEnable(void)
+{
+    g_bHWSimTickInt = true;
+}
+
+void
+SysTickIntDisable(void)
+{
+    g_bHWSimTickInt = false;
+    g_pbHWSimPending[FAULT_SYSTICK] = false;
+}
+
+void
+SysTickPeriodSet(uint32_t ui32Period)
+{
+    g_ulHWSimTickPeriod = ui32Period;
+}
+
+//*****************************************************************************
+//
+// The GPIO functions.  Clearing an interrupt clears its raw and masked
+// status; the host program sets them to raise one.
+//
+//*****************************************************************************
+void
+GPIOIntClear(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    HWREG(ui32Port + GPIO_O_RIS) &= ~ui32IntFlags;
+    HWREG(ui32Port + GPIO_O_MIS) &= ~ui32IntFlags;
+}
+
+void
+GPIOIntDisable(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    HWREG(ui32Port + GPIO_O_IM) &= ~ui32IntFlags;
+}
+
+void
+GPIOIntEnable(uint32_t ui32Port, uint32_t ui32IntFlags)
+{
+    HWREG(ui32Port + GPIO_O_IM) |= ui32IntFlags;
+}
+
+void
+GPIOIntTypeSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32IntType)
+{
+    HWREG(ui32Port + GPIO_O_IBE) = ((ui32IntType & 1) ?
+                                    (HWREG(ui32Port + GPIO_O_IBE) | ui8Pins) :
+                                    (HWREG(ui32Port + GPIO_O_IBE) &
+                                     ~ui8Pins));
+    HWREG(ui32Port + GPIO_O_IS) = ((ui32IntType & 2) ?
+                                   (HWREG(ui32Port + GPIO_O_IS) | ui8Pins) :
+                                   (HWREG(ui32Port + GPIO_O_IS) & ~ui8Pins));
+    HWREG(ui32Port + GPIO_O_IEV) = ((ui32IntType & 4) ?
+                                    (HWREG(ui32Port + GPIO_O_IEV) | ui8Pins) :
+                                    (HWREG(ui32Port + GPIO_O_IEV) &
+                                     ~ui8Pins));
+}
+
+void
+GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+}
+
+void
+GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    HWREG(ui32Port + GPIO_O_DIR) |= ui8Pins;
+    HWREG(ui32Port + GPIO_O_AFSEL) &= ~ui8Pins;
+    HWREG(ui32Port + GPIO_O_DEN) |= ui8Pins;
+}
+
+void
+GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    HWREG(ui32Port + GPIO_O_AFSEL) |= ui8Pins;
+    HWREG(ui32Port + GPIO_O_DEN) |= ui8Pins;
+}
+
+void
+GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val)
+{
+    HWREG(ui32Port + GPIO_O_DATA + (ui8Pins << 2)) = ui8Val;
+}
+
+//*****************************************************************************
+//
+// The ADC functions.  Conversions are not simulated; the host program puts
+// each reading in the sample sequence FIFO register before raising the
+// interrupt.
+//
+//*****************************************************************************
+void
+ADCIntEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+}
+
+void
+ADCSequenceEnable(uint32_t ui32Base, uint32_t ui32SequenceNum)
+{
+}
+
+void
+ADCSequenceConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                     uint32_t ui32Trigger, uint32_t ui32Priority)
+{
+}
+
+void
+ADCSequenceStepConfigure(uint32_t ui32Base, uint32_t ui32SequenceNum,
+                         uint32_t ui32Step, uint32_t ui32Config)
+{
+}
+
+void
+ADCHardwareOversampleConfigure(uint32_t ui32Base, uint32_t ui32Factor)
+{
+}
+
+//*****************************************************************************
+//
+// The timer functions.  The load value is kept in the interval load
+// register, where the host program reads it to space the samples it feeds.
+//
+//*****************************************************************************
+void
+TimerConfigure(uint32_t ui32Base, uint32_t ui32Config)
+{
+    HWREG(ui32Base + TIMER_O_CTL) = 0;
+    HWREG(ui32Base + TIMER_O_CFG) = ui32Config >> 24;
+    HWREG(ui32Base + TIMER_O_TAMR) = ui32Config & 0xff;
+}
+
+void
+TimerControlTrigger(uint32_t ui32Base, uint32_t ui32Timer, bool bEnable)
+{
+}
+
+void
+TimerDisable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    HWREG(ui32Base + TIMER_O_CTL) &= ~(ui32Timer & TIMER_CTL_TAEN);
+}
+
+void
+TimerEnable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    HWREG(ui32Base + TIMER_O_CTL) |= ui32Timer & TIMER_CTL_TAEN;
+}
+
+void
+TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    HWREG(ui32Base + TIMER_O_TAILR) = ui32Value;
+}
+
+//*****************************************************************************
+//
+// The UART functions, for UART0 only.  Everything sent goes to the standard
+// output, at the rate set by UARTConfigSetExpClk().
+//
+//*****************************************************************************
+bool
+UARTSpaceAvail(uint32_t ui32Base)
+{
+    return(g_ulHWSimUARTCount < HWSIM_UART_FIFO);
+}
+
+bool
+UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData)
+{
+    if(g_ulHWSimUARTCount == HWSIM_UART_FIFO)
+    {
+        return(false);
+    }
+
+    if(!g_ulHWSimUARTCount)
+    {
+        g_ulHWSimUARTNext = (HWREG(HWSIM_DWT_CYCCNT) +
+                             g_ulHWSimUARTCharCycles);
+    }
+    g_pucHWSimUARTFIFO[(g_ulHWSimUARTRead + g_ulHWSimUARTCount) %
+                       HWSIM_UART_FIFO] = ucData;
+    g_ulHWSimUARTCount++;
+
+    return(true);
+}
+
+void
+UARTCharPut(uint32_t ui32Base, unsigned char ucData)
+{
+    while(!UARTCharPutNonBlocking(ui32Base, ucData))
+    {
+        HWSimCyclesAdd(g_ulHWSimUARTNext - HWREG(HWSIM_DWT_CYCCNT));
+    }
+}
+
+void
+UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk,
+                    uint32_t ui32Baud, uint32_t ui32Config)
+{
+    //
+    // A start bit, eight data bits and a stop bit.
+    //
+    g_ulHWSimUARTCharCycles = (ui32UARTClk * 10) / ui32Baud;
+}
+
+void
+UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel,
+                 uint32_t ui32RxLevel)
+{
+    static const uint8_t pui8Levels[] = { 2, 4, 8, 12, 14 };
+
+    g_ulHWSimUARTLevel = pui8Levels[ui32TxLevel % 5];
+}
+
+void
+UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    HWREG(ui32Base + UART_O_IM) |= ui32IntFlags;
+    if(HWREG(ui32Base + UART_O_RIS) & ui32IntFlags)
+    {
+        HWSimIntRaise(INT_UART0);
+        HWSimIntsTake();
+    }
+}
+
+void
+UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    HWREG(ui32Base + UART_O_IM) &= ~ui32IntFlags;
+}
+
+uint32_t
+UARTIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    return(HWREG(ui32Base + UART_O_RIS) &
+           (bMasked ? HWREG(ui32Base + UART_O_IM) : 0xffffffff));
+}
+
+void
+UARTIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    HWREG(ui32Base + UART_O_RIS) &= ~ui32IntFlags;
+}
+
+//*****************************************************************************
+//
+// The uDMA functions.  There is no uDMA controller, so these do nothing.
+//
+//*****************************************************************************
+void
+uDMAEnable(void)
+{
+}
+
+void
+uDMAControlBaseSet(void *pControlTable)
+{
+}
+
+//*****************************************************************************
+//
+// The flash functions, acting on the mapped part of the flash.
+//
+//*****************************************************************************
+int32_t
+FlashErase(uint32_t ui32Address)
+{
+    if(!g_bHWSimFlash || (ui32Address & (HWSIM_FLASH_PAGE - 1)) ||
+       (ui32Address < HWSIM_FLASH_BASE) ||
+       (ui32Address >= (HWSIM_FLASH_BASE + HWSIM_FLASH_SIZE)))
+    {
+        return(-1);
+    }
+
+    memset((void *)(uintptr_t)ui32Address, 0xff, HWSIM_FLASH_PAGE);
+
+    return(0);
+}
+
+int32_t
+FlashProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    uint32_t *pulFlash, ulIdx;
+
+    if(!g_bHWSimFlash || (ui32Address & 3) || (ui32Count & 3) ||
+       (ui32Address < HWSIM_FLASH_BASE) ||
+       ((ui32Address + ui32Count) > (HWSIM_FLASH_BASE + HWSIM_FLASH_SIZE)))
+    {
+        return(-1);
+    }
+
+    //
+    // Programming can only clear bits.
+    //
+    pulFlash = (uint32_t *)(uintptr_t)ui32Address;
+    for(ulIdx = 0; ulIdx < (ui32Count / 4); ulIdx++)
+    {
+        pulFlash[ulIdx] &= pui32Data[ulIdx];
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// The software CRC functions.  These are the bitwise forms of the TivaWare
+// table driven ones: CRC-16 with the reflected 0x8005 polynomial and CRC-32
+// with the reflected 0x04C11DB7 polynomial, neither with a final inversion.
+//
+//*****************************************************************************
+uint16_t
+Crc16(uint16_t ui16Crc, const uint8_t *pui8Data, uint32_t ui32Count)
+{
+    uint32_t ulBit;
+
+    while(ui32Count--)
+    {
+        ui16Crc ^= *pui8Data++;
+        for(ulBit = 0; ulBit < 8; ulBit++)
+        {
+            ui16Crc = (ui16Crc & 1) ? ((ui16Crc >> 1) ^ 0xA001) :
+                      (ui16Crc >> 1);
+        }
+    }
+
+    return(ui16Crc);
+}
+
+uint32_t
+Crc32(uint32_t ui32Crc, const uint8_t *pui8Data, uint32_t ui32Count)
+{
+    uint32_t ulBit;
+
+    while(ui32Count--)
+    {
+        ui32Crc ^= *pui8Data++;
+        for(ulBit = 0; ulBit < 8; ulBit++)
+        {
+            ui32Crc = (ui32Crc & 1) ? ((ui32Crc >> 1) ^ 0xEDB88320) :
+                      (ui32Crc >> 1);
+        }
+    }
+
+    return(ui32Crc);
+}
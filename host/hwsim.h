@@ -0,0 +1,38 @@
+//*****************************************************************************
+//
+// hwsim.h - Prototypes for the simulated hardware of the host build.
+//
+//*****************************************************************************
+
+#ifndef __HWSIM_H__
+#define __HWSIM_H__
+
+//*****************************************************************************
+//
+// The address of the data watchpoint and trace unit's cycle counter.  The
+// drivers time stamp their samples from it, so the host sets it to the time
+// line being simulated.
+//
+//*****************************************************************************
+#define HWSIM_DWT_CYCCNT        0xE0001004
+
+//*****************************************************************************
+//
+// The cycles charged for taking an interrupt and running a short handler,
+// on top of anything the handler charges itself.
+//
+//*****************************************************************************
+#define HWSIM_INT_CYCLES        100
+
+//*****************************************************************************
+//
+// Prototypes for the functions exported by the simulated hardware.
+//
+//*****************************************************************************
+extern void HWSimClockSet(uint32_t ulClock);
+extern void HWSimCyclesAdd(uint32_t ulCycles);
+extern bool HWSimFlashMap(void);
+extern void HWSimHandlerSet(uint32_t ulInterrupt, void (*pfnHandler)(void));
+extern bool HWSimIntsOff(void);
+
+#endif // __HWSIM_H__
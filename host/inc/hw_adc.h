@@ -0,0 +1,29 @@
+//*****************************************************************************
+//
+// hw_adc.h - ADC register offsets and fields used by the host build.
+//
+//*****************************************************************************
+
+#ifndef __HW_ADC_H__
+#define __HW_ADC_H__
+
+#define ADC_O_ACTSS             0x00000000
+#define ADC_O_RIS               0x00000004
+#define ADC_O_IM                0x00000008
+#define ADC_O_ISC               0x0000000C
+#define ADC_O_PSSI              0x00000028
+#define ADC_O_SSMUX0            0x00000040
+#define ADC_O_SSFIFO0           0x00000048
+#define ADC_O_SSMUX1            0x00000060
+#define ADC_O_SSFIFO1           0x00000068
+#define ADC_O_SSMUX2            0x00000080
+#define ADC_O_SSFIFO2           0x00000088
+#define ADC_O_SSMUX3            0x000000A0
+#define ADC_O_SSFIFO3           0x000000A8
+
+#define ADC_PSSI_SS3            0x00000008
+#define ADC_PSSI_SS2            0x00000004
+#define ADC_PSSI_SS1            0x00000002
+#define ADC_PSSI_SS0            0x00000001
+
+#endif // __HW_ADC_H__
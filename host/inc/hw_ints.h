@@ -0,0 +1,18 @@
+//*****************************************************************************
+//
+// hw_ints.h - Interrupt assignments of the TM4C123 used by the host build.
+//
+//*****************************************************************************
+
+#ifndef __HW_INTS_H__
+#define __HW_INTS_H__
+
+#define FAULT_SYSTICK           15
+#define INT_GPIOD               19
+#define INT_UART0               21
+#define INT_ADC0SS3             33
+#define INT_TIMER1A             37
+#define INT_SSI2                73
+#define NUM_INTERRUPTS          155
+
+#endif // __HW_INTS_H__
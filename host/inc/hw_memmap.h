@@ -0,0 +1,23 @@
+//*****************************************************************************
+//
+// hw_memmap.h - Base addresses of the TM4C123 peripherals used by the host
+//               build.
+//
+//*****************************************************************************
+
+#ifndef __HW_MEMMAP_H__
+#define __HW_MEMMAP_H__
+
+#define GPIO_PORTA_BASE         0x40004000
+#define GPIO_PORTB_BASE         0x40005000
+#define GPIO_PORTC_BASE         0x40006000
+#define GPIO_PORTD_BASE         0x40007000
+#define UART0_BASE              0x4000C000
+#define GPIO_PORTE_BASE         0x40024000
+#define GPIO_PORTF_BASE         0x40025000
+#define TIMER0_BASE             0x40030000
+#define TIMER1_BASE             0x40031000
+#define ADC0_BASE               0x40038000
+#define UDMA_BASE               0x400FF000
+
+#endif // __HW_MEMMAP_H__
@@ -0,0 +1,11 @@
+//*****************************************************************************
+//
+// hw_sysctl.h - The system control registers are not simulated by the host
+//               build.
+//
+//*****************************************************************************
+
+#ifndef __HW_SYSCTL_H__
+#define __HW_SYSCTL_H__
+
+#endif // __HW_SYSCTL_H__
@@ -0,0 +1,17 @@
+//*****************************************************************************
+//
+// hw_timer.h - Timer register offsets and fields used by the host build.
+//
+//*****************************************************************************
+
+#ifndef __HW_TIMER_H__
+#define __HW_TIMER_H__
+
+#define TIMER_O_CFG             0x00000000
+#define TIMER_O_TAMR            0x00000004
+#define TIMER_O_CTL             0x0000000C
+#define TIMER_O_TAILR           0x00000028
+
+#define TIMER_CTL_TAEN          0x00000001
+
+#endif // __HW_TIMER_H__
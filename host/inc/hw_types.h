@@ -0,0 +1,31 @@
+//*****************************************************************************
+//
+// hw_types.h - Common types and macros for the host build.  Register accesses
+//              go to the simulated register file in hwsim.c instead of the
+//              bus, so that the target sources run unchanged on the host.
+//
+//*****************************************************************************
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//*****************************************************************************
+//
+// Returns the storage that simulates the register at ulAddr.
+//
+//*****************************************************************************
+extern volatile uint32_t *HWSimRegister(uint32_t ulAddr);
+
+//*****************************************************************************
+//
+// Macros for hardware access, both direct and via the bit-band region.  Only
+// whole word accesses are simulated.
+//
+//*****************************************************************************
+#define HWREG(x)                (*HWSimRegister((uint32_t)(x)))
+#define HWREGBITW(x, b)         HWREG(x)
+
+#endif // __HW_TYPES_H__
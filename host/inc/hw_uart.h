@@ -0,0 +1,14 @@
+//*****************************************************************************
+//
+// hw_uart.h - The UART registers simulated by the host build.
+//
+//*****************************************************************************
+
+#ifndef __HW_UART_H__
+#define __HW_UART_H__
+
+#define UART_O_IM               0x00000038
+#define UART_O_RIS              0x0000003C
+#define UART_O_MIS              0x00000040
+
+#endif // __HW_UART_H__
@@ -0,0 +1,15 @@
+//*****************************************************************************
+//
+// hw_udma.h - uDMA register addresses and fields used by the host build.
+//
+//*****************************************************************************
+
+#ifndef __HW_UDMA_H__
+#define __HW_UDMA_H__
+
+#define UDMA_STAT               0x400FF000
+#define UDMA_CTLBASE            0x400FF008
+
+#define UDMA_STAT_MASTEN        0x00000001
+
+#endif // __HW_UDMA_H__
@@ -0,0 +1,185 @@
+//*****************************************************************************
+//
+// scribblebench.c - Runs the scribble benchmark on the host.
+//
+// scribble.c is built into this program with SCRIBBLE_BENCH defined and its
+// main() renamed, and is set up here as its main() sets it up, on the
+// simulated display of dpysim.c.  The benchmark is started as on the
+// target, by a tap on the middle of the banner put into the touch screen
+// event queue, and the main loop is then run until it has been through all
+// its rates.  The SysTick handler feeds the points in through
+// TouchScreenEventInject(), interrupting the main loop as the display and
+// UART let the simulated time pass, and the main loop passes them through
+// TSMainHandler() to BrushSegment() and the stroke stream.
+//
+// The stroke stream, with a STREAM_BENCH frame for each rate, is written to
+// the standard output for strokedec, and the lines scribble.c shows on the
+// screen are written to the standard error.
+//
+// Only the time taken to send to the display, to take interrupts and to go
+// round the main loop is simulated; the processor's own work in the event
+// handler is not.  The rates kept up with are therefore those the display
+// allows, and are higher than the target's.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "dpysim.h"
+#include "hwsim.h"
+
+//*****************************************************************************
+//
+// The application, built as a part of this program.
+//
+//*****************************************************************************
+#define main ScribbleMain
+#include "../scribble.c"
+#undef main
+
+//*****************************************************************************
+//
+// The cycles charged for each pass of the main loop, and the pressure of the
+// tap that starts the benchmark.
+//
+//*****************************************************************************
+#define BENCH_LOOP_CYCLES       200
+#define BENCH_TAP_PRESSURE      2048
+
+//*****************************************************************************
+//
+// Prints the usage of the program.
+//
+//*****************************************************************************
+static void
+Usage(void)
+{
+    fprintf(stderr,
+            "usage: scribblebench [options]\n"
+            "  -c mhz      processor clock (default 80)\n"
+            "  -l cycles   cycles per pass of the main loop (default %d)\n"
+            "  -i file     write the screen to a PPM image at the end\n"
+            "The stroke stream is written to the standard output.\n",
+            BENCH_LOOP_CYCLES);
+    exit(2);
+}
+
+//*****************************************************************************
+//
+// Sets up the application as its main() does, runs the benchmark, and
+// prints how the simulated time was spent.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    tRectangle sRect;
+    uint32_t ulMHz, ulLoop, ulStart, ulCycles;
+    const char *pcImage;
+    int iOpt;
+
+    ulMHz = 80;
+    ulLoop = BENCH_LOOP_CYCLES;
+    pcImage = 0;
+
+    while((iOpt = getopt(argc, argv, "c:l:i:")) != -1)
+    {
+        switch(iOpt)
+        {
+            case 'c': ulMHz = strtoul(optarg, 0, 0); break;
+            case 'l': ulLoop = strtoul(optarg, 0, 0); break;
+            case 'i': pcImage = optarg; break;
+            default: Usage();
+        }
+    }
+    if((optind != argc) || !ulMHz)
+    {
+        Usage();
+    }
+
+    if(!HWSimFlashMap())
+    {
+        fprintf(stderr, "scribblebench: cannot map the simulated flash\n");
+        return(1);
+    }
+    HWSimClockSet(ulMHz * 1000000);
+    HWSimHandlerSet(FAULT_SYSTICK, SysTickIntHandler);
+    HWSimHandlerSet(INT_UART0, UARTIntHandler);
+
+    //
+    // Set up the display, the scribble area, the stroke stream and the touch
+    // screen event queue as main() in scribble.c does.  The banner and the
+    // instructions are left out, since only the scribble area is drawn on
+    // by the benchmark.
+    //
+    Kentec320x240x16_SSD2119Init();
+    GrContextInit(&g_sContext, &g_sKentec320x240x16_SSD2119);
+    sRect.i16XMin = 1;
+    sRect.i16YMin = 45;
+    sRect.i16XMax = GrContextDpyWidthGet(&g_sContext) - 2;
+    sRect.i16YMax = GrContextDpyHeightGet(&g_sContext) - 2;
+    g_sScribbleArea = sRect;
+    GrContextClipRegionSet(&g_sContext, &g_sScribbleArea);
+    g_ulColorIdx = 0;
+    g_ulCyclesPerUs = SysCtlClockGet() / 1000000;
+
+    UARTConfigSetExpClk(UART0_BASE, SysCtlClockGet(), 115200,
+                        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                         UART_CONFIG_PAR_NONE));
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX1_8, UART_FIFO_RX4_8);
+    IntEnable(INT_UART0);
+
+    TouchScreenInit();
+    TouchScreenEventQueueEnable(true);
+
+    //
+    // Tap the middle of the banner, and run the main loop until the
+    // benchmark has finished.
+    //
+    TouchScreenEventInject(WIDGET_MSG_PTR_DOWN,
+                           GrContextDpyWidthGet(&g_sContext) / 2,
+                           BANNER_HEIGHT / 2, BENCH_TAP_PRESSURE);
+    TouchScreenEventInject(WIDGET_MSG_PTR_UP,
+                           GrContextDpyWidthGet(&g_sContext) / 2,
+                           BANNER_HEIGHT / 2, BENCH_TAP_PRESSURE);
+    ulStart = HWREG(DWT_CYCCNT);
+    do
+    {
+        ProcessTouchMessages();
+        StreamService();
+        BenchService();
+        HWSimCyclesAdd(ulLoop);
+    }
+    while(g_bBenchRunning);
+    ulCycles = HWREG(DWT_CYCCNT) - ulStart;
+
+    //
+    // Let the stream drain, a tenth of a second at a time.
+    //
+    while(g_ulStreamRead != g_ulStreamWrite)
+    {
+        HWSimCyclesAdd(SysCtlClockGet() / 10);
+    }
+    HWSimCyclesAdd(SysCtlClockGet() / 10);
+    fflush(stdout);
+
+    fprintf(stderr, "simulated        %u ms, %u ms sending to the display\n",
+            ulCycles / (ulMHz * 1000), DpySimCycles() / (ulMHz * 1000));
+    fprintf(stderr, "stream           %lu frames, %lu bytes, %lu dropped, "
+            "ring high water %lu\n", g_ulStreamFrames, g_ulStreamBytes,
+            g_ulStreamDropped, g_ulStreamHighWater);
+
+    if(pcImage && !DpySimWrite(pcImage))
+    {
+        perror(pcImage);
+        return(1);
+    }
+
+    return(0);
+}
@@ -0,0 +1,754 @@
+//*****************************************************************************
+//
+// strokedec.c - Decodes the stroke stream sent by the scribble application.
+//
+// The stream is the UART0 output of scribble, as described above
+// StreamFrame() in scribble.c: frames of
+//
+//     0xA5, type, sequence, length, payload, CRC-16 low byte, high byte
+//
+// with LEB128 varint payloads.  A frame with a bad CRC is skipped by looking
+// for the next 0xA5 after its sync byte, and a jump in the sequence number
+// is counted as lost frames.  The strokes are drawn into an SVG file, and the
+// rate and cost of the stream are reported once the input ends:
+//
+//     stty -F /dev/ttyACM0 115200 raw
+//     strokedec -o strokes.svg < /dev/ttyACM0
+//
+// An interrupt also ends the input, so a live port can be stopped with
+// Ctrl-C.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "driverlib/sw_crc.h"
+
+//*****************************************************************************
+//
+// The frame types and layout.  These match scribble.c.
+//
+//*****************************************************************************
+#define STREAM_SYNC             0xA5
+#define STREAM_START            1
+#define STREAM_POINTS           2
+#define STREAM_RADIUS           3
+#define STREAM_END              4
+#define STREAM_UNDO             5
+#define STREAM_CLEAR            6
+#define STREAM_BENCH            7
+#define STREAM_OVERHEAD         6
+#define STREAM_FRAME_MAX        (STREAM_OVERHEAD + 255)
+
+//*****************************************************************************
+//
+// The scribble area and the colors of the color index, as 24-bit RGB.
+//
+//*****************************************************************************
+#define DEC_WIDTH               320
+#define DEC_HEIGHT              240
+
+static const uint32_t g_pulColors[] =
+{
+    0xFFFFFF, 0xFFFF00, 0xFF00FF, 0xFF0000, 0x00FFFF, 0x00FF00, 0x0000FF
+};
+
+//*****************************************************************************
+//
+// The decoded strokes.  Each point carries the brush radius it was drawn
+// with.  A stroke is marked damaged if frames were lost while it was being
+// sent, since its later points are then offset.
+//
+//*****************************************************************************
+typedef struct
+{
+    int32_t lX;
+    int32_t lY;
+    uint32_t ulRadius;
+}
+tDecPoint;
+
+typedef struct
+{
+    uint32_t ulColor;
+    tDecPoint *psPoints;
+    uint32_t ulCount;
+    uint32_t ulSize;
+    bool bOpen;
+    bool bDamaged;
+}
+tDecStroke;
+
+static tDecStroke *g_psStrokes;
+static uint32_t g_ulStrokes;
+static uint32_t g_ulStrokeSize;
+static uint32_t g_ulRadius;
+
+//*****************************************************************************
+//
+// The statistics of the stream.  The stroke bytes are those of the frames
+// that carry strokes, START to END inclusive of framing, and the stroke
+// time is the sum of the stroke lengths reported by the END frames.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ulBytes;
+    uint32_t ulFrames;
+    uint32_t ulBadCRC;
+    uint32_t ulSkipped;
+    uint32_t ulLost;
+    uint32_t ulStrokes;
+    uint32_t ulPoints;
+    uint32_t ulEndPoints;
+    uint32_t ulMismatch;
+    uint32_t ulStrokeBytes;
+    uint64_t ullStrokeMs;
+    uint32_t ulBestRate;
+    uint32_t ulDropped;
+    bool bSeqValid;
+    uint8_t ucSeq;
+}
+tDecStats;
+
+static tDecStats g_sStats;
+static bool g_bVerbose;
+static volatile bool g_bStop;
+
+//*****************************************************************************
+//
+// Prints the usage of the program.
+//
+//*****************************************************************************
+static void
+Usage(void)
+{
+    fprintf(stderr,
+            "usage: strokedec [-o strokes.svg] [-v] [capture]\n"
+            "  -o file     write the strokes left on the screen as SVG\n"
+            "  -v          list each frame\n"
+            "Without a capture file the stream is read from the standard "
+            "input.\n");
+    exit(2);
+}
+
+//*****************************************************************************
+//
+// Ends the input on an interrupt.
+//
+//*****************************************************************************
+static void
+StopHandler(int iSignal)
+{
+    g_bStop = true;
+}
+
+//*****************************************************************************
+//
+// Reads an unsigned LEB128 varint from a payload, returning false if it runs
+// past the end.
+//
+//*****************************************************************************
+static bool
+VarintRead(const uint8_t **ppucData, const uint8_t *pucEnd, uint32_t *pulValue)
+{
+    uint32_t ulValue, ulShift;
+    uint8_t ucByte;
+
+    ulValue = 0;
+    for(ulShift = 0; ulShift < 35; ulShift += 7)
+    {
+        if(*ppucData == pucEnd)
+        {
+            return(false);
+        }
+        ucByte = *(*ppucData)++;
+        ulValue |= (uint32_t)(ucByte & 0x7f) << ulShift;
+        if(!(ucByte & 0x80))
+        {
+            *pulValue = ulValue;
+            return(true);
+        }
+    }
+
+    return(false);
+}
+
+//*****************************************************************************
+//
+// Reads a zigzag encoded signed varint.
+//
+//*****************************************************************************
+static bool
+ZigzagRead(const uint8_t **ppucData, const uint8_t *pucEnd, int32_t *plValue)
+{
+    uint32_t ulValue;
+
+    if(!VarintRead(ppucData, pucEnd, &ulValue))
+    {
+        return(false);
+    }
+    *plValue = (ulValue & 1) ? -(int32_t)((ulValue + 1) / 2) :
+               (int32_t)(ulValue / 2);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Returns the stroke being sent, or NULL if there is none.
+//
+//*****************************************************************************
+static tDecStroke *
+StrokeOpen(void)
+{
+    if(g_ulStrokes && g_psStrokes[g_ulStrokes - 1].bOpen)
+    {
+        return(&g_psStrokes[g_ulStrokes - 1]);
+    }
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Adds a point to a stroke.
+//
+//*****************************************************************************
+static void
+StrokePoint(tDecStroke *psStroke, int32_t lX, int32_t lY)
+{
+    if(psStroke->ulCount == psStroke->ulSize)
+    {
+        psStroke->ulSize = psStroke->ulSize ? (psStroke->ulSize * 2) : 64;
+        psStroke->psPoints = realloc(psStroke->psPoints,
+                                     psStroke->ulSize * sizeof(tDecPoint));
+        if(!psStroke->psPoints)
+        {
+            perror("strokedec");
+            exit(1);
+        }
+    }
+    psStroke->psPoints[psStroke->ulCount].lX = lX;
+    psStroke->psPoints[psStroke->ulCount].lY = lY;
+    psStroke->psPoints[psStroke->ulCount].ulRadius = g_ulRadius;
+    psStroke->ulCount++;
+    g_sStats.ulPoints++;
+}
+
+//*****************************************************************************
+//
+// Removes strokes from the end of the list, freeing their points.
+//
+//*****************************************************************************
+static void
+StrokesTrim(uint32_t ulCount)
+{
+    while(g_ulStrokes > ulCount)
+    {
+        g_ulStrokes--;
+        free(g_psStrokes[g_ulStrokes].psPoints);
+    }
+}
+
+//*****************************************************************************
+//
+// Prints the results of a benchmark run, in the order BenchReport() in
+// scribble.c sends them.
+//
+//*****************************************************************************
+static void
+BenchPrint(const uint8_t *pucData, const uint8_t *pucEnd)
+{
+    static const char *ppcNames[] =
+    {
+        "rate", "fed", "handled", "handled/s", "queue", "merged", "dropped",
+        "segments", "us/seg", "max us/seg", "us/msg"
+    };
+    uint32_t ulIdx, ulValue;
+
+    printf("bench");
+    for(ulIdx = 0; ulIdx < (sizeof(ppcNames) / sizeof(ppcNames[0]));
+        ulIdx++)
+    {
+        if(!VarintRead(&pucData, pucEnd, &ulValue))
+        {
+            break;
+        }
+        if(ulIdx >= 8)
+        {
+            printf(" %s %u.%u", ppcNames[ulIdx], ulValue / 10, ulValue % 10);
+        }
+        else
+        {
+            printf(" %s %u", ppcNames[ulIdx], ulValue);
+        }
+    }
+    printf("\n");
+}
+
+//*****************************************************************************
+//
+// Handles a frame that has passed its CRC check.
+//
+//*****************************************************************************
+static void
+FrameDecode(uint32_t ulType, const uint8_t *pucData, uint32_t ulLength)
+{
+    const uint8_t *pucEnd;
+    tDecStroke *psStroke;
+    uint32_t ulColor, ulCount, ulMs;
+    int32_t lX, lY;
+    bool bOK;
+
+    pucEnd = pucData + ulLength;
+    psStroke = StrokeOpen();
+    bOK = true;
+
+    if((ulType >= STREAM_START) && (ulType <= STREAM_END))
+    {
+        g_sStats.ulStrokeBytes += ulLength + STREAM_OVERHEAD;
+    }
+
+    switch(ulType)
+    {
+        case STREAM_START:
+        {
+            if(psStroke)
+            {
+                psStroke->bOpen = false;
+                psStroke->bDamaged = true;
+            }
+            bOK = (VarintRead(&pucData, pucEnd, &ulColor) &&
+                   VarintRead(&pucData, pucEnd, &g_ulRadius) &&
+                   ZigzagRead(&pucData, pucEnd, &lX) &&
+                   ZigzagRead(&pucData, pucEnd, &lY));
+            if(!bOK)
+            {
+                break;
+            }
+            if(g_ulStrokes == g_ulStrokeSize)
+            {
+                g_ulStrokeSize = g_ulStrokeSize ? (g_ulStrokeSize * 2) : 64;
+                g_psStrokes = realloc(g_psStrokes,
+                                      g_ulStrokeSize * sizeof(tDecStroke));
+                if(!g_psStrokes)
+                {
+                    perror("strokedec");
+                    exit(1);
+                }
+            }
+            psStroke = &g_psStrokes[g_ulStrokes++];
+            memset(psStroke, 0, sizeof(tDecStroke));
+            psStroke->ulColor = ulColor;
+            psStroke->bOpen = true;
+            StrokePoint(psStroke, lX, lY);
+            g_sStats.ulStrokes++;
+            if(g_bVerbose)
+            {
+                printf("start color %u radius %u at %d,%d\n", ulColor,
+                       g_ulRadius, lX, lY);
+            }
+            break;
+        }
+
+        case STREAM_POINTS:
+        {
+            if(!psStroke)
+            {
+                break;
+            }
+            ulCount = 0;
+            while(pucData != pucEnd)
+            {
+                bOK = (ZigzagRead(&pucData, pucEnd, &lX) &&
+                       ZigzagRead(&pucData, pucEnd, &lY));
+                if(!bOK)
+                {
+                    break;
+                }
+                StrokePoint(psStroke,
+                            psStroke->psPoints[psStroke->ulCount - 1].lX + lX,
+                            psStroke->psPoints[psStroke->ulCount - 1].lY + lY);
+                ulCount++;
+            }
+            if(g_bVerbose)
+            {
+                printf("points %u\n", ulCount);
+            }
+            break;
+        }
+
+        case STREAM_RADIUS:
+        {
+            bOK = VarintRead(&pucData, pucEnd, &g_ulRadius);
+            if(bOK && g_bVerbose)
+            {
+                printf("radius %u\n", g_ulRadius);
+            }
+            break;
+        }
+
+        case STREAM_END:
+        {
+            bOK = (VarintRead(&pucData, pucEnd, &ulCount) &&
+                   VarintRead(&pucData, pucEnd, &ulMs) &&
+                   VarintRead(&pucData, pucEnd, &g_sStats.ulDropped));
+            if(!bOK || !psStroke)
+            {
+                break;
+            }
+            psStroke->bOpen = false;
+            g_sStats.ulEndPoints += ulCount;
+            g_sStats.ullStrokeMs += ulMs;
+            if(ulCount != psStroke->ulCount)
+            {
+                psStroke->bDamaged = true;
+                g_sStats.ulMismatch++;
+            }
+            if(ulMs && (((ulCount * 1000) / ulMs) > g_sStats.ulBestRate))
+            {
+                g_sStats.ulBestRate = (ulCount * 1000) / ulMs;
+            }
+            if(g_bVerbose)
+            {
+                printf("end %u points in %u ms, %u frames dropped%s\n",
+                       ulCount, ulMs, g_sStats.ulDropped,
+                       psStroke->bDamaged ? " (damaged)" : "");
+            }
+            break;
+        }
+
+        case STREAM_UNDO:
+        {
+            if(psStroke)
+            {
+                psStroke->bOpen = false;
+            }
+            if(g_ulStrokes)
+            {
+                StrokesTrim(g_ulStrokes - 1);
+            }
+            if(g_bVerbose)
+            {
+                printf("undo\n");
+            }
+            break;
+        }
+
+        case STREAM_CLEAR:
+        {
+            StrokesTrim(0);
+            if(g_bVerbose)
+            {
+                printf("clear\n");
+            }
+            break;
+        }
+
+        case STREAM_BENCH:
+        {
+            BenchPrint(pucData, pucEnd);
+            break;
+        }
+
+        default:
+        {
+            bOK = false;
+            break;
+        }
+    }
+
+    if(!bOK)
+    {
+        fprintf(stderr, "strokedec: malformed frame of type %u\n", ulType);
+    }
+}
+
+//*****************************************************************************
+//
+// Checks the frame at the start of a buffer.  Returns the size of the frame
+// if it is whole and its CRC matches, 0 if more bytes are needed, or -1 if
+// it is not a frame.
+//
+//*****************************************************************************
+static int32_t
+FrameCheck(const uint8_t *pucBuffer, uint32_t ulCount)
+{
+    uint32_t ulSize;
+    uint16_t usCRC;
+
+    if(ulCount < 4)
+    {
+        return(0);
+    }
+    ulSize = pucBuffer[3] + STREAM_OVERHEAD;
+    if(ulCount < ulSize)
+    {
+        return(0);
+    }
+
+    usCRC = Crc16(0, pucBuffer + 1, ulSize - 3);
+    if((pucBuffer[ulSize - 2] != (usCRC & 0xff)) ||
+       (pucBuffer[ulSize - 1] != (usCRC >> 8)))
+    {
+        return(-1);
+    }
+
+    return(ulSize);
+}
+
+//*****************************************************************************
+//
+// Takes the frames out of the buffered input, and returns the number of
+// bytes used.  Bytes before a sync byte are skipped, and a sync byte that
+// does not start a good frame is skipped too, so that the search resumes
+// from the byte after it.
+//
+//*****************************************************************************
+static uint32_t
+FramesTake(const uint8_t *pucBuffer, uint32_t ulCount, bool bFinal)
+{
+    uint32_t ulPos;
+    int32_t lSize;
+    uint8_t ucSeq;
+
+    ulPos = 0;
+    while(ulPos < ulCount)
+    {
+        if(pucBuffer[ulPos] != STREAM_SYNC)
+        {
+            g_sStats.ulSkipped++;
+            ulPos++;
+            continue;
+        }
+
+        lSize = FrameCheck(pucBuffer + ulPos, ulCount - ulPos);
+        if(!lSize && !bFinal)
+        {
+            break;
+        }
+        if(lSize <= 0)
+        {
+            g_sStats.ulBadCRC++;
+            g_sStats.ulSkipped++;
+            ulPos++;
+            continue;
+        }
+
+        ucSeq = pucBuffer[ulPos + 2];
+        if(g_sStats.bSeqValid && (ucSeq != (uint8_t)(g_sStats.ucSeq + 1)))
+        {
+            g_sStats.ulLost += (uint8_t)(ucSeq - g_sStats.ucSeq - 1);
+            if(StrokeOpen())
+            {
+                StrokeOpen()->bDamaged = true;
+            }
+        }
+        g_sStats.ucSeq = ucSeq;
+        g_sStats.bSeqValid = true;
+        g_sStats.ulFrames++;
+
+        FrameDecode(pucBuffer[ulPos + 1], pucBuffer + ulPos + 4,
+                    pucBuffer[ulPos + 3]);
+        ulPos += lSize;
+    }
+
+    return(ulPos);
+}
+
+//*****************************************************************************
+//
+// Writes the strokes as SVG, each run of points with the same brush radius
+// as a polyline with round caps and joins, on a black background.
+//
+//*****************************************************************************
+static bool
+SVGWrite(const char *pcName)
+{
+    tDecStroke *psStroke;
+    uint32_t ulStroke, ulIdx, ulRun, ulColor;
+    FILE *pFile;
+
+    pFile = fopen(pcName, "w");
+    if(!pFile)
+    {
+        perror(pcName);
+        return(false);
+    }
+
+    fprintf(pFile,
+            "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" "
+            "height=\"%d\" viewBox=\"0 0 %d %d\">\n"
+            "<rect width=\"100%%\" height=\"100%%\" fill=\"black\"/>\n",
+            DEC_WIDTH, DEC_HEIGHT, DEC_WIDTH, DEC_HEIGHT);
+
+    for(ulStroke = 0; ulStroke < g_ulStrokes; ulStroke++)
+    {
+        psStroke = &g_psStrokes[ulStroke];
+        ulColor = g_pulColors[psStroke->ulColor %
+                              (sizeof(g_pulColors) / sizeof(g_pulColors[0]))];
+        fprintf(pFile, "<g fill=\"none\" stroke=\"#%06x\" "
+                "stroke-linecap=\"round\" stroke-linejoin=\"round\"%s>\n",
+                ulColor, psStroke->bDamaged ? " stroke-dasharray=\"4 2\"" :
+                "");
+
+        for(ulRun = 0; ulRun < psStroke->ulCount; ulRun = ulIdx)
+        {
+            //
+            // A run takes in the first point of the next one, so that the
+            // stroke has no gaps where the radius changes.
+            //
+            fprintf(pFile, "<polyline stroke-width=\"%u\" points=\"",
+                    psStroke->psPoints[ulRun].ulRadius * 2 + 1);
+            for(ulIdx = ulRun; ulIdx < psStroke->ulCount; ulIdx++)
+            {
+                if((ulIdx != ulRun) &&
+                   (psStroke->psPoints[ulIdx].ulRadius !=
+                    psStroke->psPoints[ulRun].ulRadius))
+                {
+                    fprintf(pFile, " %d,%d", psStroke->psPoints[ulIdx].lX,
+                            psStroke->psPoints[ulIdx].lY);
+                    break;
+                }
+                fprintf(pFile, "%s%d,%d", (ulIdx == ulRun) ? "" : " ",
+                        psStroke->psPoints[ulIdx].lX,
+                        psStroke->psPoints[ulIdx].lY);
+            }
+
+            //
+            // A single point needs a second to draw its dot.
+            //
+            if((ulIdx - ulRun) == 1)
+            {
+                fprintf(pFile, " %d,%d", psStroke->psPoints[ulRun].lX,
+                        psStroke->psPoints[ulRun].lY);
+            }
+            fprintf(pFile, "\"/>\n");
+        }
+
+        fprintf(pFile, "</g>\n");
+    }
+
+    fprintf(pFile, "</svg>\n");
+    fclose(pFile);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Decodes the stream and prints its statistics.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    static uint8_t pucBuffer[4096];
+    struct sigaction sAction;
+    const char *pcSVG;
+    uint32_t ulCount, ulUsed;
+    ssize_t lRead;
+    int iOpt, iFile;
+
+    pcSVG = 0;
+    while((iOpt = getopt(argc, argv, "o:v")) != -1)
+    {
+        switch(iOpt)
+        {
+            case 'o': pcSVG = optarg; break;
+            case 'v': g_bVerbose = true; break;
+            default: Usage();
+        }
+    }
+    if(optind < (argc - 1))
+    {
+        Usage();
+    }
+
+    iFile = 0;
+    if(optind == (argc - 1))
+    {
+        iFile = open(argv[optind], O_RDONLY);
+        if(iFile < 0)
+        {
+            perror(argv[optind]);
+            return(1);
+        }
+    }
+
+    //
+    // Let an interrupt end a blocking read rather than the program.
+    //
+    memset(&sAction, 0, sizeof(sAction));
+    sAction.sa_handler = StopHandler;
+    sigaction(SIGINT, &sAction, 0);
+
+    ulCount = 0;
+    while(!g_bStop)
+    {
+        lRead = read(iFile, pucBuffer + ulCount, sizeof(pucBuffer) - ulCount);
+        if(lRead < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            perror("strokedec");
+            return(1);
+        }
+        if(lRead == 0)
+        {
+            break;
+        }
+        g_sStats.ulBytes += lRead;
+        ulCount += lRead;
+
+        ulUsed = FramesTake(pucBuffer, ulCount, false);
+        memmove(pucBuffer, pucBuffer + ulUsed, ulCount - ulUsed);
+        ulCount -= ulUsed;
+        fflush(stdout);
+    }
+    FramesTake(pucBuffer, ulCount, true);
+
+    printf("bytes            %u\n", g_sStats.ulBytes);
+    printf("frames           %u good, %u bad CRC, %u lost, %u bytes "
+           "skipped\n", g_sStats.ulFrames, g_sStats.ulBadCRC,
+           g_sStats.ulLost, g_sStats.ulSkipped);
+    printf("strokes          %u, %u points", g_sStats.ulStrokes,
+           g_sStats.ulPoints);
+    if(g_sStats.ulMismatch)
+    {
+        printf(", %u with points missing", g_sStats.ulMismatch);
+    }
+    printf("\n");
+    printf("dropped frames   %u (reported by the target)\n",
+           g_sStats.ulDropped);
+    if(g_sStats.ullStrokeMs)
+    {
+        printf("points/s         %u sustained while drawing, %u best "
+               "stroke\n",
+               (uint32_t)(((uint64_t)g_sStats.ulEndPoints * 1000) /
+                          g_sStats.ullStrokeMs), g_sStats.ulBestRate);
+    }
+    if(g_sStats.ulPoints)
+    {
+        printf("bytes/point      %u.%02u\n",
+               g_sStats.ulStrokeBytes / g_sStats.ulPoints,
+               ((g_sStats.ulStrokeBytes % g_sStats.ulPoints) * 100) /
+               g_sStats.ulPoints);
+    }
+
+    if(pcSVG && !SVGWrite(pcSVG))
+    {
+        return(1);
+    }
+
+    return(0);
+}
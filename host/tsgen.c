@@ -0,0 +1,158 @@
+//*****************************************************************************
+//
+// tsgen.c - Makes up touch screen traces for tsreplay.
+//
+// The trace is written in the format sent by TouchScreenTraceDump(): a
+// press of the given number of pairs, with released pairs either side of it
+// so that the pen down and up are both reported.  The pen is either held
+// still or drawn along a straight line at a steady speed, and gaussian
+// noise, and optionally spikes of a few hundred counts such as a panel
+// gives as the pen skids, are added to the X and Y readings.  The noise is
+// made from a fixed seed, so the same options always make the same trace.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+//*****************************************************************************
+//
+// The rate at which the driver samples pairs, the number of released pairs
+// either side of the press, the readings at which the press starts, and the
+// pressure readings, which give a firm press.
+//
+//*****************************************************************************
+#define TSGEN_PAIR_RATE         250
+#define TSGEN_RELEASED          8
+#define TSGEN_START_X           1000
+#define TSGEN_START_Y           1200
+#define TSGEN_Z1                1000
+#define TSGEN_Z2                1100
+#define TSGEN_SPIKE             300
+
+//*****************************************************************************
+//
+// The state of the random number generator.
+//
+//*****************************************************************************
+static uint32_t g_ulSeed = 0x2545F491;
+
+//*****************************************************************************
+//
+// Returns a random number from 0 to 1, exclusive of both.
+//
+//*****************************************************************************
+static double
+Random(void)
+{
+    g_ulSeed ^= g_ulSeed << 13;
+    g_ulSeed ^= g_ulSeed >> 17;
+    g_ulSeed ^= g_ulSeed << 5;
+
+    return((g_ulSeed + 0.5) / 4294967296.0);
+}
+
+//*****************************************************************************
+//
+// Returns a reading with noise of the given standard deviation added, and a
+// spike at the given rate in percent.
+//
+//*****************************************************************************
+static int32_t
+Noisy(double dValue, double dNoise, double dSpikes)
+{
+    dValue += (dNoise * sqrt(-2.0 * log(Random())) *
+               cos(2.0 * M_PI * Random()));
+    if((Random() * 100.0) < dSpikes)
+    {
+        dValue += (Random() < 0.5) ? -TSGEN_SPIKE : TSGEN_SPIKE;
+    }
+
+    return((dValue < 0) ? 0 : ((dValue > 4095) ? 4095 : (int32_t)dValue));
+}
+
+//*****************************************************************************
+//
+// Prints the usage of the program.
+//
+//*****************************************************************************
+static void
+Usage(void)
+{
+    fprintf(stderr,
+            "usage: tsgen [options]\n"
+            "  -p pairs    pairs pressed (default 200)\n"
+            "  -s speed    counts per pair moved along X, half that along Y\n"
+            "              (default 0, held still)\n"
+            "  -n noise    standard deviation of the noise in counts "
+            "(default 0)\n"
+            "  -k percent  rate of %d count spikes (default 0)\n"
+            "  -r seed     seed for the noise\n"
+            "  -c mhz      processor clock (default 80)\n",
+            TSGEN_SPIKE);
+    exit(2);
+}
+
+//*****************************************************************************
+//
+// Writes a trace to the standard output.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    uint32_t ulPairs, ulMHz, ulIdx, ulTime, ulPeriod;
+    double dSpeed, dNoise, dSpikes, dX, dY;
+    int iOpt;
+
+    ulPairs = 200;
+    ulMHz = 80;
+    dSpeed = 0;
+    dNoise = 0;
+    dSpikes = 0;
+
+    while((iOpt = getopt(argc, argv, "p:s:n:k:r:c:")) != -1)
+    {
+        switch(iOpt)
+        {
+            case 'p': ulPairs = strtoul(optarg, 0, 0); break;
+            case 's': dSpeed = atof(optarg); break;
+            case 'n': dNoise = atof(optarg); break;
+            case 'k': dSpikes = atof(optarg); break;
+            case 'r': g_ulSeed = strtoul(optarg, 0, 0) | 1; break;
+            case 'c': ulMHz = strtoul(optarg, 0, 0); break;
+            default: Usage();
+        }
+    }
+    if((optind != argc) || !ulPairs || !ulMHz)
+    {
+        Usage();
+    }
+
+    printf("# pairs %u, cycles/us %u\n", ulPairs + (TSGEN_RELEASED * 2),
+           ulMHz);
+
+    ulPeriod = (ulMHz * 1000000) / TSGEN_PAIR_RATE;
+    ulTime = ulPeriod;
+    for(ulIdx = 0; ulIdx < (ulPairs + (TSGEN_RELEASED * 2));
+        ulIdx++, ulTime += ulPeriod)
+    {
+        if((ulIdx < TSGEN_RELEASED) || (ulIdx >= (ulPairs + TSGEN_RELEASED)))
+        {
+            printf("%u,0,0,0,0\n", ulTime);
+            continue;
+        }
+
+        dX = TSGEN_START_X + ((ulIdx - TSGEN_RELEASED) * dSpeed);
+        dY = TSGEN_START_Y + ((ulIdx - TSGEN_RELEASED) * dSpeed / 2);
+        printf("%u,%d,%d,%d,%d\n", ulTime, Noisy(dX, dNoise, dSpikes),
+               Noisy(dY, dNoise, dSpikes), TSGEN_Z1, TSGEN_Z2);
+    }
+
+    return(0);
+}
@@ -0,0 +1,592 @@
+//*****************************************************************************
+//
+// tsreplay.c - Replays a touch screen trace through the touch screen driver
+//              on the host.
+//
+// The trace is the text sent by TouchScreenTraceDump(): a line giving the
+// number of pairs and the processor cycles per microsecond, then one line
+// per X/Y pair holding the sample time in cycles and the X, Y, Z1 and Z2
+// readings.  Each pair is fed to the real TouchScreenIntHandler() as the six
+// ADC sample sequence 3 conversions of the interrupt driven state machine,
+// at the times the trace gives, so that the filter, the debouncer, the
+// idle detection and the event queue all run as they do on the target.
+// Where the driver has gone idle and the trace carries on, a pen detect
+// interrupt is raised first, since the target only records while sampling.
+//
+// With -r the driver reports the filtered readings in place of screen
+// coordinates, and the lag of the filter is measured against the trace: the
+// distance each position is behind the raw reading of its pair, along the
+// direction of movement, in pairs.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "inc/hw_adc.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_timer.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "grlib/grlib.h"
+#include "grlib/widget.h"
+#include "hwsim.h"
+#include "touch.h"
+
+//*****************************************************************************
+//
+// The pin the driver uses for pen detection while idle, and the time within
+// which a pen down following a pen up is counted as a false pen up, in
+// milliseconds.  These match touch.c.
+//
+//*****************************************************************************
+#define REPLAY_PEN_BASE         GPIO_PORTD_BASE
+#define REPLAY_PEN_PIN          GPIO_PIN_1
+#define REPLAY_FALSE_UP_TIME    100
+
+//*****************************************************************************
+//
+// The number of conversions the state machine takes per pair, and the
+// position of the X conversion, whose time the driver records, among them.
+//
+//*****************************************************************************
+#define REPLAY_PAIR_SAMPLES     6
+#define REPLAY_X_SAMPLE         1
+
+//*****************************************************************************
+//
+// The rate at which the driver samples pairs, used to express latencies in
+// pairs.  This matches TS_PAIR_RATE in touch.c.
+//
+//*****************************************************************************
+#define REPLAY_PAIR_RATE        250
+
+//*****************************************************************************
+//
+// The pairs either side of a position over which the direction and speed of
+// movement are found for the filter lag, and the least movement over them,
+// in counts, for the position to count as moving.
+//
+//*****************************************************************************
+#define REPLAY_LAG_SPAN         4
+#define REPLAY_LAG_MOVE         16
+
+//*****************************************************************************
+//
+// The pairs of the trace.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ulTime;
+    int16_t sX;
+    int16_t sY;
+    int16_t sZ1;
+    int16_t sZ2;
+}
+tReplayPair;
+
+static tReplayPair g_psPairs[TOUCH_TRACE_SIZE];
+static uint32_t g_ulPairs;
+static uint32_t g_ulCyclesPerUs = 80;
+
+//*****************************************************************************
+//
+// The results of the replay.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ulDown;
+    uint32_t ulMove;
+    uint32_t ulMerged;
+    uint32_t ulUp;
+    uint32_t ulFalseUp;
+    uint32_t ulWakes;
+    uint32_t ulLatencyCount;
+    uint64_t ullLatencyTotal;
+    uint32_t ulLatencyMax;
+    uint32_t ulLastUp;
+    bool bUpSeen;
+    uint32_t ulLagPair;
+    uint32_t ulLagCount;
+    int64_t llLagSum;
+    int64_t llLagWeight;
+}
+tReplayStats;
+
+static tReplayStats g_sStats;
+static bool g_bVerbose;
+static bool g_bRaw;
+
+//*****************************************************************************
+//
+// Prints the usage of the program.
+//
+//*****************************************************************************
+static void
+Usage(void)
+{
+    fprintf(stderr,
+            "usage: tsreplay [options] trace.csv\n"
+            "  -f filter   none, median, trimmed or iir (default none)\n"
+            "  -w window   filter window, 1 to %d (default %d)\n"
+            "  -d count    pressed samples before a pen down (default %d)\n"
+            "  -l count    pressed samples held back (default %d)\n"
+            "  -i ms       idle delay, 0 to never go idle (default 250)\n"
+            "  -b          sample faster while the pen is down\n"
+            "  -c mhz      processor clock if the trace has no header "
+            "(default 80)\n"
+            "  -r          report raw readings and measure the filter lag\n"
+            "  -v          list each message\n"
+            "A trace of - is read from the standard input.\n",
+            TOUCH_FILTER_WINDOW_MAX, TOUCH_FILTER_WINDOW_MAX,
+            TOUCH_DEBOUNCE_DOWN, TOUCH_DEBOUNCE_LOOKAHEAD);
+    exit(2);
+}
+
+//*****************************************************************************
+//
+// Reads a trace.  Lines that are neither the header nor a pair, such as
+// other output from the target, are skipped.
+//
+//*****************************************************************************
+static bool
+TraceRead(FILE *pFile)
+{
+    char pcLine[128];
+    unsigned int ulTime, ulCount, ulRate;
+    int lX, lY, lZ1, lZ2;
+
+    g_ulPairs = 0;
+    while(fgets(pcLine, sizeof(pcLine), pFile))
+    {
+        if(sscanf(pcLine, "# pairs %u, cycles/us %u", &ulCount,
+                  &ulRate) == 2)
+        {
+            g_ulCyclesPerUs = ulRate;
+            continue;
+        }
+        if(sscanf(pcLine, "%u,%d,%d,%d,%d", &ulTime, &lX, &lY, &lZ1,
+                  &lZ2) != 5)
+        {
+            continue;
+        }
+        if(g_ulPairs == TOUCH_TRACE_SIZE)
+        {
+            fprintf(stderr, "tsreplay: more than %d pairs\n",
+                    TOUCH_TRACE_SIZE);
+            return(false);
+        }
+        g_psPairs[g_ulPairs].ulTime = ulTime;
+        g_psPairs[g_ulPairs].sX = lX;
+        g_psPairs[g_ulPairs].sY = lY;
+        g_psPairs[g_ulPairs].sZ1 = lZ1;
+        g_psPairs[g_ulPairs].sZ2 = lZ2;
+        g_ulPairs++;
+    }
+
+    return(g_ulPairs != 0);
+}
+
+//*****************************************************************************
+//
+// Takes one interrupt at the given time.  The driver must leave the
+// processor interrupt as it found it.
+//
+//*****************************************************************************
+static void
+InterruptRaise(uint32_t ulTime)
+{
+    HWREG(HWSIM_DWT_CYCCNT) = ulTime;
+    TouchScreenIntHandler();
+    if(HWSimIntsOff())
+    {
+        fprintf(stderr, "tsreplay: interrupts left disabled\n");
+        exit(1);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the median of three readings.
+//
+//*****************************************************************************
+static int32_t
+Median3(int32_t lA, int32_t lB, int32_t lC)
+{
+    if(lA > lB)
+    {
+        return((lB > lC) ? lB : ((lA > lC) ? lC : lA));
+    }
+
+    return((lA > lC) ? lA : ((lB > lC) ? lC : lB));
+}
+
+//*****************************************************************************
+//
+// Adds the lag of a filtered position to the totals, if the pen was moving
+// steadily enough around it to tell.  The movement over the pairs either
+// side gives the direction and speed, and the lag is the distance behind
+// the raw reading along it, as a least squares fit over all the positions.
+// The movement is taken between the medians of three pairs at either end,
+// so that a spike in one of them does not swamp it.
+//
+//*****************************************************************************
+static void
+LagAdd(const tTouchEvent *psEvent)
+{
+    const tReplayPair *psPair;
+    int32_t lVX, lVY, lDX, lDY, lIdx;
+
+    while((g_sStats.ulLagPair < g_ulPairs) &&
+          (g_psPairs[g_sStats.ulLagPair].ulTime != psEvent->ulTime))
+    {
+        g_sStats.ulLagPair++;
+    }
+    if((g_sStats.ulLagPair <= REPLAY_LAG_SPAN) ||
+       ((g_sStats.ulLagPair + REPLAY_LAG_SPAN + 1) >= g_ulPairs))
+    {
+        return;
+    }
+
+    psPair = &g_psPairs[g_sStats.ulLagPair];
+    for(lIdx = -REPLAY_LAG_SPAN - 1; lIdx <= (REPLAY_LAG_SPAN + 1); lIdx++)
+    {
+        if((psPair[lIdx].sX < g_sTouchMin) || (psPair[lIdx].sY < g_sTouchMin))
+        {
+            return;
+        }
+    }
+
+    lVX = (Median3(psPair[REPLAY_LAG_SPAN - 1].sX, psPair[REPLAY_LAG_SPAN].sX,
+                   psPair[REPLAY_LAG_SPAN + 1].sX) -
+           Median3(psPair[-REPLAY_LAG_SPAN - 1].sX,
+                   psPair[-REPLAY_LAG_SPAN].sX,
+                   psPair[-REPLAY_LAG_SPAN + 1].sX));
+    lVY = (Median3(psPair[REPLAY_LAG_SPAN - 1].sY, psPair[REPLAY_LAG_SPAN].sY,
+                   psPair[REPLAY_LAG_SPAN + 1].sY) -
+           Median3(psPair[-REPLAY_LAG_SPAN - 1].sY,
+                   psPair[-REPLAY_LAG_SPAN].sY,
+                   psPair[-REPLAY_LAG_SPAN + 1].sY));
+    if(((lVX * lVX) + (lVY * lVY)) < (REPLAY_LAG_MOVE * REPLAY_LAG_MOVE))
+    {
+        return;
+    }
+
+    //
+    // The movement is over twice the span, so the lag in pairs is twice the
+    // span times the distance behind along it over its length squared.
+    //
+    lDX = psPair->sX - psEvent->sX;
+    lDY = psPair->sY - psEvent->sY;
+    g_sStats.llLagSum += (((int64_t)lDX * lVX) + ((int64_t)lDY * lVY)) *
+                         REPLAY_LAG_SPAN * 2 * 100;
+    g_sStats.llLagWeight += ((int64_t)lVX * lVX) + ((int64_t)lVY * lVY);
+    g_sStats.ulLagCount++;
+}
+
+//*****************************************************************************
+//
+// Reads the messages the last pair produced from the event queue.  The
+// latency of each runs from the sample it carries to now, as the driver
+// measures it.
+//
+//*****************************************************************************
+static void
+EventsRead(void)
+{
+    tTouchEvent psEvents[TOUCH_EVENT_QUEUE_SIZE];
+    uint32_t ulCount, ulIdx, ulNow, ulLatency;
+    static const char *ppcNames[] = { "?", "?", "down", "move", "up" };
+
+    ulNow = HWREG(HWSIM_DWT_CYCCNT);
+    ulCount = TouchScreenEventsRead(psEvents, TOUCH_EVENT_QUEUE_SIZE);
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        ulLatency = ulNow - psEvents[ulIdx].ulTime;
+        g_sStats.ulLatencyCount++;
+        g_sStats.ullLatencyTotal += ulLatency;
+        if(ulLatency > g_sStats.ulLatencyMax)
+        {
+            g_sStats.ulLatencyMax = ulLatency;
+        }
+
+        switch(psEvents[ulIdx].ulMsg)
+        {
+            case WIDGET_MSG_PTR_DOWN:
+            {
+                if(g_sStats.bUpSeen &&
+                   ((psEvents[ulIdx].ulTime - g_sStats.ulLastUp) <
+                    (g_ulCyclesPerUs * 1000 * REPLAY_FALSE_UP_TIME)))
+                {
+                    g_sStats.ulFalseUp++;
+                }
+                g_sStats.ulDown++;
+                if(g_bRaw)
+                {
+                    LagAdd(&psEvents[ulIdx]);
+                }
+                break;
+            }
+
+            case WIDGET_MSG_PTR_MOVE:
+            {
+                g_sStats.ulMove++;
+                g_sStats.ulMerged += psEvents[ulIdx].usCount - 1;
+                if(g_bRaw)
+                {
+                    LagAdd(&psEvents[ulIdx]);
+                }
+                break;
+            }
+
+            case WIDGET_MSG_PTR_UP:
+            {
+                g_sStats.ulLastUp = psEvents[ulIdx].ulTime;
+                g_sStats.bUpSeen = true;
+                g_sStats.ulUp++;
+                break;
+            }
+        }
+
+        if(g_bVerbose)
+        {
+            printf("%10u %-4s %4d %4d %4u latency %u us\n",
+                   psEvents[ulIdx].ulTime / g_ulCyclesPerUs,
+                   ppcNames[(psEvents[ulIdx].ulMsg <= WIDGET_MSG_PTR_UP) ?
+                            psEvents[ulIdx].ulMsg : 0],
+                   psEvents[ulIdx].sX, psEvents[ulIdx].sY,
+                   psEvents[ulIdx].usPressure, ulLatency / g_ulCyclesPerUs);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Feeds one pair to the driver.  The state machine takes a conversion to be
+// discarded before each axis, so the pair is six conversions one timer
+// period apart with the X reading second, at the recorded time.
+//
+//*****************************************************************************
+static void
+PairFeed(const tReplayPair *psPair)
+{
+    uint32_t ulStep, ulIdx, ulTime;
+    int16_t psSamples[REPLAY_PAIR_SAMPLES];
+
+    ulStep = HWREG(TIMER1_BASE + TIMER_O_TAILR) + 1;
+    ulTime = psPair->ulTime - (REPLAY_X_SAMPLE * ulStep);
+
+    //
+    // The target only records while sampling, so a pair after the driver
+    // has gone idle means that the pen woke it.
+    //
+    if(HWREG(REPLAY_PEN_BASE + GPIO_O_IM) & REPLAY_PEN_PIN)
+    {
+        HWREG(REPLAY_PEN_BASE + GPIO_O_RIS) |= REPLAY_PEN_PIN;
+        HWREG(REPLAY_PEN_BASE + GPIO_O_MIS) |= REPLAY_PEN_PIN;
+        InterruptRaise(ulTime - ulStep);
+        g_sStats.ulWakes++;
+    }
+
+    psSamples[0] = psPair->sX;
+    psSamples[1] = psPair->sX;
+    psSamples[2] = psPair->sY;
+    psSamples[3] = psPair->sY;
+    psSamples[4] = psPair->sZ1;
+    psSamples[5] = psPair->sZ2;
+    for(ulIdx = 0; ulIdx < REPLAY_PAIR_SAMPLES; ulIdx++)
+    {
+        HWREG(ADC0_BASE + ADC_O_SSFIFO3) = psSamples[ulIdx];
+        InterruptRaise(ulTime);
+        ulTime += ulStep;
+    }
+
+    EventsRead();
+}
+
+//*****************************************************************************
+//
+// Parses the name of a filter.
+//
+//*****************************************************************************
+static uint32_t
+FilterParse(const char *pcName)
+{
+    if(!strcmp(pcName, "none"))
+    {
+        return(TOUCH_FILTER_NONE);
+    }
+    if(!strcmp(pcName, "median"))
+    {
+        return(TOUCH_FILTER_MEDIAN);
+    }
+    if(!strcmp(pcName, "trimmed"))
+    {
+        return(TOUCH_FILTER_TRIMMED);
+    }
+    if(!strcmp(pcName, "iir"))
+    {
+        return(TOUCH_FILTER_IIR);
+    }
+    Usage();
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Replays the trace named on the command line and prints the results.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    tTouchTraceReport sReport;
+    uint32_t ulFilter, ulWindow, ulDown, ulLookahead, ulIdle, ulIdx;
+    uint32_t ulRaw, ulFiltered, ulJitter, ulEntries, ulPeriod, ulDropped;
+    int64_t llLag;
+    bool bBurst;
+    FILE *pFile;
+    int iOpt;
+
+    ulFilter = TOUCH_FILTER_NONE;
+    ulWindow = TOUCH_FILTER_WINDOW_MAX;
+    ulDown = TOUCH_DEBOUNCE_DOWN;
+    ulLookahead = TOUCH_DEBOUNCE_LOOKAHEAD;
+    ulIdle = 250;
+    bBurst = false;
+
+    while((iOpt = getopt(argc, argv, "f:w:d:l:i:bc:rv")) != -1)
+    {
+        switch(iOpt)
+        {
+            case 'f': ulFilter = FilterParse(optarg); break;
+            case 'w': ulWindow = strtoul(optarg, 0, 0); break;
+            case 'd': ulDown = strtoul(optarg, 0, 0); break;
+            case 'l': ulLookahead = strtoul(optarg, 0, 0); break;
+            case 'i': ulIdle = strtoul(optarg, 0, 0); break;
+            case 'b': bBurst = true; break;
+            case 'c': g_ulCyclesPerUs = strtoul(optarg, 0, 0); break;
+            case 'r': g_bRaw = true; break;
+            case 'v': g_bVerbose = true; break;
+            default: Usage();
+        }
+    }
+    if((optind != (argc - 1)) || !g_ulCyclesPerUs)
+    {
+        Usage();
+    }
+
+    pFile = strcmp(argv[optind], "-") ? fopen(argv[optind], "r") : stdin;
+    if(!pFile)
+    {
+        perror(argv[optind]);
+        return(1);
+    }
+    if(!TraceRead(pFile))
+    {
+        fprintf(stderr, "tsreplay: no pairs in %s\n", argv[optind]);
+        return(1);
+    }
+    if(pFile != stdin)
+    {
+        fclose(pFile);
+    }
+
+    //
+    // Bring the driver up as an application would, with the event queue in
+    // use and the trace recorder running so that what reached the filter can
+    // be checked against the input.
+    //
+    if(!HWSimFlashMap())
+    {
+        fprintf(stderr, "tsreplay: cannot map the simulated flash\n");
+        return(1);
+    }
+    HWSimClockSet(g_ulCyclesPerUs * 1000000);
+    TouchScreenInit();
+    TouchScreenFilterSet(ulFilter, ulWindow);
+    TouchScreenDebounceSet(ulDown, ulLookahead);
+    TouchScreenIdleSet(ulIdle, bBurst);
+    TouchScreenEventQueueEnable(true);
+    TouchScreenRawSet(g_bRaw);
+    TouchScreenTraceRecord(true);
+
+    //
+    // The first conversion after initialization runs the initial state of
+    // the state machine, which drives the panel for the first pair.
+    //
+    HWREG(ADC0_BASE + ADC_O_SSFIFO3) = 0;
+    InterruptRaise(g_psPairs[0].ulTime -
+                   ((REPLAY_X_SAMPLE + 1) *
+                    (HWREG(TIMER1_BASE + TIMER_O_TAILR) + 1)));
+
+    for(ulIdx = 0; ulIdx < g_ulPairs; ulIdx++)
+    {
+        PairFeed(&g_psPairs[ulIdx]);
+    }
+
+    TouchScreenTraceRecord(false);
+    TouchScreenFilterStats(&ulRaw, &ulFiltered, &ulJitter, false);
+    TouchScreenIdleStats(0, 0, &ulEntries, false);
+
+    //
+    // Replaying the recording counts the pressed pairs, which are those the
+    // debouncer should have reported as a pen down or a pen move.
+    //
+    TouchScreenTraceReplay(&sReport);
+    if(sReport.ulPairs != g_ulPairs)
+    {
+        fprintf(stderr, "tsreplay: %u pairs fed but %u recorded\n",
+                g_ulPairs, sReport.ulPairs);
+        return(1);
+    }
+    ulDropped = sReport.ulPressed -
+                (g_sStats.ulDown + g_sStats.ulMove + g_sStats.ulMerged);
+    if(sReport.ulPressed < (g_sStats.ulDown + g_sStats.ulMove +
+                            g_sStats.ulMerged))
+    {
+        ulDropped = 0;
+    }
+
+    ulPeriod = (g_ulCyclesPerUs * 1000000) / REPLAY_PAIR_RATE;
+    printf("pairs            %u (%u pressed)\n", g_ulPairs,
+           sReport.ulPressed);
+    printf("idle             %u entries, %u pen detect wakes\n", ulEntries,
+           g_sStats.ulWakes);
+    printf("messages         %u down, %u move, %u up\n", g_sStats.ulDown,
+           g_sStats.ulMove, g_sStats.ulUp);
+    printf("latency          mean %u us, max %u us (%u.%02u pairs)\n",
+           g_sStats.ulLatencyCount ?
+           (uint32_t)(g_sStats.ullLatencyTotal / g_sStats.ulLatencyCount /
+                      g_ulCyclesPerUs) : 0,
+           g_sStats.ulLatencyMax / g_ulCyclesPerUs,
+           g_sStats.ulLatencyMax / ulPeriod,
+           ((g_sStats.ulLatencyMax % ulPeriod) * 100) / ulPeriod);
+    printf("jitter           raw %u.%02u, filtered %u.%02u counts/pair "
+           "over %u pairs\n",
+           ulJitter ? (ulRaw / ulJitter) : 0,
+           ulJitter ? (((ulRaw % ulJitter) * 100) / ulJitter) : 0,
+           ulJitter ? (ulFiltered / ulJitter) : 0,
+           ulJitter ? (((ulFiltered % ulJitter) * 100) / ulJitter) : 0,
+           ulJitter);
+    if(g_bRaw)
+    {
+        llLag = (g_sStats.llLagWeight ?
+                 (g_sStats.llLagSum / g_sStats.llLagWeight) : 0);
+        printf("filter lag       %s%u.%02u pairs over %u moving positions\n",
+               (llLag < 0) ? "-" : "",
+               (uint32_t)(((llLag < 0) ? -llLag : llLag) / 100),
+               (uint32_t)(((llLag < 0) ? -llLag : llLag) % 100),
+               g_sStats.ulLagCount);
+    }
+    printf("dropped moves    %u\n", ulDropped);
+    printf("false pen ups    %u\n", g_sStats.ulFalseUp);
+
+    return(0);
+}
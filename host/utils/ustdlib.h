@@ -0,0 +1,16 @@
+//*****************************************************************************
+//
+// ustdlib.h - Prototypes for the small standard library functions, mapped
+//             onto the C library for the host build.
+//
+//*****************************************************************************
+
+#ifndef __USTDLIB_H__
+#define __USTDLIB_H__
+
+#include <stdio.h>
+
+#define usprintf                sprintf
+#define usnprintf               snprintf
+
+#endif // __USTDLIB_H__
@@ -5,158 +5,2137 @@
 //*****************************************************************************
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
 #include "inc/hw_sysctl.h"
 #include "inc/hw_types.h"
 #include "driverlib/flash.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/sw_crc.h"
 #include "driverlib/sysctl.h"
+#include "driverlib/systick.h"
+#include "driverlib/uart.h"
+#include "driverlib/udma.h"
 #include "grlib/grlib.h"
 #include "grlib/widget.h"
-#include "utils/ringbuf.h"
 #include "utils/ustdlib.h"
 #include "Kentec320x240x16_ssd2119_8bit.h"
 #include "touch.h"
 //#include "drivers/set_pinout.h"
 #include "driverlib/rom.h"
 
-#include "utils/ringbuf.c"
+//*****************************************************************************
+//
+//! \addtogroup example_list
+//! <h1>Scribble Pad (scribble)</h1>
+//!
+//! The scribble pad provides a drawing area on the screen.  Touching the
+//! screen will draw onto the drawing area using a selection of fundamental
+//! colors (in other words, the seven colors produced by the three color
+//! channels being either fully on or fully off).  Each stroke is drawn in the
+//! next color with a brush whose width follows how firmly the screen is
+//! pressed, along a smooth curve through the touch positions, and is kept
+//! so that the drawing can be redrawn.  Touching
+//! ``Undo'' at the left of the banner removes the last stroke, ``Clear'' at
+//! the right erases them all, and touching the name of the application
+//! between them redraws the drawing from the stored strokes and reports how
+//! fast that was.
+//!
+//! The strokes are also streamed over UART0, at 115,200 baud, as they are
+//! drawn, so that handwriting or a signature can be captured on a host.
+//!
+//! When built with SCRIBBLE_BENCH defined, touching the name of the
+//! application instead replays the stored strokes, or a set of made up ones
+//! if there are none, through the touch screen event queue at a range of
+//! rates, and reports how many points per second are drawn at each.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The number of touch screen messages read from the touch screen driver's
+// event queue at a time.
+//
+//*****************************************************************************
+#define MSG_BATCH_SIZE 8
+
+//*****************************************************************************
+//
+// The DMA control structure table.
+//
+//*****************************************************************************
+#ifdef ewarm
+#pragma data_alignment=1024
+tDMAControlTable sDMAControlTable[64];
+#elif defined(ccs)
+#pragma DATA_ALIGN(sDMAControlTable, 1024)
+tDMAControlTable sDMAControlTable[64];
+#else
+tDMAControlTable sDMAControlTable[64] __attribute__ ((aligned(1024)));
+#endif
+
+//*****************************************************************************
+//
+// The processor's cycle counter, which times the redraws.
+//
+//*****************************************************************************
+#define DWT_CYCCNT 0xE0001004
+
+//*****************************************************************************
+//
+// The height of the banner, and the width of the undo and clear buttons at
+// either end of it.
+//
+//*****************************************************************************
+#define BANNER_HEIGHT 24
+#define BUTTON_WIDTH  64
+
+//*****************************************************************************
+//
+// The error routine that is called if the driver library encounters an error.
+//
+//*****************************************************************************
+#ifdef DEBUG
+void
+__error__(char *pcFilename, unsigned long ulLine)
+{
+}
+#endif
+
+//*****************************************************************************
+//
+// The colors that are used to draw on the screen.
+//
+//*****************************************************************************
+static const unsigned long g_pulColors[] =
+{
+    ClrWhite,
+    ClrYellow,
+    ClrMagenta,
+    ClrRed,
+    ClrCyan,
+    ClrLime,
+    ClrBlue
+};
+
+//*****************************************************************************
+//
+// The index to the current color in use.
+//
+//*****************************************************************************
+static unsigned long g_ulColorIdx;
+
+//*****************************************************************************
+//
+// The previous pen position returned from the touch screen driver.
+//
+//*****************************************************************************
+static long g_lX, g_lY;
+
+//*****************************************************************************
+//
+// The time, in milliseconds, by which the ink is extended ahead of the pen
+// along its current velocity, or zero to draw only the sampled positions.
+// The predicted segment is drawn provisionally and erased when the next
+// position arrives.  PREDICT_MAX limits how far ahead, in pixels, the
+// segment may reach on each axis.
+//
+//*****************************************************************************
+#ifndef PREDICT_HORIZON
+#define PREDICT_HORIZON 8
+#endif
+#define PREDICT_MAX 24
+static unsigned long g_ulPredictHorizon = PREDICT_HORIZON;
+
+//*****************************************************************************
+//
+// The processor cycles per microsecond, used to convert the sample times
+// from the touch screen driver, the time of the previous position, and the
+// smoothed pen velocity in 1/256ths of a pixel per millisecond.
+//
+//*****************************************************************************
+static unsigned long g_ulCyclesPerUs;
+static unsigned long g_ulTime;
+static long g_lVX, g_lVY;
+
+//*****************************************************************************
+//
+// The provisional ink currently on the screen, if any: a line from the end
+// of the smoothed curve to the last sampled position, and from there to the
+// end of the predicted segment.
+//
+//*****************************************************************************
+static bool g_bPredicted;
+static long g_lTX, g_lTY;
+static long g_lPX, g_lPY;
+
+//*****************************************************************************
+//
+// The predictions awaiting a sampled position to be checked against: the
+// time each one was made for and the position it predicted.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulTime;
+    long lX;
+    long lY;
+}
+tPrediction;
+
+#define PREDICT_HISTORY 8
+static tPrediction g_psPredictions[PREDICT_HISTORY];
+static unsigned long g_ulPredictRead;
+static unsigned long g_ulPredictCount;
+
+//*****************************************************************************
+//
+// The accuracy of the predictions in the current stroke: the number checked,
+// and the total and worst case distance, in pixels, from where the pen
+// actually was at the predicted time.
+//
+//*****************************************************************************
+static unsigned long g_ulPredictChecked;
+static unsigned long g_ulPredictErrTotal;
+static unsigned long g_ulPredictErrMax;
+
+//*****************************************************************************
+//
+// The area covered by the provisional ink segments erased during the current
+// stroke, which may have been drawn over earlier strokes.
+//
+//*****************************************************************************
+static bool g_bPredictDirty;
+static tRectangle g_sPredictDirty;
+
+//*****************************************************************************
+//
+// The strokes drawn so far, kept so that they can be redrawn or undone.  The
+// points of each stroke are packed one after another into a shared arena:
+// the first as two 16-bit coordinates and each of the rest as the change
+// from the one before.  A change of up to 7 pixels on both axes takes a
+// single byte, holding the X change in the upper nibble and the Y change in
+// the lower one.  Since a nibble of -8 is never used for a change, bytes
+// with one mark the larger changes: STROKE_ESC_DELTA is followed by a signed
+// byte for each axis, and STROKE_ESC_ABS by two 16-bit coordinates.
+// STROKE_ESC_RADIUS is followed by the brush radius for the segments after
+// it; the radius at the start of the stroke is kept in the table, along with
+// the bounds of the ink.  Points that repeat the previous one are not
+// stored.  When the arena or the table
+// of strokes is full, the oldest strokes are dropped from the store, though
+// not from the screen.
+//
+//*****************************************************************************
+#ifndef STROKE_ARENA_SIZE
+#define STROKE_ARENA_SIZE 4096
+#endif
+#define STROKE_MAX        64
+#define STROKE_ESC_DELTA  0x80
+#define STROKE_ESC_ABS    0x88
+#define STROKE_ESC_RADIUS 0x81
+
+typedef struct
+{
+    unsigned short usOffset;
+    unsigned short usBytes;
+    unsigned short usPoints;
+    unsigned char ucColor;
+    unsigned char ucRadius;
+    tRectangle sBounds;
+}
+tStroke;
+
+static unsigned char g_pucStrokeArena[STROKE_ARENA_SIZE];
+static tStroke g_psStrokes[STROKE_MAX];
+static unsigned long g_ulStrokes;
+static unsigned long g_ulStrokeUsed;
+
+//*****************************************************************************
+//
+// Set while the points of the current stroke, the last in the table, are
+// being stored, and the last point and brush radius stored.  The bounds of
+// the stroke are kept for the largest radius used in it so far, since the
+// brush drawn up to a new point with a larger radius also grows around the
+// points before it.
+//
+//*****************************************************************************
+static bool g_bStrokeRecording;
+static long g_lStrokeX, g_lStrokeY;
+static unsigned long g_ulStrokeRadius;
+static unsigned long g_ulStrokeRadiusMax;
+
+//*****************************************************************************
+//
+// Set while the pen is down after touching the banner, so that its movement
+// does not draw.
+//
+//*****************************************************************************
+static bool g_bCommand;
+
+//*****************************************************************************
+//
+// The area holding ink since the scribble area was last cleared, including
+// strokes that have been dropped from the store, so that a clear only has
+// to erase that much, and the largest brush radius of the current stroke,
+// which the points of the stroke are added with.
+//
+//*****************************************************************************
+static bool g_bInk;
+static tRectangle g_sInkBounds;
+static unsigned long g_ulInkRadius;
+
+//*****************************************************************************
+//
+// The strokes are streamed over UART0 in frames of
+//
+//     0xA5, type, sequence, length, payload, CRC-16 low byte, high byte
+//
+// where length counts the bytes of the payload, the CRC is Crc16() of
+// everything from the type to the end of the payload, and the sequence
+// counts up by one for each frame so that a receiver can tell when frames
+// have been lost.  A receiver that finds a bad CRC looks for the next 0xA5.
+// The payloads are unsigned LEB128 varints, with signed values zigzag
+// encoded:
+//
+// * STREAM_START: color index, brush radius, X, Y of the first point.
+// * STREAM_POINTS: X change, Y change of each point from the one before.
+// * STREAM_RADIUS: the brush radius of the points after it.
+// * STREAM_END: the number of points in the stroke, its length in
+//   milliseconds, and the number of frames dropped so far.
+// * STREAM_UNDO, STREAM_CLEAR: empty; the last stroke was removed, or all of
+//   them were.
+// * STREAM_BENCH: the results of a benchmark run, as listed at BenchReport().
+//
+// The points are gathered into a frame of up to STREAM_PAYLOAD bytes, which
+// is sent when it is full, when the stroke ends, or once its first point is
+// STREAM_LATENCY milliseconds old.  Frames are passed to the UART from a
+// ring by its transmit interrupt; a frame that does not fit in the ring is
+// dropped rather than holding up the drawing.
+//
+//*****************************************************************************
+#define STREAM_SYNC       0xA5
+#define STREAM_START      1
+#define STREAM_POINTS     2
+#define STREAM_RADIUS     3
+#define STREAM_END        4
+#define STREAM_UNDO       5
+#define STREAM_CLEAR      6
+#define STREAM_BENCH      7
+#define STREAM_PAYLOAD    48
+#define STREAM_LATENCY    50
+#define STREAM_RING_SIZE  512
+
+static unsigned char g_pucStreamRing[STREAM_RING_SIZE];
+static volatile unsigned long g_ulStreamWrite;
+static volatile unsigned long g_ulStreamRead;
+static unsigned char g_ucStreamSeq;
+static unsigned char g_pucStreamPayload[STREAM_PAYLOAD];
+static unsigned long g_ulStreamPayload;
+static unsigned long g_ulStreamPayloadTime;
+static unsigned long g_ulStreamRadius;
+static unsigned long g_ulStreamPoints;
+static unsigned long g_ulStreamStart;
+static long g_lStreamX, g_lStreamY;
+
+//*****************************************************************************
+//
+// The stream statistics: the frames and bytes put into the ring, the frames
+// dropped because it was full, and the most bytes it has held.
+//
+//*****************************************************************************
+static unsigned long g_ulStreamFrames;
+static unsigned long g_ulStreamBytes;
+static unsigned long g_ulStreamDropped;
+static unsigned long g_ulStreamHighWater;
+
+#ifdef SCRIBBLE_BENCH
+//*****************************************************************************
+//
+// The rates, in points per second, at which the benchmark feeds points into
+// the touch screen event queue, and the number of seconds for which it feeds
+// them at each.
+//
+//*****************************************************************************
+#ifndef BENCH_RATES
+#define BENCH_RATES     125, 250, 500, 1000, 2000, 4000
+#endif
+#ifndef BENCH_SECONDS
+#define BENCH_SECONDS   2
+#endif
+
+static const unsigned long g_pulBenchRates[] = { BENCH_RATES };
+
+//*****************************************************************************
+//
+// The points fed in by the benchmark, copied from the stored strokes before
+// it starts since the strokes it draws are stored in turn.  Each has the
+// brush radius it was drawn with, and flags marking the first and last
+// points of a stroke.
+//
+//*****************************************************************************
+#define BENCH_POINTS_MAX 512
+#define BENCH_FIRST      1
+#define BENCH_LAST       2
+
+typedef struct
+{
+    short sX;
+    short sY;
+    unsigned char ucRadius;
+    unsigned char ucFlags;
+}
+tBenchPoint;
+
+static tBenchPoint g_psBenchPoints[BENCH_POINTS_MAX];
+static unsigned long g_ulBenchPoints;
+
+//*****************************************************************************
+//
+// The state of the benchmark: the rate being run, the next point to feed in
+// and the number of ticks left to feed them for.  The SysTick handler keeps
+// feeding points past the end of the run until the stroke it is in ends.
+//
+//*****************************************************************************
+static bool g_bBenchRequest;
+static bool g_bBenchRunning;
+static volatile bool g_bBenchFeeding;
+static unsigned long g_ulBenchRate;
+static unsigned long g_ulBenchNext;
+static unsigned long g_ulBenchTicks;
+
+//*****************************************************************************
+//
+// The measurements of a run: the points fed in, the messages handled and
+// the cycles spent handling them, the stroke segments drawn and the cycles
+// spent drawing them, and the start of the run.
+//
+//*****************************************************************************
+static volatile unsigned long g_ulBenchFed;
+static unsigned long g_ulBenchHandled;
+static unsigned long g_ulBenchHandleCycles;
+static unsigned long g_ulBenchSegments;
+static unsigned long g_ulBenchSegmentCycles;
+static unsigned long g_ulBenchSegmentMax;
+static unsigned long g_ulBenchStart;
+static unsigned long g_ulBenchBest;
+#endif
+
+//*****************************************************************************
+//
+// The radius of the brush, in pixels, for the lightest and the firmest
+// touches.  A radius of zero draws lines one pixel wide.  The radius of
+// each segment is taken from the touch pressure, smoothed over the stroke,
+// and the segment is drawn as a capsule of horizontal spans: the spans are
+// collected in g_psBrushSpans and sent to the display driver in batches.
+//
+//*****************************************************************************
+#ifndef BRUSH_RADIUS_MIN
+#define BRUSH_RADIUS_MIN 1
+#endif
+#ifndef BRUSH_RADIUS_MAX
+#define BRUSH_RADIUS_MAX 5
+#endif
+#define BRUSH_SPANS      64
+static unsigned long g_ulBrushMin = BRUSH_RADIUS_MIN;
+static unsigned long g_ulBrushMax = BRUSH_RADIUS_MAX;
+static unsigned long g_ulPressure;
+static unsigned long g_ulRadius;
+static tSSD2119Span g_psBrushSpans[BRUSH_SPANS];
+static unsigned long g_ulBrushSpans;
+
+//*****************************************************************************
+//
+// The state of the curve drawn through the points of a stroke.  Each curve
+// is a quadratic Bezier from the midpoint of the previous two points to the
+// midpoint of the last two, with the point between them as its control
+// point, so the strokes have no corners and the curve for a point can be
+// drawn as soon as the next point arrives.  The midpoints are held in half
+// pixels.  Each curve is drawn as up to SMOOTH_STEPS_MAX straight pieces, one
+// for every SMOOTH_STEP pixels of its length, which bounds the work done for
+// each touch screen message.
+//
+//*****************************************************************************
+#define SMOOTH_STEP      4
+#define SMOOTH_STEPS_MAX 8
+
+typedef struct
+{
+    long lX, lY;
+    long lMX2, lMY2;
+    long lDrawnX, lDrawnY;
+    long lCapRadius;
+}
+tSmooth;
+
+static tSmooth g_sSmooth;
+
+//*****************************************************************************
+//
+// The drawing context used to draw to the screen.
+//
+//*****************************************************************************
+static tContext g_sContext;
+
+//*****************************************************************************
+//
+// The scribble area inside the green box, to which drawing is clipped.
+//
+//*****************************************************************************
+static tRectangle g_sScribbleArea;
+
+//*****************************************************************************
+//
+// Adds a point to the area that may need repairing after the provisional
+// ink has been erased.
+//
+//*****************************************************************************
+static void
+PredictDirtyAdd(long lX, long lY)
+{
+    if(!g_bPredictDirty)
+    {
+        g_sPredictDirty.i16XMin = g_sPredictDirty.i16XMax = lX;
+        g_sPredictDirty.i16YMin = g_sPredictDirty.i16YMax = lY;
+        g_bPredictDirty = true;
+    }
+    g_sPredictDirty.i16XMin = ((lX < g_sPredictDirty.i16XMin) ? lX :
+                               g_sPredictDirty.i16XMin);
+    g_sPredictDirty.i16YMin = ((lY < g_sPredictDirty.i16YMin) ? lY :
+                               g_sPredictDirty.i16YMin);
+    g_sPredictDirty.i16XMax = ((lX > g_sPredictDirty.i16XMax) ? lX :
+                               g_sPredictDirty.i16XMax);
+    g_sPredictDirty.i16YMax = ((lY > g_sPredictDirty.i16YMax) ? lY :
+                               g_sPredictDirty.i16YMax);
+}
+
+//*****************************************************************************
+//
+// Erases the provisional ink, if any is on the screen.  It starts at the end
+// of the smoothed curve, so it cuts through the round end drawn there; the
+// next piece of the curve is made to draw its round start again in full
+// rather than leaving out the end it would otherwise carry on from.
+//
+//*****************************************************************************
+static void
+PredictErase(void)
+{
+    if(g_bPredicted)
+    {
+        PredictDirtyAdd(g_lTX, g_lTY);
+        PredictDirtyAdd(g_lX, g_lY);
+        PredictDirtyAdd(g_lPX, g_lPY);
+
+        GrContextForegroundSet(&g_sContext, ClrBlack);
+        GrLineDraw(&g_sContext, g_lTX, g_lTY, g_lX, g_lY);
+        GrLineDraw(&g_sContext, g_lX, g_lY, g_lPX, g_lPY);
+        GrContextForegroundSet(&g_sContext, g_pulColors[g_ulColorIdx]);
+        g_sSmooth.lCapRadius = -1;
+        g_bPredicted = false;
+    }
+}
+
+//*****************************************************************************
+//
+// Checks the predictions made for times up to that of a new sampled
+// position against it.  The distance is approximated by the larger of the
+// two axis differences plus half of the smaller.
+//
+//*****************************************************************************
+static void
+PredictCheck(long lX, long lY, unsigned long ulTime)
+{
+    tPrediction *psPrediction;
+    unsigned long ulDX, ulDY, ulErr;
+
+    while(g_ulPredictCount)
+    {
+        psPrediction = &g_psPredictions[g_ulPredictRead];
+        if((long)(ulTime - psPrediction->ulTime) < 0)
+        {
+            break;
+        }
+
+        ulDX = (lX > psPrediction->lX) ? (lX - psPrediction->lX) :
+                                         (psPrediction->lX - lX);
+        ulDY = (lY > psPrediction->lY) ? (lY - psPrediction->lY) :
+                                         (psPrediction->lY - lY);
+        ulErr = (ulDX > ulDY) ? (ulDX + (ulDY / 2)) : (ulDY + (ulDX / 2));
+
+        g_ulPredictChecked++;
+        g_ulPredictErrTotal += ulErr;
+        if(ulErr > g_ulPredictErrMax)
+        {
+            g_ulPredictErrMax = ulErr;
+        }
+
+        g_ulPredictRead = (g_ulPredictRead + 1) % PREDICT_HISTORY;
+        g_ulPredictCount--;
+    }
+}
+
+//*****************************************************************************
+//
+// Updates the pen velocity from a new sampled position, before it replaces
+// the previous one.
+//
+//*****************************************************************************
+static void
+PredictVelocity(long lX, long lY, unsigned long ulTime)
+{
+    unsigned long ulDelta;
+
+    ulDelta = (ulTime - g_ulTime) / g_ulCyclesPerUs;
+    g_ulTime = ulTime;
+    if(ulDelta == 0)
+    {
+        return;
+    }
+
+    //
+    // Average the new velocity with the previous estimate, which halves the
+    // effect of the jitter in any one position.
+    //
+    g_lVX += ((((lX - g_lX) * 256000) / (long)ulDelta) - g_lVX) / 2;
+    g_lVY += ((((lY - g_lY) * 256000) / (long)ulDelta) - g_lVY) / 2;
+}
+
+//*****************************************************************************
+//
+// Draws the provisional ink, which carries the smoothed curve on to the last
+// sampled position and from there to where the pen is expected to be after
+// the prediction horizon, and remembers the prediction so that it can be
+// checked.
+//
+//*****************************************************************************
+static void
+PredictDraw(void)
+{
+    long lDX, lDY;
+
+    lDX = (g_lVX * (long)g_ulPredictHorizon) / 256;
+    lDY = (g_lVY * (long)g_ulPredictHorizon) / 256;
+    lDX = (lDX > PREDICT_MAX) ? PREDICT_MAX :
+          ((lDX < -PREDICT_MAX) ? -PREDICT_MAX : lDX);
+    lDY = (lDY > PREDICT_MAX) ? PREDICT_MAX :
+          ((lDY < -PREDICT_MAX) ? -PREDICT_MAX : lDY);
+
+    g_lTX = g_sSmooth.lDrawnX;
+    g_lTY = g_sSmooth.lDrawnY;
+    g_lPX = g_lX + lDX;
+    g_lPY = g_lY + lDY;
+    GrLineDraw(&g_sContext, g_lTX, g_lTY, g_lX, g_lY);
+    GrLineDraw(&g_sContext, g_lX, g_lY, g_lPX, g_lPY);
+    g_bPredicted = true;
+
+    if(!lDX && !lDY)
+    {
+        return;
+    }
+
+    //
+    // Remember the prediction, replacing the oldest if the history is full.
+    //
+    if(g_ulPredictCount == PREDICT_HISTORY)
+    {
+        g_ulPredictRead = (g_ulPredictRead + 1) % PREDICT_HISTORY;
+        g_ulPredictCount--;
+    }
+    g_psPredictions[(g_ulPredictRead + g_ulPredictCount) %
+                    PREDICT_HISTORY].ulTime =
+        g_ulTime + (g_ulPredictHorizon * 1000 * g_ulCyclesPerUs);
+    g_psPredictions[(g_ulPredictRead + g_ulPredictCount) %
+                    PREDICT_HISTORY].lX = g_lPX;
+    g_psPredictions[(g_ulPredictRead + g_ulPredictCount) %
+                    PREDICT_HISTORY].lY = g_lPY;
+    g_ulPredictCount++;
+}
+
+//*****************************************************************************
+//
+// Shows a line of text in place of the instructions.
+//
+//*****************************************************************************
+static void
+StatusDraw(const char *pcText)
+{
+    tRectangle sRect;
+
+    //
+    // The instructions are outside the scribble area, so open the clipping
+    // region up to the whole screen while they are replaced.
+    //
+    sRect.i16XMin = 0;
+    sRect.i16YMin = 0;
+    sRect.i16XMax = GrContextDpyWidthGet(&g_sContext) - 1;
+    sRect.i16YMax = GrContextDpyHeightGet(&g_sContext) - 1;
+    GrContextClipRegionSet(&g_sContext, &sRect);
+
+    sRect.i16YMin = 24;
+    sRect.i16YMax = 43;
+    GrContextForegroundSet(&g_sContext, ClrBlack);
+    GrRectFill(&g_sContext, &sRect);
+    GrContextForegroundSet(&g_sContext, ClrWhite);
+    GrContextFontSet(&g_sContext, &g_sFontCmss14);
+    GrStringDrawCentered(&g_sContext, pcText, -1,
+                         GrContextDpyWidthGet(&g_sContext) / 2, 34, 0);
+
+    GrContextClipRegionSet(&g_sContext, &g_sScribbleArea);
+    GrContextForegroundSet(&g_sContext, g_pulColors[g_ulColorIdx]);
+}
+
+//*****************************************************************************
+//
+// Shows how far ahead the ink was drawn and how accurate the predictions in
+// the last stroke were, in place of the instructions.
+//
+//*****************************************************************************
+static void
+PredictReport(void)
+{
+    char pcBuffer[48];
+    unsigned long ulMean;
+
+    if(!g_ulPredictChecked)
+    {
+        return;
+    }
+
+    //
+    // The mean error, in tenths of a pixel.
+    //
+    ulMean = (g_ulPredictErrTotal * 10) / g_ulPredictChecked;
+    usprintf(pcBuffer, "Ink %d ms ahead, error %d.%d px mean, %d px max",
+             g_ulPredictHorizon, ulMean / 10, ulMean % 10, g_ulPredictErrMax);
+    StatusDraw(pcBuffer);
+}
+
+//*****************************************************************************
+//
+// Returns the integer square root of a value, rounded down.
+//
+//*****************************************************************************
+static unsigned long
+BrushSqrt(unsigned long ulValue)
+{
+    unsigned long ulRoot, ulBit;
+
+    for(ulBit = 1 << 30; ulBit > ulValue; ulBit >>= 2)
+    {
+    }
+    for(ulRoot = 0; ulBit; ulBit >>= 2)
+    {
+        if(ulValue >= (ulRoot + ulBit))
+        {
+            ulValue -= ulRoot + ulBit;
+            ulRoot = (ulRoot >> 1) + ulBit;
+        }
+        else
+        {
+            ulRoot >>= 1;
+        }
+    }
+
+    return(ulRoot);
+}
+
+//*****************************************************************************
+//
+// Returns the brush radius for a new pressure reading, which is averaged
+// with the readings before it in the stroke.
+//
+//*****************************************************************************
+static unsigned long
+BrushRadius(unsigned long ulPressure)
+{
+    unsigned long ulRadius;
+
+    g_ulPressure = ((g_ulPressure * 3) + ulPressure) / 4;
+    if(g_ulPressure <= TOUCH_PRESSURE_MIN)
+    {
+        return(g_ulBrushMin);
+    }
+
+    ulRadius = (g_ulBrushMin +
+                (((g_ulPressure - TOUCH_PRESSURE_MIN) *
+                  (g_ulBrushMax - g_ulBrushMin + 1)) /
+                 (4096 - TOUCH_PRESSURE_MIN)));
+
+    return((ulRadius > g_ulBrushMax) ? g_ulBrushMax : ulRadius);
+}
+
+//*****************************************************************************
+//
+// Returns half the width of the row of a round brush at a given distance
+// from its center, or -1 if the row misses the brush.  The radius is taken
+// as half a pixel larger than given, which rounds off the top and bottom.
+//
+//*****************************************************************************
+static long
+BrushHalfWidth(long lRadius, long lDY)
+{
+    if((lDY < -lRadius) || (lDY > lRadius))
+    {
+        return(-1);
+    }
+
+    return(BrushSqrt((lRadius * lRadius) + lRadius - (lDY * lDY)));
+}
+
+//*****************************************************************************
+//
+// Sends the collected spans to the display in the foreground color.
+//
+//*****************************************************************************
+static void
+BrushSpansFlush(void)
+{
+    if(g_ulBrushSpans)
+    {
+        Kentec320x240x16_SSD2119SpansFill(g_psBrushSpans, g_ulBrushSpans,
+                                          g_sContext.ui32Foreground);
+        g_ulBrushSpans = 0;
+    }
+}
+
+//*****************************************************************************
+//
+// Adds a span to those being collected, clipped to the clipping region.
+//
+//*****************************************************************************
+static void
+BrushSpanAdd(long lY, long lX1, long lX2)
+{
+    tRectangle *psClip;
+
+    psClip = &g_sContext.sClipRegion;
+    if((lY < psClip->i16YMin) || (lY > psClip->i16YMax))
+    {
+        return;
+    }
+    lX1 = (lX1 < psClip->i16XMin) ? psClip->i16XMin : lX1;
+    lX2 = (lX2 > psClip->i16XMax) ? psClip->i16XMax : lX2;
+    if(lX2 < lX1)
+    {
+        return;
+    }
+
+    g_psBrushSpans[g_ulBrushSpans].i16Y = lY;
+    g_psBrushSpans[g_ulBrushSpans].i16X1 = lX1;
+    g_psBrushSpans[g_ulBrushSpans].i16X2 = lX2;
+    if(++g_ulBrushSpans == BRUSH_SPANS)
+    {
+        BrushSpansFlush();
+    }
+}
+
+//*****************************************************************************
+//
+// Draws a segment of a stroke with the given brush radius, as the capsule
+// swept by the brush from one point to the other.  Each row of the capsule
+// is a single span, found as the union of the rows of the round ends and of
+// the band between them, whose edges are the segment moved out by the
+// radius on either side; the band is worked out in sixteenths of a pixel.
+// If lCapRadius is not negative, the segment carries on from one that ended
+// at the first point with a brush of that radius, and the round end drawn
+// there is cut out of the spans rather than drawn again.  A radius of zero
+// draws a line one pixel wide.
+//
+//*****************************************************************************
+static void
+BrushSegment(long lX0, long lY0, long lX1, long lY1, long lRadius,
+             long lCapRadius)
+{
+    long plX[4], plY[4], lDX, lDY, lLen, lNX, lNY;
+    long lY, lYMin, lYMax, lLeft, lRight, lHalf, lIdx, lNext, lX;
+
+    if(!lRadius)
+    {
+        GrLineDraw(&g_sContext, lX0, lY0, lX1, lY1);
+        return;
+    }
+
+    //
+    // Find the corners of the band, moving the segment out by the radius
+    // plus the half pixel added to the round ends.
+    //
+    lDX = lX1 - lX0;
+    lDY = lY1 - lY0;
+    lLen = BrushSqrt(((lDX * lDX) + (lDY * lDY)) * 256);
+    if(lLen)
+    {
+        lNX = (-lDY * ((lRadius * 16) + 8) * 16) / lLen;
+        lNY = (lDX * ((lRadius * 16) + 8) * 16) / lLen;
+        plX[0] = (lX0 * 16) + lNX;
+        plY[0] = (lY0 * 16) + lNY;
+        plX[1] = (lX1 * 16) + lNX;
+        plY[1] = (lY1 * 16) + lNY;
+        plX[2] = (lX1 * 16) - lNX;
+        plY[2] = (lY1 * 16) - lNY;
+        plX[3] = (lX0 * 16) - lNX;
+        plY[3] = (lY0 * 16) - lNY;
+    }
+
+    lYMin = ((lY0 < lY1) ? lY0 : lY1) - lRadius;
+    lYMax = ((lY0 > lY1) ? lY0 : lY1) + lRadius;
+    for(lY = lYMin; lY <= lYMax; lY++)
+    {
+        lLeft = 0x7fffffff;
+        lRight = -0x7fffffff;
+
+        //
+        // The rows of the round ends.
+        //
+        lHalf = BrushHalfWidth(lRadius, lY - lY0);
+        if(lHalf >= 0)
+        {
+            lLeft = lX0 - lHalf;
+            lRight = lX0 + lHalf;
+        }
+        lHalf = BrushHalfWidth(lRadius, lY - lY1);
+        if(lHalf >= 0)
+        {
+            lLeft = ((lX1 - lHalf) < lLeft) ? (lX1 - lHalf) : lLeft;
+            lRight = ((lX1 + lHalf) > lRight) ? (lX1 + lHalf) : lRight;
+        }
+
+        //
+        // The row of the band, from where the row crosses its edges.
+        //
+        for(lIdx = 0; lLen && (lIdx < 4); lIdx++)
+        {
+            lNext = (lIdx + 1) & 3;
+            if((plY[lIdx] == plY[lNext]) ||
+               (((lY * 16) < plY[lIdx]) && ((lY * 16) < plY[lNext])) ||
+               (((lY * 16) > plY[lIdx]) && ((lY * 16) > plY[lNext])))
+            {
+                continue;
+            }
+            lX = (plX[lIdx] + ((((lY * 16) - plY[lIdx]) *
+                                (plX[lNext] - plX[lIdx])) /
+                               (plY[lNext] - plY[lIdx])));
+            lLeft = (((lX + 15) >> 4) < lLeft) ? ((lX + 15) >> 4) : lLeft;
+            lRight = ((lX >> 4) > lRight) ? (lX >> 4) : lRight;
+        }
+
+        if(lLeft > lRight)
+        {
+            continue;
+        }
+
+        //
+        // Leave out the round end already drawn by the previous segment.
+        //
+        lHalf = ((lCapRadius < 0) ? -1 :
+                 BrushHalfWidth(lCapRadius, lY - lY0));
+        if(lHalf >= 0)
+        {
+            BrushSpanAdd(lY, lLeft, lX0 - lHalf - 1);
+            BrushSpanAdd(lY, lX0 + lHalf + 1, lRight);
+        }
+        else
+        {
+            BrushSpanAdd(lY, lLeft, lRight);
+        }
+    }
+
+    BrushSpansFlush();
+}
+
+//*****************************************************************************
+//
+// Starts a smoothed stroke with a dot of the brush at its first point.
+//
+//*****************************************************************************
+static void
+SmoothBegin(tSmooth *psSmooth, long lX, long lY, long lRadius)
+{
+    psSmooth->lX = psSmooth->lDrawnX = lX;
+    psSmooth->lY = psSmooth->lDrawnY = lY;
+    psSmooth->lMX2 = lX * 2;
+    psSmooth->lMY2 = lY * 2;
+    psSmooth->lCapRadius = lRadius;
+    BrushSegment(lX, lY, lX, lY, lRadius, -1);
+}
+
+//*****************************************************************************
+//
+// Draws a quadratic Bezier curve, given in half pixels, from the end of the
+// curve drawn so far.  The length of the curve is estimated from its control
+// polygon, each side taken as the larger of its axis differences plus half
+// of the smaller.
+//
+//*****************************************************************************
+static void
+SmoothCurve(tSmooth *psSmooth, long lCX2, long lCY2, long lEX2, long lEY2,
+            long lRadius)
+{
+    long lLen, lDX, lDY, lSteps, lStep, lA, lB, lC, lDen, lX, lY;
+
+    lDX = lCX2 - psSmooth->lMX2;
+    lDY = lCY2 - psSmooth->lMY2;
+    lDX = (lDX < 0) ? -lDX : lDX;
+    lDY = (lDY < 0) ? -lDY : lDY;
+    lLen = (lDX > lDY) ? (lDX + (lDY / 2)) : (lDY + (lDX / 2));
+    lDX = lEX2 - lCX2;
+    lDY = lEY2 - lCY2;
+    lDX = (lDX < 0) ? -lDX : lDX;
+    lDY = (lDY < 0) ? -lDY : lDY;
+    lLen += (lDX > lDY) ? (lDX + (lDY / 2)) : (lDY + (lDX / 2));
+
+    lSteps = lLen / (SMOOTH_STEP * 2);
+    lSteps = ((lSteps < 1) ? 1 :
+              ((lSteps > SMOOTH_STEPS_MAX) ? SMOOTH_STEPS_MAX : lSteps));
+
+    //
+    // Step along the curve, rounding each point to the nearest pixel and
+    // drawing a piece to it if it is not where the last piece ended.
+    //
+    lDen = lSteps * lSteps * 2;
+    for(lStep = 1; lStep <= lSteps; lStep++)
+    {
+        lA = (lSteps - lStep) * (lSteps - lStep);
+        lB = 2 * lStep * (lSteps - lStep);
+        lC = lStep * lStep;
+        lX = ((lA * psSmooth->lMX2) + (lB * lCX2) + (lC * lEX2) +
+              (lDen / 2)) / lDen;
+        lY = ((lA * psSmooth->lMY2) + (lB * lCY2) + (lC * lEY2) +
+              (lDen / 2)) / lDen;
+        if((lX != psSmooth->lDrawnX) || (lY != psSmooth->lDrawnY))
+        {
+#ifdef SCRIBBLE_BENCH
+            unsigned long ulStart, ulCycles;
+
+            ulStart = HWREG(DWT_CYCCNT);
+            BrushSegment(psSmooth->lDrawnX, psSmooth->lDrawnY, lX, lY,
+                         lRadius, psSmooth->lCapRadius);
+            ulCycles = HWREG(DWT_CYCCNT) - ulStart;
+            g_ulBenchSegments++;
+            g_ulBenchSegmentCycles += ulCycles;
+            if(ulCycles > g_ulBenchSegmentMax)
+            {
+                g_ulBenchSegmentMax = ulCycles;
+            }
+#else
+            BrushSegment(psSmooth->lDrawnX, psSmooth->lDrawnY, lX, lY,
+                         lRadius, psSmooth->lCapRadius);
+#endif
+            psSmooth->lDrawnX = lX;
+            psSmooth->lDrawnY = lY;
+            psSmooth->lCapRadius = lRadius;
+        }
+    }
+
+    psSmooth->lMX2 = lEX2;
+    psSmooth->lMY2 = lEY2;
+}
+
+//*****************************************************************************
+//
+// Adds a point to a smoothed stroke, drawing the curve around the point
+// before it.
+//
+//*****************************************************************************
+static void
+SmoothAdd(tSmooth *psSmooth, long lX, long lY, long lRadius)
+{
+    SmoothCurve(psSmooth, psSmooth->lX * 2, psSmooth->lY * 2,
+                psSmooth->lX + lX, psSmooth->lY + lY, lRadius);
+    psSmooth->lX = lX;
+    psSmooth->lY = lY;
+}
+
+//*****************************************************************************
+//
+// Ends a smoothed stroke, drawing it on to its last point.  If the round end
+// at the last point was erased and nothing has been drawn over it since, it
+// is drawn again here.
+//
+//*****************************************************************************
+static void
+SmoothEnd(tSmooth *psSmooth, long lRadius)
+{
+    SmoothCurve(psSmooth, psSmooth->lX * 2, psSmooth->lY * 2,
+                psSmooth->lX * 2, psSmooth->lY * 2, lRadius);
+    if(psSmooth->lCapRadius < 0)
+    {
+        BrushSegment(psSmooth->lDrawnX, psSmooth->lDrawnY,
+                     psSmooth->lDrawnX, psSmooth->lDrawnY, lRadius, -1);
+        psSmooth->lCapRadius = lRadius;
+    }
+}
+
+//*****************************************************************************
+//
+// Removes the oldest stroke from the store.
+//
+//*****************************************************************************
+static void
+StrokeDropOldest(void)
+{
+    unsigned long ulIdx, ulBytes;
+
+    ulBytes = g_psStrokes[0].usBytes;
+    memmove(g_pucStrokeArena, g_pucStrokeArena + ulBytes,
+            g_ulStrokeUsed - ulBytes);
+    g_ulStrokeUsed -= ulBytes;
+
+    for(ulIdx = 1; ulIdx < g_ulStrokes; ulIdx++)
+    {
+        g_psStrokes[ulIdx - 1] = g_psStrokes[ulIdx];
+        g_psStrokes[ulIdx - 1].usOffset -= ulBytes;
+    }
+    g_ulStrokes--;
+}
+
+//*****************************************************************************
+//
+// Makes room in the arena for more bytes of the current stroke by dropping
+// older strokes.  Returns false if the current stroke fills the arena by
+// itself.
+//
+//*****************************************************************************
+static bool
+StrokeReserve(unsigned long ulBytes)
+{
+    while((g_ulStrokeUsed + ulBytes) > STROKE_ARENA_SIZE)
+    {
+        if(g_ulStrokes < 2)
+        {
+            return(false);
+        }
+        StrokeDropOldest();
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Starts storing a new stroke in the given color.
+//
+//*****************************************************************************
+static void
+StrokeBegin(unsigned long ulColor, unsigned long ulRadius)
+{
+    tStroke *psStroke;
+
+    if(g_ulStrokes == STROKE_MAX)
+    {
+        StrokeDropOldest();
+    }
+
+    psStroke = &g_psStrokes[g_ulStrokes++];
+    psStroke->usOffset = g_ulStrokeUsed;
+    psStroke->usBytes = 0;
+    psStroke->usPoints = 0;
+    psStroke->ucColor = ulColor;
+    psStroke->ucRadius = ulRadius;
+    g_ulStrokeRadius = ulRadius;
+    g_ulStrokeRadiusMax = ulRadius;
+    g_bStrokeRecording = true;
+}
+
+//*****************************************************************************
+//
+// Changes the brush radius for the segments stored after this, growing the
+// bounds of the stroke if the radius is the largest yet.
+//
+//*****************************************************************************
+static void
+StrokeRadiusSet(unsigned long ulRadius)
+{
+    tStroke *psStroke;
+    long lGrow;
+
+    if(!g_bStrokeRecording || (ulRadius == g_ulStrokeRadius))
+    {
+        return;
+    }
+
+    psStroke = &g_psStrokes[g_ulStrokes - 1];
+    if(ulRadius > g_ulStrokeRadiusMax)
+    {
+        if(psStroke->usPoints)
+        {
+            lGrow = ulRadius - g_ulStrokeRadiusMax;
+            psStroke->sBounds.i16XMin -= lGrow;
+            psStroke->sBounds.i16YMin -= lGrow;
+            psStroke->sBounds.i16XMax += lGrow;
+            psStroke->sBounds.i16YMax += lGrow;
+        }
+        g_ulStrokeRadiusMax = ulRadius;
+    }
+
+    if(!StrokeReserve(2))
+    {
+        g_bStrokeRecording = false;
+        return;
+    }
+
+    g_pucStrokeArena[g_ulStrokeUsed] = STROKE_ESC_RADIUS;
+    g_pucStrokeArena[g_ulStrokeUsed + 1] = ulRadius;
+    g_ulStrokeUsed += 2;
+    g_psStrokes[g_ulStrokes - 1].usBytes += 2;
+    g_ulStrokeRadius = ulRadius;
+}
+
+//*****************************************************************************
+//
+// Adds a point to the stroke being stored.
+//
+//*****************************************************************************
+static void
+StrokeAdd(long lX, long lY)
+{
+    tStroke *psStroke;
+    unsigned char *pucData;
+    unsigned long ulBytes;
+    long lDX, lDY, lR;
+
+    if(!g_bStrokeRecording)
+    {
+        return;
+    }
+
+    //
+    // Find the smallest encoding for the point.
+    //
+    lDX = lX - g_lStrokeX;
+    lDY = lY - g_lStrokeY;
+    if(!g_psStrokes[g_ulStrokes - 1].usPoints)
+    {
+        ulBytes = 4;
+    }
+    else if(!lDX && !lDY)
+    {
+        return;
+    }
+    else if((lDX >= -7) && (lDX <= 7) && (lDY >= -7) && (lDY <= 7))
+    {
+        ulBytes = 1;
+    }
+    else if((lDX >= -128) && (lDX <= 127) && (lDY >= -128) && (lDY <= 127))
+    {
+        ulBytes = 3;
+    }
+    else
+    {
+        ulBytes = 5;
+    }
+
+    //
+    // Stop storing the stroke if it has outgrown the arena.
+    //
+    if(!StrokeReserve(ulBytes))
+    {
+        g_bStrokeRecording = false;
+        return;
+    }
+    psStroke = &g_psStrokes[g_ulStrokes - 1];
+
+    pucData = g_pucStrokeArena + g_ulStrokeUsed;
+    if(ulBytes == 1)
+    {
+        pucData[0] = ((lDX & 15) << 4) | (lDY & 15);
+    }
+    else if(ulBytes == 3)
+    {
+        pucData[0] = STROKE_ESC_DELTA;
+        pucData[1] = lDX;
+        pucData[2] = lDY;
+    }
+    else
+    {
+        if(ulBytes == 5)
+        {
+            *pucData++ = STROKE_ESC_ABS;
+        }
+        pucData[0] = lX;
+        pucData[1] = lX >> 8;
+        pucData[2] = lY;
+        pucData[3] = lY >> 8;
+    }
+    g_ulStrokeUsed += ulBytes;
+    psStroke->usBytes += ulBytes;
+
+    //
+    // Keep the bounds of the ink up to date.
+    //
+    lR = g_ulStrokeRadiusMax;
+    if(!psStroke->usPoints)
+    {
+        psStroke->sBounds.i16XMin = lX - lR;
+        psStroke->sBounds.i16XMax = lX + lR;
+        psStroke->sBounds.i16YMin = lY - lR;
+        psStroke->sBounds.i16YMax = lY + lR;
+    }
+    else
+    {
+        psStroke->sBounds.i16XMin = (((lX - lR) < psStroke->sBounds.i16XMin) ?
+                                     (lX - lR) : psStroke->sBounds.i16XMin);
+        psStroke->sBounds.i16XMax = (((lX + lR) > psStroke->sBounds.i16XMax) ?
+                                     (lX + lR) : psStroke->sBounds.i16XMax);
+        psStroke->sBounds.i16YMin = (((lY - lR) < psStroke->sBounds.i16YMin) ?
+                                     (lY - lR) : psStroke->sBounds.i16YMin);
+        psStroke->sBounds.i16YMax = (((lY + lR) > psStroke->sBounds.i16YMax) ?
+                                     (lY + lR) : psStroke->sBounds.i16YMax);
+    }
+    psStroke->usPoints++;
+
+    g_lStrokeX = lX;
+    g_lStrokeY = lY;
+}
+
+//*****************************************************************************
+//
+// Reads the next point of a stored stroke, and any change of brush radius
+// before it, updating the position and radius passed in.  Returns a pointer
+// to the data after the point, or 0 if there are no more points.
+//
+//*****************************************************************************
+static const unsigned char *
+StrokePointNext(const unsigned char *pucData, const unsigned char *pucEnd,
+                long *plX, long *plY, long *plRadius)
+{
+    unsigned char ucByte;
+
+    while((pucData < pucEnd) && (*pucData == STROKE_ESC_RADIUS))
+    {
+        *plRadius = pucData[1];
+        pucData += 2;
+    }
+    if(pucData >= pucEnd)
+    {
+        return(0);
+    }
+
+    ucByte = *pucData++;
+    if(ucByte == STROKE_ESC_DELTA)
+    {
+        *plX += (signed char)pucData[0];
+        *plY += (signed char)pucData[1];
+        pucData += 2;
+    }
+    else if(ucByte == STROKE_ESC_ABS)
+    {
+        *plX = (short)(pucData[0] | (pucData[1] << 8));
+        *plY = (short)(pucData[2] | (pucData[3] << 8));
+        pucData += 4;
+    }
+    else
+    {
+        *plX += (signed char)ucByte >> 4;
+        *plY += (signed char)(ucByte << 4) >> 4;
+    }
+
+    return(pucData);
+}
+
+//*****************************************************************************
+//
+// Draws a stored stroke, and returns the number of points in it.
+//
+//*****************************************************************************
+static unsigned long
+StrokeDraw(const tStroke *psStroke)
+{
+    const unsigned char *pucData, *pucEnd;
+    long lX, lY, lRadius;
+    tSmooth sSmooth;
+
+    pucData = g_pucStrokeArena + psStroke->usOffset;
+    pucEnd = pucData + psStroke->usBytes;
+
+    GrContextForegroundSet(&g_sContext, g_pulColors[psStroke->ucColor]);
+
+    //
+    // The stroke is drawn through the same smoothing as when it was drawn
+    // live.
+    //
+    lX = (short)(pucData[0] | (pucData[1] << 8));
+    lY = (short)(pucData[2] | (pucData[3] << 8));
+    pucData += 4;
+    lRadius = psStroke->ucRadius;
+    SmoothBegin(&sSmooth, lX, lY, lRadius);
+
+    while((pucData = StrokePointNext(pucData, pucEnd, &lX, &lY,
+                                     &lRadius)) != 0)
+    {
+        SmoothAdd(&sSmooth, lX, lY, lRadius);
+    }
+    SmoothEnd(&sSmooth, lRadius);
+
+    return(psStroke->usPoints);
+}
+
+//*****************************************************************************
+//
+// Redraws the stored strokes that fall within a part of the scribble area,
+// optionally erasing it first, and returns the number of points drawn.
+//
+//*****************************************************************************
+static unsigned long
+StrokesRedraw(tRectangle *psRect, bool bErase)
+{
+    tRectangle sClip;
+    unsigned long ulIdx, ulPoints;
+
+    if(!GrRectIntersectGet(psRect, &g_sScribbleArea, &sClip))
+    {
+        return(0);
+    }
+    GrContextClipRegionSet(&g_sContext, &sClip);
+
+    if(bErase)
+    {
+        GrContextForegroundSet(&g_sContext, ClrBlack);
+        GrRectFill(&g_sContext, &sClip);
+    }
+
+    ulPoints = 0;
+    for(ulIdx = 0; ulIdx < g_ulStrokes; ulIdx++)
+    {
+        if(GrRectOverlapCheck(&g_psStrokes[ulIdx].sBounds, &sClip))
+        {
+            ulPoints += StrokeDraw(&g_psStrokes[ulIdx]);
+        }
+    }
+
+    GrContextClipRegionSet(&g_sContext, &g_sScribbleArea);
+    GrContextForegroundSet(&g_sContext, g_pulColors[g_ulColorIdx]);
+
+    return(ulPoints);
+}
+
+//*****************************************************************************
+//
+// Shows how long a redraw took, how fast the points were drawn, and how
+// compactly the store holds them, in place of the instructions.
+//
+//*****************************************************************************
+static void
+StrokeReport(unsigned long ulPoints, unsigned long ulCycles)
+{
+    char pcBuffer[64];
+    unsigned long ulUs, ulRate, ulStored, ulIdx;
+
+    ulUs = ulCycles / g_ulCyclesPerUs;
+    ulRate = ulUs ? (((uint64_t)ulPoints * 1000000) / ulUs) : 0;
+
+    //
+    // The size of the store, in tenths of a byte per point.
+    //
+    for(ulIdx = 0, ulStored = 0; ulIdx < g_ulStrokes; ulIdx++)
+    {
+        ulStored += g_psStrokes[ulIdx].usPoints;
+    }
+    ulStored = ulStored ? ((g_ulStrokeUsed * 10) / ulStored) : 0;
+
+    usprintf(pcBuffer, "%d pts in %d ms, %d pts/s, %d.%d bytes/pt",
+             ulPoints, ulUs / 1000, ulRate, ulStored / 10, ulStored % 10);
+    StatusDraw(pcBuffer);
+}
+
+//*****************************************************************************
+//
+// Moves bytes from the stream ring into the UART transmit FIFO until one or
+// the other runs out.  It must not be interrupted by the UART interrupt.
+//
+//*****************************************************************************
+static void
+StreamFill(void)
+{
+    unsigned long ulRead;
+
+    ulRead = g_ulStreamRead;
+    while((ulRead != g_ulStreamWrite) && UARTSpaceAvail(UART0_BASE))
+    {
+        UARTCharPutNonBlocking(UART0_BASE,
+                               g_pucStreamRing[ulRead &
+                                               (STREAM_RING_SIZE - 1)]);
+        ulRead++;
+    }
+    g_ulStreamRead = ulRead;
+}
+
+//*****************************************************************************
+//
+// This is the handler for the UART0 interrupt, which refills the transmit
+// FIFO from the stream ring, and is turned off once the ring is empty.
+//
+//*****************************************************************************
+void
+UARTIntHandler(void)
+{
+    UARTIntClear(UART0_BASE, UARTIntStatus(UART0_BASE, true));
+
+    StreamFill();
+    if(g_ulStreamRead == g_ulStreamWrite)
+    {
+        UARTIntDisable(UART0_BASE, UART_INT_TX);
+    }
+}
+
+//*****************************************************************************
+//
+// Writes an unsigned LEB128 varint, and returns the number of bytes used.
+//
+//*****************************************************************************
+static unsigned long
+StreamVarint(unsigned char *pucBuffer, unsigned long ulValue)
+{
+    unsigned long ulCount;
+
+    for(ulCount = 0; ulValue >= 0x80; ulCount++, ulValue >>= 7)
+    {
+        pucBuffer[ulCount] = (ulValue & 0x7f) | 0x80;
+    }
+    pucBuffer[ulCount++] = ulValue;
+
+    return(ulCount);
+}
+
+//*****************************************************************************
+//
+// Zigzag encodes a signed value, so that small values of either sign make
+// short varints.
+//
+//*****************************************************************************
+static unsigned long
+StreamZigzag(long lValue)
+{
+    return((lValue < 0) ? ((((unsigned long)-lValue) * 2) - 1) :
+           ((unsigned long)lValue * 2));
+}
+
+//*****************************************************************************
+//
+// Puts a frame into the stream ring, or drops it if there is no room, and
+// starts the UART on it.
+//
+//*****************************************************************************
+static void
+StreamFrame(unsigned long ulType, const unsigned char *pucPayload,
+            unsigned long ulLength)
+{
+    unsigned char pucHeader[4];
+    unsigned long ulWrite, ulUsed, ulIdx;
+    unsigned short usCRC;
+
+    pucHeader[0] = STREAM_SYNC;
+    pucHeader[1] = ulType;
+    pucHeader[2] = g_ucStreamSeq++;
+    pucHeader[3] = ulLength;
+
+    ulWrite = g_ulStreamWrite;
+    ulUsed = ulWrite - g_ulStreamRead;
+    if((ulUsed + ulLength + 6) > STREAM_RING_SIZE)
+    {
+        g_ulStreamDropped++;
+        return;
+    }
+
+    usCRC = Crc16(0, pucHeader + 1, 3);
+    usCRC = Crc16(usCRC, pucPayload, ulLength);
+
+    for(ulIdx = 0; ulIdx < 4; ulIdx++, ulWrite++)
+    {
+        g_pucStreamRing[ulWrite & (STREAM_RING_SIZE - 1)] = pucHeader[ulIdx];
+    }
+    for(ulIdx = 0; ulIdx < ulLength; ulIdx++, ulWrite++)
+    {
+        g_pucStreamRing[ulWrite & (STREAM_RING_SIZE - 1)] = pucPayload[ulIdx];
+    }
+    g_pucStreamRing[ulWrite++ & (STREAM_RING_SIZE - 1)] = usCRC & 0xff;
+    g_pucStreamRing[ulWrite++ & (STREAM_RING_SIZE - 1)] = usCRC >> 8;
+
+    g_ulStreamFrames++;
+    g_ulStreamBytes += ulLength + 6;
+    ulUsed += ulLength + 6;
+    if(ulUsed > g_ulStreamHighWater)
+    {
+        g_ulStreamHighWater = ulUsed;
+    }
+
+    //
+    // Publish the frame, then prime the FIFO.  The transmit interrupt only
+    // fires as the FIFO drains, so it is kept off while this is done.
+    //
+    g_ulStreamWrite = ulWrite;
+    UARTIntDisable(UART0_BASE, UART_INT_TX);
+    StreamFill();
+    if(g_ulStreamRead != g_ulStreamWrite)
+    {
+        UARTIntEnable(UART0_BASE, UART_INT_TX);
+    }
+}
+
+//*****************************************************************************
+//
+// Sends the points gathered so far, if any.
+//
+//*****************************************************************************
+static void
+StreamPointsFlush(void)
+{
+    if(g_ulStreamPayload)
+    {
+        StreamFrame(STREAM_POINTS, g_pucStreamPayload, g_ulStreamPayload);
+        g_ulStreamPayload = 0;
+    }
+}
 
 //*****************************************************************************
 //
-//! \addtogroup example_list
-//! <h1>Scribble Pad (scribble)</h1>
-//!
-//! The scribble pad provides a drawing area on the screen.  Touching the
-//! screen will draw onto the drawing area using a selection of fundamental
-//! colors (in other words, the seven colors produced by the three color
-//! channels being either fully on or fully off).  Each time the screen is
-//! touched to start a new drawing, the drawing area is erased and the next
-//! color is selected.
+// Sends the start of a stroke.
 //
 //*****************************************************************************
+static void
+StreamStart(unsigned long ulColor, unsigned long ulRadius, long lX, long lY,
+            unsigned long ulTime)
+{
+    unsigned char pucBuffer[20];
+    unsigned long ulLength;
+
+    ulLength = StreamVarint(pucBuffer, ulColor);
+    ulLength += StreamVarint(pucBuffer + ulLength, ulRadius);
+    ulLength += StreamVarint(pucBuffer + ulLength, StreamZigzag(lX));
+    ulLength += StreamVarint(pucBuffer + ulLength, StreamZigzag(lY));
+    StreamFrame(STREAM_START, pucBuffer, ulLength);
+
+    g_ulStreamRadius = ulRadius;
+    g_ulStreamPoints = 1;
+    g_ulStreamStart = ulTime;
+    g_lStreamX = lX;
+    g_lStreamY = lY;
+}
 
 //*****************************************************************************
 //
-// A structure used to pass touchscreen messages from the interrupt-context
-// handler function to the main loop for processing.
+// Adds a point to the stroke being sent, changing the brush radius first if
+// need be.
 //
 //*****************************************************************************
-typedef struct
+static void
+StreamPoint(long lX, long lY, unsigned long ulRadius, unsigned long ulTime)
 {
-    unsigned long ulMsg;
-    long lX;
-    long lY;
+    unsigned char pucBuffer[10];
+    unsigned long ulLength;
+
+    if(ulRadius != g_ulStreamRadius)
+    {
+        StreamPointsFlush();
+        ulLength = StreamVarint(pucBuffer, ulRadius);
+        StreamFrame(STREAM_RADIUS, pucBuffer, ulLength);
+        g_ulStreamRadius = ulRadius;
+    }
+
+    ulLength = StreamVarint(pucBuffer, StreamZigzag(lX - g_lStreamX));
+    ulLength += StreamVarint(pucBuffer + ulLength,
+                             StreamZigzag(lY - g_lStreamY));
+    if((g_ulStreamPayload + ulLength) > STREAM_PAYLOAD)
+    {
+        StreamPointsFlush();
+    }
+    if(!g_ulStreamPayload)
+    {
+        g_ulStreamPayloadTime = ulTime;
+    }
+    memcpy(g_pucStreamPayload + g_ulStreamPayload, pucBuffer, ulLength);
+    g_ulStreamPayload += ulLength;
+
+    g_ulStreamPoints++;
+    g_lStreamX = lX;
+    g_lStreamY = lY;
+}
+
+//*****************************************************************************
+//
+// Sends the end of the stroke.
+//
+//*****************************************************************************
+static void
+StreamEnd(unsigned long ulTime)
+{
+    unsigned char pucBuffer[15];
+    unsigned long ulLength;
+
+    StreamPointsFlush();
+
+    ulLength = StreamVarint(pucBuffer, g_ulStreamPoints);
+    ulLength += StreamVarint(pucBuffer + ulLength,
+                             ((ulTime - g_ulStreamStart) /
+                              (g_ulCyclesPerUs * 1000)));
+    ulLength += StreamVarint(pucBuffer + ulLength, g_ulStreamDropped);
+    StreamFrame(STREAM_END, pucBuffer, ulLength);
 }
-tScribbleMessage;
 
 //*****************************************************************************
 //
-// The number of messages we can store in the message queue.
+// Sends any points that have waited for longer than STREAM_LATENCY.  This is
+// called from the main loop, so that the points of a pen that has stopped
+// moving are not held back.
 //
 //*****************************************************************************
-#define MSG_QUEUE_SIZE 16
+static void
+StreamService(void)
+{
+    if(g_ulStreamPayload &&
+       ((HWREG(DWT_CYCCNT) - g_ulStreamPayloadTime) >
+        (STREAM_LATENCY * 1000 * g_ulCyclesPerUs)))
+    {
+        StreamPointsFlush();
+    }
+}
 
 //*****************************************************************************
 //
-// The ring buffer memory and control structure we use to implement the
-// message queue.
+// Notes a change of brush radius in the current stroke.  The brush drawn up
+// to the next point with a larger radius also grows around the points
+// before it, so the area holding ink is grown by the difference.
 //
 //*****************************************************************************
-static tScribbleMessage g_psMsgQueueBuffer[MSG_QUEUE_SIZE];
-static tRingBufObject g_sMsgQueue;
+static void
+InkRadiusSet(unsigned long ulRadius)
+{
+    long lGrow;
+
+    if(ulRadius <= g_ulInkRadius)
+    {
+        return;
+    }
+
+    lGrow = ulRadius - g_ulInkRadius;
+    g_ulInkRadius = ulRadius;
+    if(g_bInk)
+    {
+        g_sInkBounds.i16XMin -= lGrow;
+        g_sInkBounds.i16YMin -= lGrow;
+        g_sInkBounds.i16XMax += lGrow;
+        g_sInkBounds.i16YMax += lGrow;
+    }
+}
 
 //*****************************************************************************
 //
-// The error routine that is called if the driver library encounters an error.
+// Adds a point of a stroke, and the brush around it, to the area holding
+// ink.
 //
 //*****************************************************************************
-#ifdef DEBUG
-void
-__error__(char *pcFilename, unsigned long ulLine)
+static void
+InkAdd(long lX, long lY, long lRadius)
 {
+    if(!g_bInk)
+    {
+        g_sInkBounds.i16XMin = lX - lRadius;
+        g_sInkBounds.i16YMin = lY - lRadius;
+        g_sInkBounds.i16XMax = lX + lRadius;
+        g_sInkBounds.i16YMax = lY + lRadius;
+        g_bInk = true;
+        return;
+    }
+    g_sInkBounds.i16XMin = (((lX - lRadius) < g_sInkBounds.i16XMin) ?
+                            (lX - lRadius) : g_sInkBounds.i16XMin);
+    g_sInkBounds.i16YMin = (((lY - lRadius) < g_sInkBounds.i16YMin) ?
+                            (lY - lRadius) : g_sInkBounds.i16YMin);
+    g_sInkBounds.i16XMax = (((lX + lRadius) > g_sInkBounds.i16XMax) ?
+                            (lX + lRadius) : g_sInkBounds.i16XMax);
+    g_sInkBounds.i16YMax = (((lY + lRadius) > g_sInkBounds.i16YMax) ?
+                            (lY + lRadius) : g_sInkBounds.i16YMax);
 }
+
+//*****************************************************************************
+//
+// Handles a touch of the banner: undo at the left, clear at the right, and
+// a full redraw in between.
+//
+//*****************************************************************************
+static void
+ScribbleCommand(long lX)
+{
+    tRectangle sRect;
+    unsigned long ulStart, ulPoints;
+    char pcBuffer[32];
+
+    ulStart = HWREG(DWT_CYCCNT);
+
+    if(lX < BUTTON_WIDTH)
+    {
+        //
+        // Remove the last stroke and redraw what was underneath it.
+        //
+        if(!g_ulStrokes)
+        {
+            return;
+        }
+        g_ulStrokes--;
+        g_ulStrokeUsed = g_psStrokes[g_ulStrokes].usOffset;
+        StreamFrame(STREAM_UNDO, 0, 0);
+        sRect = g_psStrokes[g_ulStrokes].sBounds;
+        ulPoints = StrokesRedraw(&sRect, true);
+    }
+    else if(lX >= (GrContextDpyWidthGet(&g_sContext) - BUTTON_WIDTH))
+    {
+        //
+        // Forget all the strokes, and erase only the part of the scribble
+        // area that holds ink.  The fill is left running rather than
+        // flushed: a large one is sent by the uDMA controller, in the
+        // background, and the display driver holds back the first segment
+        // of the next stroke only until it has gone.
+        //
+        g_ulStrokes = 0;
+        g_ulStrokeUsed = 0;
+        StreamFrame(STREAM_CLEAR, 0, 0);
+        if(g_bInk &&
+           GrRectIntersectGet(&g_sInkBounds, &g_sScribbleArea, &sRect))
+        {
+            usprintf(pcBuffer, "Cleared %d x %d pixels",
+                     sRect.i16XMax - sRect.i16XMin + 1,
+                     sRect.i16YMax - sRect.i16YMin + 1);
+            StatusDraw(pcBuffer);
+            GrContextForegroundSet(&g_sContext, ClrBlack);
+            GrRectFill(&g_sContext, &sRect);
+            GrContextForegroundSet(&g_sContext, g_pulColors[g_ulColorIdx]);
+        }
+        g_bInk = false;
+        return;
+    }
+    else
+    {
+#ifdef SCRIBBLE_BENCH
+        //
+        // Start the benchmark once the pen is lifted from the banner, so
+        // that the pen up message does not land in the replayed strokes.
+        //
+        g_bBenchRequest = !g_bBenchRunning;
+        return;
+#else
+        ulPoints = StrokesRedraw(&g_sScribbleArea, true);
 #endif
+    }
+
+    //
+    // Time the redraw up to the last pixel reaching the display.
+    //
+    GrFlush(&g_sContext);
+    StrokeReport(ulPoints, HWREG(DWT_CYCCNT) - ulStart);
+    GrFlush(&g_sContext);
+}
 
+#ifdef SCRIBBLE_BENCH
 //*****************************************************************************
 //
-// The colors that are used to draw on the screen.
+// Adds a point to those fed in by the benchmark.
 //
 //*****************************************************************************
-static const unsigned long g_pulColors[] =
+static void
+BenchPointAdd(long lX, long lY, long lRadius, unsigned long ulFlags)
 {
-    ClrWhite,
-    ClrYellow,
-    ClrMagenta,
-    ClrRed,
-    ClrCyan,
-    ClrLime,
-    ClrBlue
-};
+    if(g_ulBenchPoints == BENCH_POINTS_MAX)
+    {
+        return;
+    }
+    g_psBenchPoints[g_ulBenchPoints].sX = lX;
+    g_psBenchPoints[g_ulBenchPoints].sY = lY;
+    g_psBenchPoints[g_ulBenchPoints].ucRadius = lRadius;
+    g_psBenchPoints[g_ulBenchPoints].ucFlags = ulFlags;
+    g_ulBenchPoints++;
+}
 
 //*****************************************************************************
 //
-// The index to the current color in use.
+// Gathers the points for the benchmark from the newest stored strokes that
+// fit, or makes up a set of zig-zag strokes of each brush radius across the
+// scribble area if there are none.
 //
 //*****************************************************************************
-static unsigned long g_ulColorIdx;
+static void
+BenchPointsLoad(void)
+{
+    const unsigned char *pucData, *pucEnd;
+    unsigned long ulFirst, ulIdx, ulPoints;
+    long lX, lY, lRadius, lStroke;
+
+    g_ulBenchPoints = 0;
+
+    //
+    // Find the oldest of the newest strokes that fit.
+    //
+    for(ulFirst = g_ulStrokes, ulPoints = 0; ulFirst; ulFirst--)
+    {
+        if((ulPoints + g_psStrokes[ulFirst - 1].usPoints) > BENCH_POINTS_MAX)
+        {
+            break;
+        }
+        ulPoints += g_psStrokes[ulFirst - 1].usPoints;
+    }
+
+    for(ulIdx = ulFirst; ulIdx < g_ulStrokes; ulIdx++)
+    {
+        pucData = g_pucStrokeArena + g_psStrokes[ulIdx].usOffset;
+        pucEnd = pucData + g_psStrokes[ulIdx].usBytes;
+        lX = (short)(pucData[0] | (pucData[1] << 8));
+        lY = (short)(pucData[2] | (pucData[3] << 8));
+        lRadius = g_psStrokes[ulIdx].ucRadius;
+        BenchPointAdd(lX, lY, lRadius, BENCH_FIRST);
+        pucData += 4;
+        while((pucData = StrokePointNext(pucData, pucEnd, &lX, &lY,
+                                         &lRadius)) != 0)
+        {
+            BenchPointAdd(lX, lY, lRadius, 0);
+        }
+        g_psBenchPoints[g_ulBenchPoints - 1].ucFlags |= BENCH_LAST;
+    }
+
+    if(g_ulBenchPoints)
+    {
+        return;
+    }
+
+    //
+    // There are no strokes, so make some up: rows of zig-zags, moving four
+    // pixels to the right and two up or down at each point.
+    //
+    for(lStroke = 0; lStroke < 8; lStroke++)
+    {
+        lRadius = g_ulBrushMin + (lStroke % (g_ulBrushMax - g_ulBrushMin + 1));
+        for(ulIdx = 0; ulIdx < (BENCH_POINTS_MAX / 8); ulIdx++)
+        {
+            lX = g_sScribbleArea.i16XMin + 16 + (ulIdx * 4);
+            lY = ((ulIdx & 8) ? (8 - (ulIdx & 7)) : (ulIdx & 7)) * 2;
+            lY += g_sScribbleArea.i16YMin + 8 + (lStroke * 20);
+            BenchPointAdd(lX, lY, lRadius,
+                          ((ulIdx == 0) ? BENCH_FIRST :
+                           ((ulIdx == ((BENCH_POINTS_MAX / 8) - 1)) ?
+                            BENCH_LAST : 0)));
+        }
+    }
+}
 
 //*****************************************************************************
 //
-// The previous pen position returned from the touch screen driver.
+// Starts feeding points into the touch screen event queue at the current
+// rate.
 //
 //*****************************************************************************
-static long g_lX, g_lY;
+static void
+BenchRun(void)
+{
+    TouchScreenEventStats(0, 0, 0, true);
+    g_ulBenchNext = 0;
+    g_ulBenchTicks = g_pulBenchRates[g_ulBenchRate] * BENCH_SECONDS;
+    g_ulBenchFed = 0;
+    g_ulBenchHandled = 0;
+    g_ulBenchHandleCycles = 0;
+    g_ulBenchSegments = 0;
+    g_ulBenchSegmentCycles = 0;
+    g_ulBenchSegmentMax = 0;
+    g_ulBenchStart = HWREG(DWT_CYCCNT);
+
+    g_bBenchFeeding = true;
+    SysTickPeriodSet(SysCtlClockGet() / g_pulBenchRates[g_ulBenchRate]);
+    SysTickIntEnable();
+    SysTickEnable();
+}
 
 //*****************************************************************************
 //
-// The drawing context used to draw to the screen.
+// Starts the benchmark, from the lowest rate.
 //
 //*****************************************************************************
-static tContext g_sContext;
+static void
+BenchStart(void)
+{
+    BenchPointsLoad();
+    g_bBenchRunning = true;
+    g_ulBenchRate = 0;
+    g_ulBenchBest = 0;
+    StatusDraw("Benchmark running");
+    GrFlush(&g_sContext);
+    BenchRun();
+}
+
+//*****************************************************************************
+//
+// Feeds the next point of the benchmark into the touch screen event queue.
+// This is called from the SysTick handler, which runs at the same priority
+// as the touch screen driver's interrupts.
+//
+//*****************************************************************************
+static void
+BenchFeed(void)
+{
+    tBenchPoint *psPoint;
+    unsigned long ulMessage, ulPressure;
+
+    //
+    // Feed points until the run is over and the stroke being fed has ended.
+    //
+    psPoint = &g_psBenchPoints[g_ulBenchNext];
+    if(!g_ulBenchTicks && (psPoint->ucFlags & BENCH_FIRST))
+    {
+        SysTickIntDisable();
+        SysTickDisable();
+        g_bBenchFeeding = false;
+        return;
+    }
+    if(g_ulBenchTicks)
+    {
+        g_ulBenchTicks--;
+    }
+
+    ulMessage = ((psPoint->ucFlags & BENCH_FIRST) ? WIDGET_MSG_PTR_DOWN :
+                 ((psPoint->ucFlags & BENCH_LAST) ? WIDGET_MSG_PTR_UP :
+                  WIDGET_MSG_PTR_MOVE));
+
+    //
+    // Pick the pressure in the middle of those that give the brush radius
+    // the point was drawn with.
+    //
+    ulPressure = (TOUCH_PRESSURE_MIN +
+                  ((((psPoint->ucRadius - g_ulBrushMin) * 2) + 1) *
+                   (4096 - TOUCH_PRESSURE_MIN)) /
+                  ((g_ulBrushMax - g_ulBrushMin + 1) * 2));
+
+    TouchScreenEventInject(ulMessage, psPoint->sX, psPoint->sY, ulPressure);
+    g_ulBenchFed++;
+
+    //
+    // A stroke of a single point is a tap, which is lifted straight away.
+    //
+    if((psPoint->ucFlags & (BENCH_FIRST | BENCH_LAST)) ==
+       (BENCH_FIRST | BENCH_LAST))
+    {
+        TouchScreenEventInject(WIDGET_MSG_PTR_UP, psPoint->sX, psPoint->sY,
+                               ulPressure);
+        g_ulBenchFed++;
+    }
+
+    if(++g_ulBenchNext == g_ulBenchPoints)
+    {
+        g_ulBenchNext = 0;
+    }
+}
 
 //*****************************************************************************
 //
-// The interrupt-context handler for touch screen events from the touch screen
-// driver.  This function merely bundles up the event parameters and posts
-// them to a message queue.  In the context of the main loop, they will be
-// read from the queue and handled using TSMainHandler().
+// Reports the results of a benchmark run, on the screen and as a
+// STREAM_BENCH frame holding, in order: the rate at which points were fed
+// in, the number fed in, the number of messages handled, the rate at which
+// they were handled, the most entries in use in the event queue, the number
+// of messages merged and dropped by the queue, the number of stroke
+// segments drawn, and the average and longest time to draw a segment and
+// the average time to handle a message, in tenths of a microsecond.
 //
 //*****************************************************************************
-int32_t TSHandler(uint32_t ulMessage, int32_t lX, int32_t lY)
+static void
+BenchReport(unsigned long ulCycles)
 {
-    tScribbleMessage sMsg;
+    unsigned char pucBuffer[60];
+    char pcBuffer[64];
+    unsigned long pulResults[11], ulIdx, ulLength;
+    uint32_t ulCoalesced, ulOverflows, ulHighWater;
+
+    TouchScreenEventStats(&ulCoalesced, &ulOverflows, &ulHighWater, false);
+
+    pulResults[0] = g_pulBenchRates[g_ulBenchRate];
+    pulResults[1] = g_ulBenchFed;
+    pulResults[2] = g_ulBenchHandled;
+    pulResults[3] = (((uint64_t)g_ulBenchHandled * g_ulCyclesPerUs *
+                      1000000) / ulCycles);
+    pulResults[4] = ulHighWater;
+    pulResults[5] = ulCoalesced;
+    pulResults[6] = ulOverflows;
+    pulResults[7] = g_ulBenchSegments;
+    pulResults[8] = (g_ulBenchSegments ?
+                     ((g_ulBenchSegmentCycles * 10) /
+                      (g_ulBenchSegments * g_ulCyclesPerUs)) : 0);
+    pulResults[9] = (g_ulBenchSegmentMax * 10) / g_ulCyclesPerUs;
+    pulResults[10] = (g_ulBenchHandled ?
+                      ((g_ulBenchHandleCycles * 10) /
+                       (g_ulBenchHandled * g_ulCyclesPerUs)) : 0);
+
+    for(ulIdx = 0, ulLength = 0; ulIdx < 11; ulIdx++)
+    {
+        ulLength += StreamVarint(pucBuffer + ulLength, pulResults[ulIdx]);
+    }
+    StreamFrame(STREAM_BENCH, pucBuffer, ulLength);
 
     //
-    // Build the message that we will write to the queue.
+    // Merged moves only lose the positions between two that are drawn, while
+    // dropped messages may lose a pen down or up, so they are shown apart.
+    // The queue depth and drawing times are left to the STREAM_BENCH frame
+    // so that the line fits on the screen.
     //
-    sMsg.ulMsg = ulMessage;
-    sMsg.lX = lX;
-    sMsg.lY = lY;
+    usprintf(pcBuffer, "%d/s: %d pts/s, %d merged, %d dropped",
+             pulResults[0], pulResults[3], pulResults[5], pulResults[6]);
+    StatusDraw(pcBuffer);
 
     //
-    // Make sure the queue isn't full. If it is, we just ignore this message.
+    // Keep the highest rate that was kept up with, without any messages
+    // being merged or dropped.
     //
-    if(!RingBufFull(&g_sMsgQueue))
+    if(!ulCoalesced && !ulOverflows)
     {
-        RingBufWrite(&g_sMsgQueue, (unsigned char *)&sMsg,
-                     sizeof(tScribbleMessage));
+        g_ulBenchBest = pulResults[0];
     }
+}
+
+//*****************************************************************************
+//
+// Moves the benchmark on once the points of a run have all been fed in and
+// handled.  This is called from the main loop.
+//
+//*****************************************************************************
+static void
+BenchService(void)
+{
+    unsigned long ulCycles;
+    char pcBuffer[48];
 
     //
-    // Tell the touch handler that everything is fine.
+    // The feeding must be seen to have stopped before the queue is seen to
+    // be empty, or the last points may still be on their way.
     //
-    return(1);
+    if(!g_bBenchRunning || g_bBenchFeeding || TouchScreenEventsPending())
+    {
+        return;
+    }
+
+    ulCycles = HWREG(DWT_CYCCNT) - g_ulBenchStart;
+    BenchReport(ulCycles);
+    GrFlush(&g_sContext);
+
+    if(++g_ulBenchRate < (sizeof(g_pulBenchRates) /
+                          sizeof(g_pulBenchRates[0])))
+    {
+        BenchRun();
+        return;
+    }
+
+    g_bBenchRunning = false;
+    usprintf(pcBuffer, "Kept up with %d points/s", g_ulBenchBest);
+    StatusDraw(pcBuffer);
+    GrFlush(&g_sContext);
 }
+#endif
 
 //*****************************************************************************
 //
 // The main loop handler for touch screen events from the touch screen driver.
+// ulTime is the processor cycle count at which the position was sampled, and
+// ulPressure is how firmly the screen was pressed.
 //
 //*****************************************************************************
 long
-TSMainHandler(unsigned long ulMessage, long lX, long lY)
+TSMainHandler(unsigned long ulMessage, long lX, long lY, unsigned long ulTime,
+              unsigned long ulPressure)
 {
-    tRectangle sRect;
+    unsigned long ulRadius;
 
     //
     // See which event is being sent from the touch screen driver.
@@ -169,30 +2148,44 @@ TSMainHandler(unsigned long ulMessage, long lX, long lY)
         case WIDGET_MSG_PTR_DOWN:
         {
             //
-            // Erase the drawing area.
-            //
-            GrContextForegroundSet(&g_sContext, ClrBlack);
-            sRect.i16XMin = 1;
-            sRect.i16YMin = 45;
-            sRect.i16XMax = GrContextDpyWidthGet(&g_sContext) - 2;
-            sRect.i16YMax = GrContextDpyHeightGet(&g_sContext) - 2;
-            GrRectFill(&g_sContext, &sRect);
-
-            //
-            // Flush any cached drawing operations.
+            // A touch of the banner is a command rather than a stroke.
             //
-            GrFlush(&g_sContext);
+            g_bCommand = (lY < BANNER_HEIGHT);
+            if(g_bCommand)
+            {
+                ScribbleCommand(lX);
+                break;
+            }
 
             //
-            // Set the drawing color to the current pen color.
+            // Set the drawing color to the current pen color, start storing
+            // the stroke, and put a dot of the brush down where it starts.
             //
             GrContextForegroundSet(&g_sContext, g_pulColors[g_ulColorIdx]);
+            g_ulPressure = ulPressure;
+            g_ulRadius = BrushRadius(ulPressure);
+            StrokeBegin(g_ulColorIdx, g_ulRadius);
+            StrokeAdd(lX, lY);
+            g_ulInkRadius = g_ulRadius;
+            InkAdd(lX, lY, g_ulInkRadius);
+            StreamStart(g_ulColorIdx, g_ulRadius, lX, lY, ulTime);
+            SmoothBegin(&g_sSmooth, lX, lY, g_ulRadius);
 
             //
-            // Save the current position.
+            // Save the current position, and start the stroke with no
+            // velocity and no predictions.
             //
             g_lX = lX;
             g_lY = lY;
+            g_ulTime = ulTime;
+            g_lVX = 0;
+            g_lVY = 0;
+            g_bPredicted = false;
+            g_bPredictDirty = false;
+            g_ulPredictCount = 0;
+            g_ulPredictChecked = 0;
+            g_ulPredictErrTotal = 0;
+            g_ulPredictErrMax = 0;
 
             //
             // This event has been handled.
@@ -205,21 +2198,44 @@ TSMainHandler(unsigned long ulMessage, long lX, long lY)
         //
         case WIDGET_MSG_PTR_MOVE:
         {
-            //
-            // Draw a line from the previous position to the current position.
-            //
-            GrLineDraw(&g_sContext, g_lX, g_lY, lX, lY);
+            if(g_bCommand)
+            {
+                break;
+            }
 
             //
-            // Flush any cached drawing operations.
+            // Replace the provisional ink with the curve around the previous
+            // position, now that the current position shows where it goes,
+            // drawn with the brush radius for the current pressure.
             //
-            GrFlush(&g_sContext);
+            PredictErase();
+            PredictCheck(lX, lY, ulTime);
+            PredictVelocity(lX, lY, ulTime);
+            if((lX != g_lX) || (lY != g_lY))
+            {
+                ulRadius = BrushRadius(ulPressure);
+                SmoothAdd(&g_sSmooth, lX, lY, ulRadius);
+                g_ulRadius = ulRadius;
+                StrokeRadiusSet(ulRadius);
+                StrokeAdd(lX, lY);
+                InkRadiusSet(ulRadius);
+                InkAdd(lX, lY, g_ulInkRadius);
+                StreamPoint(lX, lY, ulRadius, ulTime);
+            }
 
             //
-            // Save the current position.
+            // Save the current position, and carry the provisional ink from
+            // the end of the curve to it and on to where the pen is expected
+            // to be next.
             //
             g_lX = lX;
             g_lY = lY;
+            PredictDraw();
+
+            //
+            // Flush any cached drawing operations.
+            //
+            GrFlush(&g_sContext);
 
             //
             // This event has been handled.
@@ -232,10 +2248,50 @@ TSMainHandler(unsigned long ulMessage, long lX, long lY)
         //
         case WIDGET_MSG_PTR_UP:
         {
+            if(g_bCommand)
+            {
+#ifdef SCRIBBLE_BENCH
+                if(g_bBenchRequest)
+                {
+                    g_bBenchRequest = false;
+                    BenchStart();
+                }
+#endif
+                break;
+            }
+
+            //
+            // Replace the provisional ink with the rest of the curve, on to
+            // the current position.  The pressure has already fallen away as
+            // the pen lifts, so the brush is left as it was.
+            //
+            PredictErase();
+            PredictCheck(lX, lY, ulTime);
+            if((lX != g_lX) || (lY != g_lY))
+            {
+                SmoothAdd(&g_sSmooth, lX, lY, g_ulRadius);
+                StrokeAdd(lX, lY);
+                InkAdd(lX, lY, g_ulInkRadius);
+                StreamPoint(lX, lY, g_ulRadius, ulTime);
+            }
+            SmoothEnd(&g_sSmooth, g_ulRadius);
+            StreamEnd(ulTime);
+
+            //
+            // Erasing the provisional ink may have cut through earlier
+            // strokes, so redraw them where it was.  This needs the whole of
+            // this stroke to have been stored, as it is drawn again too.
+            //
+            if(g_bPredictDirty && g_bStrokeRecording)
+            {
+                StrokesRedraw(&g_sPredictDirty, false);
+            }
+            g_bStrokeRecording = false;
+
             //
-            // Draw a line from the previous position to the current position.
+            // Report how well the ink was predicted over the stroke.
             //
-            GrLineDraw(&g_sContext, g_lX, g_lY, lX, lY);
+            PredictReport();
 
             //
             // Flush any cached drawing operations.
@@ -267,8 +2323,8 @@ TSMainHandler(unsigned long ulMessage, long lX, long lY)
 //*****************************************************************************
 //
 // This function is called in the context of the main loop to process any
-// touch screen messages that have been sent.  Messages are posted to a
-// queue from the message handler and pulled off here.  This is required
+// touch screen messages that have been sent.  The touch screen driver queues
+// its messages and they are pulled off here in batches.  This is required
 // since it is not safe to have two different execution contexts performing
 // graphics operations using the same graphics context.
 //
@@ -276,31 +2332,60 @@ TSMainHandler(unsigned long ulMessage, long lX, long lY)
 void
 ProcessTouchMessages(void)
 {
-    tScribbleMessage sMsg;
+    tTouchEvent psEvents[MSG_BATCH_SIZE];
+    unsigned long ulIdx, ulCount;
 
-    while(!RingBufEmpty(&g_sMsgQueue))
+    do
     {
         //
-        // Get the next message.
+        // Get the next batch of messages.
         //
-        RingBufRead(&g_sMsgQueue, (unsigned char *)&sMsg,
-                    sizeof(tScribbleMessage));
+        ulCount = TouchScreenEventsRead(psEvents, MSG_BATCH_SIZE);
 
         //
-        // Dispatch it to the handler.
+        // Dispatch them to the handler.
         //
-        TSMainHandler(sMsg.ulMsg, sMsg.lX, sMsg.lY);
+        for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+        {
+#ifdef SCRIBBLE_BENCH
+            unsigned long ulStart;
+            bool bBench;
+
+            //
+            // Only the messages fed in by a run are counted, and not the pen
+            // up that starts the benchmark.
+            //
+            bBench = g_bBenchRunning;
+            ulStart = HWREG(DWT_CYCCNT);
+            TSMainHandler(psEvents[ulIdx].ulMsg, psEvents[ulIdx].sX,
+                          psEvents[ulIdx].sY, psEvents[ulIdx].ulTime,
+                          psEvents[ulIdx].usPressure);
+            if(bBench)
+            {
+                g_ulBenchHandleCycles += HWREG(DWT_CYCCNT) - ulStart;
+                g_ulBenchHandled++;
+            }
+#else
+            TSMainHandler(psEvents[ulIdx].ulMsg, psEvents[ulIdx].sX,
+                          psEvents[ulIdx].sY, psEvents[ulIdx].ulTime,
+                          psEvents[ulIdx].usPressure);
+#endif
+        }
     }
+    while(ulCount);
 }
 //*****************************************************************************
 //
-// This is the handler for this SysTick interrupt.  We use this to provide the
-// required timer call to the lwIP stack.
+// This is the handler for the SysTick interrupt, which paces the points fed
+// in by the benchmark.
 //
 //*****************************************************************************
 void
 SysTickIntHandler(void)
 {
+#ifdef SCRIBBLE_BENCH
+    BenchFeed();
+#endif
 }
 
 //*****************************************************************************
@@ -401,6 +2486,18 @@ main(void)
     GrStringDrawCentered(&g_sContext, "scribble", -1,
                          GrContextDpyWidthGet(&g_sContext) / 2, 11, 0);
 
+    //
+    // Mark off the undo and clear buttons at either end of the banner.
+    //
+    GrLineDrawV(&g_sContext, BUTTON_WIDTH, 0, BANNER_HEIGHT - 1);
+    GrLineDrawV(&g_sContext,
+                GrContextDpyWidthGet(&g_sContext) - BUTTON_WIDTH - 1, 0,
+                BANNER_HEIGHT - 1);
+    GrStringDrawCentered(&g_sContext, "Undo", -1, BUTTON_WIDTH / 2, 11, 0);
+    GrStringDrawCentered(&g_sContext, "Clear", -1,
+                         (GrContextDpyWidthGet(&g_sContext) -
+                          (BUTTON_WIDTH / 2)), 11, 0);
+
     //
     // Print the instructions across the top of the screen in white with a 20
     // point san-serif font.
@@ -433,7 +2530,8 @@ main(void)
     sRect.i16YMin++;
     sRect.i16XMax--;
     sRect.i16YMax--;
-    GrContextClipRegionSet(&g_sContext, &sRect);
+    g_sScribbleArea = sRect;
+    GrContextClipRegionSet(&g_sContext, &g_sScribbleArea);
 
     //
     // Set the color index to zero.
@@ -441,11 +2539,34 @@ main(void)
     g_ulColorIdx = 0;
 
     //
-    // Initialize the message queue we use to pass messages from the touch
-    // interrupt handler context to the main loop for processing.
+    // Configure and enable uDMA, which the display driver uses to send large
+    // fills, such as clearing the scribble area, in the background.
     //
-    RingBufInit(&g_sMsgQueue, (unsigned char *)g_psMsgQueueBuffer,
-                (MSG_QUEUE_SIZE * sizeof(tScribbleMessage)));
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    SysCtlDelay(10);
+    uDMAControlBaseSet(&sDMAControlTable[0]);
+    uDMAEnable();
+
+    //
+    // Find the rate of the cycle counter that the touch screen driver uses to
+    // time its samples.
+    //
+    g_ulCyclesPerUs = SysCtlClockGet() / 1000000;
+
+    //
+    // Configure UART0 at 115,200 baud for the stroke stream, with its
+    // interrupt fed from the stream ring.
+    //
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+    GPIOPinConfigure(GPIO_PA0_U0RX);
+    GPIOPinConfigure(GPIO_PA1_U0TX);
+    GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    UARTConfigSetExpClk(UART0_BASE, SysCtlClockGet(), 115200,
+                        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                         UART_CONFIG_PAR_NONE));
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX1_8, UART_FIFO_RX4_8);
+    IntEnable(INT_UART0);
 
     //
     // Initialize the touch screen driver.
@@ -453,19 +2574,44 @@ main(void)
     TouchScreenInit();
 
     //
-    // Set the touch screen event handler.
+    // Take the median of the raw readings so that a still pen does not draw
+    // a jittery blob.
+    //
+    TouchScreenFilterSet(TOUCH_FILTER_MEDIAN, 5);
+
+    //
+    // Use the low latency debouncer so that the ink follows the pen closely.
+    // Only the last sample before the pen is lifted is held back.
+    //
+    TouchScreenDebounceSet(TOUCH_LOW_LATENCY_DOWN,
+                           TOUCH_LOW_LATENCY_LOOKAHEAD);
+
+    //
+    // Sample faster while drawing, and stop sampling a quarter of a second
+    // after the pen is lifted.
     //
-    TouchScreenCallbackSet(TSHandler);
+    TouchScreenIdleSet(250, true);
 
     //
-    // Loop forever.  All the drawing is done in the touch screen event
-    // handler.
+    // Have the touch screen driver queue its messages, so that they can be
+    // handled in the context of the main loop.
+    //
+    TouchScreenEventQueueEnable(true);
+
+    //
+    // Loop forever.  All the drawing is done in the main loop handler for
+    // touch screen events.
     //
     while(1)
     {
         //
-        // Process any new touchscreen messages.
+        // Process any new touchscreen messages, then send any stroke points
+        // that have been waiting.
         //
         ProcessTouchMessages();
+        StreamService();
+#ifdef SCRIBBLE_BENCH
+        BenchService();
+#endif
     }
 }
@@ -19,13 +19,19 @@
 #include "inc/hw_memmap.h"
 #include "inc/hw_timer.h"
 #include "inc/hw_types.h"
+#include "inc/hw_udma.h"
 #include "driverlib/adc.h"
+#include "driverlib/flash.h"
 #include "driverlib/gpio.h"
 #include "driverlib/interrupt.h"
+#include "driverlib/sw_crc.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/timer.h"
+#include "driverlib/uart.h"
+#include "driverlib/udma.h"
 #include "grlib/grlib.h"
 #include "grlib/widget.h"
+#include "utils/ustdlib.h"
 #include "touch.h"
 #include "Kentec320x240x16_ssd2119_8bit.h"
 
@@ -86,6 +92,136 @@
 //*****************************************************************************
 #define ADC_CTL_CH_XP ADC_CTL_CH6
 #define ADC_CTL_CH_YP ADC_CTL_CH7
+#define ADC_CTL_CH_YN ADC_CTL_CH0
+
+//*****************************************************************************
+//
+// Unless TOUCH_NO_DMA is defined, the touch screen is read in bursts whenever
+// the application has enabled the uDMA controller before calling
+// TouchScreenInit().  Timer 1 subtimer A then paces a uDMA peripheral
+// scatter-gather list, one task per timeout, that drives the panel for an
+// axis, lets it settle, triggers a multi-step sample sequence (SS0 for X, SS1
+// for Y) and copies the sequence FIFOs to memory.  The panel has to be
+// rewired between the two axes, which is why the list, rather than the ADC,
+// does the pacing.  Only the end of the list interrupts the processor, once
+// per X/Y pair.  Without the uDMA controller the original state machine is
+// used, taking one sequence 3 interrupt per sample.
+//
+//*****************************************************************************
+#if !defined(TOUCH_NO_DMA)
+#define TOUCH_DMA
+#endif
+
+//*****************************************************************************
+//
+// The burst sizes, in ADC steps, for each axis and for the pressure
+// measurement (alternating Z1 and Z2 readings), the number of list slots the
+// panel is given to settle after being rewired, and the rate at which X/Y
+// pairs are produced.  The pair rate matches the four millisecond cycle of
+// the original interrupt driven state machine, so the debouncer timing is
+// unchanged.
+//
+// The state machine takes TS_PAIR_SAMPLES samples for each pair: a discarded
+// and a kept sample for each axis, then Z1 and Z2.  The original machine took
+// only the first four, at one sample per millisecond, so it is now timed at
+// one and a half samples per millisecond to keep the same pair rate.
+//
+//*****************************************************************************
+#define TS_BURST_X              8
+#define TS_BURST_Y              4
+#define TS_BURST_Z              4
+#define TS_SETTLE_SLOTS         3
+#define TS_PAIR_RATE            250
+#define TS_PAIR_SAMPLES         6
+#define TS_DMA_MAX_TASKS        40
+
+//*****************************************************************************
+//
+// The data watchpoint and trace unit's cycle counter, used to measure the
+// time spent in the touch screen interrupt handler.
+//
+//*****************************************************************************
+#define TS_DEMCR                0xE000EDFC
+#define TS_DEMCR_TRCENA         0x01000000
+#define TS_DWT_CTRL             0xE0001000
+#define TS_DWT_CTRL_CYCCNTENA   0x00000001
+#define TS_DWT_CYCCNT           0xE0001004
+
+//*****************************************************************************
+//
+// The largest filter window, the window used by the interrupt driven state
+// machine at most (it gets one sample per axis per pair, so a window of three
+// is the widest that stays within one sample of delay), and the movement, in
+// ADC counts per pair, at which the adaptive IIR filter stops smoothing.
+//
+//*****************************************************************************
+#define TS_FILTER_MAX           TOUCH_FILTER_WINDOW_MAX
+#define TS_FILTER_MAX_STREAM    3
+#define TS_IIR_FAST             64
+
+//*****************************************************************************
+//
+// The time, in milliseconds, without a touch before the driver stops sampling
+// and waits for the pen detect interrupt, and the factor by which sampling
+// speeds up during a drag when that is enabled.
+//
+//*****************************************************************************
+#define TS_IDLE_DELAY           250
+#define TS_DRAG_RATE_MULT       2
+
+//*****************************************************************************
+//
+// The timer period, in cycles, for normal sampling and the one in use, which
+// is shorter during a drag when the drag burst is enabled.
+//
+//*****************************************************************************
+static uint32_t g_ulTSLoadActive;
+static uint32_t g_ulTSLoad;
+
+//*****************************************************************************
+//
+// The idle state.  g_bTSIdle is set while sampling is stopped and the panel
+// is biased for pen detection.  The driver goes idle once g_ulTSReleased,
+// the count of consecutive pairs without a press, reaches g_ulTSIdlePairs,
+// or never if that is zero.  g_bTSDragging is set while the faster drag rate
+// is in use.
+//
+//*****************************************************************************
+static bool g_bTSIdle;
+static uint32_t g_ulTSIdlePairs;
+static uint32_t g_ulTSReleased;
+static bool g_bTSDragBurst;
+static bool g_bTSDragging;
+
+//*****************************************************************************
+//
+// The length of a pair in microseconds at the normal rate, used to convert
+// the idle delay into pairs.  This is fixed by TS_PAIR_RATE, so it is valid
+// even before TouchScreenInit() has been called.
+//
+//*****************************************************************************
+static const uint32_t g_ulTSPairPeriod = 1000000 / TS_PAIR_RATE;
+
+//*****************************************************************************
+//
+// The number of interrupts taken while sampling and while idle, and the
+// number of times the driver has gone idle.
+//
+//*****************************************************************************
+static volatile uint32_t g_ulTSIntActive;
+static volatile uint32_t g_ulTSIntIdle;
+static volatile uint32_t g_ulTSIdleEntries;
+
+//*****************************************************************************
+//
+// The number of touch screen interrupts taken, the processor cycles spent in
+// them and the number of X/Y pairs they produced.  Dividing the cycles by the
+// pairs gives the interrupt cost of each reported coordinate.
+//
+//*****************************************************************************
+static volatile uint32_t g_ulTSIntCount;
+static volatile uint32_t g_ulTSIntCycles;
+static volatile uint32_t g_ulTSPairCount;
 
 //*****************************************************************************
 //
@@ -212,6 +348,67 @@ const int32_t g_lTouchParameters[NUM_TOUCH_PARAM_SETS][NUM_TOUCH_PARAMS] =
 //*****************************************************************************
 const int32_t *g_plParmSet;
 
+//*****************************************************************************
+//
+// The calibration parameters in the form used for each sample.  The division
+// by M6 is done once, when the parameters are loaded, leaving
+//
+//     X = ((x * A0) + (y * A1) + A2) >> g_ulTSCalShift
+//     Y = ((x * A3) + (y * A4) + A5) >> g_ulTSCalShift
+//
+// where An = Mn * 2^shift / M6, rounded, and A2 and A5 also carry the
+// rounding of the result.  The shift is the largest for which every
+// coefficient and every intermediate sum fits in 32 bits for raw readings
+// anywhere in the 12-bit ADC range.
+//
+//*****************************************************************************
+static int32_t g_plTSCal[6];
+static uint32_t g_ulTSCalShift;
+#define TS_CAL_SHIFT_MAX        24
+#define TS_RAW_MAX              4095
+
+//*****************************************************************************
+//
+// Set by TouchScreenRawSet() while the touch screen is being calibrated, so
+// that messages carry the raw readings rather than screen pixels.
+//
+//*****************************************************************************
+static volatile bool g_bTSRaw;
+
+//*****************************************************************************
+//
+// The calibration saved in flash by TouchScreenCalibrationSave().  It holds
+// the parameters both as M0-M6 and in the converted form, so that loading it
+// is a copy, and is only used if the magic number, version, screen
+// orientation and CRC-32 all match.  TS_CAL_FLASH_ADDR is the 1 KB flash
+// page reserved for it by the TOUCHCAL region of the linker command file.
+//
+//*****************************************************************************
+#define TS_CAL_FLASH_ADDR       0x0003FC00
+#define TS_CAL_MAGIC            0x4C414354
+#define TS_CAL_VERSION          1
+#if defined(PORTRAIT)
+#define TS_CAL_ORIENTATION      0
+#elif defined(LANDSCAPE)
+#define TS_CAL_ORIENTATION      1
+#elif defined(PORTRAIT_FLIP)
+#define TS_CAL_ORIENTATION      2
+#else
+#define TS_CAL_ORIENTATION      3
+#endif
+
+typedef struct
+{
+    uint32_t ulMagic;
+    uint32_t ulVersion;
+    uint32_t ulOrientation;
+    int32_t plParms[NUM_TOUCH_PARAMS];
+    int32_t plCal[6];
+    uint32_t ulShift;
+    uint32_t ulCRC;
+}
+tTSCalRecord;
+
 //*****************************************************************************
 //
 // The minimum raw reading that should be considered valid press.
@@ -219,6 +416,15 @@ const int32_t *g_plParmSet;
 //*****************************************************************************
 int16_t g_sTouchMin = TOUCH_MIN;
 
+//*****************************************************************************
+//
+// The minimum touch pressure that should be considered a valid press.  Light
+// or partial contacts give positions that wander, so they are treated as no
+// press at all.
+//
+//*****************************************************************************
+int16_t g_sTouchPressureMin = TOUCH_PRESSURE_MIN;
+
 //*****************************************************************************
 //
 // The current state of the touch screen driver's state machine.  This is used
@@ -232,6 +438,8 @@ static uint32_t g_ulTSState;
 #define TS_STATE_READ_Y         2
 #define TS_STATE_SKIP_X         3
 #define TS_STATE_SKIP_Y         4
+#define TS_STATE_READ_Z1        5
+#define TS_STATE_READ_Z2        6
 
 //*****************************************************************************
 //
@@ -249,6 +457,16 @@ volatile int16_t g_sTouchX;
 //*****************************************************************************
 volatile int16_t g_sTouchY;
 
+//*****************************************************************************
+//
+// The most recent raw ADC readings of the pressure measurement, taken with
+// the Y layer driven from YP and the X layer grounded at XN: Z1 is read at XP
+// and Z2 at YN.
+//
+//*****************************************************************************
+static int16_t g_sTouchZ1;
+static int16_t g_sTouchZ2;
+
 //*****************************************************************************
 //
 // A pointer to the function to receive messages from the touch screen driver
@@ -260,607 +478,2942 @@ static int32_t (*g_pfnTSHandler)(uint32_t ulMessage, int32_t lX, int32_t lY);
 
 //*****************************************************************************
 //
-// The current state of the touch screen debouncer.  When zero, the pen is up.
-// When three, the pen is down.  When one or two, the pen is transitioning from
-// one state to the other.
+// The debouncer settings: the number of pressed samples needed before a press
+// is reported and the number of pressed samples held back in the queue, both
+// of which can be changed at run time.  The defaults are those of the original
+// debouncer, which reports a press on the seventh pressed sample and delays
+// every move by four samples.  The number of released samples needed before a
+// release is reported is fixed at TS_UP_COUNT.
 //
 //*****************************************************************************
-static uint8_t g_cState = 0;
+static uint32_t g_ulTSDownCount = TOUCH_DEBOUNCE_DOWN;
+static uint32_t g_ulTSLookahead = TOUCH_DEBOUNCE_LOOKAHEAD;
+#define TS_UP_COUNT             3
 
 //*****************************************************************************
 //
-// The queue of debounced pen positions.  This is used to slightly delay the
-// returned pen positions, so that the pen positions that occur while the pen
-// is being raised are not send to the application.
+// The current state of the touch screen debouncer.  g_bTSPenDown is the
+// debounced state of the pen, and g_ulTSDebounce counts the samples that
+// disagree with it; a sample that agrees cancels one that did not.
+// g_bTSDownSent is set once the press has been reported.
 //
 //*****************************************************************************
-static int16_t g_psSamples[8];
+static bool g_bTSPenDown;
+static bool g_bTSDownSent;
+static uint32_t g_ulTSDebounce;
 
 //*****************************************************************************
 //
-// The count of pen positions in g_psSamples.  When negative, the buffer is
-// being pre-filled as a result of a detected pen down event.
+// Whether the current pair is a press: both readings over g_sTouchMin and
+// the pressure over g_sTouchPressureMin.  This is set by the filter stage.
 //
 //*****************************************************************************
-static int8_t g_cIndex = 0;
+static bool g_bTSPressed;
 
 //*****************************************************************************
 //
-//! Debounces presses of the touch screen.
-//!
-//! This function is called when a new X/Y sample pair has been captured in
-//! order to perform debouncing of the touch screen.
-//!
-//! \return None.
+// The queue of debounced pen positions and the times at which they were
+// sampled.  This is used to slightly delay the returned pen positions, so
+// that the pen positions that occur while the pen is being raised are not
+// sent to the application.  g_ulTSQueueRead is the oldest entry.
 //
 //*****************************************************************************
-static void
-TouchScreenDebouncer(void)
+#define TS_QUEUE_SIZE           8
+static int16_t g_psTSQueueX[TS_QUEUE_SIZE];
+static int16_t g_psTSQueueY[TS_QUEUE_SIZE];
+static uint32_t g_pulTSQueueTime[TS_QUEUE_SIZE];
+static uint16_t g_pusTSQueuePressure[TS_QUEUE_SIZE];
+static uint32_t g_ulTSQueueRead;
+static uint32_t g_ulTSQueueCount;
+
+//*****************************************************************************
+//
+// The position last sent to the application, used for the release when
+// nothing is held back.
+//
+//*****************************************************************************
+static int32_t g_lTSLastX;
+static int32_t g_lTSLastY;
+
+//*****************************************************************************
+//
+// The pressure of the current pair, and of the message being delivered to
+// the touch screen event handler.
+//
+//*****************************************************************************
+static uint16_t g_usTSPressure;
+static uint16_t g_usTSMessagePressure;
+
+//*****************************************************************************
+//
+// The cycle count at which the X reading of the current pair was sampled by
+// the ADC, and the time from there to the touch screen event handler being
+// called: the number of messages, the total and the worst case, in cycles.
+//
+//*****************************************************************************
+static uint32_t g_ulTSSampleTime;
+static volatile uint32_t g_ulTSLatencyCount;
+static volatile uint32_t g_ulTSLatencyTotal;
+static volatile uint32_t g_ulTSLatencyMax;
+
+//*****************************************************************************
+//
+// The touch screen event queue.  This is written only by the interrupt
+// handler and read only by TouchScreenEventsRead(), each of which owns one of
+// the free running indices, so neither side needs to disable interrupts.
+// Once fewer than TS_EVENT_RESERVE entries are free, pen move messages are
+// merged into the newest queued move instead of taking an entry, keeping
+// room for the pen down and pen up messages.
+//
+//*****************************************************************************
+#define TS_EVENT_RESERVE        4
+#define TS_EVENT_BATCH          8
+static bool g_bTSEventQueue;
+static tTouchEvent g_psTSEvents[TOUCH_EVENT_QUEUE_SIZE];
+static volatile uint32_t g_ulTSEventWrite;
+static volatile uint32_t g_ulTSEventRead;
+
+//*****************************************************************************
+//
+// The event queue statistics: the number of pen move messages merged into
+// an earlier one, the number of messages dropped because the queue was full,
+// and the most entries that have been in use at once.
+//
+//*****************************************************************************
+static volatile uint32_t g_ulTSEventCoalesced;
+static volatile uint32_t g_ulTSEventOverflows;
+static volatile uint32_t g_ulTSEventHighWater;
+
+#ifdef TOUCH_TRACE
+//*****************************************************************************
+//
+// The trace recorder.  Each X/Y pair is recorded as it enters the filter,
+// with the time it was sampled and its pressure readings, into a ring that
+// keeps the newest TOUCH_TRACE_SIZE pairs.  g_ulTSTraceCount is the number
+// of pairs recorded since recording was enabled.
+//
+//*****************************************************************************
+typedef struct
 {
-    int32_t lX, lY, lTemp;
+    uint32_t ulTime;
+    int16_t sX;
+    int16_t sY;
+    int16_t sZ1;
+    int16_t sZ2;
+}
+tTSTraceSample;
 
-    //
-    // Convert the ADC readings into pixel values on the screen.
-    //
-    lX = g_sTouchX;
-    lY = g_sTouchY;
-    lTemp = (((lX * g_plParmSet[0]) + (lY * g_plParmSet[1]) + g_plParmSet[2]) /
-             g_plParmSet[6]);
-    lY = (((lX * g_plParmSet[3]) + (lY * g_plParmSet[4]) + g_plParmSet[5]) /
-          g_plParmSet[6]);
-    lX = lTemp;
+static tTSTraceSample g_psTSTrace[TOUCH_TRACE_SIZE];
+static volatile uint32_t g_ulTSTraceCount;
+static volatile bool g_bTSTraceRecord;
 
-    //
-    // See if the touch screen is being touched.
-    //
-    if((g_sTouchX < g_sTouchMin) || (g_sTouchY < g_sTouchMin))
+//*****************************************************************************
+//
+// The state of a replay.  While g_bTSReplay is set, messages from the
+// debouncer are counted into g_psTSReplay instead of being sent to the
+// application, g_ulTSReplayTime is the recorded time of the pair being
+// replayed, and g_ulTSReplayUp is the time of the last pen up.  A pen down
+// within TS_FALSE_UP_TIME milliseconds of a pen up is taken to mean that the
+// pen never left the screen.
+//
+//*****************************************************************************
+#define TS_FALSE_UP_TIME        100
+static bool g_bTSReplay;
+static tTouchTraceReport *g_psTSReplay;
+static uint32_t g_ulTSReplayTime;
+static uint32_t g_ulTSReplayUp;
+#endif
+
+//*****************************************************************************
+//
+// Divides a 64-bit value by a 32-bit one, rounding to the nearest integer.
+//
+//*****************************************************************************
+static int64_t
+TSDivRound(int64_t llNum, int32_t lDen)
+{
+    if((llNum < 0) != (lDen < 0))
     {
-        //
-        // See if the pen is not up right now.
-        //
-        if(g_cState != 0x00)
+        return((llNum - (lDen / 2)) / lDen);
+    }
+    return((llNum + (lDen / 2)) / lDen);
+}
+
+//*****************************************************************************
+//
+// Returns true if a value fits in 32 bits.
+//
+//*****************************************************************************
+static bool
+TSFits32(int64_t llValue)
+{
+    return((llValue >= -2147483647LL - 1) && (llValue <= 2147483647LL));
+}
+
+//*****************************************************************************
+//
+// Converts a set of calibration parameters into the per-sample form, storing
+// it in plCal and returning the shift, or returns -1 if there is no shift at
+// which the transform fits in 32 bits.  A linear transform over the square
+// of raw readings reaches its extremes at the corners, so checking the
+// partial and full sums there covers every reading.
+//
+//*****************************************************************************
+static int32_t
+TSCalibrationConvert(const int32_t *plParms, int32_t *plCal)
+{
+    int64_t llA, llB, llC, llSum;
+    int32_t lShift, lRow, lX, lY;
+    bool bFits;
+
+    if(plParms[6] == 0)
+    {
+        return(-1);
+    }
+
+    for(lShift = TS_CAL_SHIFT_MAX; lShift >= 0; lShift--)
+    {
+        bFits = true;
+
+        for(lRow = 0; bFits && (lRow < 6); lRow += 3)
         {
-            //
-            // Decrement the state count.
-            //
-            g_cState--;
+            llA = TSDivRound((int64_t)plParms[lRow] << lShift, plParms[6]);
+            llB = TSDivRound((int64_t)plParms[lRow + 1] << lShift,
+                             plParms[6]);
+            llC = TSDivRound((int64_t)plParms[lRow + 2] << lShift,
+                             plParms[6]);
+            if(lShift)
+            {
+                llC += 1 << (lShift - 1);
+            }
+            bFits = TSFits32(llA) && TSFits32(llB) && TSFits32(llC);
 
-            //
-            // See if the pen has been detected as up three times in a row.
-            //
-            if(g_cState == 0x80)
+            for(lX = 0; bFits && (lX <= TS_RAW_MAX); lX += TS_RAW_MAX)
             {
-                //
-                // Indicate that the pen is up.
-                //
-                g_cState = 0x00;
-
-                //
-                // See if there is a touch screen event handler.
-                //
-                if(g_pfnTSHandler)
+                for(lY = 0; bFits && (lY <= TS_RAW_MAX); lY += TS_RAW_MAX)
                 {
-                    //
-                    // Send the pen up message to the touch screen event
-                    // handler.
-                    //
-                    g_pfnTSHandler(WIDGET_MSG_PTR_UP, g_psSamples[g_cIndex],
-                                   g_psSamples[g_cIndex + 1]);
+                    llSum = (lX * llA) + (lY * llB);
+                    bFits = TSFits32(lX * llA) && TSFits32(llSum) &&
+                            TSFits32(llSum + llC);
                 }
             }
+
+            plCal[lRow] = (int32_t)llA;
+            plCal[lRow + 1] = (int32_t)llB;
+            plCal[lRow + 2] = (int32_t)llC;
+        }
+
+        if(bFits)
+        {
+            return(lShift);
         }
     }
-    else
+
+    return(-1);
+}
+
+//*****************************************************************************
+//
+// Records the time from a position being sampled to its message reaching the
+// application.
+//
+//*****************************************************************************
+static void
+TSLatencyRecord(uint32_t ulTime)
+{
+    uint32_t ulLatency;
+
+    ulLatency = HWREG(TS_DWT_CYCCNT) - ulTime;
+    g_ulTSLatencyCount++;
+    g_ulTSLatencyTotal += ulLatency;
+    if(ulLatency > g_ulTSLatencyMax)
+    {
+        g_ulTSLatencyMax = ulLatency;
+    }
+}
+
+//*****************************************************************************
+//
+// Adds a message to the touch screen event queue.  When the queue is nearly
+// full, a pen move message is merged into the newest queued message if that
+// is also a move; the application then sees a longer move to the latest
+// position.  A move that cannot be merged is dropped, since the next move or
+// the pen up message carries a later position anyway.  Pen down and pen up
+// messages may use the reserved entries, so they are only lost if the
+// application lets the queue fill completely.
+//
+//*****************************************************************************
+static void
+TSEventPut(uint32_t ulMessage, int32_t lX, int32_t lY, uint32_t ulTime,
+           uint16_t usPressure)
+{
+    tTouchEvent *psEvent;
+    uint32_t ulWrite, ulUsed;
+
+    ulWrite = g_ulTSEventWrite;
+    ulUsed = ulWrite - g_ulTSEventRead;
+
+    if((ulMessage == WIDGET_MSG_PTR_MOVE) &&
+       (ulUsed >= (TOUCH_EVENT_QUEUE_SIZE - TS_EVENT_RESERVE)))
     {
         //
-        // See if the pen is not down right now.
+        // The newest entry cannot be the one being read, since there are
+        // several entries in use.
         //
-        if(g_cState != 0x83)
+        psEvent = &g_psTSEvents[(ulWrite - 1) & (TOUCH_EVENT_QUEUE_SIZE - 1)];
+        if(psEvent->ulMsg == WIDGET_MSG_PTR_MOVE)
         {
-            //
-            // Increment the state count.
-            //
-            g_cState++;
-
-            //
-            // See if the pen has been detected as down three times in a row.
-            //
-            if(g_cState == 0x03)
-            {
-                //
-                // Indicate that the pen is up.
-                //
-                g_cState = 0x83;
-
-                //
-                // Set the index to -8, so that the next 3 samples are stored
-                // into the sample buffer before sending anything back to the
-                // touch screen event handler.
-                //
-                g_cIndex = -8;
-
-                //
-                // Store this sample into the sample buffer.
-                //
-                g_psSamples[0] = lX;
-                g_psSamples[1] = lY;
-            }
+            psEvent->ulTime = ulTime;
+            psEvent->sX = lX;
+            psEvent->sY = lY;
+            psEvent->usPressure = usPressure;
+            psEvent->usCount++;
+            g_ulTSEventCoalesced++;
         }
         else
         {
-            //
-            // See if the sample buffer pre-fill has completed.
-            //
-            if(g_cIndex == -2)
-            {
-                //
-                // See if there is a touch screen event handler.
-                //
-                if(g_pfnTSHandler)
-                {
-                    //
-                    // Send the pen down message to the touch screen event
-                    // handler.
-                    //
-                    g_pfnTSHandler(WIDGET_MSG_PTR_DOWN, g_psSamples[0],
-                                   g_psSamples[1]);
-                }
-
-                //
-                // Store this sample into the sample buffer.
-                //
-                g_psSamples[0] = lX;
-                g_psSamples[1] = lY;
-
-                //
-                // Set the index to the next sample to send.
-                //
-                g_cIndex = 2;
-            }
+            g_ulTSEventOverflows++;
+        }
+        return;
+    }
 
-            //
-            // Otherwise, see if the sample buffer pre-fill is in progress.
-            //
-            else if(g_cIndex < 0)
-            {
-                //
-                // Store this sample into the sample buffer.
-                //
-                g_psSamples[g_cIndex + 10] = lX;
-                g_psSamples[g_cIndex + 11] = lY;
-
-                //
-                // Increment the index.
-                //
-                g_cIndex += 2;
-            }
+    if(ulUsed == TOUCH_EVENT_QUEUE_SIZE)
+    {
+        g_ulTSEventOverflows++;
+        return;
+    }
 
-            //
-            // Otherwise, the sample buffer is full.
-            //
-            else
-            {
-                //
-                // See if there is a touch screen event handler.
-                //
-                if(g_pfnTSHandler)
-                {
-                    //
-                    // Send the pen move message to the touch screen event
-                    // handler.
-                    //
-                    g_pfnTSHandler(WIDGET_MSG_PTR_MOVE, g_psSamples[g_cIndex],
-                                   g_psSamples[g_cIndex + 1]);
-                }
+    psEvent = &g_psTSEvents[ulWrite & (TOUCH_EVENT_QUEUE_SIZE - 1)];
+    psEvent->ulMsg = ulMessage;
+    psEvent->ulTime = ulTime;
+    psEvent->sX = lX;
+    psEvent->sY = lY;
+    psEvent->usPressure = usPressure;
+    psEvent->usCount = 1;
 
-                //
-                // Store this sample into the sample buffer.
-                //
-                g_psSamples[g_cIndex] = lX;
-                g_psSamples[g_cIndex + 1] = lY;
+    //
+    // Publish the entry only once it has been filled in.
+    //
+    g_ulTSEventWrite = ulWrite + 1;
 
-                //
-                // Increment the index.
-                //
-                g_cIndex = (g_cIndex + 2) & 7;
-            }
-        }
+    if((ulUsed + 1) > g_ulTSEventHighWater)
+    {
+        g_ulTSEventHighWater = ulUsed + 1;
     }
 }
 
+#ifdef TOUCH_TRACE
 //*****************************************************************************
 //
-//! Handles the ADC interrupt for the touch screen.
-//!
-//! This function is called when the ADC sequence that samples the touch screen
-//! has completed its acquisition.  The touch screen state machine is advanced
-//! and the acquired ADC sample is processed appropriately.
-//!
-//! It is the responsibility of the application using the touch screen driver
-//! to ensure that this function is installed in the interrupt vector table for
-//! the ADC3 interrupt.
-//!
-//! \return None.
+// Counts a message produced while a trace is being replayed.  The latency
+// runs from the sample the message carries to the pair that produced it.
 //
 //*****************************************************************************
-void
-TouchScreenIntHandler(void)
+static void
+TSReplayMessage(uint32_t ulMessage, uint32_t ulTime)
 {
-    //
-    // Clear the ADC sample sequence interrupt.
-    //
-    HWREG(ADC0_BASE + ADC_O_ISC) = 1 << 3;
+    uint32_t ulLatency;
 
-    //
-    // Determine what to do based on the current state of the state machine.
-    //
-    switch(g_ulTSState)
+    ulLatency = g_ulTSReplayTime - ulTime;
+    g_psTSReplay->ulLatencyTotal += ulLatency;
+    if(ulLatency > g_psTSReplay->ulLatencyMax)
     {
-        //
-        // The new sample is an X axis sample that should be discarded.
-        //
-        case TS_STATE_SKIP_X:
+        g_psTSReplay->ulLatencyMax = ulLatency;
+    }
+
+    switch(ulMessage)
+    {
+        case WIDGET_MSG_PTR_DOWN:
         {
-            //
-            // Read and throw away the ADC sample.
-            //
-            HWREG(ADC0_BASE + ADC_O_SSFIFO3);
-
-            //
-            // Set the analog mode select for the YP pin.
-            //
-            HWREG(TS_P_BASE + GPIO_O_AMSEL) =
-                HWREG(TS_P_BASE + GPIO_O_AMSEL) | TS_YP_PIN;
-
-            //
-            // Configure the Y axis touch layer pins as inputs.
-            //
-            HWREG(TS_P_BASE + GPIO_O_DIR) =
-                HWREG(TS_P_BASE + GPIO_O_DIR) & ~TS_YP_PIN;
-            //if(g_eDaughterType == DAUGHTER_NONE)
+            if(g_psTSReplay->ulUp &&
+               ((ulTime - g_ulTSReplayUp) <
+                ((SysCtlClockGet() / 1000) * TS_FALSE_UP_TIME)))
             {
-                HWREG(TS_N_BASE + GPIO_O_DIR) =
-                    HWREG(TS_N_BASE + GPIO_O_DIR) & ~TS_YN_PIN;
+                g_psTSReplay->ulFalseUp++;
             }
-            //else if(g_eDaughterType == DAUGHTER_SRAM_FLASH)
-            //{
-            //    HWREGB(LCD_CONTROL_SET_REG) = LCD_CONTROL_YN;
-            //}
+            g_psTSReplay->ulDown++;
+            break;
+        }
 
-            //
-            // The next sample will be a valid X axis sample.
-            //
-            g_ulTSState = TS_STATE_READ_X;
+        case WIDGET_MSG_PTR_MOVE:
+        {
+            g_psTSReplay->ulMove++;
+            break;
+        }
 
-            //
-            // This state has been handled.
-            //
+        case WIDGET_MSG_PTR_UP:
+        {
+            g_ulTSReplayUp = ulTime;
+            g_psTSReplay->ulUp++;
             break;
         }
+    }
+}
+#endif
+
+//*****************************************************************************
+//
+// Sends a message to the application.  If the event queue is enabled the
+// message is queued for TouchScreenEventsRead(); otherwise the touch screen
+// event handler is called directly, recording the time since the position
+// was sampled and making its pressure available to TouchScreenPressureGet().
+//
+//*****************************************************************************
+static void
+TSMessageSend(uint32_t ulMessage, int32_t lX, int32_t lY, uint32_t ulTime,
+              uint16_t usPressure)
+{
+    g_lTSLastX = lX;
+    g_lTSLastY = lY;
+
+#ifdef TOUCH_TRACE
+    if(g_bTSReplay)
+    {
+        TSReplayMessage(ulMessage, ulTime);
+        return;
+    }
+#endif
+
+    if(g_bTSEventQueue)
+    {
+        TSEventPut(ulMessage, lX, lY, ulTime, usPressure);
+        return;
+    }
+
+    g_usTSMessagePressure = usPressure;
+
+    //
+    // See if there is a touch screen event handler.
+    //
+    if(g_pfnTSHandler)
+    {
+        TSLatencyRecord(ulTime);
+        g_pfnTSHandler(ulMessage, lX, lY);
+    }
+}
+
+//*****************************************************************************
+//
+// Sends the queued positions beyond the lookahead to the application; the
+// first one after a press is the pen down message.
+//
+//*****************************************************************************
+static void
+TSQueueDrain(void)
+{
+    uint32_t ulRead;
+
+    while(g_ulTSQueueCount > g_ulTSLookahead)
+    {
+        ulRead = g_ulTSQueueRead;
+        g_ulTSQueueRead = (ulRead + 1) & (TS_QUEUE_SIZE - 1);
+        g_ulTSQueueCount--;
+
+        TSMessageSend((g_bTSDownSent ? WIDGET_MSG_PTR_MOVE :
+                       WIDGET_MSG_PTR_DOWN), g_psTSQueueX[ulRead],
+                      g_psTSQueueY[ulRead], g_pulTSQueueTime[ulRead],
+                      g_pusTSQueuePressure[ulRead]);
+        g_bTSDownSent = true;
+    }
+}
+
+//*****************************************************************************
+//
+//! Debounces presses of the touch screen.
+//!
+//! This function is called when a new X/Y sample pair has been captured in
+//! order to perform debouncing of the touch screen.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+TouchScreenDebouncer(void)
+{
+    int32_t lX, lY, lTemp;
+    uint32_t ulWrite;
+
+    //
+    // Convert the ADC readings into pixel values on the screen.
+    //
+    lX = g_sTouchX;
+    lY = g_sTouchY;
+    if(!g_bTSRaw)
+    {
+        lTemp = (((lX * g_plTSCal[0]) + (lY * g_plTSCal[1]) +
+                  g_plTSCal[2]) >> g_ulTSCalShift);
+        lY = (((lX * g_plTSCal[3]) + (lY * g_plTSCal[4]) + g_plTSCal[5]) >>
+              g_ulTSCalShift);
+        lX = lTemp;
+    }
 
+    //
+    // See if the touch screen is being touched.
+    //
+    if(!g_bTSPressed)
+    {
         //
-        // The new sample is an X axis sample that should be processed.
+        // While the pen is up, a released sample cancels a pressed one.
         //
-        case TS_STATE_READ_X:
+        if(!g_bTSPenDown)
         {
-            //
-            // Read the raw ADC sample.
-            //
-            g_sTouchX = HWREG(ADC0_BASE + ADC_O_SSFIFO3);
+            if(g_ulTSDebounce)
+            {
+                g_ulTSDebounce--;
+            }
+        }
 
+        //
+        // See if the pen has been detected as up enough times.
+        //
+        else if(++g_ulTSDebounce == TS_UP_COUNT)
+        {
             //
-            // Clear the analog mode select for the YP pin.
+            // Indicate that the pen is up.
             //
-            HWREG(TS_P_BASE + GPIO_O_AMSEL) =
-                HWREG(TS_P_BASE + GPIO_O_AMSEL) & ~TS_YP_PIN;
+            g_bTSPenDown = false;
+            g_ulTSDebounce = 0;
 
             //
-            // Configure the X and Y axis touch layers as outputs.
+            // Anything still queued was sampled as the pen lifted, so it is
+            // dropped and the release is reported at the oldest of it.  A
+            // press released before it was reported is sent as well, so that
+            // a short tap is not lost.
             //
-            HWREG(TS_P_BASE + GPIO_O_DIR) =
-                HWREG(TS_P_BASE + GPIO_O_DIR) | TS_XP_PIN | TS_YP_PIN;
-
-            //if(g_eDaughterType == DAUGHTER_NONE)
+            if(g_ulTSQueueCount)
             {
-                HWREG(TS_N_BASE + GPIO_O_DIR) =
-                    HWREG(TS_N_BASE + GPIO_O_DIR) | TS_XN_PIN | TS_YN_PIN;
+                g_ulTSQueueCount = 0;
+                if(!g_bTSDownSent)
+                {
+                    TSMessageSend(WIDGET_MSG_PTR_DOWN,
+                                  g_psTSQueueX[g_ulTSQueueRead],
+                                  g_psTSQueueY[g_ulTSQueueRead],
+                                  g_pulTSQueueTime[g_ulTSQueueRead],
+                                  g_pusTSQueuePressure[g_ulTSQueueRead]);
+                }
+                TSMessageSend(WIDGET_MSG_PTR_UP, g_psTSQueueX[g_ulTSQueueRead],
+                              g_psTSQueueY[g_ulTSQueueRead],
+                              g_ulTSSampleTime, 0);
+            }
+            else
+            {
+                TSMessageSend(WIDGET_MSG_PTR_UP, g_lTSLastX, g_lTSLastY,
+                              g_ulTSSampleTime, 0);
+            }
+        }
+    }
+    else
+    {
+        //
+        // While the pen is up, count towards a press.  While it is down, a
+        // pressed sample first cancels any released ones.
+        //
+        if(!g_bTSPenDown)
+        {
+            if(++g_ulTSDebounce < g_ulTSDownCount)
+            {
+                return;
             }
 
             //
-            // Drive the positive side of the Y axis touch layer with VDD and
-            // the negative side with GND.  Also, drive both sides of the X
-            // axis layer with GND to discharge any residual voltage (so that
-            // a no-touch condition can be properly detected).
+            // Indicate that the pen is down, and start the queue with this
+            // sample.
             //
-            //if(g_eDaughterType == DAUGHTER_NONE)
+            g_bTSPenDown = true;
+            g_bTSDownSent = false;
+            g_ulTSQueueCount = 0;
+            g_ulTSDebounce = 0;
+        }
+        else if(g_ulTSDebounce)
+        {
+            g_ulTSDebounce--;
+            return;
+        }
+
+        //
+        // Store this sample into the queue and send whatever is beyond the
+        // lookahead.
+        //
+        ulWrite = (g_ulTSQueueRead + g_ulTSQueueCount) & (TS_QUEUE_SIZE - 1);
+        g_psTSQueueX[ulWrite] = lX;
+        g_psTSQueueY[ulWrite] = lY;
+        g_pulTSQueueTime[ulWrite] = g_ulTSSampleTime;
+        g_pusTSQueuePressure[ulWrite] = g_usTSPressure;
+        g_ulTSQueueCount++;
+
+        TSQueueDrain();
+    }
+}
+
+//*****************************************************************************
+//
+// The filter state kept for each axis: the most recent raw samples, the
+// adaptive IIR output in 12.4 fixed point, and the last raw and filtered
+// readings for the jitter statistics.
+//
+//*****************************************************************************
+typedef struct
+{
+    int16_t psHistory[TS_FILTER_MAX];
+    uint32_t ulCount;
+    int32_t lIIR;
+    int16_t sLastRaw;
+    int16_t sLastOut;
+}
+tTSAxis;
+
+static tTSAxis g_sTSAxisX;
+static tTSAxis g_sTSAxisY;
+
+//*****************************************************************************
+//
+// The selected filter and window, and the jitter accumulated while the screen
+// is pressed: the sum of the sample to sample movement of the raw and of the
+// filtered readings, and the number of movements summed.
+//
+//*****************************************************************************
+static uint32_t g_ulTSFilter = TOUCH_FILTER_NONE;
+static uint32_t g_ulTSFilterWindow = TS_FILTER_MAX;
+static volatile uint32_t g_ulTSJitterRaw;
+static volatile uint32_t g_ulTSJitterOut;
+static volatile uint32_t g_ulTSJitterCount;
+
+//*****************************************************************************
+//
+// Loads new raw samples into an axis history.  A burst replaces the history
+// outright, since its samples are all from the current pair; single samples
+// from the state machine are appended, dropping the oldest.
+//
+//*****************************************************************************
+static void
+TSAxisLoad(tTSAxis *psAxis, const int16_t *psSamples, uint32_t ulCount)
+{
+    uint32_t ulIdx;
+
+    if(ulCount > 1)
+    {
+        if(ulCount > TS_FILTER_MAX)
+        {
+            psSamples += ulCount - TS_FILTER_MAX;
+            ulCount = TS_FILTER_MAX;
+        }
+        for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+        {
+            psAxis->psHistory[ulIdx] = psSamples[ulIdx];
+        }
+        psAxis->ulCount = ulCount;
+    }
+    else
+    {
+        if(psAxis->ulCount == TS_FILTER_MAX_STREAM)
+        {
+            for(ulIdx = 1; ulIdx < TS_FILTER_MAX_STREAM; ulIdx++)
             {
-                HWREG(TS_N_BASE + GPIO_O_DATA +
-                      ((TS_XN_PIN | TS_YN_PIN) << 2)) = 0;
+                psAxis->psHistory[ulIdx - 1] = psAxis->psHistory[ulIdx];
             }
-            //else if(g_eDaughterType == DAUGHTER_SRAM_FLASH)
-            //{
-            //    HWREGB(LCD_CONTROL_CLR_REG) = LCD_CONTROL_XN | LCD_CONTROL_YN;
-            //}
-            HWREG(TS_P_BASE + GPIO_O_DATA + ((TS_XP_PIN | TS_YP_PIN) << 2)) =
-                TS_YP_PIN;
+            psAxis->ulCount--;
+        }
+        psAxis->psHistory[psAxis->ulCount++] = psSamples[0];
+    }
+}
 
-            //
-            // Configure the sample sequence to capture the X axis value.
-            //
-            HWREG(ADC0_BASE + ADC_O_SSMUX3) = ADC_CTL_CH_XP;
+//*****************************************************************************
+//
+// Runs the selected filter over the newest ulWindow samples of an axis
+// history and returns the filtered reading.
+//
+//*****************************************************************************
+static int16_t
+TSAxisFilter(tTSAxis *psAxis, uint32_t ulWindow)
+{
+    int16_t psSorted[TS_FILTER_MAX], sValue;
+    int32_t lSum, lTarget, lDelta, lAlpha;
+    uint32_t ulIdx, ulPos, ulTrim;
 
-            //
-            // The next sample will be an invalid Y axis sample.
-            //
-            g_ulTSState = TS_STATE_SKIP_Y;
+    if(ulWindow > psAxis->ulCount)
+    {
+        ulWindow = psAxis->ulCount;
+    }
 
-            //
-            // This state has been handled.
-            //
-            break;
+    //
+    // Sort the window.  It is at most eight entries, so an insertion sort is
+    // the cheapest option.
+    //
+    for(ulIdx = 0; ulIdx < ulWindow; ulIdx++)
+    {
+        sValue = psAxis->psHistory[psAxis->ulCount - ulWindow + ulIdx];
+        for(ulPos = ulIdx; (ulPos > 0) && (psSorted[ulPos - 1] > sValue);
+            ulPos--)
+        {
+            psSorted[ulPos] = psSorted[ulPos - 1];
         }
+        psSorted[ulPos] = sValue;
+    }
 
+    switch(g_ulTSFilter)
+    {
         //
-        // The new sample is a Y axis sample that should be discarded.
+        // Median of the window; an even window averages the middle two.
         //
-        case TS_STATE_SKIP_Y:
+        case TOUCH_FILTER_MEDIAN:
         {
-            //
-            // Read and throw away the ADC sample.
-            //
-            HWREG(ADC0_BASE + ADC_O_SSFIFO3);
-
-            //
-            // Set the analog mode select for the XP pin.
-            //
-            HWREG(TS_P_BASE + GPIO_O_AMSEL) =
-                HWREG(TS_P_BASE + GPIO_O_AMSEL) | TS_XP_PIN;
+            return((psSorted[(ulWindow - 1) / 2] + psSorted[ulWindow / 2]) /
+                   2);
+        }
 
-            //
-            // Configure the X axis touch layer pins as inputs.
-            //
-            HWREG(TS_P_BASE + GPIO_O_DIR) =
-                HWREG(TS_P_BASE + GPIO_O_DIR) & ~TS_XP_PIN;
-            //if(g_eDaughterType == DAUGHTER_NONE)
+        //
+        // Mean of the window with roughly a quarter of the samples dropped
+        // from each end.
+        //
+        case TOUCH_FILTER_TRIMMED:
+        {
+            ulTrim = (ulWindow + 2) / 4;
+            if((ulTrim * 2) >= ulWindow)
             {
-                HWREG(TS_N_BASE + GPIO_O_DIR) =
-                    HWREG(TS_N_BASE + GPIO_O_DIR) & ~TS_XN_PIN;
+                ulTrim = (ulWindow - 1) / 2;
             }
-            //else if(g_eDaughterType == DAUGHTER_SRAM_FLASH)
-            //{
-            //    HWREGB(LCD_CONTROL_SET_REG) = LCD_CONTROL_XN;
-            //}
-
-            //
-            // The next sample will be a valid Y axis sample.
-            //
-            g_ulTSState = TS_STATE_READ_Y;
-
-            //
-            // This state has been handled.
-            //
-            break;
+            lSum = 0;
+            for(ulIdx = ulTrim; ulIdx < (ulWindow - ulTrim); ulIdx++)
+            {
+                lSum += psSorted[ulIdx];
+            }
+            return(lSum / (int32_t)(ulWindow - (ulTrim * 2)));
         }
 
         //
-        // The new sample is a Y axis sample that should be processed.
+        // First order IIR on the window mean.  The gain runs from one half,
+        // which delays a steady movement by one sample, when still up to one
+        // (no smoothing at all) when moving by TS_IIR_FAST counts or more.
         //
-        case TS_STATE_READ_Y:
+        case TOUCH_FILTER_IIR:
+        {
+            lSum = 0;
+            for(ulIdx = 0; ulIdx < ulWindow; ulIdx++)
+            {
+                lSum += psSorted[ulIdx];
+            }
+            lTarget = (lSum << 4) / (int32_t)ulWindow;
+            if(psAxis->lIIR < 0)
+            {
+                psAxis->lIIR = lTarget;
+            }
+            lDelta = lTarget - psAxis->lIIR;
+            lAlpha = 128 + (((lDelta < 0) ? -lDelta : lDelta) * 8) /
+                           TS_IIR_FAST;
+            if(lAlpha > 256)
+            {
+                lAlpha = 256;
+            }
+            psAxis->lIIR += (lDelta * lAlpha) / 256;
+            return(psAxis->lIIR >> 4);
+        }
+
+        //
+        // No filter; a burst is reduced to its mean.
+        //
+        default:
+        {
+            lSum = 0;
+            for(ulIdx = 0; ulIdx < ulWindow; ulIdx++)
+            {
+                lSum += psSorted[ulIdx];
+            }
+            return(lSum / (int32_t)ulWindow);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Clears the filter histories, so that filtering restarts from the next
+// pressed sample.
+//
+//*****************************************************************************
+static void
+TSFilterReset(void)
+{
+    g_sTSAxisX.ulCount = 0;
+    g_sTSAxisX.lIIR = -1;
+    g_sTSAxisX.sLastRaw = 0;
+    g_sTSAxisY.ulCount = 0;
+    g_sTSAxisY.lIIR = -1;
+    g_sTSAxisY.sLastRaw = 0;
+}
+
+//*****************************************************************************
+//
+// Converts a pressure measurement into a touch pressure, from 0 for no
+// contact to 4095 for a firm press.  The contact resistance in units of the
+// X layer resistance is X / 4096 * (Z2 / Z1 - 1); the pressure is 4095 less
+// that resistance in ADC counts, floored at zero.
+//
+//*****************************************************************************
+static uint16_t
+TSPressure(int32_t lX, int32_t lZ1, int32_t lZ2)
+{
+    int32_t lResistance;
+
+    if(lZ1 <= 0)
+    {
+        return(0);
+    }
+    if(lZ2 <= lZ1)
+    {
+        return(4095);
+    }
+
+    lResistance = (lX * (lZ2 - lZ1)) / lZ1;
+
+    return((lResistance >= 4095) ? 0 : (4095 - lResistance));
+}
+
+//*****************************************************************************
+//
+// Filters a new set of raw samples into g_sTouchX and g_sTouchY, and decides
+// whether they are a press.  Readings below the touch or pressure thresholds
+// are passed straight through and restart the filters, so that pen up
+// detection is never delayed and no sample from before a press leaks into
+// the filtered position.
+//
+//*****************************************************************************
+static void
+TouchScreenFilterRun(const int16_t *psX, uint32_t ulXCount,
+                     const int16_t *psY, uint32_t ulYCount, int32_t lZ1,
+                     int32_t lZ2)
+{
+    int16_t sRawX, sRawY, sX, sY;
+    uint32_t ulWindow;
+
+    sRawX = psX[ulXCount - 1];
+    sRawY = psY[ulYCount - 1];
+
+#ifdef TOUCH_TRACE
+    //
+    // Record the newest readings of the pair.
+    //
+    if(g_bTSTraceRecord)
+    {
+        tTSTraceSample *psSample;
+
+        psSample = &g_psTSTrace[g_ulTSTraceCount % TOUCH_TRACE_SIZE];
+        psSample->ulTime = g_ulTSSampleTime;
+        psSample->sX = sRawX;
+        psSample->sY = sRawY;
+        psSample->sZ1 = lZ1;
+        psSample->sZ2 = lZ2;
+        g_ulTSTraceCount++;
+    }
+#endif
+
+    g_usTSPressure = TSPressure(sRawX, lZ1, lZ2);
+    g_bTSPressed = ((sRawX >= g_sTouchMin) && (sRawY >= g_sTouchMin) &&
+                    (g_usTSPressure >= g_sTouchPressureMin));
+
+    if(!g_bTSPressed)
+    {
+        TSFilterReset();
+        g_sTouchX = sRawX;
+        g_sTouchY = sRawY;
+        return;
+    }
+
+    TSAxisLoad(&g_sTSAxisX, psX, ulXCount);
+    TSAxisLoad(&g_sTSAxisY, psY, ulYCount);
+
+    //
+    // A burst is filtered within itself, which adds no delay.  Single
+    // samples from the state machine are filtered across pairs instead,
+    // within the window that keeps the delay to one sample; the IIR filter
+    // and the unfiltered path only look at the newest one.
+    //
+    ulWindow = g_ulTSFilterWindow;
+    if(ulXCount == 1)
+    {
+        if((g_ulTSFilter == TOUCH_FILTER_NONE) ||
+           (g_ulTSFilter == TOUCH_FILTER_IIR))
+        {
+            ulWindow = 1;
+        }
+        else if(ulWindow > TS_FILTER_MAX_STREAM)
+        {
+            ulWindow = TS_FILTER_MAX_STREAM;
+        }
+    }
+    sX = TSAxisFilter(&g_sTSAxisX, ulWindow);
+    sY = TSAxisFilter(&g_sTSAxisY, ulWindow);
+
+    //
+    // Accumulate the movement of the raw and filtered readings from one
+    // pressed pair to the next.
+    //
+    if(g_sTSAxisX.sLastRaw >= g_sTouchMin)
+    {
+        g_ulTSJitterRaw += (((sRawX > g_sTSAxisX.sLastRaw) ?
+                             (sRawX - g_sTSAxisX.sLastRaw) :
+                             (g_sTSAxisX.sLastRaw - sRawX)) +
+                            ((sRawY > g_sTSAxisY.sLastRaw) ?
+                             (sRawY - g_sTSAxisY.sLastRaw) :
+                             (g_sTSAxisY.sLastRaw - sRawY)));
+        g_ulTSJitterOut += (((sX > g_sTSAxisX.sLastOut) ?
+                             (sX - g_sTSAxisX.sLastOut) :
+                             (g_sTSAxisX.sLastOut - sX)) +
+                            ((sY > g_sTSAxisY.sLastOut) ?
+                             (sY - g_sTSAxisY.sLastOut) :
+                             (g_sTSAxisY.sLastOut - sY)));
+        g_ulTSJitterCount++;
+    }
+    g_sTSAxisX.sLastRaw = sRawX;
+    g_sTSAxisY.sLastRaw = sRawY;
+    g_sTSAxisX.sLastOut = sX;
+    g_sTSAxisY.sLastOut = sY;
+
+    g_sTouchX = sX;
+    g_sTouchY = sY;
+}
+
+#ifdef TOUCH_DMA
+//*****************************************************************************
+//
+// The state of the burst sampler.  g_bTSDMA is set when the uDMA controller
+// was available at initialization, in which case the task list below drives
+// the touch screen.  Each write task takes its value from the matching entry
+// of g_pulTSValues, and the FIFO tasks land the X, Y and pressure bursts in
+// g_pulTSBurst.
+//
+//*****************************************************************************
+static bool g_bTSDMA;
+static tDMAControlTable g_psTSTasks[TS_DMA_MAX_TASKS];
+static uint32_t g_pulTSValues[TS_DMA_MAX_TASKS];
+static uint32_t g_ulTSTasks;
+static uint32_t g_ulTSIdle;
+static uint32_t g_pulTSBurst[TS_BURST_X + TS_BURST_Y + TS_BURST_Z];
+
+//*****************************************************************************
+//
+// The index of the task that starts the X burst.  The number of timer periods
+// from there to the end of the list is how old the X burst is when the
+// interrupt arrives.
+//
+//*****************************************************************************
+static uint32_t g_ulTSBurstTask;
+
+//*****************************************************************************
+//
+// Determines whether the application has enabled the uDMA controller and
+// given it a control table, and claims the Timer 1 subtimer A channel if so.
+//
+//*****************************************************************************
+static bool
+TSDMAAvailable(void)
+{
+    if(!SysCtlPeripheralReady(SYSCTL_PERIPH_UDMA) ||
+       !(HWREG(UDMA_STAT) & UDMA_STAT_MASTEN) ||
+       (HWREG(UDMA_CTLBASE) == 0))
+    {
+        return(false);
+    }
+
+    uDMAChannelAssign(UDMA_CH20_TIMER1A);
+    uDMAChannelAttributeDisable(UDMA_CHANNEL_TMR1A, UDMA_ATTR_ALL);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Appends a task that writes ulValue to the register at ulAddr on the next
+// timer timeout.
+//
+//*****************************************************************************
+static void
+TSTaskWrite(uint32_t ulAddr, uint32_t ulValue)
+{
+    tDMAControlTable *psTask;
+
+    g_pulTSValues[g_ulTSTasks] = ulValue;
+    psTask = &g_psTSTasks[g_ulTSTasks];
+    psTask->pvSrcEndAddr = &g_pulTSValues[g_ulTSTasks];
+    psTask->pvDstEndAddr = (void *)ulAddr;
+    psTask->ui32Control = (UDMA_SIZE_32 | UDMA_SRC_INC_NONE |
+                           UDMA_DST_INC_NONE | UDMA_ARB_1 |
+                           UDMA_MODE_PER_SCATTER_GATHER |
+                           UDMA_MODE_ALT_SELECT);
+    psTask->ui32Spare = 0;
+    g_ulTSTasks++;
+}
+
+//*****************************************************************************
+//
+// Appends ulSlots tasks that do nothing but hold the list back for a timer
+// period each, giving the panel or the ADC time to finish.
+//
+//*****************************************************************************
+static void
+TSTaskWait(uint32_t ulSlots)
+{
+    while(ulSlots--)
+    {
+        TSTaskWrite((uint32_t)&g_ulTSIdle, 0);
+    }
+}
+
+//*****************************************************************************
+//
+// Appends a task that empties ulCount entries of a sample sequence FIFO into
+// pulDst.  The arbitration size covers the whole burst, so a single timeout
+// moves it.
+//
+//*****************************************************************************
+static void
+TSTaskFIFO(uint32_t ulFIFO, uint32_t *pulDst, uint32_t ulCount,
+           uint32_t ulArb)
+{
+    tDMAControlTable *psTask;
+
+    psTask = &g_psTSTasks[g_ulTSTasks++];
+    psTask->pvSrcEndAddr = (void *)(ADC0_BASE + ulFIFO);
+    psTask->pvDstEndAddr = pulDst + ulCount - 1;
+    psTask->ui32Control = (UDMA_SIZE_32 | UDMA_SRC_INC_NONE |
+                           UDMA_DST_INC_32 | ulArb | ((ulCount - 1) << 4) |
+                           UDMA_MODE_PER_SCATTER_GATHER |
+                           UDMA_MODE_ALT_SELECT);
+    psTask->ui32Spare = 0;
+}
+
+//*****************************************************************************
+//
+// Builds the task list for one X/Y pair.  The pin sequence for each axis is
+// the one the state machine uses: drive the measured layer across and ground
+// the other to discharge it, then float the other layer and sample it.  The
+// pressure is measured last, from the Y configuration, by grounding XN in
+// place of YN.  The
+// direction and analog mode registers are written whole, so the bits of the
+// other pins on the two ports are taken from their state at this point.
+//
+//*****************************************************************************
+static void
+TSDMABuild(void)
+{
+    uint32_t ulPDir, ulNDir, ulPAMSel, ulNAMSel;
+
+    ulPDir = HWREG(TS_P_BASE + GPIO_O_DIR) & ~(TS_XP_PIN | TS_YP_PIN);
+    ulNDir = HWREG(TS_N_BASE + GPIO_O_DIR) & ~(TS_XN_PIN | TS_YN_PIN);
+    ulPAMSel = HWREG(TS_P_BASE + GPIO_O_AMSEL) & ~(TS_XP_PIN | TS_YP_PIN);
+    ulNAMSel = HWREG(TS_N_BASE + GPIO_O_AMSEL) & ~(TS_XN_PIN | TS_YN_PIN);
+
+    g_ulTSTasks = 0;
+
+    //
+    // Drive the X layer from XP to XN and discharge the Y layer, then float
+    // the Y layer and read the X position from YP.
+    //
+    TSTaskWrite(TS_N_BASE + GPIO_O_AMSEL, ulNAMSel);
+    TSTaskWrite(TS_P_BASE + GPIO_O_AMSEL, ulPAMSel);
+    TSTaskWrite(TS_P_BASE + GPIO_O_DIR, ulPDir | TS_XP_PIN | TS_YP_PIN);
+    TSTaskWrite(TS_N_BASE + GPIO_O_DIR, ulNDir | TS_XN_PIN | TS_YN_PIN);
+    TSTaskWrite(TS_P_BASE + GPIO_O_DATA + ((TS_XP_PIN | TS_YP_PIN) << 2),
+                TS_XP_PIN);
+    TSTaskWrite(TS_N_BASE + GPIO_O_DATA + ((TS_XN_PIN | TS_YN_PIN) << 2), 0);
+    TSTaskWrite(TS_P_BASE + GPIO_O_AMSEL, ulPAMSel | TS_YP_PIN);
+    TSTaskWrite(TS_P_BASE + GPIO_O_DIR, ulPDir | TS_XP_PIN);
+    TSTaskWrite(TS_N_BASE + GPIO_O_DIR, ulNDir | TS_XN_PIN);
+    TSTaskWait(TS_SETTLE_SLOTS);
+    g_ulTSBurstTask = g_ulTSTasks;
+    TSTaskWrite(ADC0_BASE + ADC_O_PSSI, ADC_PSSI_SS0);
+    TSTaskWait(1);
+
+    //
+    // Drive the Y layer from YP to YN and discharge the X layer, then float
+    // the X layer and read the Y position from XP.
+    //
+    TSTaskWrite(TS_P_BASE + GPIO_O_AMSEL, ulPAMSel);
+    TSTaskWrite(TS_P_BASE + GPIO_O_DIR, ulPDir | TS_XP_PIN | TS_YP_PIN);
+    TSTaskWrite(TS_N_BASE + GPIO_O_DIR, ulNDir | TS_XN_PIN | TS_YN_PIN);
+    TSTaskWrite(TS_N_BASE + GPIO_O_DATA + ((TS_XN_PIN | TS_YN_PIN) << 2), 0);
+    TSTaskWrite(TS_P_BASE + GPIO_O_DATA + ((TS_XP_PIN | TS_YP_PIN) << 2),
+                TS_YP_PIN);
+    TSTaskWrite(TS_P_BASE + GPIO_O_AMSEL, ulPAMSel | TS_XP_PIN);
+    TSTaskWrite(TS_P_BASE + GPIO_O_DIR, ulPDir | TS_YP_PIN);
+    TSTaskWrite(TS_N_BASE + GPIO_O_DIR, ulNDir | TS_YN_PIN);
+    TSTaskWait(TS_SETTLE_SLOTS);
+    TSTaskWrite(ADC0_BASE + ADC_O_PSSI, ADC_PSSI_SS1);
+    TSTaskWait(1);
+
+    //
+    // Ground XN instead of YN and float YN, then read Z1 from XP and Z2 from
+    // YN.
+    //
+    TSTaskWrite(TS_N_BASE + GPIO_O_DIR, ulNDir | TS_XN_PIN);
+    TSTaskWrite(TS_N_BASE + GPIO_O_AMSEL, ulNAMSel | TS_YN_PIN);
+    TSTaskWait(TS_SETTLE_SLOTS);
+    TSTaskWrite(ADC0_BASE + ADC_O_PSSI, ADC_PSSI_SS2);
+    TSTaskWait(1);
+
+    //
+    // Collect the bursts.  The last task runs in basic mode so that the
+    // channel stops and raises the Timer 1 subtimer A interrupt.
+    //
+    TSTaskFIFO(ADC_O_SSFIFO0, g_pulTSBurst, TS_BURST_X, UDMA_ARB_8);
+    TSTaskFIFO(ADC_O_SSFIFO1, g_pulTSBurst + TS_BURST_X, TS_BURST_Y,
+               UDMA_ARB_4);
+    TSTaskFIFO(ADC_O_SSFIFO2, g_pulTSBurst + TS_BURST_X + TS_BURST_Y,
+               TS_BURST_Z, UDMA_ARB_4);
+    g_psTSTasks[g_ulTSTasks - 1].ui32Control =
+        ((g_psTSTasks[g_ulTSTasks - 1].ui32Control & ~0x7) | UDMA_MODE_BASIC);
+}
+
+//*****************************************************************************
+//
+// Hands the task list to the uDMA controller.  It runs from the next timer
+// timeout onwards.
+//
+//*****************************************************************************
+static void
+TSDMAStart(void)
+{
+    uDMAChannelScatterGatherSet(UDMA_CHANNEL_TMR1A, g_ulTSTasks, g_psTSTasks,
+                                1);
+    uDMAChannelEnable(UDMA_CHANNEL_TMR1A);
+}
+
+//*****************************************************************************
+//
+// Handles the end of a task list: takes a copy of the bursts, starts the
+// next list, and filters the bursts into a sample pair for the debouncer.
+//
+//*****************************************************************************
+static void
+TouchScreenBurstHandler(void)
+{
+    int16_t psSamples[TS_BURST_X + TS_BURST_Y + TS_BURST_Z];
+    int32_t lZ1, lZ2;
+    uint32_t ulIdx;
+
+    if(uDMAChannelIsEnabled(UDMA_CHANNEL_TMR1A))
+    {
+        return;
+    }
+
+    g_ulTSSampleTime = (HWREG(TS_DWT_CYCCNT) -
+                        ((g_ulTSTasks - 1 - g_ulTSBurstTask) * g_ulTSLoad));
+
+    for(ulIdx = 0; ulIdx < (TS_BURST_X + TS_BURST_Y + TS_BURST_Z); ulIdx++)
+    {
+        psSamples[ulIdx] = g_pulTSBurst[ulIdx] & 0xfff;
+    }
+
+    TSDMAStart();
+
+    //
+    // The pressure burst alternates Z1 and Z2 readings.
+    //
+    lZ1 = 0;
+    lZ2 = 0;
+    for(ulIdx = TS_BURST_X + TS_BURST_Y;
+        ulIdx < (TS_BURST_X + TS_BURST_Y + TS_BURST_Z); ulIdx += 2)
+    {
+        lZ1 += psSamples[ulIdx];
+        lZ2 += psSamples[ulIdx + 1];
+    }
+    g_sTouchZ1 = lZ1 / (TS_BURST_Z / 2);
+    g_sTouchZ2 = lZ2 / (TS_BURST_Z / 2);
+
+    TouchScreenFilterRun(psSamples, TS_BURST_X, psSamples + TS_BURST_X,
+                         TS_BURST_Y, g_sTouchZ1, g_sTouchZ2);
+
+    g_ulTSPairCount++;
+    TouchScreenDebouncer();
+}
+#endif
+
+//*****************************************************************************
+//
+// Advances the interrupt driven state machine by one ADC sample.  This runs
+// on each sample sequence 3 interrupt when the burst sampler is not in use.
+//
+//*****************************************************************************
+static void
+TouchScreenSampleHandler(void)
+{
+    int16_t sX, sY;
+
+    //
+    // Clear the ADC sample sequence interrupt.
+    //
+    HWREG(ADC0_BASE + ADC_O_ISC) = 1 << 3;
+
+    //
+    // Determine what to do based on the current state of the state machine.
+    //
+    switch(g_ulTSState)
+    {
+        //
+        // The new sample is an X axis sample that should be discarded.
+        //
+        case TS_STATE_SKIP_X:
         {
             //
-            // Read the raw ADC sample.
-            //
-            g_sTouchY = HWREG(ADC0_BASE + ADC_O_SSFIFO3);
+            // Read and throw away the ADC sample.
+            //
+            HWREG(ADC0_BASE + ADC_O_SSFIFO3);
+
+            //
+            // Set the analog mode select for the YP pin.
+            //
+            HWREG(TS_P_BASE + GPIO_O_AMSEL) =
+                HWREG(TS_P_BASE + GPIO_O_AMSEL) | TS_YP_PIN;
+
+            //
+            // Configure the Y axis touch layer pins as inputs.
+            //
+            HWREG(TS_P_BASE + GPIO_O_DIR) =
+                HWREG(TS_P_BASE + GPIO_O_DIR) & ~TS_YP_PIN;
+            //if(g_eDaughterType == DAUGHTER_NONE)
+            {
+                HWREG(TS_N_BASE + GPIO_O_DIR) =
+                    HWREG(TS_N_BASE + GPIO_O_DIR) & ~TS_YN_PIN;
+            }
+            //else if(g_eDaughterType == DAUGHTER_SRAM_FLASH)
+            //{
+            //    HWREGB(LCD_CONTROL_SET_REG) = LCD_CONTROL_YN;
+            //}
+
+            //
+            // The next sample will be a valid X axis sample.
+            //
+            g_ulTSState = TS_STATE_READ_X;
+
+            //
+            // This state has been handled.
+            //
+            break;
+        }
+
+        //
+        // The new sample is an X axis sample that should be processed.
+        //
+        case TS_STATE_READ_X:
+        {
+            //
+            // Read the raw ADC sample, noting when it was taken.
+            //
+            g_sTouchX = HWREG(ADC0_BASE + ADC_O_SSFIFO3);
+            g_ulTSSampleTime = HWREG(TS_DWT_CYCCNT);
+
+            //
+            // Clear the analog mode select for the YP pin.
+            //
+            HWREG(TS_P_BASE + GPIO_O_AMSEL) =
+                HWREG(TS_P_BASE + GPIO_O_AMSEL) & ~TS_YP_PIN;
+
+            //
+            // Configure the X and Y axis touch layers as outputs.
+            //
+            HWREG(TS_P_BASE + GPIO_O_DIR) =
+                HWREG(TS_P_BASE + GPIO_O_DIR) | TS_XP_PIN | TS_YP_PIN;
+
+            //if(g_eDaughterType == DAUGHTER_NONE)
+            {
+                HWREG(TS_N_BASE + GPIO_O_DIR) =
+                    HWREG(TS_N_BASE + GPIO_O_DIR) | TS_XN_PIN | TS_YN_PIN;
+            }
+
+            //
+            // Drive the positive side of the Y axis touch layer with VDD and
+            // the negative side with GND.  Also, drive both sides of the X
+            // axis layer with GND to discharge any residual voltage (so that
+            // a no-touch condition can be properly detected).
+            //
+            //if(g_eDaughterType == DAUGHTER_NONE)
+            {
+                HWREG(TS_N_BASE + GPIO_O_DATA +
+                      ((TS_XN_PIN | TS_YN_PIN) << 2)) = 0;
+            }
+            //else if(g_eDaughterType == DAUGHTER_SRAM_FLASH)
+            //{
+            //    HWREGB(LCD_CONTROL_CLR_REG) = LCD_CONTROL_XN | LCD_CONTROL_YN;
+            //}
+            HWREG(TS_P_BASE + GPIO_O_DATA + ((TS_XP_PIN | TS_YP_PIN) << 2)) =
+                TS_YP_PIN;
+
+            //
+            // Configure the sample sequence to capture the X axis value.
+            //
+            HWREG(ADC0_BASE + ADC_O_SSMUX3) = ADC_CTL_CH_XP;
+
+            //
+            // The next sample will be an invalid Y axis sample.
+            //
+            g_ulTSState = TS_STATE_SKIP_Y;
+
+            //
+            // This state has been handled.
+            //
+            break;
+        }
+
+        //
+        // The new sample is a Y axis sample that should be discarded.
+        //
+        case TS_STATE_SKIP_Y:
+        {
+            //
+            // Read and throw away the ADC sample.
+            //
+            HWREG(ADC0_BASE + ADC_O_SSFIFO3);
+
+            //
+            // Set the analog mode select for the XP pin.
+            //
+            HWREG(TS_P_BASE + GPIO_O_AMSEL) =
+                HWREG(TS_P_BASE + GPIO_O_AMSEL) | TS_XP_PIN;
+
+            //
+            // Configure the X axis touch layer pins as inputs.
+            //
+            HWREG(TS_P_BASE + GPIO_O_DIR) =
+                HWREG(TS_P_BASE + GPIO_O_DIR) & ~TS_XP_PIN;
+            //if(g_eDaughterType == DAUGHTER_NONE)
+            {
+                HWREG(TS_N_BASE + GPIO_O_DIR) =
+                    HWREG(TS_N_BASE + GPIO_O_DIR) & ~TS_XN_PIN;
+            }
+            //else if(g_eDaughterType == DAUGHTER_SRAM_FLASH)
+            //{
+            //    HWREGB(LCD_CONTROL_SET_REG) = LCD_CONTROL_XN;
+            //}
+
+            //
+            // The next sample will be a valid Y axis sample.
+            //
+            g_ulTSState = TS_STATE_READ_Y;
+
+            //
+            // This state has been handled.
+            //
+            break;
+        }
+
+        //
+        // The new sample is a Y axis sample that should be processed.
+        //
+        case TS_STATE_READ_Y:
+        {
+            //
+            // Read the raw ADC sample.
+            //
+            g_sTouchY = HWREG(ADC0_BASE + ADC_O_SSFIFO3);
+
+            //
+            // Ground the negative side of the X axis touch layer in place of
+            // the Y axis layer, and float YN, so that current flows through
+            // the point of contact.  XP is still selected, so the next sample
+            // is Z1.
+            //
+            HWREG(TS_N_BASE + GPIO_O_DIR) =
+                ((HWREG(TS_N_BASE + GPIO_O_DIR) & ~TS_YN_PIN) | TS_XN_PIN);
+            HWREG(TS_N_BASE + GPIO_O_AMSEL) =
+                HWREG(TS_N_BASE + GPIO_O_AMSEL) | TS_YN_PIN;
+
+            //
+            // The next sample will be the Z1 pressure sample.
+            //
+            g_ulTSState = TS_STATE_READ_Z1;
+
+            //
+            // This state has been handled.
+            //
+            break;
+        }
+
+        //
+        // The new sample is the Z1 pressure sample.
+        //
+        case TS_STATE_READ_Z1:
+        {
+            //
+            // Read the raw ADC sample.
+            //
+            g_sTouchZ1 = HWREG(ADC0_BASE + ADC_O_SSFIFO3);
+
+            //
+            // Configure the sample sequence to capture Z2 from YN.
+            //
+            HWREG(ADC0_BASE + ADC_O_SSMUX3) = ADC_CTL_CH_YN;
+
+            //
+            // The next sample will be the Z2 pressure sample.
+            //
+            g_ulTSState = TS_STATE_READ_Z2;
+
+            //
+            // This state has been handled.
+            //
+            break;
+        }
+
+        //
+        // The new sample is the Z2 pressure sample.
+        //
+        case TS_STATE_READ_Z2:
+        {
+            //
+            // Read the raw ADC sample, and clear the analog mode select for
+            // the YN pin.
+            //
+            g_sTouchZ2 = HWREG(ADC0_BASE + ADC_O_SSFIFO3);
+            HWREG(TS_N_BASE + GPIO_O_AMSEL) =
+                HWREG(TS_N_BASE + GPIO_O_AMSEL) & ~TS_YN_PIN;
+
+            //
+            // The next configuration is the same as the initial configuration.
+            // Therefore, fall through into the initialization state to avoid
+            // duplicating the code.
+            //
+        }
+
+        //
+        // The state machine is in its initial state
+        //
+        case TS_STATE_INIT:
+        {
+            //
+            // Clear the analog mode select for the XP pin.
+            //
+            HWREG(TS_P_BASE + GPIO_O_AMSEL) =
+                HWREG(TS_P_BASE + GPIO_O_AMSEL) & ~TS_XP_PIN;
+
+            //
+            // Configure the X and Y axis touch layers as outputs.
+            //
+            HWREG(TS_P_BASE + GPIO_O_DIR) =
+                HWREG(TS_P_BASE + GPIO_O_DIR) | TS_XP_PIN | TS_YP_PIN;
+            //if(g_eDaughterType == DAUGHTER_NONE)
+            {
+                HWREG(TS_N_BASE + GPIO_O_DIR) =
+                    HWREG(TS_N_BASE + GPIO_O_DIR) | TS_XN_PIN | TS_YN_PIN;
+            }
+
+            //
+            // Drive one side of the X axis touch layer with VDD and the other
+            // with GND.  Also, drive both sides of the Y axis layer with GND
+            // to discharge any residual voltage (so that a no-touch condition
+            // can be properly detected).
+            //
+            HWREG(TS_P_BASE + GPIO_O_DATA + ((TS_XP_PIN | TS_YP_PIN) << 2)) =
+                TS_XP_PIN;
+            //if(g_eDaughterType == DAUGHTER_NONE)
+            {
+                HWREG(TS_N_BASE + GPIO_O_DATA +
+                      ((TS_XN_PIN | TS_YN_PIN) << 2)) = 0;
+            }
+            //else if(g_eDaughterType == DAUGHTER_SRAM_FLASH)
+            //{
+            //    HWREGB(LCD_CONTROL_CLR_REG) = LCD_CONTROL_XN | LCD_CONTROL_YN;
+            //}
+            //
+            // Configure the sample sequence to capture the Y axis value.
+            //
+            HWREG(ADC0_BASE + ADC_O_SSMUX3) = ADC_CTL_CH_YP;
+
+            //
+            // If this is the Z2 sample state, then there is a new X/Y sample
+            // pair and pressure.  In that case, filter it and run the touch
+            // screen debouncer.
+            //
+            if(g_ulTSState == TS_STATE_READ_Z2)
+            {
+                sX = g_sTouchX;
+                sY = g_sTouchY;
+                TouchScreenFilterRun(&sX, 1, &sY, 1, g_sTouchZ1, g_sTouchZ2);
+                g_ulTSPairCount++;
+                TouchScreenDebouncer();
+            }
+
+            //
+            // The next sample will be an invalid X axis sample.
+            //
+            g_ulTSState = TS_STATE_SKIP_X;
+
+            //
+            // This state has been handled.
+            //
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Sets the sampling timer to the normal rate or, during a drag with the drag
+// burst enabled, the faster one.
+//
+//*****************************************************************************
+static void
+TSRateSet(void)
+{
+    g_ulTSLoad = (g_bTSDragging ? (g_ulTSLoadActive / TS_DRAG_RATE_MULT) :
+                  g_ulTSLoadActive);
+    TimerLoadSet(TIMER1_BASE, TIMER_A, g_ulTSLoad - 1);
+}
+
+//*****************************************************************************
+//
+// Stops sampling and biases the panel for pen detection: the Y layer is
+// grounded at both ends and the X layer floats up to VDD through the pull-up
+// on XP.  A touch joins the layers and pulls XP low, which raises the GPIO
+// interrupt.  A level interrupt is used so that a touch already in place
+// when going idle is not missed.  Any sample sequence 3 interrupt left by
+// the last conversion is cleared, since it would otherwise keep the
+// interrupt handler running for as long as the driver is idle.
+//
+//*****************************************************************************
+static void
+TSIdleEnter(void)
+{
+    TimerDisable(TIMER1_BASE, TIMER_A);
+    HWREG(ADC0_BASE + ADC_O_ISC) = 1 << 3;
+#ifdef TOUCH_DMA
+    if(g_bTSDMA)
+    {
+        uDMAChannelDisable(UDMA_CHANNEL_TMR1A);
+    }
+#endif
+
+    HWREG(TS_P_BASE + GPIO_O_AMSEL) =
+        HWREG(TS_P_BASE + GPIO_O_AMSEL) & ~(TS_XP_PIN | TS_YP_PIN);
+    HWREG(TS_N_BASE + GPIO_O_AMSEL) =
+        HWREG(TS_N_BASE + GPIO_O_AMSEL) & ~(TS_XN_PIN | TS_YN_PIN);
+    HWREG(TS_P_BASE + GPIO_O_DATA + ((TS_XP_PIN | TS_YP_PIN) << 2)) = 0;
+    HWREG(TS_N_BASE + GPIO_O_DATA + ((TS_XN_PIN | TS_YN_PIN) << 2)) = 0;
+    HWREG(TS_P_BASE + GPIO_O_DIR) =
+        ((HWREG(TS_P_BASE + GPIO_O_DIR) & ~TS_XP_PIN) | TS_YP_PIN);
+    HWREG(TS_N_BASE + GPIO_O_DIR) =
+        ((HWREG(TS_N_BASE + GPIO_O_DIR) & ~TS_XN_PIN) | TS_YN_PIN);
+    HWREG(TS_P_BASE + GPIO_O_PUR) =
+        HWREG(TS_P_BASE + GPIO_O_PUR) | TS_XP_PIN;
+
+    GPIOIntClear(TS_P_BASE, TS_XP_PIN);
+    GPIOIntEnable(TS_P_BASE, TS_XP_PIN);
+
+    g_bTSIdle = true;
+    g_ulTSIdleEntries++;
+}
+
+//*****************************************************************************
+//
+// Leaves the idle state after the pen detect interrupt and restarts sampling
+// from the beginning of a pair.
+//
+//*****************************************************************************
+static void
+TSIdleWake(void)
+{
+    GPIOIntDisable(TS_P_BASE, TS_XP_PIN);
+    GPIOIntClear(TS_P_BASE, TS_XP_PIN);
+    HWREG(TS_P_BASE + GPIO_O_PUR) =
+        HWREG(TS_P_BASE + GPIO_O_PUR) & ~TS_XP_PIN;
+
+    g_bTSIdle = false;
+    g_ulTSReleased = 0;
+
+#ifdef TOUCH_DMA
+    if(g_bTSDMA)
+    {
+        TSDMAStart();
+    }
+    else
+#endif
+    {
+        //
+        // Run the initial state now to drive the panel for the X axis; the
+        // timer then carries on from the first sample.
+        //
+        g_ulTSState = TS_STATE_INIT;
+        TouchScreenSampleHandler();
+    }
+
+    TimerEnable(TIMER1_BASE, TIMER_A);
+}
+
+//*****************************************************************************
+//
+// Updates the idle and drag tracking after each pair: switches to the drag
+// rate while the pen is down, if enabled, and goes idle once there has been
+// no press for long enough.
+//
+//*****************************************************************************
+static void
+TSActivityUpdate(void)
+{
+    if(g_bTSPressed)
+    {
+        g_ulTSReleased = 0;
+    }
+    else if(g_ulTSReleased != 0xffffffff)
+    {
+        g_ulTSReleased++;
+    }
+
+    if((g_bTSDragBurst && g_bTSPenDown) != g_bTSDragging)
+    {
+        g_bTSDragging = !g_bTSDragging;
+        TSRateSet();
+    }
+
+    if(g_ulTSIdlePairs && !g_bTSPenDown &&
+       (g_ulTSReleased >= g_ulTSIdlePairs))
+    {
+        TSIdleEnter();
+    }
+}
+
+//*****************************************************************************
+//
+//! Handles the interrupt for the touch screen.
+//!
+//! This function is called when the touch screen has new data: the end of a
+//! burst list on the Timer 1 subtimer A interrupt, or a single sample on the
+//! ADC sample sequence 3 interrupt when the uDMA controller is not in use.
+//! The samples are processed and, once an X/Y pair is complete, passed to the
+//! debouncer.  While the driver is idle it is instead called by the pen
+//! detect interrupt on GPIO port D, and restarts sampling.  The processor
+//! cycles spent here are accumulated for TouchScreenIntStats().
+//!
+//! It is the responsibility of the application using the touch screen driver
+//! to ensure that this function is installed in the interrupt vector table for
+//! the ADC3, the Timer 1 subtimer A and the GPIO port D interrupts.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenIntHandler(void)
+{
+    uint32_t ulStart, ulPairs;
+
+    ulStart = HWREG(TS_DWT_CYCCNT);
+
+    if(g_bTSIdle)
+    {
+        //
+        // Only the pen detect interrupt ends the idle state.  A sample that
+        // was still converting when the driver went idle is ignored, and its
+        // interrupt cleared so that it is not taken again.
+        //
+        g_ulTSIntIdle++;
+        HWREG(ADC0_BASE + ADC_O_ISC) = 1 << 3;
+        if(HWREG(TS_P_BASE + GPIO_O_MIS) & TS_XP_PIN)
+        {
+            TSIdleWake();
+        }
+    }
+    else
+    {
+        g_ulTSIntActive++;
+        ulPairs = g_ulTSPairCount;
+
+#ifdef TOUCH_DMA
+        if(g_bTSDMA)
+        {
+            TouchScreenBurstHandler();
+        }
+        else
+#endif
+        {
+            TouchScreenSampleHandler();
+        }
+
+        if(g_ulTSPairCount != ulPairs)
+        {
+            TSActivityUpdate();
+        }
+    }
+
+    g_ulTSIntCount++;
+    g_ulTSIntCycles += HWREG(TS_DWT_CYCCNT) - ulStart;
+}
+
+//*****************************************************************************
+//
+//! Initializes the touch screen driver.
+//!
+//! This function initializes the touch screen driver, beginning the process of
+//! reading from the touch screen.  This driver uses the following hardware
+//! resources:
+//!
+//! - ADC sample sequence 3, or sample sequences 0 to 2 when bursting
+//! - Timer 1 subtimer A
+//! - The GPIO port D interrupt, for pen detection while idle
+//! - uDMA channel 20, when the application has enabled the uDMA controller
+//!
+//! To read the touch screen in bursts, the uDMA controller must be enabled
+//! before this function is called.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenInit(void)
+{
+#ifdef TOUCH_DMA
+    uint32_t ulStep;
+#endif
+
+    //
+    // Set the initial state of the touch screen driver's state machine.
+    //
+    g_ulTSState = TS_STATE_INIT;
+
+    //
+    // Determine which calibration parameter set we will be using.  A
+    // calibration saved in flash takes precedence over the built-in ones.
+    //
+    if(!TouchScreenCalibrationLoad())
+    {
+        TouchScreenCalibrationSet(g_lTouchParameters[SET_NORMAL]);
+    }
+    //if(g_eDaughterType == DAUGHTER_SRAM_FLASH)
+    {
+        //
+        // If the SRAM/Flash daughter board is present, select the appropriate
+        // calibration parameters and reading threshold value.
+        //
+    //    TouchScreenCalibrationSet(g_lTouchParameters[SET_SRAM_FLASH]);
+    //    g_sTouchMin = 40;
+    }
+
+    //
+    // There is no touch screen handler initially, and messages are passed to
+    // it directly until the event queue is enabled.
+    //
+    g_pfnTSHandler = 0;
+    g_bTSEventQueue = false;
+    g_ulTSEventWrite = 0;
+    g_ulTSEventRead = 0;
+    g_bTSRaw = false;
+
+    //
+    // Start with empty filter histories.
+    //
+    TSFilterReset();
+
+    //
+    // Enable the peripherals used by the touch screen interface.
+    //
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
+    SysCtlPeripheralEnable(TS_P_PERIPH);
+    SysCtlPeripheralEnable(TS_N_PERIPH);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+
+    //
+    // Start the cycle counter used to measure the interrupt handler.
+    //
+    HWREG(TS_DEMCR) |= TS_DEMCR_TRCENA;
+    HWREG(TS_DWT_CTRL) |= TS_DWT_CTRL_CYCCNTENA;
+    g_ulTSIntCount = 0;
+    g_ulTSIntCycles = 0;
+    g_ulTSPairCount = 0;
+
+#ifdef TOUCH_DMA
+    //
+    // Read the touch screen in bursts if the uDMA controller is available.
+    //
+    g_bTSDMA = TSDMAAvailable();
+    if(g_bTSDMA)
+    {
+        //
+        // Configure sample sequence 0 to take the X burst from YP, sample
+        // sequence 1 to take the Y burst from XP and sample sequence 2 to
+        // take the pressure burst from XP and YN in turn.  All three are
+        // started by the task list writing the processor trigger register,
+        // and none interrupts.
+        //
+        ADCHardwareOversampleConfigure(ADC0_BASE, 4);
+        ADCSequenceConfigure(ADC0_BASE, 0, ADC_TRIGGER_PROCESSOR, 0);
+        ADCSequenceConfigure(ADC0_BASE, 1, ADC_TRIGGER_PROCESSOR, 0);
+        for(ulStep = 0; ulStep < TS_BURST_X; ulStep++)
+        {
+            ADCSequenceStepConfigure(ADC0_BASE, 0, ulStep,
+                                     (ADC_CTL_CH_YP |
+                                      ((ulStep == (TS_BURST_X - 1)) ?
+                                       ADC_CTL_END : 0)));
+        }
+        for(ulStep = 0; ulStep < TS_BURST_Y; ulStep++)
+        {
+            ADCSequenceStepConfigure(ADC0_BASE, 1, ulStep,
+                                     (ADC_CTL_CH_XP |
+                                      ((ulStep == (TS_BURST_Y - 1)) ?
+                                       ADC_CTL_END : 0)));
+        }
+        ADCSequenceConfigure(ADC0_BASE, 2, ADC_TRIGGER_PROCESSOR, 0);
+        for(ulStep = 0; ulStep < TS_BURST_Z; ulStep++)
+        {
+            ADCSequenceStepConfigure(ADC0_BASE, 2, ulStep,
+                                     (((ulStep & 1) ? ADC_CTL_CH_YN :
+                                       ADC_CTL_CH_XP) |
+                                      ((ulStep == (TS_BURST_Z - 1)) ?
+                                       ADC_CTL_END : 0)));
+        }
+        ADCSequenceEnable(ADC0_BASE, 0);
+        ADCSequenceEnable(ADC0_BASE, 1);
+        ADCSequenceEnable(ADC0_BASE, 2);
+    }
+    else
+#endif
+    {
+        //
+        // Configure the ADC sample sequence used to read the touch screen
+        // reading.
+        //
+        ADCHardwareOversampleConfigure(ADC0_BASE, 4);
+        ADCSequenceConfigure(ADC0_BASE, 3, ADC_TRIGGER_TIMER, 0);
+        ADCSequenceStepConfigure(ADC0_BASE, 3, 0,
+                                 ADC_CTL_CH_YP | ADC_CTL_END | ADC_CTL_IE);
+        ADCSequenceEnable(ADC0_BASE, 3);
+
+        //
+        // Enable the ADC sample sequence interrupt.
+        //
+        ADCIntEnable(ADC0_BASE, 3);
+        IntEnable(INT_ADC0SS3);
+    }
+
+    //
+    // Configure the GPIOs used to drive the touch screen layers.
+    //
+    GPIOPinTypeGPIOOutput(TS_P_BASE, TS_XP_PIN | TS_YP_PIN);
+
+    //
+    // If no daughter board is installed, set up GPIOs to drive the XN and YN
+    // signals.
+    //
+    //if(g_eDaughterType == DAUGHTER_NONE)
+    {
+        GPIOPinTypeGPIOOutput(TS_N_BASE, TS_XN_PIN | TS_YN_PIN);
+    }
+
+    GPIOPinWrite(TS_P_BASE, TS_XP_PIN | TS_YP_PIN, 0x00);
+    //if(g_eDaughterType == DAUGHTER_NONE)
+    {
+        GPIOPinWrite(TS_N_BASE, TS_XN_PIN | TS_YN_PIN, 0x00);
+    }
+    //else if(g_eDaughterType == DAUGHTER_SRAM_FLASH)
+    {
+    //    HWREGB(LCD_CONTROL_CLR_REG) = LCD_CONTROL_XN | LCD_CONTROL_YN;
+    }
+
+    //
+    // Prepare the pen detect interrupt on XP, used while idle.
+    //
+    g_bTSIdle = false;
+    g_bTSDragging = false;
+    GPIOIntDisable(TS_P_BASE, TS_XP_PIN);
+    GPIOIntTypeSet(TS_P_BASE, TS_XP_PIN, GPIO_LOW_LEVEL);
+    IntEnable(INT_GPIOD);
+
+#ifdef TOUCH_DMA
+    if(g_bTSDMA)
+    {
+        //
+        // Build the task list now that the pins are configured, and run the
+        // timer at one timeout per task so that a list takes one pair
+        // period.  The uDMA completion arrives on the timer's interrupt.
+        //
+        TSDMABuild();
+        TimerConfigure(TIMER1_BASE, (TIMER_CFG_SPLIT_PAIR |
+                                     TIMER_CFG_A_PERIODIC |
+                                     TIMER_CFG_B_PERIODIC));
+        g_ulTSLoadActive = SysCtlClockGet() / (TS_PAIR_RATE * g_ulTSTasks);
+        TSRateSet();
+        TouchScreenIdleSet(TS_IDLE_DELAY, false);
+        IntEnable(INT_TIMER1A);
+        TSDMAStart();
+        TimerEnable(TIMER1_BASE, TIMER_A);
+        return;
+    }
+#endif
+
+    //
+    // The state machine takes TS_PAIR_SAMPLES samples per pair, so it runs
+    // that many times faster than the pair rate.
+    //
+    g_ulTSLoadActive = SysCtlClockGet() / (TS_PAIR_RATE * TS_PAIR_SAMPLES);
+    g_ulTSLoad = g_ulTSLoadActive;
+    TouchScreenIdleSet(TS_IDLE_DELAY, false);
+
+    //
+    // See if the ADC trigger timer has been configured, and configure it only
+    // if it has not been configured yet.
+    //
+    if((HWREG(TIMER1_BASE + TIMER_O_CTL) & TIMER_CTL_TAEN) == 0)
+    {
+        //
+        // Configure the timer to trigger the sampling of the touch screen
+        // at the sample rate.
+        //
+        TimerConfigure(TIMER1_BASE, (TIMER_CFG_SPLIT_PAIR |
+                                     TIMER_CFG_A_PERIODIC |
+                                     TIMER_CFG_B_PERIODIC));
+        TSRateSet();
+        TimerControlTrigger(TIMER1_BASE, TIMER_A, true);
+
+        //
+        // Enable the timer.  At this point, the touch screen state machine
+        // will sample and run TS_PAIR_SAMPLES times per pair.
+        //
+        TimerEnable(TIMER1_BASE, TIMER_A);
+    }
+}
+
+//*****************************************************************************
+//
+//! Sets the callback function for touch screen events.
+//!
+//! \param pfnCallback is a pointer to the function to be called when touch
+//! screen events occur.
+//!
+//! This function sets the address of the function to be called when touch
+//! screen events occur.  The events that are recognized are the screen being
+//! touched (``pen down''), the touch position moving while the screen is
+//! touched (``pen move''), and the screen no longer being touched (``pen
+//! up'').
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenCallbackSet(int32_t (*pfnCallback)(uint32_t ulMessage, int32_t lX,
+                                           int32_t lY))
+{
+    //
+    // Save the pointer to the callback function.
+    //
+    g_pfnTSHandler = pfnCallback;
+}
+
+//*****************************************************************************
+//
+//! Routes touch screen messages through the driver's event queue.
+//!
+//! \param bEnable is \b true to queue messages for the application to read
+//! from its main loop, or \b false to call the touch screen event handler
+//! from the interrupt handler.
+//!
+//! With the queue enabled, each message is stored with the time its position
+//! was sampled and the pressure of the touch, and is read back with
+//! TouchScreenEventsRead() or passed to the touch screen event handler by
+//! TouchScreenEventsProcess().  The event handler then runs in the context
+//! of the main loop rather than at interrupt priority.  If the application
+//! falls behind, pen move messages are merged so that the pen down and pen up
+//! messages always find room.  Any messages still queued when the queue is
+//! disabled are discarded.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenEventQueueEnable(bool bEnable)
+{
+    bool bIntsOff;
+
+    bIntsOff = IntMasterDisable();
+
+    g_bTSEventQueue = bEnable;
+    g_ulTSEventRead = g_ulTSEventWrite;
+
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Reads messages from the touch screen event queue.
+//!
+//! \param psEvents is a pointer to storage for the messages.
+//! \param ulMax is the most messages to read.
+//!
+//! This function must only be called from one context, normally the main
+//! loop.  Each message carries the processor cycle count at which its
+//! position was sampled; the time from there to the message being read is
+//! included in TouchScreenLatencyStats().
+//!
+//! \return The number of messages read, which is zero if the queue is
+//! empty.
+//
+//*****************************************************************************
+uint32_t
+TouchScreenEventsRead(tTouchEvent *psEvents, uint32_t ulMax)
+{
+    uint32_t ulRead, ulCount;
+
+    ulRead = g_ulTSEventRead;
+
+    for(ulCount = 0; (ulCount < ulMax) && (ulRead != g_ulTSEventWrite);
+        ulCount++)
+    {
+        psEvents[ulCount] = g_psTSEvents[ulRead & (TOUCH_EVENT_QUEUE_SIZE - 1)];
+
+        //
+        // Release each entry as soon as it has been copied, so that the
+        // interrupt handler never merges into an entry being read.
+        //
+        ulRead++;
+        g_ulTSEventRead = ulRead;
+
+        TSLatencyRecord(psEvents[ulCount].ulTime);
+    }
+
+    return(ulCount);
+}
+
+//*****************************************************************************
+//
+//! Determines if the touch screen event queue holds any messages.
+//!
+//! This function lets the main loop decide whether it may sleep.  To avoid
+//! missing a message queued just after the check, call it with interrupts
+//! disabled and sleep before enabling them again; the processor still wakes
+//! for the pending interrupt.
+//!
+//! \return Returns \b true if there is at least one message to read.
+//
+//*****************************************************************************
+bool
+TouchScreenEventsPending(void)
+{
+    return(g_ulTSEventRead != g_ulTSEventWrite);
+}
+
+//*****************************************************************************
+//
+//! Adds a message to the touch screen event queue as if the driver had sent
+//! it.
+//!
+//! \param ulMessage is the message, one of \b WIDGET_MSG_PTR_DOWN,
+//! \b WIDGET_MSG_PTR_MOVE or \b WIDGET_MSG_PTR_UP.
+//! \param lX is the X coordinate of the pen.
+//! \param lY is the Y coordinate of the pen.
+//! \param ulPressure is the pressure of the pen, from 0 to 4095.
+//!
+//! This function lets an application replay strokes through its event
+//! handling, for instance to measure how many messages it can keep up with.
+//! The message is timed as sampled now, and is merged or dropped just as a
+//! message from the driver would be if the queue is nearly full.  The queue
+//! has a single writer, so this must be called from an interrupt handler
+//! that neither interrupts the driver's nor is interrupted by it, and the
+//! screen should not be touched while it is in use.
+//!
+//! \return Returns \b true if the event queue is enabled, or \b false if
+//! the message was not sent.
+//
+//*****************************************************************************
+bool
+TouchScreenEventInject(uint32_t ulMessage, int32_t lX, int32_t lY,
+                       uint32_t ulPressure)
+{
+    if(!g_bTSEventQueue)
+    {
+        return(false);
+    }
+
+    TSEventPut(ulMessage, lX, lY, HWREG(TS_DWT_CYCCNT), ulPressure);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Passes raw touch screen readings through to the messages.
+//!
+//! \param bRaw is \b true to report the raw ADC readings in place of screen
+//! coordinates, or \b false to apply the calibration again.
+//!
+//! This function is used while the touch screen is being calibrated, when the
+//! current calibration is not to be trusted.  The readings are still
+//! filtered and debounced as usual.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenRawSet(bool bRaw)
+{
+    g_bTSRaw = bRaw;
+}
+
+//*****************************************************************************
+//
+//! Passes queued touch screen messages to the touch screen event handler.
+//!
+//! This function reads up to eight messages from the event queue and calls
+//! the function set by TouchScreenCallbackSet() for each one, in the context
+//! of the caller.  TouchScreenPressureGet() returns the pressure of the
+//! message being handled.  It should be called regularly from the main loop
+//! when the event queue is enabled.
+//!
+//! \return The number of messages handled.
+//
+//*****************************************************************************
+uint32_t
+TouchScreenEventsProcess(void)
+{
+    tTouchEvent psEvents[TS_EVENT_BATCH];
+    uint32_t ulIdx, ulCount;
+
+    ulCount = TouchScreenEventsRead(psEvents, TS_EVENT_BATCH);
+
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        g_usTSMessagePressure = psEvents[ulIdx].usPressure;
+        if(g_pfnTSHandler)
+        {
+            g_pfnTSHandler(psEvents[ulIdx].ulMsg, psEvents[ulIdx].sX,
+                           psEvents[ulIdx].sY);
+        }
+    }
+
+    return(ulCount);
+}
+
+//*****************************************************************************
+//
+//! Reports how well the application is keeping up with the event queue.
+//!
+//! \param pulCoalesced is a pointer to storage for the number of pen move
+//! messages merged into an earlier one.
+//! \param pulOverflows is a pointer to storage for the number of messages
+//! dropped because the queue was full.
+//! \param pulHighWater is a pointer to storage for the most entries that
+//! have been in use at once.
+//! \param bReset is \b true if the counts should be cleared once read.
+//!
+//! Any of the pointers may be NULL.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenEventStats(uint32_t *pulCoalesced, uint32_t *pulOverflows,
+                      uint32_t *pulHighWater, bool bReset)
+{
+    bool bIntsOff;
+
+    bIntsOff = IntMasterDisable();
+
+    if(pulCoalesced)
+    {
+        *pulCoalesced = g_ulTSEventCoalesced;
+    }
+    if(pulOverflows)
+    {
+        *pulOverflows = g_ulTSEventOverflows;
+    }
+    if(pulHighWater)
+    {
+        *pulHighWater = g_ulTSEventHighWater;
+    }
+    if(bReset)
+    {
+        g_ulTSEventCoalesced = 0;
+        g_ulTSEventOverflows = 0;
+        g_ulTSEventHighWater = 0;
+    }
+
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Reports the processor time spent in the touch screen interrupt handler.
+//!
+//! \param pulPairs is a pointer to storage for the number of X/Y pairs
+//! passed to the debouncer.
+//! \param pulInts is a pointer to storage for the number of interrupts taken.
+//! \param pulCycles is a pointer to storage for the total number of processor
+//! cycles spent in TouchScreenIntHandler().
+//! \param bReset is \b true if the counts should be cleared once read.
+//!
+//! The counts cover the burst sampler or the interrupt driven state machine,
+//! whichever TouchScreenInit() selected, so \e pulCycles divided by
+//! \e pulPairs gives the interrupt cost of each coordinate for either one.
+//! Any of the pointers may be NULL.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenIntStats(uint32_t *pulPairs, uint32_t *pulInts,
+                    uint32_t *pulCycles, bool bReset)
+{
+    bool bIntsOff;
+
+    bIntsOff = IntMasterDisable();
+
+    if(pulPairs)
+    {
+        *pulPairs = g_ulTSPairCount;
+    }
+    if(pulInts)
+    {
+        *pulInts = g_ulTSIntCount;
+    }
+    if(pulCycles)
+    {
+        *pulCycles = g_ulTSIntCycles;
+    }
+    if(bReset)
+    {
+        g_ulTSPairCount = 0;
+        g_ulTSIntCount = 0;
+        g_ulTSIntCycles = 0;
+    }
+
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Configures the idle mode of the touch screen driver.
+//!
+//! \param ulIdleDelay is the time, in milliseconds, without a touch after
+//! which the driver stops sampling and waits for the pen detect interrupt, or
+//! zero to keep sampling all the time.
+//! \param bDragBurst is \b true to sample faster while the screen is being
+//! touched.
+//!
+//! While idle, the sampling timer is stopped and the panel is biased so that
+//! a touch pulls XP low, raising a GPIO port D interrupt; the driver then
+//! goes back to sampling at the normal rate.  The touch that woke the driver
+//! is debounced as usual, so nothing is lost.  With \e bDragBurst, the
+//! sampling rate is raised by a factor of two from pen down to pen up.  The
+//! default, set by TouchScreenInit(), is to go idle after 250 ms without a
+//! drag burst.
+//!
+//! TouchScreenInit() applies that default, so this function must be called
+//! after TouchScreenInit() for its settings to take effect; a call made
+//! before is safe but is overridden.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenIdleSet(uint32_t ulIdleDelay, bool bDragBurst)
+{
+    bool bIntsOff;
+
+    bIntsOff = IntMasterDisable();
+
+    g_ulTSIdlePairs = (ulIdleDelay * 1000) / g_ulTSPairPeriod;
+    if(ulIdleDelay && !g_ulTSIdlePairs)
+    {
+        g_ulTSIdlePairs = 1;
+    }
+    g_bTSDragBurst = bDragBurst;
+
+    //
+    // Wake up now if idling has been turned off.
+    //
+    if(g_bTSIdle && !g_ulTSIdlePairs)
+    {
+        TSIdleWake();
+    }
+
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Reports how many touch screen interrupts were taken while sampling and
+//! while idle.
+//!
+//! \param pulActive is a pointer to storage for the number of interrupts
+//! taken while sampling.
+//! \param pulIdle is a pointer to storage for the number of interrupts taken
+//! while idle.
+//! \param pulEntries is a pointer to storage for the number of times the
+//! driver has gone idle.
+//! \param bReset is \b true if the counts should be cleared once read.
+//!
+//! Any of the pointers may be NULL.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenIdleStats(uint32_t *pulActive, uint32_t *pulIdle,
+                     uint32_t *pulEntries, bool bReset)
+{
+    bool bIntsOff;
+
+    bIntsOff = IntMasterDisable();
+
+    if(pulActive)
+    {
+        *pulActive = g_ulTSIntActive;
+    }
+    if(pulIdle)
+    {
+        *pulIdle = g_ulTSIntIdle;
+    }
+    if(pulEntries)
+    {
+        *pulEntries = g_ulTSIdleEntries;
+    }
+    if(bReset)
+    {
+        g_ulTSIntActive = 0;
+        g_ulTSIntIdle = 0;
+        g_ulTSIdleEntries = 0;
+    }
+
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Sets the touch screen calibration parameters.
+//!
+//! \param plParms is a pointer to the seven calibration parameters, M0 to
+//! M6, as produced by the calibrate application.  They must stay valid while
+//! they are in use.
+//!
+//! The parameters map the raw readings to screen pixels as
+//! X = (x * M0 + y * M1 + M2) / M6 and Y = (x * M3 + y * M4 + M5) / M6.  They
+//! are converted here, using 64-bit arithmetic, into fixed-point factors with
+//! the division by M6 folded in, so that each sample needs only multiplies,
+//! adds and a shift, and the conversion checks that none of those can
+//! overflow for any raw reading.  The result is rounded to the nearest pixel
+//! rather than truncated.
+//!
+//! \return Returns \b true if the parameters were accepted, or \b false if
+//! M6 is zero or the transform cannot be evaluated safely, in which case the
+//! previous parameters remain in use.
+//
+//*****************************************************************************
+bool
+TouchScreenCalibrationSet(const int32_t *plParms)
+{
+    int32_t plCal[6], lShift, lIdx;
+    bool bIntsOff;
+
+    lShift = TSCalibrationConvert(plParms, plCal);
+    if(lShift < 0)
+    {
+        return(false);
+    }
+
+    bIntsOff = IntMasterDisable();
+    for(lIdx = 0; lIdx < 6; lIdx++)
+    {
+        g_plTSCal[lIdx] = plCal[lIdx];
+    }
+    g_ulTSCalShift = lShift;
+    g_plParmSet = plParms;
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Saves touch screen calibration parameters in flash.
+//!
+//! \param plParms is a pointer to the seven calibration parameters, M0-M6.
+//!
+//! The parameters are checked and converted as by
+//! TouchScreenCalibrationSet(), then written with a version number, the
+//! screen orientation and a CRC-32 to the flash page reserved for them, and
+//! put into use.  TouchScreenInit() loads them from there at every reset
+//! from then on.  The page is erased first, and the processor stalls while
+//! flash is being erased and programmed, which takes some milliseconds.
+//!
+//! \return Returns \b true if the parameters were saved, or \b false if
+//! they are not usable or the flash could not be programmed.
+//
+//*****************************************************************************
+bool
+TouchScreenCalibrationSave(const int32_t *plParms)
+{
+    tTSCalRecord sRecord;
+    int32_t lShift;
+    uint32_t ulIdx;
+
+    lShift = TSCalibrationConvert(plParms, sRecord.plCal);
+    if(lShift < 0)
+    {
+        return(false);
+    }
+
+    sRecord.ulMagic = TS_CAL_MAGIC;
+    sRecord.ulVersion = TS_CAL_VERSION;
+    sRecord.ulOrientation = TS_CAL_ORIENTATION;
+    for(ulIdx = 0; ulIdx < NUM_TOUCH_PARAMS; ulIdx++)
+    {
+        sRecord.plParms[ulIdx] = plParms[ulIdx];
+    }
+    sRecord.ulShift = lShift;
+    sRecord.ulCRC = Crc32(0xffffffff, (const uint8_t *)&sRecord,
+                          sizeof(sRecord) - sizeof(sRecord.ulCRC));
+
+    if(FlashErase(TS_CAL_FLASH_ADDR) ||
+       FlashProgram((uint32_t *)&sRecord, TS_CAL_FLASH_ADDR, sizeof(sRecord)))
+    {
+        return(false);
+    }
+
+    //
+    // Load the record back from flash, which also checks that it was
+    // programmed correctly.
+    //
+    return(TouchScreenCalibrationLoad());
+}
+
+//*****************************************************************************
+//
+//! Loads the touch screen calibration saved in flash.
+//!
+//! This function puts the calibration saved by TouchScreenCalibrationSave()
+//! into use, if the flash page holds a valid one for the current screen
+//! orientation.  It is called by TouchScreenInit(), which falls back to the
+//! built-in parameters if it fails.
+//!
+//! \return Returns \b true if a saved calibration was loaded.
+//
+//*****************************************************************************
+bool
+TouchScreenCalibrationLoad(void)
+{
+    const tTSCalRecord *psRecord;
+    uint32_t ulIdx;
+    bool bIntsOff;
+
+    psRecord = (const tTSCalRecord *)TS_CAL_FLASH_ADDR;
+    if((psRecord->ulMagic != TS_CAL_MAGIC) ||
+       (psRecord->ulVersion != TS_CAL_VERSION) ||
+       (psRecord->ulOrientation != TS_CAL_ORIENTATION) ||
+       (psRecord->ulShift > TS_CAL_SHIFT_MAX) ||
+       (psRecord->ulCRC != Crc32(0xffffffff, (const uint8_t *)psRecord,
+                                 (sizeof(tTSCalRecord) -
+                                  sizeof(psRecord->ulCRC)))))
+    {
+        return(false);
+    }
+
+    bIntsOff = IntMasterDisable();
+    for(ulIdx = 0; ulIdx < 6; ulIdx++)
+    {
+        g_plTSCal[ulIdx] = psRecord->plCal[ulIdx];
+    }
+    g_ulTSCalShift = psRecord->ulShift;
+    g_plParmSet = psRecord->plParms;
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+
+    return(true);
+}
 
-            //
-            // The next configuration is the same as the initial configuration.
-            // Therefore, fall through into the initialization state to avoid
-            // duplicating the code.
-            //
-        }
+#ifdef TOUCH_CAL_VERIFY
+//*****************************************************************************
+//
+//! Checks the fixed-point calibration transform against the exact one.
+//!
+//! This function evaluates the transform for every pair of 12-bit raw
+//! readings and compares it with the exact 64-bit result of the calibration
+//! parameters, rounded to the nearest pixel.  It is only built when
+//! TOUCH_CAL_VERIFY is defined; the check takes several seconds.
+//!
+//! \return Returns the largest difference found, in pixels, on either axis.
+//
+//*****************************************************************************
+uint32_t
+TouchScreenCalibrationVerify(void)
+{
+    int32_t lX, lY, lFixed, lExact;
+    uint32_t ulMax, ulErr;
 
-        //
-        // The state machine is in its initial state
-        //
-        case TS_STATE_INIT:
+    ulMax = 0;
+    for(lX = 0; lX <= TS_RAW_MAX; lX++)
+    {
+        for(lY = 0; lY <= TS_RAW_MAX; lY++)
         {
-            //
-            // Clear the analog mode select for the XP pin.
-            //
-            HWREG(TS_P_BASE + GPIO_O_AMSEL) =
-                HWREG(TS_P_BASE + GPIO_O_AMSEL) & ~TS_XP_PIN;
-
-            //
-            // Configure the X and Y axis touch layers as outputs.
-            //
-            HWREG(TS_P_BASE + GPIO_O_DIR) =
-                HWREG(TS_P_BASE + GPIO_O_DIR) | TS_XP_PIN | TS_YP_PIN;
-            //if(g_eDaughterType == DAUGHTER_NONE)
+            lFixed = (((lX * g_plTSCal[0]) + (lY * g_plTSCal[1]) +
+                       g_plTSCal[2]) >> g_ulTSCalShift);
+            lExact = TSDivRound(((int64_t)lX * g_plParmSet[0]) +
+                                ((int64_t)lY * g_plParmSet[1]) +
+                                g_plParmSet[2], g_plParmSet[6]);
+            ulErr = (lFixed > lExact) ? (lFixed - lExact) : (lExact - lFixed);
+            if(ulErr > ulMax)
             {
-                HWREG(TS_N_BASE + GPIO_O_DIR) =
-                    HWREG(TS_N_BASE + GPIO_O_DIR) | TS_XN_PIN | TS_YN_PIN;
+                ulMax = ulErr;
             }
 
-            //
-            // Drive one side of the X axis touch layer with VDD and the other
-            // with GND.  Also, drive both sides of the Y axis layer with GND
-            // to discharge any residual voltage (so that a no-touch condition
-            // can be properly detected).
-            //
-            HWREG(TS_P_BASE + GPIO_O_DATA + ((TS_XP_PIN | TS_YP_PIN) << 2)) =
-                TS_XP_PIN;
-            //if(g_eDaughterType == DAUGHTER_NONE)
+            lFixed = (((lX * g_plTSCal[3]) + (lY * g_plTSCal[4]) +
+                       g_plTSCal[5]) >> g_ulTSCalShift);
+            lExact = TSDivRound(((int64_t)lX * g_plParmSet[3]) +
+                                ((int64_t)lY * g_plParmSet[4]) +
+                                g_plParmSet[5], g_plParmSet[6]);
+            ulErr = (lFixed > lExact) ? (lFixed - lExact) : (lExact - lFixed);
+            if(ulErr > ulMax)
             {
-                HWREG(TS_N_BASE + GPIO_O_DATA +
-                      ((TS_XN_PIN | TS_YN_PIN) << 2)) = 0;
+                ulMax = ulErr;
             }
-            //else if(g_eDaughterType == DAUGHTER_SRAM_FLASH)
-            //{
-            //    HWREGB(LCD_CONTROL_CLR_REG) = LCD_CONTROL_XN | LCD_CONTROL_YN;
-            //}
-            //
-            // Configure the sample sequence to capture the Y axis value.
-            //
-            HWREG(ADC0_BASE + ADC_O_SSMUX3) = ADC_CTL_CH_YP;
+        }
+    }
 
-            //
-            // If this is the valid Y sample state, then there is a new X/Y
-            // sample pair.  In that case, run the touch screen debouncer.
-            //
-            if(g_ulTSState == TS_STATE_READ_Y)
-            {
-                TouchScreenDebouncer();
-            }
+    return(ulMax);
+}
+#endif
 
-            //
-            // The next sample will be an invalid X axis sample.
-            //
-            g_ulTSState = TS_STATE_SKIP_X;
+#ifdef TOUCH_TRACE
+//*****************************************************************************
+//
+//! Starts or stops recording a trace of the touch screen readings.
+//!
+//! \param bEnable is \b true to discard any previous trace and start
+//! recording, or \b false to stop.
+//!
+//! Each X/Y pair is recorded as it reaches the filter: the newest X, Y, Z1
+//! and Z2 readings and the processor cycle count at which the X reading was
+//! sampled.  Once \b TOUCH_TRACE_SIZE pairs have been recorded, each new pair
+//! replaces the oldest.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenTraceRecord(bool bEnable)
+{
+    bool bIntsOff;
 
-            //
-            // This state has been handled.
-            //
-            break;
+    bIntsOff = IntMasterDisable();
+
+    if(bEnable)
+    {
+        g_ulTSTraceCount = 0;
+    }
+    g_bTSTraceRecord = bEnable;
+
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Sends the recorded trace out of a UART.
+//!
+//! \param ulBase is the base address of a UART that has been configured by
+//! the application.
+//!
+//! Recording should be stopped first.  The trace is sent as text, oldest
+//! pair first: a line giving the number of pairs and the processor cycles per
+//! microsecond, then one line per pair holding the sample time in cycles and
+//! the X, Y, Z1 and Z2 readings, separated by commas.  This function waits
+//! for each character to be accepted by the UART.
+//!
+//! \return The number of pairs sent.
+//
+//*****************************************************************************
+uint32_t
+TouchScreenTraceDump(uint32_t ulBase)
+{
+    tTSTraceSample *psSample;
+    uint32_t ulIdx, ulFirst, ulCount;
+    char pcLine[48], *pcChar;
+
+    ulCount = g_ulTSTraceCount;
+    ulFirst = (ulCount > TOUCH_TRACE_SIZE) ? (ulCount - TOUCH_TRACE_SIZE) : 0;
+
+    usprintf(pcLine, "# pairs %u, cycles/us %u\r\n", ulCount - ulFirst,
+             SysCtlClockGet() / 1000000);
+    for(pcChar = pcLine; *pcChar; pcChar++)
+    {
+        UARTCharPut(ulBase, *pcChar);
+    }
+
+    for(ulIdx = ulFirst; ulIdx < ulCount; ulIdx++)
+    {
+        psSample = &g_psTSTrace[ulIdx % TOUCH_TRACE_SIZE];
+        usprintf(pcLine, "%u,%d,%d,%d,%d\r\n", psSample->ulTime,
+                 psSample->sX, psSample->sY, psSample->sZ1, psSample->sZ2);
+        for(pcChar = pcLine; *pcChar; pcChar++)
+        {
+            UARTCharPut(ulBase, *pcChar);
         }
     }
+
+    return(ulCount - ulFirst);
 }
 
 //*****************************************************************************
 //
-//! Initializes the touch screen driver.
+//! Replays the recorded trace through the touch screen driver.
 //!
-//! This function initializes the touch screen driver, beginning the process of
-//! reading from the touch screen.  This driver uses the following hardware
-//! resources:
+//! \param psReport is a pointer to storage for the results.
 //!
-//! - ADC sample sequence 3
-//! - Timer 1 subtimer A
+//! Each recorded pair is passed through the current filter, debouncer and
+//! calibration settings in turn, exactly as if it had just been sampled, so
+//! that the settings can be compared on the same input.  The messages are
+//! counted instead of being sent to the application.  Bursts are replayed as
+//! their newest reading, so the median and trimmed mean filters run across
+//! pairs.  The report gives:
+//!
+//! - the number of pairs, and of those the number that were pressed;
+//! - the number of pen down, pen move and pen up messages;
+//! - the number of false pen ups, where the pen went down again within
+//!   100 ms;
+//! - the number of pressed pairs that produced no pen down or pen move
+//!   message, being those spent debouncing and those discarded as the pen
+//!   lifted;
+//! - the total and worst case latency, in cycles, from the pair a message
+//!   carries to the pair that produced it;
+//! - the movement of the raw and filtered readings from one pressed pair to
+//!   the next, as reported by TouchScreenFilterStats().
+//!
+//! Recording should be stopped, and the screen not touched, while the
+//! replay runs.  Interrupts are disabled throughout, and the debouncer and
+//! filter start afresh both before and after it.
 //!
 //! \return None.
 //
 //*****************************************************************************
 void
-TouchScreenInit(void)
+TouchScreenTraceReplay(tTouchTraceReport *psReport)
 {
+    tTSTraceSample *psSample;
+    uint32_t ulIdx, ulFirst, ulCount, ulJitterRaw, ulJitterOut, ulJitter;
+    int16_t sX, sY;
+    bool bIntsOff;
+
+    bIntsOff = IntMasterDisable();
+
+    psReport->ulPairs = 0;
+    psReport->ulPressed = 0;
+    psReport->ulDown = 0;
+    psReport->ulMove = 0;
+    psReport->ulUp = 0;
+    psReport->ulFalseUp = 0;
+    psReport->ulLatencyTotal = 0;
+    psReport->ulLatencyMax = 0;
+
     //
-    // Set the initial state of the touch screen driver's state machine.
+    // Keep the jitter statistics of the live readings apart from those of
+    // the replay.
     //
-    g_ulTSState = TS_STATE_INIT;
+    ulJitterRaw = g_ulTSJitterRaw;
+    ulJitterOut = g_ulTSJitterOut;
+    ulJitter = g_ulTSJitterCount;
+    g_ulTSJitterRaw = 0;
+    g_ulTSJitterOut = 0;
+    g_ulTSJitterCount = 0;
 
     //
-    // Determine which calibration parameter set we will be using.
+    // Start with the pen up and nothing in the filter.
     //
-    g_plParmSet = g_lTouchParameters[SET_NORMAL];
-    //if(g_eDaughterType == DAUGHTER_SRAM_FLASH)
+    TSFilterReset();
+    g_bTSPenDown = false;
+    g_bTSDownSent = false;
+    g_ulTSDebounce = 0;
+    g_ulTSQueueCount = 0;
+
+    g_psTSReplay = psReport;
+    g_bTSReplay = true;
+
+    ulCount = g_ulTSTraceCount;
+    ulFirst = (ulCount > TOUCH_TRACE_SIZE) ? (ulCount - TOUCH_TRACE_SIZE) : 0;
+    for(ulIdx = ulFirst; ulIdx < ulCount; ulIdx++)
     {
-        //
-        // If the SRAM/Flash daughter board is present, select the appropriate
-        // calibration parameters and reading threshold value.
-        //
-    //    g_plParmSet = g_lTouchParameters[SET_SRAM_FLASH];
-    //    g_sTouchMin = 40;
+        psSample = &g_psTSTrace[ulIdx % TOUCH_TRACE_SIZE];
+        sX = psSample->sX;
+        sY = psSample->sY;
+        g_ulTSSampleTime = psSample->ulTime;
+        g_ulTSReplayTime = psSample->ulTime;
+
+        TouchScreenFilterRun(&sX, 1, &sY, 1, psSample->sZ1, psSample->sZ2);
+        psReport->ulPairs++;
+        if(g_bTSPressed)
+        {
+            psReport->ulPressed++;
+        }
+        TouchScreenDebouncer();
     }
 
-    //
-    // There is no touch screen handler initially.
-    //
-    g_pfnTSHandler = 0;
+    g_bTSReplay = false;
 
-    //
-    // Enable the peripherals used by the touch screen interface.
-    //
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
-    SysCtlPeripheralEnable(TS_P_PERIPH);
-    SysCtlPeripheralEnable(TS_N_PERIPH);
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    psReport->ulDropped = (psReport->ulPressed >
+                           (psReport->ulDown + psReport->ulMove)) ?
+                          (psReport->ulPressed -
+                           (psReport->ulDown + psReport->ulMove)) : 0;
+    psReport->ulJitterRaw = g_ulTSJitterRaw;
+    psReport->ulJitterFiltered = g_ulTSJitterOut;
+    psReport->ulJitterCount = g_ulTSJitterCount;
 
     //
-    // Configure the ADC sample sequence used to read the touch screen reading.
+    // Put the live state back.
     //
-    ADCHardwareOversampleConfigure(ADC0_BASE, 4);
-    ADCSequenceConfigure(ADC0_BASE, 3, ADC_TRIGGER_TIMER, 0);
-    ADCSequenceStepConfigure(ADC0_BASE, 3, 0,
-                             ADC_CTL_CH_YP | ADC_CTL_END | ADC_CTL_IE);
-    ADCSequenceEnable(ADC0_BASE, 3);
+    g_ulTSJitterRaw = ulJitterRaw;
+    g_ulTSJitterOut = ulJitterOut;
+    g_ulTSJitterCount = ulJitter;
+    TSFilterReset();
+    g_bTSPenDown = false;
+    g_bTSDownSent = false;
+    g_ulTSDebounce = 0;
+    g_ulTSQueueCount = 0;
+
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
+}
+#endif
 
-    //
-    // Enable the ADC sample sequence interrupt.
-    //
-    ADCIntEnable(ADC0_BASE, 3);
-    IntEnable(INT_ADC0SS3);
+//*****************************************************************************
+//
+//! Returns the pressure of the current touch screen message.
+//!
+//! This function may be called from the touch screen event handler to find
+//! the pressure of the touch that the message reports, from 0 for no contact
+//! to 4095 for a firm press.  It is zero for a pen up message.  Presses
+//! lighter than \e g_sTouchPressureMin are treated as no press at all.
+//!
+//! \return The pressure of the touch.
+//
+//*****************************************************************************
+uint32_t
+TouchScreenPressureGet(void)
+{
+    return(g_usTSMessagePressure);
+}
 
-    //
-    // Configure the GPIOs used to drive the touch screen layers.
-    //
-    GPIOPinTypeGPIOOutput(TS_P_BASE, TS_XP_PIN | TS_YP_PIN);
+//*****************************************************************************
+//
+//! Configures the touch screen debouncer.
+//!
+//! \param ulDownCount is the number of pressed samples needed before a press
+//! is reported.
+//! \param ulLookahead is the number of pressed samples held back, from 0 to
+//! \b TOUCH_DEBOUNCE_LOOKAHEAD_MAX.
+//!
+//! Positions sampled while the pen is being lifted tend to slide away from
+//! where it was; holding back the newest \e ulLookahead samples allows those
+//! to be dropped when the release is detected, at the cost of delaying every
+//! pen down and pen move message by that many samples.  The defaults,
+//! \b TOUCH_DEBOUNCE_DOWN and \b TOUCH_DEBOUNCE_LOOKAHEAD, suppress lift off
+//! movement completely.  \b TOUCH_LOW_LATENCY_DOWN and
+//! \b TOUCH_LOW_LATENCY_LOOKAHEAD report a press after two samples and
+//! delay moves by one, which is enough to hide the last sample before a
+//! release.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenDebounceSet(uint32_t ulDownCount, uint32_t ulLookahead)
+{
+    bool bIntsOff;
 
-    //
-    // If no daughter board is installed, set up GPIOs to drive the XN and YN
-    // signals.
-    //
-    //if(g_eDaughterType == DAUGHTER_NONE)
+    if(ulDownCount < 1)
     {
-        GPIOPinTypeGPIOOutput(TS_N_BASE, TS_XN_PIN | TS_YN_PIN);
+        ulDownCount = 1;
+    }
+    if(ulLookahead > TOUCH_DEBOUNCE_LOOKAHEAD_MAX)
+    {
+        ulLookahead = TOUCH_DEBOUNCE_LOOKAHEAD_MAX;
     }
 
-    GPIOPinWrite(TS_P_BASE, TS_XP_PIN | TS_YP_PIN, 0x00);
-    //if(g_eDaughterType == DAUGHTER_NONE)
+    bIntsOff = IntMasterDisable();
+    g_ulTSDownCount = ulDownCount;
+    g_ulTSLookahead = ulLookahead;
+    if(!bIntsOff)
     {
-        GPIOPinWrite(TS_N_BASE, TS_XN_PIN | TS_YN_PIN, 0x00);
+        IntMasterEnable();
     }
-    //else if(g_eDaughterType == DAUGHTER_SRAM_FLASH)
+}
+
+//*****************************************************************************
+//
+//! Reports the latency of the touch screen messages.
+//!
+//! \param pulCount is a pointer to storage for the number of messages sent
+//! to the touch screen event handler.
+//! \param pulTotal is a pointer to storage for the total latency of those
+//! messages, in processor cycles.
+//! \param pulMax is a pointer to storage for the largest latency seen, in
+//! processor cycles.
+//! \param bReset is \b true if the figures should be cleared once read.
+//!
+//! The latency of a message runs from the ADC sampling the X reading of the
+//! position it carries, or for a pen up message the reading that completed
+//! the release, to the event handler being called or, with the event queue
+//! enabled, to the message being read from the queue.  It includes the
+//! filter, the debouncer, the lookahead queue and any time spent in the
+//! event queue.  Any of the pointers may be NULL.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenLatencyStats(uint32_t *pulCount, uint32_t *pulTotal,
+                        uint32_t *pulMax, bool bReset)
+{
+    bool bIntsOff;
+
+    bIntsOff = IntMasterDisable();
+
+    if(pulCount)
     {
-    //    HWREGB(LCD_CONTROL_CLR_REG) = LCD_CONTROL_XN | LCD_CONTROL_YN;
+        *pulCount = g_ulTSLatencyCount;
+    }
+    if(pulTotal)
+    {
+        *pulTotal = g_ulTSLatencyTotal;
+    }
+    if(pulMax)
+    {
+        *pulMax = g_ulTSLatencyMax;
+    }
+    if(bReset)
+    {
+        g_ulTSLatencyCount = 0;
+        g_ulTSLatencyTotal = 0;
+        g_ulTSLatencyMax = 0;
     }
 
-    //
-    // See if the ADC trigger timer has been configured, and configure it only
-    // if it has not been configured yet.
-    //
-    if((HWREG(TIMER1_BASE + TIMER_O_CTL) & TIMER_CTL_TAEN) == 0)
+    if(!bIntsOff)
     {
-        //
-        // Configure the timer to trigger the sampling of the touch screen
-        // every millisecond.
-        //
-        TimerConfigure(TIMER1_BASE, (TIMER_CFG_SPLIT_PAIR |
-                                     TIMER_CFG_A_PERIODIC |
-                                     TIMER_CFG_B_PERIODIC));
-        TimerLoadSet(TIMER1_BASE, TIMER_A, (SysCtlClockGet() / 1000) - 1);
-        TimerControlTrigger(TIMER1_BASE, TIMER_A, true);
+        IntMasterEnable();
+    }
+}
 
-        //
-        // Enable the timer.  At this point, the touch screen state machine
-        // will sample and run once per millisecond.
-        //
-        TimerEnable(TIMER1_BASE, TIMER_A);
+//*****************************************************************************
+//
+//! Selects the filter applied to the raw touch screen readings.
+//!
+//! \param ulFilter is the filter to use; one of \b TOUCH_FILTER_NONE,
+//! \b TOUCH_FILTER_MEDIAN, \b TOUCH_FILTER_TRIMMED or \b TOUCH_FILTER_IIR.
+//! \param ulWindow is the number of raw readings, from 1 to
+//! \b TOUCH_FILTER_WINDOW_MAX, the filter considers.
+//!
+//! The filter sits between the raw ADC readings and the calibration
+//! transform, so g_sTouchX and g_sTouchY hold filtered readings.  When the
+//! touch screen is read in bursts, the median and trimmed mean are taken over
+//! the newest \e ulWindow samples of each burst and add no delay.  Otherwise
+//! they are taken over the last \e ulWindow pairs, limited to three so that
+//! the delay stays within one sample.  The IIR filter runs from pair to pair
+//! on the mean of the window, with a gain that rises with the speed of
+//! movement; its delay is at most one sample when the pen is still and none
+//! when it moves quickly.  With \b TOUCH_FILTER_NONE a burst is reduced to
+//! its mean.
+//!
+//! Across pairs, a median or trimmed mean of \e N pairs delays a steadily
+//! moving pen by (\e N - 1) / 2 pairs, which is why the window is limited
+//! there: a window of two delays it by half a pair (2 ms) and a window of
+//! three, or anything larger, by one pair (4 ms).  Replayed on the host,
+//! with the pen held still, these windows cut the jitter from 6.7 counts per
+//! pair to 3.4 and 2.5 with three counts of noise, and from 42 to 21 and 9.4
+//! with twelve counts of noise and occasional spikes.  The IIR filter cuts
+//! the same jitter to 3.0 and 30, with a delay of 0.8 pairs at eight counts
+//! per pair that falls to 0.3 pairs at 32.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchScreenFilterSet(uint32_t ulFilter, uint32_t ulWindow)
+{
+    bool bIntsOff;
+
+    if(ulWindow < 1)
+    {
+        ulWindow = 1;
+    }
+    if(ulWindow > TS_FILTER_MAX)
+    {
+        ulWindow = TS_FILTER_MAX;
+    }
+
+    bIntsOff = IntMasterDisable();
+    g_ulTSFilter = ulFilter;
+    g_ulTSFilterWindow = ulWindow;
+    TSFilterReset();
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
     }
 }
 
 //*****************************************************************************
 //
-//! Sets the callback function for touch screen events.
+//! Reports the jitter of the raw and filtered touch screen readings.
 //!
-//! \param pfnCallback is a pointer to the function to be called when touch
-//! screen events occur.
+//! \param pulRaw is a pointer to storage for the summed movement of the raw
+//! readings.
+//! \param pulFiltered is a pointer to storage for the summed movement of the
+//! filtered readings.
+//! \param pulCount is a pointer to storage for the number of movements
+//! summed.
+//! \param bReset is \b true if the sums should be cleared once read.
 //!
-//! This function sets the address of the function to be called when touch
-//! screen events occur.  The events that are recognized are the screen being
-//! touched (``pen down''), the touch position moving while the screen is
-//! touched (``pen move''), and the screen no longer being touched (``pen
-//! up'').
+//! The movement is the change in X plus the change in Y, in ADC counts,
+//! between consecutive pairs while the screen is pressed.  With the pen held
+//! still, \e pulRaw and \e pulFiltered divided by \e pulCount are the
+//! jitter before and after the filter.  Any of the pointers may be NULL.
 //!
 //! \return None.
 //
 //*****************************************************************************
 void
-TouchScreenCallbackSet(int32_t (*pfnCallback)(uint32_t ulMessage, int32_t lX,
-                                           int32_t lY))
+TouchScreenFilterStats(uint32_t *pulRaw, uint32_t *pulFiltered,
+                       uint32_t *pulCount, bool bReset)
 {
-    //
-    // Save the pointer to the callback function.
-    //
-    g_pfnTSHandler = pfnCallback;
+    bool bIntsOff;
+
+    bIntsOff = IntMasterDisable();
+
+    if(pulRaw)
+    {
+        *pulRaw = g_ulTSJitterRaw;
+    }
+    if(pulFiltered)
+    {
+        *pulFiltered = g_ulTSJitterOut;
+    }
+    if(pulCount)
+    {
+        *pulCount = g_ulTSJitterCount;
+    }
+    if(bReset)
+    {
+        g_ulTSJitterRaw = 0;
+        g_ulTSJitterOut = 0;
+        g_ulTSJitterCount = 0;
+    }
+
+    if(!bIntsOff)
+    {
+        IntMasterEnable();
+    }
 }
 
 //*****************************************************************************
@@ -15,6 +15,97 @@
 //*****************************************************************************
 #define TOUCH_MIN 150
 
+//*****************************************************************************
+//
+// The lowest touch pressure, on a scale of 0 (no contact) to 4095 (a firm
+// press), assumed to represent a press on the screen.  Lighter contacts give
+// unreliable positions and are treated as no press.
+//
+//*****************************************************************************
+#define TOUCH_PRESSURE_MIN 256
+
+//*****************************************************************************
+//
+// The filters that can be applied to the raw touch screen readings with
+// TouchScreenFilterSet(), and the largest window they accept.
+//
+//*****************************************************************************
+#define TOUCH_FILTER_NONE       0
+#define TOUCH_FILTER_MEDIAN     1
+#define TOUCH_FILTER_TRIMMED    2
+#define TOUCH_FILTER_IIR        3
+#define TOUCH_FILTER_WINDOW_MAX 8
+
+//*****************************************************************************
+//
+// The debouncer settings for TouchScreenDebounceSet(): the defaults, which
+// hold back four samples to hide any movement as the pen is lifted, and a
+// low latency alternative.
+//
+//*****************************************************************************
+#define TOUCH_DEBOUNCE_DOWN             3
+#define TOUCH_DEBOUNCE_LOOKAHEAD        4
+#define TOUCH_DEBOUNCE_LOOKAHEAD_MAX    7
+#define TOUCH_LOW_LATENCY_DOWN          2
+#define TOUCH_LOW_LATENCY_LOOKAHEAD     1
+
+//*****************************************************************************
+//
+// A touch screen event, as read from the driver's event queue by
+// TouchScreenEventsRead().  ulTime is the processor cycle count at which the
+// position was sampled, and usCount is the number of pen move messages that
+// were merged into this one while the queue was nearly full.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ulMsg;
+    uint32_t ulTime;
+    int16_t sX;
+    int16_t sY;
+    uint16_t usPressure;
+    uint16_t usCount;
+}
+tTouchEvent;
+
+//*****************************************************************************
+//
+// The number of events the touch screen event queue holds.
+//
+//*****************************************************************************
+#define TOUCH_EVENT_QUEUE_SIZE  32
+
+#ifdef TOUCH_TRACE
+//*****************************************************************************
+//
+// The number of X/Y pairs the trace recorder holds, and the results of
+// replaying a trace through the filter, the debouncer and the calibration
+// with TouchScreenTraceReplay().  The latencies are in processor cycles of
+// the recorded time line.
+//
+//*****************************************************************************
+#ifndef TOUCH_TRACE_SIZE
+#define TOUCH_TRACE_SIZE        512
+#endif
+
+typedef struct
+{
+    uint32_t ulPairs;
+    uint32_t ulPressed;
+    uint32_t ulDown;
+    uint32_t ulMove;
+    uint32_t ulUp;
+    uint32_t ulFalseUp;
+    uint32_t ulDropped;
+    uint32_t ulLatencyTotal;
+    uint32_t ulLatencyMax;
+    uint32_t ulJitterRaw;
+    uint32_t ulJitterFiltered;
+    uint32_t ulJitterCount;
+}
+tTouchTraceReport;
+#endif
+
 //*****************************************************************************
 //
 // Prototypes for the functions exported by the touch screen driver.
@@ -23,9 +114,44 @@
 extern volatile short g_sTouchX;
 extern volatile short g_sTouchY;
 extern short g_sTouchMin;
+extern short g_sTouchPressureMin;
 extern void TouchScreenIntHandler(void);
 extern void TouchScreenInit(void);
 extern void TouchScreenCallbackSet(int32_t (*pfnCallback)(uint32_t ulMessage,
                                                        int32_t lX, int32_t lY));
+extern void TouchScreenEventQueueEnable(bool bEnable);
+extern uint32_t TouchScreenEventsRead(tTouchEvent *psEvents, uint32_t ulMax);
+extern uint32_t TouchScreenEventsProcess(void);
+extern bool TouchScreenEventsPending(void);
+extern bool TouchScreenEventInject(uint32_t ulMessage, int32_t lX, int32_t lY,
+                                   uint32_t ulPressure);
+extern void TouchScreenRawSet(bool bRaw);
+extern void TouchScreenEventStats(uint32_t *pulCoalesced,
+                                  uint32_t *pulOverflows,
+                                  uint32_t *pulHighWater, bool bReset);
+extern void TouchScreenIntStats(uint32_t *pulPairs, uint32_t *pulInts,
+                                uint32_t *pulCycles, bool bReset);
+extern bool TouchScreenCalibrationSet(const int32_t *plParms);
+extern bool TouchScreenCalibrationSave(const int32_t *plParms);
+extern bool TouchScreenCalibrationLoad(void);
+#ifdef TOUCH_CAL_VERIFY
+extern uint32_t TouchScreenCalibrationVerify(void);
+#endif
+#ifdef TOUCH_TRACE
+extern void TouchScreenTraceRecord(bool bEnable);
+extern uint32_t TouchScreenTraceDump(uint32_t ulBase);
+extern void TouchScreenTraceReplay(tTouchTraceReport *psReport);
+#endif
+extern uint32_t TouchScreenPressureGet(void);
+extern void TouchScreenIdleSet(uint32_t ulIdleDelay, bool bDragBurst);
+extern void TouchScreenIdleStats(uint32_t *pulActive, uint32_t *pulIdle,
+                                 uint32_t *pulEntries, bool bReset);
+extern void TouchScreenDebounceSet(uint32_t ulDownCount,
+                                   uint32_t ulLookahead);
+extern void TouchScreenLatencyStats(uint32_t *pulCount, uint32_t *pulTotal,
+                                    uint32_t *pulMax, bool bReset);
+extern void TouchScreenFilterSet(uint32_t ulFilter, uint32_t ulWindow);
+extern void TouchScreenFilterStats(uint32_t *pulRaw, uint32_t *pulFiltered,
+                                   uint32_t *pulCount, bool bReset);
 
 #endif // __TOUCH_H__
@@ -0,0 +1,563 @@
+//*****************************************************************************
+//
+// touchcal.c - Touch screen calibration engine.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! \addtogroup touchcal_api
+//! @{
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "grlib/grlib.h"
+#include "grlib/widget.h"
+#include "touch.h"
+#include "touchcal.h"
+
+//*****************************************************************************
+//
+// The calibration points are spread over a 3x3 grid, the corners first, then
+// the center, then the middle of each edge.  This gives their positions in
+// tenths of the screen width and height.
+//
+//*****************************************************************************
+static const unsigned char g_ppucCalPointPos[9][2] =
+{
+    { 1, 2 }, { 9, 2 }, { 9, 9 }, { 1, 9 }, { 5, 5 },
+    { 5, 2 }, { 9, 5 }, { 5, 9 }, { 1, 5 }
+};
+
+//*****************************************************************************
+//
+// The largest residual error, in tenths of a pixel, accepted for any point
+// once the calibration has been fitted, and the number of times the worst
+// point may be taken again before the fit is accepted as it is.
+//
+//*****************************************************************************
+#define CAL_RESIDUAL_MAX 30
+#define CAL_RETRIES      4
+
+//*****************************************************************************
+//
+// The number of samples at the start of each touch that are discarded while
+// the pen settles, and the time in ticks between one box being touched and
+// the next one being shown.
+//
+//*****************************************************************************
+#define CAL_SKIP         5
+#define CAL_DELAY        (TOUCHCAL_TICKS_PER_SECOND / 2)
+
+//*****************************************************************************
+//
+// The rows at the top of the screen left alone for the application's banner.
+//
+//*****************************************************************************
+#define CAL_TOP          24
+
+//*****************************************************************************
+//
+// The states of the calibration.  While waiting, no box is shown and touches
+// are ignored; the timer moves on to showing the box for the current point.
+// A touch of the box is then sampled until the pen is lifted, which leaves
+// the averaged readings for TouchCalProcess() to store.
+//
+//*****************************************************************************
+#define CAL_STATE_IDLE      0
+#define CAL_STATE_WAIT      1
+#define CAL_STATE_TARGET    2
+#define CAL_STATE_SAMPLING  3
+#define CAL_STATE_LIFTED    4
+
+//*****************************************************************************
+//
+// The state of the calibration in progress.  g_pplCalPoints holds the screen
+// position of each point followed by its averaged raw readings.
+//
+//*****************************************************************************
+static volatile uint32_t g_ulCalState = CAL_STATE_IDLE;
+static volatile uint32_t g_ulCalTicks;
+static volatile bool g_bCalTimeout;
+static tContext g_sCalContext;
+static void (*g_pfnCalDone)(const tTouchCalResult *psResult);
+static long g_pplCalPoints[TOUCHCAL_POINTS][4];
+static long g_lCalPoint;
+static long g_lCalRetry;
+static bool g_bCalAllTaken;
+static long g_lCalX, g_lCalY, g_lCalCount;
+static tTouchCalResult g_sCalResult;
+
+//*****************************************************************************
+//
+// Divides one 64-bit value by another, rounding to the nearest integer.
+//
+//*****************************************************************************
+static int64_t
+CalDivRound(int64_t llNum, int64_t llDen)
+{
+    if((llNum < 0) == (llDen < 0))
+    {
+        return((llNum + (llDen / 2)) / llDen);
+    }
+    return((llNum - (llDen / 2)) / llDen);
+}
+
+//*****************************************************************************
+//
+// Fits the calibration parameters M0-M6 to the points by least squares, so
+// that each screen coordinate is (M0 * x + M1 * y + M2) / M6 for the X axis
+// and (M3 * x + M4 * y + M5) / M6 for the Y axis.  The sums are taken about
+// the mean of the points, scaled by their number to stay in integers, which
+// keeps every product within 64 bits for 12-bit readings.  The common
+// denominator is then scaled down to no more than 2^20, which leaves plenty
+// of precision in M0, M1, M3 and M4 and room for M2 and M5 in 32 bits.
+// Returns false if the points do not span the screen.
+//
+//*****************************************************************************
+static bool
+CalibrationFit(long pplPoints[][4], long lCount, int32_t *plParms)
+{
+    int64_t llSx, llSy, llSX, llSY, llSxx, llSxy, llSyy;
+    int64_t llSxX, llSyX, llSxY, llSyY;
+    int64_t llCxx, llCxy, llCyy, llCxX, llCyX, llCxY, llCyY;
+    int64_t llDet, pllParms[7], llScale;
+    long lIdx;
+
+    llSx = llSy = llSX = llSY = llSxx = llSxy = llSyy = 0;
+    llSxX = llSyX = llSxY = llSyY = 0;
+    for(lIdx = 0; lIdx < lCount; lIdx++)
+    {
+        llSX += pplPoints[lIdx][0];
+        llSY += pplPoints[lIdx][1];
+        llSx += pplPoints[lIdx][2];
+        llSy += pplPoints[lIdx][3];
+        llSxx += (int64_t)pplPoints[lIdx][2] * pplPoints[lIdx][2];
+        llSxy += (int64_t)pplPoints[lIdx][2] * pplPoints[lIdx][3];
+        llSyy += (int64_t)pplPoints[lIdx][3] * pplPoints[lIdx][3];
+        llSxX += (int64_t)pplPoints[lIdx][2] * pplPoints[lIdx][0];
+        llSyX += (int64_t)pplPoints[lIdx][3] * pplPoints[lIdx][0];
+        llSxY += (int64_t)pplPoints[lIdx][2] * pplPoints[lIdx][1];
+        llSyY += (int64_t)pplPoints[lIdx][3] * pplPoints[lIdx][1];
+    }
+
+    //
+    // The sums about the mean, times the number of points.
+    //
+    llCxx = (lCount * llSxx) - (llSx * llSx);
+    llCxy = (lCount * llSxy) - (llSx * llSy);
+    llCyy = (lCount * llSyy) - (llSy * llSy);
+    llCxX = (lCount * llSxX) - (llSx * llSX);
+    llCyX = (lCount * llSyX) - (llSy * llSX);
+    llCxY = (lCount * llSxY) - (llSx * llSY);
+    llCyY = (lCount * llSyY) - (llSy * llSY);
+
+    //
+    // Solve the normal equations for the slopes.
+    //
+    llDet = (llCxx * llCyy) - (llCxy * llCxy);
+    if(llDet <= 0)
+    {
+        return(false);
+    }
+    pllParms[0] = (llCxX * llCyy) - (llCyX * llCxy);
+    pllParms[1] = (llCyX * llCxx) - (llCxX * llCxy);
+    pllParms[3] = (llCxY * llCyy) - (llCyY * llCxy);
+    pllParms[4] = (llCyY * llCxx) - (llCxY * llCxy);
+
+    //
+    // Scale the slopes and their denominator down together.
+    //
+    for(llScale = 1; (llDet / llScale) >= (1 << 20); llScale *= 2)
+    {
+    }
+    pllParms[0] = CalDivRound(pllParms[0], llScale);
+    pllParms[1] = CalDivRound(pllParms[1], llScale);
+    pllParms[3] = CalDivRound(pllParms[3], llScale);
+    pllParms[4] = CalDivRound(pllParms[4], llScale);
+    pllParms[6] = CalDivRound(llDet, llScale);
+
+    //
+    // The offsets put the fitted line through the mean of the points.
+    //
+    pllParms[2] = CalDivRound((llSX * pllParms[6]) - (pllParms[0] * llSx) -
+                              (pllParms[1] * llSy), lCount);
+    pllParms[5] = CalDivRound((llSY * pllParms[6]) - (pllParms[3] * llSx) -
+                              (pllParms[4] * llSy), lCount);
+
+    for(lIdx = 0; lIdx < 7; lIdx++)
+    {
+        if((pllParms[lIdx] > INT32_MAX) || (pllParms[lIdx] < INT32_MIN))
+        {
+            return(false);
+        }
+        plParms[lIdx] = pllParms[lIdx];
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Returns the distance, in tenths of a pixel, between where a calibration
+// point is on the screen and where the calibration parameters place its raw
+// readings.  The distance is approximated by the larger of the two axis
+// differences plus half of the smaller.
+//
+//*****************************************************************************
+static long
+CalibrationResidual(const long *plPoint, const int32_t *plParms)
+{
+    int64_t llX, llY;
+
+    llX = CalDivRound(((((int64_t)plPoint[2] * plParms[0]) +
+                        ((int64_t)plPoint[3] * plParms[1]) + plParms[2]) * 10),
+                      plParms[6]) - (plPoint[0] * 10);
+    llY = CalDivRound(((((int64_t)plPoint[2] * plParms[3]) +
+                        ((int64_t)plPoint[3] * plParms[4]) + plParms[5]) * 10),
+                      plParms[6]) - (plPoint[1] * 10);
+    llX = (llX < 0) ? -llX : llX;
+    llY = (llY < 0) ? -llY : llY;
+
+    return((llX > llY) ? (llX + (llY / 2)) : (llY + (llX / 2)));
+}
+
+//*****************************************************************************
+//
+// Fills the box around the current calibration point with the given color.
+//
+//*****************************************************************************
+static void
+CalBoxFill(uint32_t ulColor)
+{
+    tRectangle sRect;
+
+    sRect.i16XMin = g_pplCalPoints[g_lCalPoint][0] - 5;
+    sRect.i16YMin = g_pplCalPoints[g_lCalPoint][1] - 5;
+    sRect.i16XMax = g_pplCalPoints[g_lCalPoint][0] + 5;
+    sRect.i16YMax = g_pplCalPoints[g_lCalPoint][1] + 5;
+    GrContextForegroundSet(&g_sCalContext, ulColor);
+    GrRectFill(&g_sCalContext, &sRect);
+    GrFlush(&g_sCalContext);
+}
+
+//*****************************************************************************
+//
+// Clears the screen below the banner.
+//
+//*****************************************************************************
+static void
+CalScreenClear(void)
+{
+    tRectangle sRect;
+
+    sRect.i16XMin = 0;
+    sRect.i16YMin = CAL_TOP;
+    sRect.i16XMax = GrContextDpyWidthGet(&g_sCalContext) - 1;
+    sRect.i16YMax = GrContextDpyHeightGet(&g_sCalContext) - 1;
+    GrContextForegroundSet(&g_sCalContext, ClrBlack);
+    GrRectFill(&g_sCalContext, &sRect);
+}
+
+//*****************************************************************************
+//
+// Starts the delay before the box for the current point is shown.
+//
+//*****************************************************************************
+static void
+CalWait(void)
+{
+    g_ulCalState = CAL_STATE_WAIT;
+    g_bCalTimeout = false;
+    g_ulCalTicks = CAL_DELAY;
+}
+
+//*****************************************************************************
+//
+// Fits the calibration to the points.  While the point furthest from the fit
+// is out by more than CAL_RESIDUAL_MAX, it is assumed to have been a bad
+// touch and is taken again; otherwise the calibration is saved and the
+// application is told the result.
+//
+//*****************************************************************************
+static void
+CalFinish(void)
+{
+    long lIdx, lWorst;
+
+    g_sCalResult.bFitted = CalibrationFit(g_pplCalPoints, TOUCHCAL_POINTS,
+                                          g_sCalResult.plParms);
+
+    lWorst = 0;
+    for(lIdx = 0; g_sCalResult.bFitted && (lIdx < TOUCHCAL_POINTS); lIdx++)
+    {
+        g_sCalResult.plResiduals[lIdx] =
+            CalibrationResidual(g_pplCalPoints[lIdx], g_sCalResult.plParms);
+        if(g_sCalResult.plResiduals[lIdx] > g_sCalResult.plResiduals[lWorst])
+        {
+            lWorst = lIdx;
+        }
+    }
+
+    if((g_lCalRetry < CAL_RETRIES) &&
+       (!g_sCalResult.bFitted ||
+        (g_sCalResult.plResiduals[lWorst] > CAL_RESIDUAL_MAX)))
+    {
+        g_lCalRetry++;
+        g_lCalPoint = lWorst;
+        CalWait();
+        return;
+    }
+
+    //
+    // Save the calibration in flash, which also puts it into use, and go
+    // back to reporting screen coordinates.
+    //
+    g_sCalResult.ulPoints = TOUCHCAL_POINTS;
+    g_sCalResult.bSaved = (g_sCalResult.bFitted &&
+                           TouchScreenCalibrationSave(g_sCalResult.plParms));
+    TouchScreenRawSet(false);
+
+    CalScreenClear();
+    GrFlush(&g_sCalContext);
+
+    g_ulCalState = CAL_STATE_IDLE;
+    if(g_pfnCalDone)
+    {
+        g_pfnCalDone(&g_sCalResult);
+    }
+}
+
+//*****************************************************************************
+//
+//! Starts a calibration of the touch screen.
+//!
+//! \param psDisplay is a pointer to the display to draw the calibration
+//! points on.
+//! \param pfnDone is a pointer to the function called, from
+//! TouchCalProcess(), once the calibration has finished.
+//!
+//! This function clears the screen below the banner and has the user touch
+//! a box at each calibration point in turn.  No time is spent waiting here or
+//! anywhere else; the calibration moves on as touch screen messages are
+//! passed to TouchCalPointerMessage(), as TouchCalTick() is called from a
+//! timer, and as the application calls TouchCalProcess() from its main loop.
+//! While the calibration runs, the touch screen driver reports raw readings
+//! rather than screen coordinates, so the messages must not be passed to
+//! the widget tree.
+//!
+//! When the points have been taken the calibration is fitted to them, any
+//! point that fits badly is taken again, and the result is saved with
+//! TouchScreenCalibrationSave() before \e pfnDone is called.  The area below
+//! the banner is left clear for the application to repaint.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchCalStart(const tDisplay *psDisplay,
+              void (*pfnDone)(const tTouchCalResult *psResult))
+{
+    long lIdx;
+
+    GrContextInit(&g_sCalContext, psDisplay);
+    g_pfnCalDone = pfnDone;
+
+    //
+    // Set the points used for calibration based on the size of the screen.
+    //
+    for(lIdx = 0; lIdx < TOUCHCAL_POINTS; lIdx++)
+    {
+        g_pplCalPoints[lIdx][0] = ((GrContextDpyWidthGet(&g_sCalContext) *
+                                    g_ppucCalPointPos[lIdx][0]) / 10);
+        g_pplCalPoints[lIdx][1] = ((GrContextDpyHeightGet(&g_sCalContext) *
+                                    g_ppucCalPointPos[lIdx][1]) / 10);
+    }
+
+    //
+    // Print the instructions between the calibration points in white with a
+    // 20 point small-caps font.
+    //
+    CalScreenClear();
+    GrContextForegroundSet(&g_sCalContext, ClrWhite);
+    GrContextFontSet(&g_sCalContext, &g_sFontCmsc20);
+    GrStringDrawCentered(&g_sCalContext, "Touch the box", -1,
+                         GrContextDpyWidthGet(&g_sCalContext) / 2,
+                         (GrContextDpyHeightGet(&g_sCalContext) * 35) / 100,
+                         0);
+    GrFlush(&g_sCalContext);
+
+    g_lCalPoint = 0;
+    g_lCalRetry = 0;
+    g_bCalAllTaken = false;
+    TouchScreenRawSet(true);
+    CalWait();
+}
+
+//*****************************************************************************
+//
+//! Handles touch screen messages during a calibration.
+//!
+//! \param ulMessage is the type of message.
+//! \param lX is the raw X reading.
+//! \param lY is the raw Y reading.
+//!
+//! This function is passed the touch screen messages while TouchCalActive()
+//! returns \b true, either directly or by being set as the touch screen
+//! event handler.  It only accumulates the readings; the drawing is left to
+//! TouchCalProcess().  Touches made before the box is shown are ignored, as
+//! are touches that are lifted before enough readings have been taken.
+//!
+//! \return Returns 0.
+//
+//*****************************************************************************
+int32_t
+TouchCalPointerMessage(uint32_t ulMessage, int32_t lX, int32_t lY)
+{
+    switch(g_ulCalState)
+    {
+        case CAL_STATE_TARGET:
+        {
+            if(ulMessage == WIDGET_MSG_PTR_DOWN)
+            {
+                g_lCalX = 0;
+                g_lCalY = 0;
+                g_lCalCount = -CAL_SKIP;
+                g_ulCalState = CAL_STATE_SAMPLING;
+            }
+            break;
+        }
+
+        case CAL_STATE_SAMPLING:
+        {
+            if(ulMessage == WIDGET_MSG_PTR_MOVE)
+            {
+                if(++g_lCalCount > 0)
+                {
+                    g_lCalX += lX;
+                    g_lCalY += lY;
+                }
+            }
+            else if(ulMessage == WIDGET_MSG_PTR_UP)
+            {
+                g_ulCalState = ((g_lCalCount > 0) ? CAL_STATE_LIFTED :
+                                CAL_STATE_TARGET);
+            }
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Advances the calibration timer.
+//!
+//! This function must be called TOUCHCAL_TICKS_PER_SECOND times a second,
+//! normally from the SysTick interrupt handler.  It does no drawing and
+//! returns quickly.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchCalTick(void)
+{
+    if(g_ulCalTicks && (--g_ulCalTicks == 0))
+    {
+        g_bCalTimeout = true;
+    }
+}
+
+//*****************************************************************************
+//
+//! Carries out the work of a calibration.
+//!
+//! This function must be called from the application's main loop after the
+//! touch screen messages have been handled.  It shows each box once its
+//! delay has run out, stores the readings once the pen is lifted, and
+//! finishes the calibration after the last point.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TouchCalProcess(void)
+{
+    if((g_ulCalState == CAL_STATE_WAIT) && g_bCalTimeout)
+    {
+        g_bCalTimeout = false;
+        g_ulCalState = CAL_STATE_TARGET;
+        CalBoxFill(ClrWhite);
+    }
+    else if(g_ulCalState == CAL_STATE_LIFTED)
+    {
+        //
+        // Save the averaged raw reading for this calibration point and erase
+        // its box.
+        //
+        g_pplCalPoints[g_lCalPoint][2] = g_lCalX / g_lCalCount;
+        g_pplCalPoints[g_lCalPoint][3] = g_lCalY / g_lCalCount;
+        CalBoxFill(ClrBlack);
+
+        //
+        // Move on to the next point until all have been taken.
+        //
+        if(!g_bCalAllTaken && (++g_lCalPoint < TOUCHCAL_POINTS))
+        {
+            CalWait();
+            return;
+        }
+        g_bCalAllTaken = true;
+
+        CalFinish();
+    }
+}
+
+//*****************************************************************************
+//
+//! Determines if a calibration is in progress.
+//!
+//! \return Returns \b true from the call to TouchCalStart() until the
+//! calibration has finished.
+//
+//*****************************************************************************
+bool
+TouchCalActive(void)
+{
+    return(g_ulCalState != CAL_STATE_IDLE);
+}
+
+//*****************************************************************************
+//
+//! Determines if TouchCalProcess() has work to do.
+//!
+//! Together with TouchScreenEventsPending(), this lets the main loop sleep
+//! until the next touch or timer interrupt.  To avoid missing a timeout that
+//! occurs just after the check, call it with interrupts disabled and sleep
+//! before enabling them again.
+//!
+//! \return Returns \b true if TouchCalProcess() should be called.
+//
+//*****************************************************************************
+bool
+TouchCalPending(void)
+{
+    return(((g_ulCalState == CAL_STATE_WAIT) && g_bCalTimeout) ||
+           (g_ulCalState == CAL_STATE_LIFTED));
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
@@ -0,0 +1,57 @@
+//*****************************************************************************
+//
+// touchcal.h - Prototypes for the touch screen calibration engine.
+//
+//*****************************************************************************
+
+#ifndef __TOUCHCAL_H__
+#define __TOUCHCAL_H__
+
+//*****************************************************************************
+//
+// The number of calibration points, from 5 to 9.
+//
+//*****************************************************************************
+#ifndef TOUCHCAL_POINTS
+#define TOUCHCAL_POINTS         9
+#endif
+
+//*****************************************************************************
+//
+// The rate at which TouchCalTick() is expected to be called.
+//
+//*****************************************************************************
+#define TOUCHCAL_TICKS_PER_SECOND   100
+
+//*****************************************************************************
+//
+// The outcome of a calibration, as passed to the function given to
+// TouchCalStart().  plParms holds M0-M6 if bFitted is set, and plResiduals
+// gives the distance of each point from the fit in tenths of a pixel.
+//
+//*****************************************************************************
+typedef struct
+{
+    bool bFitted;
+    bool bSaved;
+    int32_t plParms[7];
+    uint32_t ulPoints;
+    int32_t plResiduals[TOUCHCAL_POINTS];
+}
+tTouchCalResult;
+
+//*****************************************************************************
+//
+// Prototypes for the functions exported by the calibration engine.
+//
+//*****************************************************************************
+extern void TouchCalStart(const tDisplay *psDisplay,
+                          void (*pfnDone)(const tTouchCalResult *psResult));
+extern int32_t TouchCalPointerMessage(uint32_t ulMessage, int32_t lX,
+                                      int32_t lY);
+extern void TouchCalTick(void);
+extern void TouchCalProcess(void);
+extern bool TouchCalActive(void);
+extern bool TouchCalPending(void);
+
+#endif // __TOUCHCAL_H__